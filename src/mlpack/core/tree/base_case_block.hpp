@@ -0,0 +1,172 @@
+/**
+ * @file base_case_block.hpp
+ * @author agent
+ *
+ * Support for evaluating all of the base cases between two leaves at once.  A
+ * RuleType may optionally implement
+ *
+ * @code
+ * bool BaseCaseBlock(const size_t queryBegin,
+ *                    const size_t queryCount,
+ *                    const size_t referenceBegin,
+ *                    const size_t referenceCount);
+ * @endcode
+ *
+ * which is called by dual-tree traversers whose leaves hold contiguous ranges
+ * of points, instead of calling BaseCase() for each pair of points.  If it
+ * returns false, the traverser falls back to calling BaseCase() for each pair.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BASE_CASE_BLOCK_HPP
+#define MLPACK_CORE_TREE_BASE_CASE_BLOCK_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace tree {
+
+HAS_MEM_FUNC(BaseCaseBlock, HasBaseCaseBlockCheck);
+
+//! Whether or not the given RuleType implements BaseCaseBlock().
+template<typename RuleType>
+struct HasBaseCaseBlock
+{
+  static const bool value = HasBaseCaseBlockCheck<RuleType,
+      bool(RuleType::*)(const size_t, const size_t, const size_t,
+                        const size_t)>::value;
+};
+
+/**
+ * Call rule.BaseCaseBlock() and return its result.
+ */
+template<typename RuleType>
+inline typename std::enable_if<HasBaseCaseBlock<RuleType>::value, bool>::type
+BaseCaseBlock(RuleType& rule,
+              const size_t queryBegin,
+              const size_t queryCount,
+              const size_t referenceBegin,
+              const size_t referenceCount)
+{
+  return rule.BaseCaseBlock(queryBegin, queryCount, referenceBegin,
+      referenceCount);
+}
+
+/**
+ * The RuleType does not implement BaseCaseBlock(), so return false; the
+ * traverser will call BaseCase() for each pair of points.
+ */
+template<typename RuleType>
+inline typename std::enable_if<!HasBaseCaseBlock<RuleType>::value, bool>::type
+BaseCaseBlock(RuleType& /* rule */,
+              const size_t /* queryBegin */,
+              const size_t /* queryCount */,
+              const size_t /* referenceBegin */,
+              const size_t /* referenceCount */)
+{
+  return false;
+}
+
+/**
+ * Compute the distances between each point of a block of query points and each
+ * point of a block of reference points, so that distances(r, q) is the distance
+ * between query point (queryBegin + q) and reference point (referenceBegin +
+ * r).  The distances are only accurate up to roundoff: the true distance is
+ * within the returned slack of each computed distance.  Rules should use these
+ * distances to decide which base cases can be skipped, and compute the distance
+ * of the others exactly.
+ *
+ * This generic version returns false, which means that block distances cannot
+ * be computed for this metric.
+ *
+ * @param metric Instantiated metric.
+ * @param querySet Set of query points.
+ * @param queryBegin Index of first query point of the block.
+ * @param queryCount Number of query points in the block.
+ * @param referenceSet Set of reference points.
+ * @param referenceBegin Index of first reference point of the block.
+ * @param referenceCount Number of reference points in the block.
+ * @param distances Matrix to store distances in.
+ * @param slack Bound on the error of each computed distance.
+ * @return Whether or not the distances were computed.
+ */
+template<typename MetricType, typename MatType>
+bool BlockDistances(MetricType& /* metric */,
+                    const MatType& /* querySet */,
+                    const size_t /* queryBegin */,
+                    const size_t /* queryCount */,
+                    const MatType& /* referenceSet */,
+                    const size_t /* referenceBegin */,
+                    const size_t /* referenceCount */,
+                    arma::Mat<typename MatType::elem_type>& /* distances */,
+                    double& /* slack */)
+{
+  return false;
+}
+
+/**
+ * Compute the (squared) Euclidean distances between two blocks of points with
+ * one matrix product, using ||q - r||^2 = ||q||^2 + ||r||^2 - 2 <q, r>.
+ */
+template<bool TakeRoot, typename MatType>
+bool BlockDistances(metric::LMetric<2, TakeRoot>& /* metric */,
+                    const MatType& querySet,
+                    const size_t queryBegin,
+                    const size_t queryCount,
+                    const MatType& referenceSet,
+                    const size_t referenceBegin,
+                    const size_t referenceCount,
+                    arma::Mat<typename MatType::elem_type>& distances,
+                    double& slack)
+{
+  typedef typename MatType::elem_type ElemType;
+
+  if (queryCount == 0 || referenceCount == 0)
+  {
+    distances.set_size(referenceCount, queryCount);
+    slack = 0.0;
+    return true;
+  }
+
+  const auto queries = querySet.cols(queryBegin, queryBegin + queryCount - 1);
+  const auto references = referenceSet.cols(referenceBegin,
+      referenceBegin + referenceCount - 1);
+
+  const arma::Row<ElemType> queryNorms = arma::sum(arma::square(queries));
+  const arma::Row<ElemType> referenceNorms =
+      arma::sum(arma::square(references));
+
+  distances = references.t() * queries;
+  distances *= -2;
+  distances.each_col() += referenceNorms.t();
+  distances.each_row() += queryNorms;
+
+  // Roundoff can make the squared distance of (nearly) identical points
+  // slightly negative.
+  distances.transform([](ElemType d) { return (d < 0) ? ElemType(0) : d; });
+
+  // The error of each inner product is at most about (dimensionality * epsilon)
+  // times the product of the norms; be generous.
+  slack = 2.0 * (querySet.n_rows + 4) *
+      std::numeric_limits<ElemType>::epsilon() *
+      (double(queryNorms.max()) + double(referenceNorms.max()));
+
+  if (TakeRoot)
+  {
+    distances = arma::sqrt(distances);
+    // |sqrt(a) - sqrt(b)| <= sqrt(|a - b|).
+    slack = std::sqrt(slack);
+  }
+
+  return true;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
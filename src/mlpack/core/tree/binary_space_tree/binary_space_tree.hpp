@@ -14,7 +14,10 @@
 #include <mlpack/prereqs.hpp>
 
 #include "../statistic.hpp"
+#include "../borrow_dataset.hpp"
 #include "midpoint_split.hpp"
+#include "node_arena.hpp"
+#include "split_traits.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -32,6 +35,13 @@ namespace tree /** Trees and tree-building procedures. */ {
  * This tree does take one runtime parameter in the constructor, which is the
  * max leaf size to be used.
  *
+ * When the tree is built from a dataset, the nodes below the root are
+ * allocated from an arena owned by the root, so that nodes which are close
+ * together in the tree are close together in memory.  If mlpack is built with
+ * OpenMP and the split type allows it (see SplitTraits), the subtrees of large
+ * trees are built in parallel; the resulting tree is the same as the one built
+ * on a single thread.
+ *
  * @tparam MetricType The metric used for tree-building.  The BoundType may
  *     place restrictions on the metrics that can be used.
  * @tparam StatisticType Extra data contained in the node.  See statistic.hpp
@@ -86,8 +96,21 @@ class BinarySpaceTree
   //! The minimum distance from the center to any edge of the bound.
   ElemType minimumBoundDistance;
   //! The dataset.  If we are the root of the tree, we own the dataset and must
-  //! delete it.
+  //! delete it (if the dataset is borrowed, this only holds an alias of the
+  //! caller's memory).
   MatType* dataset;
+  //! If the dataset is borrowed, the index in the dataset of each point of the
+  //! tree, so that the points of this node are (*indices)[begin] to
+  //! (*indices)[begin + count - 1]; otherwise NULL.  If we are the root of the
+  //! tree, we own the indices and must delete them.
+  std::vector<size_t>* indices;
+  //! The arena the children of this node are allocated from, or NULL if they
+  //! are allocated individually.  If we are the root of the tree, we own the
+  //! arena and must delete it.
+  NodeArena<BinarySpaceTree>* arena;
+  //! Whether this node was allocated from an arena (in which case it must be
+  //! destroyed but not deleted).
+  bool inArena;
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -196,6 +219,23 @@ class BinarySpaceTree
                   std::vector<size_t>& newFromOld,
                   const size_t maxLeafSize = 20);
 
+  /**
+   * Construct this as the root node of a binary space tree that references the
+   * given dataset instead of copying it.  The dataset is reordered while the
+   * tree is built and then restored, so it is unchanged when the constructor
+   * returns; the tree keeps a permutation of the point indices instead, and
+   * Point() and Descendant() return indices into the given dataset.  The
+   * dataset must outlive the tree and must not be modified while the tree
+   * exists.  See BorrowDataset for more details.
+   *
+   * @param data Dataset to create tree from.  This will not be copied.
+   * @param borrowDataset Instance of BorrowDataset, to select this constructor.
+   * @param maxLeafSize Size of each leaf in the tree.
+   */
+  BinarySpaceTree(MatType& data,
+                  const BorrowDataset borrowDataset,
+                  const size_t maxLeafSize = 20);
+
   /**
    * Construct this node as a child of the given parent, starting at column
    * begin and using count points.  The ordering of that subset of points in the
@@ -333,6 +373,20 @@ class BinarySpaceTree
   //! Modify the dataset which the tree is built on.  Be careful!
   MatType& Dataset() { return *dataset; }
 
+  //! Return whether the tree references the caller's dataset (see
+  //! BorrowDataset), in which case the points of a node are not contiguous.
+  bool BorrowsDataset() const { return indices != NULL; }
+
+  /**
+   * Copy the points held in this node (and its descendants) into the given
+   * matrix, so that column i of the matrix is the point Descendant(i).  For a
+   * tree that does not borrow its dataset, these points are already contiguous
+   * in the dataset.
+   *
+   * @param points Matrix to store the points in.
+   */
+  void GatherPoints(MatType& points) const;
+
   //! Get the metric that the tree uses.
   MetricType Metric() const { return MetricType(); }
 
@@ -494,26 +548,85 @@ class BinarySpaceTree
 
  private:
   /**
-   * Splits the current node, assigning its left and right children recursively.
+   * Create a node of the tree that holds the given points of the parent's
+   * dataset, but do not split it.  If an arena is given, the node is expected
+   * to have been allocated from it, and its children will be allocated from it
+   * too.
+   *
+   * @param parent Parent of this node.
+   * @param begin Index of point to start tree construction with.
+   * @param count Number of points to use to construct tree.
+   * @param arena Arena the node was allocated from (may be NULL).
+   */
+  BinarySpaceTree(BinarySpaceTree* parent,
+                  const size_t begin,
+                  const size_t count,
+                  NodeArena<BinarySpaceTree>* arena);
+
+  /**
+   * Build the tree below this node (which should be the root), building large
+   * subtrees in parallel if possible.
    *
+   * @param oldFromNew Vector holding permuted indices (may be NULL).
    * @param maxLeafSize Maximum number of points held in a leaf.
    * @param splitter Instantiated SplitType object.
    */
-  void SplitNode(const size_t maxLeafSize,
+  void BuildTree(std::vector<size_t>* oldFromNew,
+                 const size_t maxLeafSize,
                  SplitType<BoundType<MetricType>, MatType>& splitter);
 
   /**
-   * Splits the current node, assigning its left and right children recursively.
-   * Also returns a list of the changed indices.
+   * Build the subtree below this node recursively, on the current thread.
+   *
+   * @param oldFromNew Vector holding permuted indices (may be NULL).
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @param splitter Instantiated SplitType object.
+   */
+  void BuildSubtree(std::vector<size_t>* oldFromNew,
+                    const size_t maxLeafSize,
+                    SplitType<BoundType<MetricType>, MatType>& splitter);
+
+  /**
+   * Split the current node, assigning its left and right children (which are
+   * not split themselves).  If oldFromNew is not NULL, the changed indices are
+   * recorded in it.
    *
-   * @param oldFromNew Vector holding permuted indices.
+   * @param oldFromNew Vector holding permuted indices (may be NULL).
    * @param maxLeafSize Maximum number of points held in a leaf.
    * @param splitter Instantiated SplitType object.
+   * @return Whether or not the node was split.
    */
-  void SplitNode(std::vector<size_t>& oldFromNew,
+  bool SplitNode(std::vector<size_t>* oldFromNew,
                  const size_t maxLeafSize,
                  SplitType<BoundType<MetricType>, MatType>& splitter);
 
+  /**
+   * Finish the current node once its children (if any) are built: set the
+   * parent distances of the children and create the statistic.
+   */
+  void FinishNode();
+
+  /**
+   * Create a child of this node holding the given points, allocating it from
+   * the arena if there is one.
+   */
+  BinarySpaceTree* NewChild(const size_t begin, const size_t count);
+
+  /**
+   * Destroy the given node (which may be NULL), deleting it only if it was not
+   * allocated from an arena.
+   */
+  static void DeleteNode(BinarySpaceTree* node);
+
+  /**
+   * Set the index permutation of this node and its descendants once a tree that
+   * borrows its dataset is built, and recreate their statistics so that they
+   * see the points through the permutation.
+   *
+   * @param newIndices Index in the dataset of each point of the tree.
+   */
+  void SetIndices(std::vector<size_t>* newIndices);
+
   /**
    * Update the bound of the current node. This method does not take into
    * account bound-specific properties.
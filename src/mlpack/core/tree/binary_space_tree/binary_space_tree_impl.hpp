@@ -17,6 +17,11 @@
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
 #include <queue>
+#include <algorithm>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace tree {
@@ -40,14 +45,14 @@ BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    indices(NULL),
+    arena(new NodeArena<BinarySpaceTree>()),
+    inArena(false)
 {
-  // Do the actual splitting of this node.
+  // Do the actual splitting and build the statistics of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(maxLeafSize, splitter);
-
-  // Create the statistic depending on if we are a leaf or not.
-  stat = StatisticType(*this);
+  BuildTree(NULL, maxLeafSize, splitter);
 }
 
 template<typename MetricType,
@@ -68,19 +73,19 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    indices(NULL),
+    arena(new NodeArena<BinarySpaceTree>()),
+    inArena(false)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting and build the statistics.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
-
-  // Create the statistic depending on if we are a leaf or not.
-  stat = StatisticType(*this);
+  BuildTree(&oldFromNew, maxLeafSize, splitter);
 }
 
 template<typename MetricType,
@@ -102,19 +107,19 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    indices(NULL),
+    arena(new NodeArena<BinarySpaceTree>()),
+    inArena(false)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting and build the statistics.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
-
-  // Create the statistic depending on if we are a leaf or not.
-  stat = StatisticType(*this);
+  BuildTree(&oldFromNew, maxLeafSize, splitter);
 
   // Map the newFromOld indices correctly.
   newFromOld.resize(data.n_cols);
@@ -137,14 +142,14 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    indices(NULL),
+    arena(new NodeArena<BinarySpaceTree>()),
+    inArena(false)
 {
-  // Do the actual splitting of this node.
+  // Do the actual splitting and build the statistics of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(maxLeafSize, splitter);
-
-  // Create the statistic depending on if we are a leaf or not.
-  stat = StatisticType(*this);
+  BuildTree(NULL, maxLeafSize, splitter);
 }
 
 template<typename MetricType,
@@ -165,19 +170,19 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    indices(NULL),
+    arena(new NodeArena<BinarySpaceTree>()),
+    inArena(false)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(dataset->n_cols);
   for (size_t i = 0; i < dataset->n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting and build the statistics.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
-
-  // Create the statistic depending on if we are a leaf or not.
-  stat = StatisticType(*this);
+  BuildTree(&oldFromNew, maxLeafSize, splitter);
 }
 
 template<typename MetricType,
@@ -199,19 +204,19 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    indices(NULL),
+    arena(new NodeArena<BinarySpaceTree>()),
+    inArena(false)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(dataset->n_cols);
   for (size_t i = 0; i < dataset->n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting and build the statistics.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
-
-  // Create the statistic depending on if we are a leaf or not.
-  stat = StatisticType(*this);
+  BuildTree(&oldFromNew, maxLeafSize, splitter);
 
   // Map the newFromOld indices correctly.
   newFromOld.resize(dataset->n_cols);
@@ -219,6 +224,44 @@ BinarySpaceTree(
     newFromOld[oldFromNew[i]] = i;
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BinarySpaceTree(
+    MatType& data,
+    const BorrowDataset /* borrowDataset */,
+    const size_t maxLeafSize) :
+    left(NULL),
+    right(NULL),
+    parent(NULL),
+    begin(0),
+    count(data.n_cols),
+    bound(data.n_rows),
+    parentDistance(0), // Parent distance for the root is 0: it has no parent.
+    // Alias the caller's memory; only the alias is deleted with the tree.
+    dataset(new MatType(data.memptr(), data.n_rows, data.n_cols, false, true)),
+    indices(NULL),
+    arena(new NodeArena<BinarySpaceTree>()),
+    inArena(false)
+{
+  std::vector<size_t> oldFromNew(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; i++)
+    oldFromNew[i] = i; // Fill with unharmed indices.
+
+  // Build the tree as usual, which reorders the dataset.
+  SplitType<BoundType<MetricType>, MatType> splitter;
+  BuildTree(&oldFromNew, maxLeafSize, splitter);
+
+  // Now put the points back where the caller had them, and let the nodes find
+  // their points through the permutation instead.
+  RestoreOriginalOrder(*dataset, oldFromNew);
+  SetIndices(new std::vector<size_t>(std::move(oldFromNew)));
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -238,13 +281,13 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset()) // Point to the parent's dataset.
+    dataset(&parent->Dataset()), // Point to the parent's dataset.
+    indices(parent->indices),
+    arena(NULL),
+    inArena(false)
 {
-  // Perform the actual splitting.
-  SplitNode(maxLeafSize, splitter);
-
-  // Create the statistic depending on if we are a leaf or not.
-  stat = StatisticType(*this);
+  // Perform the actual splitting and build the statistics.
+  BuildSubtree(NULL, maxLeafSize, splitter);
 }
 
 template<typename MetricType,
@@ -267,17 +310,17 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    indices(parent->indices),
+    arena(NULL),
+    inArena(false)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
   assert(oldFromNew.size() == dataset->n_cols);
 
-  // Perform the actual splitting.
-  SplitNode(oldFromNew, maxLeafSize, splitter);
-
-  // Create the statistic depending on if we are a leaf or not.
-  stat = StatisticType(*this);
+  // Perform the actual splitting and build the statistics.
+  BuildSubtree(&oldFromNew, maxLeafSize, splitter);
 }
 
 template<typename MetricType,
@@ -301,17 +344,17 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset()->n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    indices(parent->indices),
+    arena(NULL),
+    inArena(false)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
   Log::Assert(oldFromNew.size() == dataset->n_cols);
 
-  // Perform the actual splitting.
-  SplitNode(oldFromNew, maxLeafSize, splitter);
-
-  // Create the statistic depending on if we are a leaf or not.
-  stat = StatisticType(*this);
+  // Perform the actual splitting and build the statistics.
+  BuildSubtree(&oldFromNew, maxLeafSize, splitter);
 
   // Map the newFromOld indices correctly.
   newFromOld.resize(dataset->n_cols);
@@ -319,6 +362,35 @@ BinarySpaceTree(
     newFromOld[oldFromNew[i]] = i;
 }
 
+/**
+ * Create a node that is not split, for use when building the tree.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BinarySpaceTree(
+    BinarySpaceTree* parent,
+    const size_t begin,
+    const size_t count,
+    NodeArena<BinarySpaceTree>* arena) :
+    left(NULL),
+    right(NULL),
+    parent(parent),
+    begin(begin),
+    count(count),
+    bound(parent->Dataset().n_rows),
+    dataset(&parent->Dataset()),
+    indices(parent->indices),
+    arena(arena),
+    inArena(arena != NULL)
+{
+  // Nothing to do; the node is split when the tree is built.
+}
+
 /**
  * Create a binary space tree by copying the other tree.  Be careful!  This can
  * take a long time and use a lot of memory.
@@ -342,7 +414,11 @@ BinarySpaceTree(
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     // Copy matrix, but only if we are the root.
-    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
+    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    indices((other.parent == NULL && other.indices) ?
+        new std::vector<size_t>(*other.indices) : NULL),
+    arena(NULL), // The copied children are allocated individually.
+    inArena(false)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -371,6 +447,7 @@ BinarySpaceTree(
       queue.pop();
 
       node->dataset = dataset;
+      node->indices = indices;
       if (node->left)
         queue.push(node->left);
       if (node->right)
@@ -400,7 +477,10 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    indices(other.indices),
+    arena(other.arena),
+    inArena(false)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -412,6 +492,8 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.indices = NULL;
+  other.arena = NULL;
 
   // Set new parent.
   if (left)
@@ -455,12 +537,17 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
-  delete left;
-  delete right;
+  DeleteNode(left);
+  DeleteNode(right);
 
-  // If we're the root, delete the matrix.
+  // If we're the root, delete the matrix, the indices and the arena the other
+  // nodes were allocated from.
   if (!parent)
+  {
     delete dataset;
+    delete indices;
+    delete arena;
+  }
 }
 
 template<typename MetricType,
@@ -719,7 +806,7 @@ template<typename MetricType,
 inline size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
                               SplitType>::Descendant(const size_t index) const
 {
-  return (begin + index);
+  return indices ? (*indices)[begin + index] : (begin + index);
 }
 
 /**
@@ -734,7 +821,7 @@ template<typename MetricType,
 inline size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
                               SplitType>::Point(const size_t index) const
 {
-  return (begin + index);
+  return indices ? (*indices)[begin + index] : (begin + index);
 }
 
 template<typename MetricType,
@@ -744,8 +831,121 @@ template<typename MetricType,
          template<typename SplitBoundType, typename SplitMatType>
              class SplitType>
 void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
-    SplitNode(const size_t maxLeafSize,
-              SplitType<BoundType<MetricType>, MatType>& splitter)
+BuildTree(std::vector<size_t>* oldFromNew,
+          const size_t maxLeafSize,
+          SplitType<BoundType<MetricType>, MatType>& splitter)
+{
+#ifdef HAS_OPENMP
+  // Subtrees can only be built in parallel if the splitter can be used from
+  // several threads at once, and if the bounds of sibling nodes don't depend
+  // on each other (as they do for hollow ball bounds).
+  const bool parallel = SplitTraits<Split>::ParallelSafe &&
+      !std::is_same<BoundType<MetricType>,
+                    bound::HollowBallBound<MetricType>>::value;
+  const size_t numThreads = omp_get_max_threads();
+
+  // Building a subtree on its own thread is only worthwhile if it is large
+  // enough.
+  const size_t minParallelCount = 4096;
+
+  if (!parallel || numThreads == 1 || count < 2 * minParallelCount)
+  {
+    BuildSubtree(oldFromNew, maxLeafSize, splitter);
+    return;
+  }
+
+  // Split the top of the tree on this thread, level by level, until there are
+  // enough subtrees to keep all the threads busy.  The nodes that are split
+  // here are kept in breadth-first order, so that they can be finished from the
+  // bottom up once their subtrees are built.
+  std::vector<BinarySpaceTree*> splitNodes;
+  std::vector<BinarySpaceTree*> frontier(1, this);
+  std::vector<BinarySpaceTree*> subtrees;
+  while (!frontier.empty() && frontier.size() + subtrees.size() <
+      4 * numThreads)
+  {
+    std::vector<BinarySpaceTree*> nextFrontier;
+    for (size_t i = 0; i < frontier.size(); ++i)
+    {
+      BinarySpaceTree* node = frontier[i];
+      if (node->count < minParallelCount)
+      {
+        subtrees.push_back(node);
+      }
+      else if (node->SplitNode(oldFromNew, maxLeafSize, splitter))
+      {
+        splitNodes.push_back(node);
+        nextFrontier.push_back(node->left);
+        nextFrontier.push_back(node->right);
+      }
+      else
+      {
+        // The node could not be split, so it is a leaf.
+        node->FinishNode();
+      }
+    }
+
+    frontier.swap(nextFrontier);
+  }
+  subtrees.insert(subtrees.end(), frontier.begin(), frontier.end());
+
+  // Each subtree allocates its nodes from its own arena, so that the nodes of a
+  // subtree are still contiguous and the threads don't share an allocator.
+  // The largest subtrees are started first.
+  std::sort(subtrees.begin(), subtrees.end(),
+      [](const BinarySpaceTree* a, const BinarySpaceTree* b)
+      {
+        return a->count > b->count;
+      });
+  for (size_t i = 0; i < subtrees.size(); ++i)
+    subtrees[i]->arena = arena->Fork();
+
+  // The subtrees hold disjoint ranges of the dataset (and of oldFromNew), so
+  // they can be built independently.
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+    subtrees[i]->BuildSubtree(oldFromNew, maxLeafSize, splitter);
+
+  // Now finish the top of the tree.
+  for (size_t i = splitNodes.size(); i > 0; --i)
+    splitNodes[i - 1]->FinishNode();
+#else
+  BuildSubtree(oldFromNew, maxLeafSize, splitter);
+#endif
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BuildSubtree(std::vector<size_t>* oldFromNew,
+             const size_t maxLeafSize,
+             SplitType<BoundType<MetricType>, MatType>& splitter)
+{
+  // Split this node, then recursively build its children.  The left child must
+  // be built first, since the bound of the right child may depend on it.
+  if (SplitNode(oldFromNew, maxLeafSize, splitter))
+  {
+    left->BuildSubtree(oldFromNew, maxLeafSize, splitter);
+    right->BuildSubtree(oldFromNew, maxLeafSize, splitter);
+  }
+
+  FinishNode();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+SplitNode(std::vector<size_t>* oldFromNew,
+          const size_t maxLeafSize,
+          SplitType<BoundType<MetricType>, MatType>& splitter)
 {
   // We need to expand the bounds of this node properly.
   UpdateBound(bound);
@@ -755,7 +955,7 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 
   // Now, check if we need to split at all.
   if (count <= maxLeafSize)
-    return; // We can't split this.
+    return false; // We can't split this.
 
   // splitCol denotes the two partitions of the dataset after the split. The
   // points on its left go to the left child and the others go to the right
@@ -771,35 +971,26 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   // The node may not be always split. For instance, if all the points are the
   // same, we can't split them.
   if (!split)
-    return;
+    return false;
 
   // Perform the actual splitting.  This will order the dataset such that
   // points that belong to the left subtree are on the left of splitCol, and
   // points from the right subtree are on the right side of splitCol.
-  splitCol = splitter.PerformSplit(*dataset, begin, count, splitInfo);
+  if (oldFromNew)
+    splitCol = splitter.PerformSplit(*dataset, begin, count, splitInfo,
+        *oldFromNew);
+  else
+    splitCol = splitter.PerformSplit(*dataset, begin, count, splitInfo);
 
   assert(splitCol > begin);
   assert(splitCol < begin + count);
 
-  // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
-      maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      splitter, maxLeafSize);
-
-  // Calculate parent distances for those two nodes.
-  arma::vec center, leftCenter, rightCenter;
-  Center(center);
-  left->Center(leftCenter);
-  right->Center(rightCenter);
-
-  const ElemType leftParentDistance = MetricType::Evaluate(center, leftCenter);
-  const ElemType rightParentDistance = MetricType::Evaluate(center,
-      rightCenter);
+  // Now that we know the split column, we can create the children.  They are
+  // allocated together, so siblings are next to each other in the arena.
+  left = NewChild(begin, splitCol - begin);
+  right = NewChild(splitCol, begin + count - splitCol);
 
-  left->ParentDistance() = leftParentDistance;
-  right->ParentDistance() = rightParentDistance;
+  return true;
 }
 
 template<typename MetricType,
@@ -809,64 +1000,103 @@ template<typename MetricType,
          template<typename SplitBoundType, typename SplitMatType>
              class SplitType>
 void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
-SplitNode(std::vector<size_t>& oldFromNew,
-          const size_t maxLeafSize,
-          SplitType<BoundType<MetricType>, MatType>& splitter)
+FinishNode()
 {
-  // We need to expand the bounds of this node properly.
-  UpdateBound(bound);
-
-  // Calculate the furthest descendant distance.
-  furthestDescendantDistance = 0.5 * bound.Diameter();
-
-  // First, check if we need to split at all.
-  if (count <= maxLeafSize)
-    return; // We can't split this.
-
-  // splitCol denotes the two partitions of the dataset after the split. The
-  // points on its left go to the left child and the others go to the right
-  // child.
-  size_t splitCol;
+  // Calculate parent distances for the children.
+  if (left && right)
+  {
+    arma::vec center, leftCenter, rightCenter;
+    Center(center);
+    left->Center(leftCenter);
+    right->Center(rightCenter);
+
+    const ElemType leftParentDistance = MetricType::Evaluate(center,
+        leftCenter);
+    const ElemType rightParentDistance = MetricType::Evaluate(center,
+        rightCenter);
+
+    left->ParentDistance() = leftParentDistance;
+    right->ParentDistance() = rightParentDistance;
+  }
 
-  // Find the partition of the node. This method does not perform the split.
-  typename Split::SplitInfo splitInfo;
+  // Create the statistic depending on if we are a leaf or not.
+  stat = StatisticType(*this);
+}
 
-  const bool split = splitter.SplitNode(bound, *dataset, begin, count,
-      splitInfo);
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>*
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+NewChild(const size_t childBegin, const size_t childCount)
+{
+  if (arena)
+    return new (arena->Allocate()) BinarySpaceTree(this, childBegin,
+        childCount, arena);
+  else
+    return new BinarySpaceTree(this, childBegin, childCount, NULL);
+}
 
-  // The node may not be always split. For instance, if all the points are the
-  // same, we can't split them.
-  if (!split)
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+DeleteNode(BinarySpaceTree* node)
+{
+  if (!node)
     return;
 
-  // Perform the actual splitting.  This will order the dataset such that
-  // points that belong to the left subtree are on the left of splitCol, and
-  // points from the right subtree are on the right side of splitCol.
-  splitCol = splitter.PerformSplit(*dataset, begin, count, splitInfo,
-      oldFromNew);
-
-  assert(splitCol > begin);
-  assert(splitCol < begin + count);
+  // Nodes in an arena are freed with the arena.
+  if (node->inArena)
+    node->~BinarySpaceTree();
+  else
+    delete node;
+}
 
-  // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
-      splitter, maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      oldFromNew, splitter, maxLeafSize);
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+SetIndices(std::vector<size_t>* newIndices)
+{
+  indices = newIndices;
+  if (left)
+    left->SetIndices(newIndices);
+  if (right)
+    right->SetIndices(newIndices);
 
-  // Calculate parent distances for those two nodes.
-  arma::vec center, leftCenter, rightCenter;
-  Center(center);
-  left->Center(leftCenter);
-  right->Center(rightCenter);
+  // The statistics of the children are ready, so this one can be recreated.
+  stat = StatisticType(*this);
+}
 
-  const ElemType leftParentDistance = MetricType::Evaluate(center, leftCenter);
-  const ElemType rightParentDistance = MetricType::Evaluate(center,
-      rightCenter);
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+GatherPoints(MatType& points) const
+{
+  if (!indices)
+  {
+    points = (count > 0) ? MatType(dataset->cols(begin, begin + count - 1)) :
+        MatType(dataset->n_rows, 0);
+    return;
+  }
 
-  left->ParentDistance() = leftParentDistance;
-  right->ParentDistance() = rightParentDistance;
+  points.set_size(dataset->n_rows, count);
+  for (size_t i = 0; i < count; ++i)
+    points.col(i) = dataset->col((*indices)[begin + i]);
 }
 
 template<typename MetricType,
@@ -926,7 +1156,10 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
-    dataset(NULL)
+    dataset(NULL),
+    indices(NULL),
+    arena(NULL),
+    inArena(false)
 {
   // Nothing to do.
 }
@@ -946,15 +1179,30 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 {
   using data::CreateNVP;
 
+  // A borrowed dataset is not ours to save, and the points of the nodes are
+  // not where a loaded tree would expect them.
+  if (Archive::is_saving::value && indices)
+  {
+    throw std::invalid_argument("BinarySpaceTree::Serialize(): cannot save a "
+        "tree that borrows its dataset");
+  }
+
   // If we're loading, and we have children, they need to be deleted.
   if (Archive::is_loading::value)
   {
-    if (left)
-      delete left;
-    if (right)
-      delete right;
+    DeleteNode(left);
+    DeleteNode(right);
     if (!parent)
+    {
       delete dataset;
+      delete indices;
+      delete arena;
+    }
+
+    // The loaded children are allocated individually, and the loaded tree owns
+    // its dataset.
+    arena = NULL;
+    indices = NULL;
   }
 
   ar & CreateNVP(parent, "parent");
@@ -16,6 +16,7 @@
 
 // In case it hasn't been included yet.
 #include "dual_tree_traverser.hpp"
+#include "../base_case_block.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -59,22 +60,31 @@ DualTreeTraverser<RuleType>::Traverse(
   // If both are leaves, we must evaluate the base case.
   if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
+    // Unless a dataset is borrowed, the points of each leaf are contiguous, so
+    // the rules may be able to evaluate all of the base cases at once.
+    if (!queryNode.BorrowsDataset() && !referenceNode.BorrowsDataset() &&
+        BaseCaseBlock(rule, queryNode.Begin(), queryNode.Count(),
+        referenceNode.Begin(), referenceNode.Count()))
+    {
+      numBaseCases += queryNode.Count() * referenceNode.Count();
+      return;
+    }
+
     // Loop through each of the points in each node.
-    const size_t queryEnd = queryNode.Begin() + queryNode.Count();
-    const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
-    for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
+    for (size_t i = 0; i < queryNode.Count(); ++i)
     {
       // See if we need to investigate this point (this function should be
       // implemented for the single-tree recursion too).  Restore the traversal
       // information first.
+      const size_t query = queryNode.Point(i);
       rule.TraversalInfo() = traversalInfo;
       const double childScore = rule.Score(query, referenceNode);
 
       if (childScore == DBL_MAX)
         continue; // We can't improve this particular point.
 
-      for (size_t ref = referenceNode.Begin(); ref < refEnd; ++ref)
-        rule.BaseCase(query, ref);
+      for (size_t j = 0; j < referenceNode.Count(); ++j)
+        rule.BaseCase(query, referenceNode.Point(j));
 
       numBaseCases += referenceNode.Count();
     }
@@ -0,0 +1,101 @@
+/**
+ * @file node_arena.hpp
+ * @author agent
+ *
+ * A simple arena that tree nodes can be allocated from, so that the nodes of a
+ * tree are stored in a few large blocks of memory (in the order they were
+ * allocated) rather than each in its own allocation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_NODE_ARENA_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_NODE_ARENA_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * An arena of memory for objects of type NodeType.  Memory is handed out in
+ * allocation order from blocks of blockSize objects; it is only released when
+ * the arena is destroyed.  The arena never calls constructors or destructors:
+ * objects are created in the returned memory with placement new, and the owner
+ * of the arena must call their destructors before the arena is destroyed.
+ *
+ * Allocate() is not thread-safe.  When several threads need to allocate at
+ * once, each should use its own arena created with Fork(); forked arenas are
+ * owned (and freed) by the arena they were forked from.
+ *
+ * @tparam NodeType Type of object to allocate memory for.
+ */
+template<typename NodeType>
+class NodeArena
+{
+ public:
+  /**
+   * Create an empty arena.  No memory is allocated until the first call to
+   * Allocate().
+   *
+   * @param blockSize Number of objects held by each block of memory.
+   */
+  NodeArena(const size_t blockSize = 256) :
+      blockSize(blockSize),
+      used(blockSize)
+  { }
+
+  //! Free all of the memory of the arena and any forked arenas.
+  ~NodeArena()
+  {
+    for (size_t i = 0; i < blocks.size(); ++i)
+      ::operator delete(blocks[i]);
+    for (size_t i = 0; i < forks.size(); ++i)
+      delete forks[i];
+  }
+
+  //! Return memory for one object of type NodeType.
+  void* Allocate()
+  {
+    if (used == blockSize)
+    {
+      blocks.push_back(static_cast<char*>(
+          ::operator new(blockSize * sizeof(NodeType))));
+      used = 0;
+    }
+
+    return blocks.back() + (used++) * sizeof(NodeType);
+  }
+
+  /**
+   * Create a new arena owned by this one.  This is not thread-safe, so forks
+   * should be created before the threads that will use them start.
+   */
+  NodeArena* Fork()
+  {
+    forks.push_back(new NodeArena(blockSize));
+    return forks.back();
+  }
+
+ private:
+  //! Arenas cannot be copied.
+  NodeArena(const NodeArena& other);
+  //! Arenas cannot be copied.
+  NodeArena& operator=(const NodeArena& other);
+
+  //! The number of objects in each block.
+  size_t blockSize;
+  //! The number of objects used in the last block.
+  size_t used;
+  //! The blocks of memory.
+  std::vector<char*> blocks;
+  //! Arenas forked from this one.
+  std::vector<NodeArena*> forks;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
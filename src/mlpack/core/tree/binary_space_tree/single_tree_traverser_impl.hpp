@@ -51,9 +51,8 @@ SingleTreeTraverser<RuleType>::Traverse(
   // If we are a leaf, run the base case as necessary.
   if (referenceNode.IsLeaf())
   {
-    const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
-    for (size_t i = referenceNode.Begin(); i < refEnd; ++i)
-      rule.BaseCase(queryIndex, i);
+    for (size_t i = 0; i < referenceNode.Count(); ++i)
+      rule.BaseCase(queryIndex, referenceNode.Point(i));
   }
   else
   {
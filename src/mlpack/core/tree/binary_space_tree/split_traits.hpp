@@ -0,0 +1,57 @@
+/**
+ * @file split_traits.hpp
+ * @author agent
+ *
+ * Traits of the split types used by BinarySpaceTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+
+#include "midpoint_split.hpp"
+#include "mean_split.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The SplitTraits class describes a split type used by BinarySpaceTree.  By
+ * default, nothing is assumed about the split.
+ */
+template<typename SplitType>
+class SplitTraits
+{
+ public:
+  /**
+   * If true, the split may be used from several threads at once on disjoint
+   * parts of the dataset, so that subtrees can be built in parallel.  This is
+   * not true of splits that keep state between nodes or that use the global
+   * random number generator.
+   */
+  static const bool ParallelSafe = false;
+};
+
+//! The midpoint split has no state.
+template<typename BoundType, typename MatType>
+class SplitTraits<MidpointSplit<BoundType, MatType>>
+{
+ public:
+  static const bool ParallelSafe = true;
+};
+
+//! The mean split has no state.
+template<typename BoundType, typename MatType>
+class SplitTraits<MeanSplit<BoundType, MatType>>
+{
+ public:
+  static const bool ParallelSafe = true;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file borrow_dataset.hpp
+ * @author agent
+ *
+ * Definition of the BorrowDataset tag, which selects the constructors of
+ * BinarySpaceTree and Octree that reference the caller's dataset instead of
+ * copying it, and of a helper that restores the column order of a dataset
+ * after it has been reordered by tree construction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BORROW_DATASET_HPP
+#define MLPACK_CORE_TREE_BORROW_DATASET_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Pass an instance of this class to a BinarySpaceTree or Octree constructor to
+ * build the tree on the given dataset without copying it:
+ *
+ * @code
+ * KDTree<EuclideanDistance, EmptyStatistic, arma::mat> tree(data,
+ *     BorrowDataset());
+ * @endcode
+ *
+ * The dataset is reordered while the tree is built and then restored to its
+ * original order, so when the constructor returns the dataset is unchanged.
+ * The tree keeps a permutation of the point indices instead, so Point() and
+ * Descendant() return indices into the original dataset, and no mapping is
+ * needed to interpret results.  The dataset must not be modified or destroyed
+ * while the tree exists.  Because the points of a node are no longer contiguous
+ * in memory, base cases are evaluated one pair at a time; a node's points can
+ * be gathered into a contiguous matrix with GatherPoints() when needed.
+ */
+struct BorrowDataset { };
+
+/**
+ * Given a dataset whose columns have been reordered so that column i holds the
+ * point that was originally in column oldFromNew[i], move every point back to
+ * its original column.  This works in place and needs only one extra column.
+ *
+ * @param data Dataset to restore.
+ * @param oldFromNew Original index of each column of the dataset.
+ */
+template<typename MatType>
+void RestoreOriginalOrder(MatType& data, const std::vector<size_t>& oldFromNew)
+{
+  std::vector<size_t> newFromOld(oldFromNew.size());
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    newFromOld[oldFromNew[i]] = i;
+
+  // Follow each cycle of the permutation, pulling into each column the point
+  // that belongs there.  The first column of the cycle is saved, since it is
+  // overwritten first and is needed last.
+  std::vector<bool> restored(oldFromNew.size(), false);
+  arma::Col<typename MatType::elem_type> first;
+  for (size_t start = 0; start < newFromOld.size(); ++start)
+  {
+    if (restored[start] || newFromOld[start] == start)
+      continue;
+
+    first = data.col(start);
+    size_t i = start;
+    while (newFromOld[i] != start)
+    {
+      data.col(i) = data.col(newFromOld[i]);
+      restored[i] = true;
+      i = newFromOld[i];
+    }
+    data.col(i) = first;
+    restored[i] = true;
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,8 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/math/range.hpp>
 
+#include <deque>
+
 #include "../statistic.hpp"
 #include "first_point_is_root.hpp"
 
@@ -107,7 +109,8 @@ class CoverTree
   /**
    * Create the cover tree with the given dataset and given base.
    * The dataset will not be modified during the building procedure (unlike
-   * BinarySpaceTree).
+   * BinarySpaceTree), and it is referenced instead of copied, so it must
+   * outlive the tree.
    *
    * The last argument will be removed in mlpack 1.1.0 (see #274 and #273).
    *
@@ -121,7 +124,8 @@ class CoverTree
   /**
    * Create the cover tree with the given dataset and the given instantiated
    * metric.  Optionally, set the base.  The dataset will not be modified during
-   * the building procedure (unlike BinarySpaceTree).
+   * the building procedure (unlike BinarySpaceTree), and it is referenced
+   * instead of copied, so it must outlive the tree.
    *
    * @param dataset Reference to the dataset to build a tree on.
    * @param metric Instantiated metric to use during tree building.
@@ -445,6 +449,44 @@ class CoverTree
   //! The metric used for this tree.
   MetricType* metric;
 
+  /**
+   * Scratch space used while the tree is built.  Every node at a given depth of
+   * the recursion builds the near and far sets of its children in the same
+   * pair of vectors, so that they are not allocated again for each child.  A
+   * deque is used so that growing it does not move the vectors of shallower
+   * levels, which are still in use.
+   */
+  struct BuildBuffers
+  {
+    //! Indices of the near and far sets, one vector for each depth.
+    std::deque<arma::Col<size_t> > indices;
+    //! Distances of the near and far sets, one vector for each depth.
+    std::deque<arma::vec> distances;
+  };
+
+  /**
+   * Construct a child cover tree node during tree building.  This is the same
+   * as the public child constructor, but the near and far sets of the children
+   * of this node are built in the given buffers.
+   *
+   * @param buffers Scratch space shared by the whole build.
+   * @param depth Depth of this node in the recursion.
+   */
+  CoverTree(const MatType& dataset,
+            const ElemType base,
+            const size_t pointIndex,
+            const int scale,
+            CoverTree* parent,
+            const ElemType parentDistance,
+            arma::Col<size_t>& indices,
+            arma::vec& distances,
+            size_t nearSetSize,
+            size_t& farSetSize,
+            size_t& usedSetSize,
+            MetricType& metric,
+            BuildBuffers& buffers,
+            const size_t depth);
+
   /**
    * Create the children for this node.
    */
@@ -452,7 +494,9 @@ class CoverTree
                       arma::vec& distances,
                       size_t nearSetSize,
                       size_t& farSetSize,
-                      size_t& usedSetSize);
+                      size_t& usedSetSize,
+                      BuildBuffers& buffers,
+                      const size_t depth);
 
   /**
    * Fill the vector of distances with the distances between the point specified
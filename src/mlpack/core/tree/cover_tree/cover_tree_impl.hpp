@@ -73,8 +73,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   // Create the children.
   size_t farSetSize = 0;
   size_t usedSetSize = 0;
+  BuildBuffers buffers;
   CreateChildren(indices, distances, dataset.n_cols - 1, farSetSize,
-      usedSetSize);
+      usedSetSize, buffers, 0);
 
   // If we ended up creating only one child, remove the implicit node.
   while (children.size() == 1)
@@ -164,8 +165,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   // Create the children.
   size_t farSetSize = 0;
   size_t usedSetSize = 0;
+  BuildBuffers buffers;
   CreateChildren(indices, distances, dataset.n_cols - 1, farSetSize,
-      usedSetSize);
+      usedSetSize, buffers, 0);
 
   // If we ended up creating only one child, remove the implicit node.
   while (children.size() == 1)
@@ -257,8 +259,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   // Create the children.
   size_t farSetSize = 0;
   size_t usedSetSize = 0;
+  BuildBuffers buffers;
   CreateChildren(indices, distances, dataset->n_cols - 1, farSetSize,
-      usedSetSize);
+      usedSetSize, buffers, 0);
 
   // If we ended up creating only one child, remove the implicit node.
   while (children.size() == 1)
@@ -348,8 +351,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   // Create the children.
   size_t farSetSize = 0;
   size_t usedSetSize = 0;
+  BuildBuffers buffers;
   CreateChildren(indices, distances, dataset->n_cols - 1, farSetSize,
-      usedSetSize);
+      usedSetSize, buffers, 0);
 
   // If we ended up creating only one child, remove the implicit node.
   while (children.size() == 1)
@@ -434,7 +438,61 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
   }
 
   // Otherwise, create the children.
-  CreateChildren(indices, distances, nearSetSize, farSetSize, usedSetSize);
+  BuildBuffers buffers;
+  CreateChildren(indices, distances, nearSetSize, farSetSize, usedSetSize,
+      buffers, 0);
+
+  // Initialize statistic.
+  stat = StatisticType(*this);
+}
+
+// Construct a child node during tree building, reusing the given buffers.
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
+    const MatType& dataset,
+    const ElemType base,
+    const size_t pointIndex,
+    const int scale,
+    CoverTree* parent,
+    const ElemType parentDistance,
+    arma::Col<size_t>& indices,
+    arma::vec& distances,
+    size_t nearSetSize,
+    size_t& farSetSize,
+    size_t& usedSetSize,
+    MetricType& metric,
+    BuildBuffers& buffers,
+    const size_t depth) :
+    dataset(&dataset),
+    point(pointIndex),
+    scale(scale),
+    base(base),
+    numDescendants(0),
+    parent(parent),
+    parentDistance(parentDistance),
+    furthestDescendantDistance(0),
+    localMetric(false),
+    localDataset(false),
+    metric(&metric),
+    distanceComps(0)
+{
+  // If the size of the near set is 0, this is a leaf.
+  if (nearSetSize == 0)
+  {
+    this->scale = INT_MIN;
+    numDescendants = 1;
+    stat = StatisticType(*this);
+    return;
+  }
+
+  // Otherwise, create the children.
+  CreateChildren(indices, distances, nearSetSize, farSetSize, usedSetSize,
+      buffers, depth);
 
   // Initialize statistic.
   stat = StatisticType(*this);
@@ -987,7 +1045,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     arma::vec& distances,
     size_t nearSetSize,
     size_t& farSetSize,
-    size_t& usedSetSize)
+    size_t& usedSetSize,
+    BuildBuffers& buffers,
+    const size_t depth)
 {
   // Determine the next scale level.  This should be the first level where there
   // are any points in the far set.  So, if we know the maximum distance in the
@@ -1005,7 +1065,8 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     // This should not modify farSetSize or usedSetSize.
     size_t tempSize = 0;
     children.push_back(new CoverTree(*dataset, base, point, INT_MIN, this, 0,
-        indices, distances, 0, tempSize, usedSetSize, *metric));
+        indices, distances, 0, tempSize, usedSetSize, *metric, buffers,
+        depth + 1));
     distanceComps += children.back()->DistanceComps();
 
     // Every point in the near set should be a leaf.
@@ -1014,7 +1075,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
       // farSetSize and usedSetSize will not be modified.
       children.push_back(new CoverTree(*dataset, base, indices[i],
           INT_MIN, this, distances[i], indices, distances, 0, tempSize,
-          usedSetSize, *metric));
+          usedSetSize, *metric, buffers, depth + 1));
       distanceComps += children.back()->DistanceComps();
       usedSetSize++;
     }
@@ -1046,7 +1107,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
   size_t childUsedSetSize = 0;
   children.push_back(new CoverTree(*dataset, base, point, nextScale, this, 0,
       indices, distances, childNearSetSize, childFarSetSize, childUsedSetSize,
-      *metric));
+      *metric, buffers, depth + 1));
   // Don't double-count the self-child (so, subtract one).
   numDescendants += children[0]->NumDescendants();
 
@@ -1104,7 +1165,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
       size_t childNearSetSize = 0;
       children.push_back(new CoverTree(*dataset, base, indices[0], nextScale,
           this, distances[0], indices, distances, childNearSetSize, farSetSize,
-          usedSetSize, *metric));
+          usedSetSize, *metric, buffers, depth + 1));
       distanceComps += children.back()->DistanceComps();
       numDescendants += children.back()->NumDescendants();
 
@@ -1118,11 +1179,23 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     }
 
     // Create the near and far set indices and distance vectors.  We don't fill
-    // in the self-point, yet.
-    arma::Col<size_t> childIndices(nearSetSize + farSetSize);
+    // in the self-point, yet.  The vectors are shared by every child built at
+    // this depth of the recursion, so they are only reallocated when they are
+    // too small, and may be longer than the point set.
+    if (buffers.indices.size() <= depth)
+    {
+      buffers.indices.resize(depth + 1);
+      buffers.distances.resize(depth + 1);
+    }
+    arma::Col<size_t>& childIndices = buffers.indices[depth];
+    arma::vec& childDistances = buffers.distances[depth];
+    if (childIndices.n_elem < nearSetSize + farSetSize)
+    {
+      childIndices.set_size(nearSetSize + farSetSize);
+      childDistances.set_size(nearSetSize + farSetSize);
+    }
     childIndices.rows(0, (nearSetSize + farSetSize - 2)) = indices.rows(1,
         nearSetSize + farSetSize - 1);
-    arma::vec childDistances(nearSetSize + farSetSize);
 
     // Build distances for the child.
     ComputeDistances(indices[0], childIndices, childDistances, nearSetSize
@@ -1146,7 +1219,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     childUsedSetSize = 1; // Mark self point as used.
     children.push_back(new CoverTree(*dataset, base, indices[0], nextScale,
         this, distances[0], childIndices, childDistances, childNearSetSize,
-        childFarSetSize, childUsedSetSize, *metric));
+        childFarSetSize, childUsedSetSize, *metric, buffers, depth + 1));
     numDescendants += children.back()->NumDescendants();
 
     // Remove any implicit nodes.
@@ -1241,9 +1314,11 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
                      const size_t pointSetSize)
 {
   // For each point, rebuild the distances.  The indices do not need to be
-  // modified.
+  // modified.  Each distance is independent of the others, so large point sets
+  // are split between threads; this does not change the resulting tree.
   distanceComps += pointSetSize;
-  for (size_t i = 0; i < pointSetSize; ++i)
+  #pragma omp parallel for if (pointSetSize >= 2048) schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) pointSetSize; ++i)
   {
     distances[i] = metric->Evaluate(dataset->col(pointIndex),
         dataset->col(indices[i]));
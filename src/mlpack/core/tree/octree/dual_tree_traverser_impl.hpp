@@ -14,6 +14,7 @@
 
 // In case it hasn't been included yet.
 #include "dual_tree_traverser.hpp"
+#include "../base_case_block.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -44,10 +45,20 @@ void Octree<MetricType, StatisticType, MatType>::DualTreeTraverser<RuleType>::
 
   if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
-    const size_t begin = queryNode.Point(0);
-    const size_t end = begin + queryNode.NumPoints();
-    for (size_t q = begin; q < end; ++q)
+    // Unless a dataset is borrowed, the points of each leaf are contiguous, so
+    // the rules may be able to evaluate all of the base cases at once.
+    if (!queryNode.BorrowsDataset() && !referenceNode.BorrowsDataset() &&
+        BaseCaseBlock(rule, queryNode.Point(0), queryNode.NumPoints(),
+        referenceNode.Point(0), referenceNode.NumPoints()))
     {
+      numBaseCases += queryNode.NumPoints() * referenceNode.NumPoints();
+      return;
+    }
+
+    for (size_t i = 0; i < queryNode.NumPoints(); ++i)
+    {
+      const size_t q = queryNode.Point(i);
+
       // First, see if we can prune the reference node for this query point.
       rule.TraversalInfo() = traversalInfo;
       const double score = rule.Score(q, referenceNode);
@@ -57,10 +68,8 @@ void Octree<MetricType, StatisticType, MatType>::DualTreeTraverser<RuleType>::
         continue;
       }
 
-      const size_t rBegin = referenceNode.Point(0);
-      const size_t rEnd = rBegin + referenceNode.NumPoints();
-      for (size_t r = rBegin; r < rEnd; ++r)
-        rule.BaseCase(q, r);
+      for (size_t j = 0; j < referenceNode.NumPoints(); ++j)
+        rule.BaseCase(q, referenceNode.Point(j));
 
       numBaseCases += referenceNode.NumPoints();
     }
@@ -15,6 +15,7 @@
 #include <mlpack/prereqs.hpp>
 #include "../hrectbound.hpp"
 #include "../statistic.hpp"
+#include "../borrow_dataset.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -51,8 +52,13 @@ class Octree
   //! The minimum bounding rectangle of the points held in the node (and its
   //! children).
   bound::HRectBound<MetricType> bound;
-  //! The dataset.
+  //! The dataset.  If the dataset is borrowed, this is an alias of the caller's
+  //! memory.
   MatType* dataset;
+  //! If the dataset is borrowed, the index in the dataset of each point of the
+  //! tree, so that the points of this node are (*indices)[begin] to
+  //! (*indices)[begin + count - 1]; otherwise NULL.  The root owns the indices.
+  std::vector<size_t>* indices;
   //! The parent (NULL if this node is the root).
   Octree* parent;
   //! The statistic.
@@ -157,6 +163,23 @@ class Octree
          std::vector<size_t>& newFromOld,
          const size_t maxLeafSize = 20);
 
+  /**
+   * Construct this as the root node of an octree that references the given
+   * dataset instead of copying it.  The dataset is reordered while the tree is
+   * built and then restored, so it is unchanged when the constructor returns;
+   * the tree keeps a permutation of the point indices instead, and Point() and
+   * Descendant() return indices into the given dataset.  The dataset must
+   * outlive the tree and must not be modified while the tree exists.  See
+   * BorrowDataset for more details.
+   *
+   * @param data Dataset to create tree from.  This will not be copied.
+   * @param borrowDataset Instance of BorrowDataset, to select this constructor.
+   * @param maxLeafSize Maximum number of points in a leaf node.
+   */
+  Octree(MatType& data,
+         const BorrowDataset borrowDataset,
+         const size_t maxLeafSize = 20);
+
   /**
    * Construct this node as a child of the given parent, starting at column
    * begin and using count points.  The ordering of that subset of points in the
@@ -238,6 +261,18 @@ class Octree
   //! Return the dataset used by this node.
   const MatType& Dataset() const { return *dataset; }
 
+  //! Return whether the tree references the caller's dataset (see
+  //! BorrowDataset), in which case the points of a node are not contiguous.
+  bool BorrowsDataset() const { return indices != NULL; }
+
+  /**
+   * Copy the points held in this node (and its descendants) into the given
+   * matrix, so that column i of the matrix is the point Descendant(i).
+   *
+   * @param points Matrix to store the points in.
+   */
+  void GatherPoints(MatType& points) const;
+
   //! Get the pointer to the parent.
   Octree* Parent() const { return parent; }
   //! Modify the pointer to the parent (be careful!).
@@ -425,6 +460,15 @@ class Octree
                  std::vector<size_t>& oldFromNew,
                  const size_t maxLeafSize);
 
+  /**
+   * Set the index permutation of this node and its descendants once a tree that
+   * borrows its dataset is built, and recreate their statistics so that they
+   * see the points through the permutation.
+   *
+   * @param newIndices Index in the dataset of each point of the tree.
+   */
+  void SetIndices(std::vector<size_t>* newIndices);
+
   /**
    * This is used for sorting points while splitting.
    */
@@ -27,6 +27,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
     count(dataset.n_cols),
     bound(dataset.n_rows),
     dataset(new MatType(dataset)),
+    indices(NULL),
     parent(NULL),
     parentDistance(0.0)
 {
@@ -65,6 +66,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(dataset.n_cols),
     bound(dataset.n_rows),
     dataset(new MatType(dataset)),
+    indices(NULL),
     parent(NULL),
     parentDistance(0.0)
 {
@@ -108,6 +110,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(dataset.n_cols),
     bound(dataset.n_rows),
     dataset(new MatType(dataset)),
+    indices(NULL),
     parent(NULL),
     parentDistance(0.0)
 {
@@ -153,6 +156,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
     count(dataset.n_cols),
     bound(dataset.n_rows),
     dataset(new MatType(std::move(dataset))),
+    indices(NULL),
     parent(NULL),
     parentDistance(0.0)
 {
@@ -191,6 +195,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(dataset.n_cols),
     bound(dataset.n_rows),
     dataset(new MatType(std::move(dataset))),
+    indices(NULL),
     parent(NULL),
     parentDistance(0.0)
 {
@@ -234,6 +239,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(dataset.n_cols),
     bound(dataset.n_rows),
     dataset(new MatType(std::move(dataset))),
+    indices(NULL),
     parent(NULL),
     parentDistance(0.0)
 {
@@ -271,6 +277,55 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     newFromOld[oldFromNew[i]] = i;
 }
 
+//! Construct the tree on a borrowed dataset.
+template<typename MetricType, typename StatisticType, typename MatType>
+Octree<MetricType, StatisticType, MatType>::Octree(
+    MatType& dataset,
+    const BorrowDataset /* borrowDataset */,
+    const size_t maxLeafSize) :
+    begin(0),
+    count(dataset.n_cols),
+    bound(dataset.n_rows),
+    // Alias the caller's memory; only the alias is deleted with the tree.
+    dataset(new MatType(dataset.memptr(), dataset.n_rows, dataset.n_cols, false,
+        true)),
+    indices(NULL),
+    parent(NULL),
+    parentDistance(0.0)
+{
+  std::vector<size_t> oldFromNew(this->dataset->n_cols);
+  for (size_t i = 0; i < this->dataset->n_cols; ++i)
+    oldFromNew[i] = i;
+
+  // Build the tree as usual, which reorders the dataset.
+  if (count > 0)
+  {
+    // Calculate empirical center of data.
+    bound |= *this->dataset;
+    arma::vec center;
+    bound.Center(center);
+
+    double maxWidth = 0.0;
+    for (size_t i = 0; i < bound.Dim(); ++i)
+      if (bound[i].Hi() - bound[i].Lo() > maxWidth)
+        maxWidth = bound[i].Hi() - bound[i].Lo();
+
+    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+
+    furthestDescendantDistance = 0.5 * bound.Diameter();
+  }
+  else
+  {
+    furthestDescendantDistance = 0.0;
+  }
+
+  // Now put the points back where the caller had them, and let the nodes find
+  // their points through the permutation instead.  This also initializes the
+  // statistics.
+  RestoreOriginalOrder(*this->dataset, oldFromNew);
+  SetIndices(new std::vector<size_t>(std::move(oldFromNew)));
+}
+
 //! Construct a child node.
 template<typename MetricType, typename StatisticType, typename MatType>
 Octree<MetricType, StatisticType, MatType>::Octree(
@@ -284,6 +339,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(count),
     bound(parent->dataset->n_rows),
     dataset(parent->dataset),
+    indices(parent->indices),
     parent(parent)
 {
   // Calculate empirical center of data.
@@ -319,6 +375,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(count),
     bound(parent->dataset->n_rows),
     dataset(parent->dataset),
+    indices(parent->indices),
     parent(parent)
 {
   // Calculate empirical center of data.
@@ -347,6 +404,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(const Octree& other) :
     count(other.count),
     bound(other.bound),
     dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    indices((other.parent == NULL && other.indices) ?
+        new std::vector<size_t>(*other.indices) : NULL),
     parent(NULL),
     stat(other.stat),
     parentDistance(other.parentDistance),
@@ -359,7 +418,25 @@ Octree<MetricType, StatisticType, MatType>::Octree(const Octree& other) :
   {
     children.push_back(new Octree(other.Child(i)));
     children[i]->parent = this;
-    children[i]->dataset = this->dataset;
+  }
+
+  // Propagate the dataset and indices to all of the descendants, but only if we
+  // are the root.
+  if (other.parent == NULL)
+  {
+    std::stack<Octree*> stack;
+    for (size_t i = 0; i < children.size(); ++i)
+      stack.push(children[i]);
+    while (!stack.empty())
+    {
+      Octree* node = stack.top();
+      stack.pop();
+
+      node->dataset = dataset;
+      node->indices = indices;
+      for (size_t i = 0; i < node->children.size(); ++i)
+        stack.push(node->children[i]);
+    }
   }
 }
 
@@ -371,6 +448,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(Octree&& other) :
     count(other.count),
     bound(std::move(other.bound)),
     dataset(other.dataset),
+    indices(other.indices),
     parent(other.parent),
     stat(std::move(other.stat)),
     parentDistance(other.parentDistance),
@@ -384,6 +462,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(Octree&& other) :
   other.begin = 0;
   other.count = 0;
   other.dataset = new MatType();
+  other.indices = NULL;
   other.parentDistance = 0.0;
   other.furthestDescendantDistance = 0.0;
   other.parent = NULL;
@@ -395,6 +474,7 @@ Octree<MetricType, StatisticType, MatType>::Octree() :
     count(0),
     bound(0),
     dataset(new MatType()),
+    indices(NULL),
     parent(NULL),
     parentDistance(0.0),
     furthestDescendantDistance(0.0)
@@ -416,9 +496,12 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 template<typename MetricType, typename StatisticType, typename MatType>
 Octree<MetricType, StatisticType, MatType>::~Octree()
 {
-  // Delete the dataset if we aren't the parent.
+  // Delete the dataset and the indices if we aren't the parent.
   if (!parent)
+  {
     delete dataset;
+    delete indices;
+  }
 
   // Now delete each of the children.
   for (size_t i = 0; i < children.size(); ++i)
@@ -561,14 +644,23 @@ template<typename MetricType, typename StatisticType, typename MatType>
 size_t Octree<MetricType, StatisticType, MatType>::Descendant(
     const size_t index) const
 {
-  return begin + index;
+  return indices ? (*indices)[begin + index] : (begin + index);
 }
 
 template<typename MetricType, typename StatisticType, typename MatType>
 size_t Octree<MetricType, StatisticType, MatType>::Point(const size_t index)
     const
 {
-  return begin + index;
+  return indices ? (*indices)[begin + index] : (begin + index);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::GatherPoints(
+    MatType& points) const
+{
+  points.set_size(dataset->n_rows, count);
+  for (size_t i = 0; i < count; ++i)
+    points.col(i) = dataset->col(Descendant(i));
 }
 
 template<typename MetricType, typename StatisticType, typename MatType>
@@ -635,6 +727,14 @@ void Octree<MetricType, StatisticType, MatType>::Serialize(
 {
   using data::CreateNVP;
 
+  // A borrowed dataset is not ours to save, and the points of the nodes are
+  // not where a loaded tree would expect them.
+  if (Archive::is_saving::value && indices)
+  {
+    throw std::invalid_argument("Octree::Serialize(): cannot save a tree that "
+        "borrows its dataset");
+  }
+
   // If we're loading and we have children, they need to be deleted.
   if (Archive::is_loading::value)
   {
@@ -643,7 +743,11 @@ void Octree<MetricType, StatisticType, MatType>::Serialize(
     children.clear();
 
     if (!parent)
+    {
       delete dataset;
+      delete indices;
+    }
+    indices = NULL;
   }
 
   ar & CreateNVP(begin, "begin");
@@ -906,6 +1010,19 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   }
 }
 
+//! Set the index permutation of the subtree.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::SetIndices(
+    std::vector<size_t>* newIndices)
+{
+  indices = newIndices;
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->SetIndices(newIndices);
+
+  // The statistics of the children are ready, so this one can be recreated.
+  stat = StatisticType(*this);
+}
+
 } // namespace tree
 } // namespace mlpack
 
@@ -35,10 +35,8 @@ void Octree<MetricType, StatisticType, MatType>::SingleTreeTraverser<RuleType>::
   // If we are a leaf, run the base cases.
   if (referenceNode.NumChildren() == 0)
   {
-    const size_t refBegin = referenceNode.Point(0);
-    const size_t refEnd = refBegin + referenceNode.NumPoints();
-    for (size_t r = refBegin; r < refEnd; ++r)
-      rule.BaseCase(queryIndex, r);
+    for (size_t i = 0; i < referenceNode.NumPoints(); ++i)
+      rule.BaseCase(queryIndex, referenceNode.Point(i));
   }
   else
   {
@@ -0,0 +1,74 @@
+/**
+ * @file bulk_load.hpp
+ * @author agent
+ *
+ * Definition of the BulkLoad tag, which selects the bulk-loading constructors
+ * of RectangleTree, and of the BulkLoadTraits class, which tells whether a
+ * given kind of RectangleTree may be packed bottom-up.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_BULK_LOAD_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_BULK_LOAD_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Pass an instance of this class to a RectangleTree constructor to build the
+ * tree with Sort-Tile-Recursive packing instead of inserting each point:
+ *
+ * @code
+ * RStarTree<EuclideanDistance, EmptyStatistic, arma::mat> tree(data,
+ *     BulkLoad());
+ * @endcode
+ */
+struct BulkLoad { };
+
+class RTreeSplit;
+class RStarTreeSplit;
+class XTreeSplit;
+
+/**
+ * The BulkLoadTraits class tells whether a RectangleTree with the given split
+ * type may be packed bottom-up.  Packing only guarantees that the leaves are on
+ * the same level and that the nodes are filled; trees whose nodes must satisfy
+ * other invariants (the R+ and R++ trees must not have overlapping children,
+ * and the Hilbert R tree keeps its children sorted by Hilbert value) are built
+ * by inserting the points in packed order instead.
+ */
+template<typename SplitType>
+struct BulkLoadTraits
+{
+  //! If true, the tree is packed bottom-up.
+  static const bool Packable = false;
+};
+
+//! R trees may be packed.
+template<>
+struct BulkLoadTraits<RTreeSplit>
+{
+  static const bool Packable = true;
+};
+
+//! R* trees may be packed.
+template<>
+struct BulkLoadTraits<RStarTreeSplit>
+{
+  static const bool Packable = true;
+};
+
+//! X trees may be packed; the packed nodes are all normal nodes.
+template<>
+struct BulkLoadTraits<XTreeSplit>
+{
+  static const bool Packable = true;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
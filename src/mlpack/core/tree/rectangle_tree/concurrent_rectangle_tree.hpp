@@ -0,0 +1,258 @@
+/**
+ * @file concurrent_rectangle_tree.hpp
+ * @author agent
+ *
+ * Definition of ConcurrentRectangleTree, a wrapper around a RectangleTree that
+ * lets one writer insert and delete points while any number of readers search
+ * consistent snapshots of the tree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_CONCURRENT_RECTANGLE_TREE_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_CONCURRENT_RECTANGLE_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A ConcurrentRectangleTree holds a RectangleTree (or any of its variants) that
+ * is updated by a single writer thread while other threads search it.  The
+ * writer modifies a private working tree with Insert() and Delete(); readers
+ * never see those modifications until the writer calls Publish(), which makes
+ * the current state of the working tree the current snapshot.  A reader
+ * obtains the current snapshot with Snapshot() and may search it for as long
+ * as it holds the returned pointer.
+ *
+ * Snapshots are built by path copying: when publishing, only the nodes of the
+ * working tree that changed since the last Publish() are copied, and every
+ * other node is shared with the previous snapshot.  The working tree gives
+ * each changed node and its ancestors a new version, so the unchanged subtrees
+ * are found without visiting them.  So publishing takes time proportional
+ * to the number of nodes changed since the last Publish(), not to the size of
+ * the tree.  The points themselves are held in a buffer that grows
+ * geometrically and is shared by the working tree and all snapshots, so they
+ * are never copied when publishing either.
+ *
+ * A snapshot that is replaced by Publish() is retired along with the epoch (the
+ * number of the Publish() call) that replaced it.  Each later call to
+ * Publish() frees the retired snapshots that no reader holds any more, and with
+ * them the nodes that no newer snapshot shares.  Readers therefore never free
+ * nodes themselves, and old snapshots never have to be reclaimed by hand.
+ *
+ * Because nodes are shared between snapshots, the Parent() of a node in a
+ * snapshot may be the copy of its parent from an older snapshot.  That parent
+ * is kept alive as long as the node is, so comparing it against other nodes is
+ * safe, but it should not be used to walk up a snapshot.  Searches of a
+ * snapshot with NeighborSearch or RangeSearch only compare parent pointers.
+ *
+ * Inserted points are buffered and added to the working tree all at once when
+ * the next Publish() or Delete() is called.
+ *
+ * A snapshot may be searched with NeighborSearch or RangeSearch by passing it
+ * to their constructors that take a pointer to a reference tree:
+ *
+ * @code
+ * typedef RStarTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+ *     arma::mat> TreeType;
+ * ConcurrentRectangleTree<TreeType> index(TreeType(std::move(data)));
+ *
+ * // In a reader thread.
+ * std::shared_ptr<TreeType> snapshot = index.Snapshot();
+ * KNN knn(snapshot.get(), SINGLE_TREE_MODE);
+ * knn.Search(queries, 5, neighbors, distances);
+ * @endcode
+ *
+ * Readers must not modify a snapshot, and since nodes are shared, that
+ * includes the statistics of its nodes; searches with a separate query set do
+ * not modify it, but monochromatic searches do.
+ *
+ * @tparam TreeType Type of RectangleTree to hold.
+ */
+template<typename TreeType>
+class ConcurrentRectangleTree
+{
+ public:
+  //! The type of matrix the tree is built on.
+  typedef typename TreeType::Mat MatType;
+  //! The type of element held in the matrix.
+  typedef typename TreeType::ElemType ElemType;
+
+  /**
+   * Take ownership of the given tree and publish it as the first snapshot.
+   *
+   * @param tree Tree to take ownership of.
+   */
+  ConcurrentRectangleTree(TreeType&& tree);
+
+  /**
+   * Insert a point into the working tree.  The point is not visible to readers
+   * until the next call to Publish().  This may only be called by the writer.
+   *
+   * @param point Point to insert.
+   * @return Index of the point in the dataset of the tree.
+   */
+  template<typename VecType>
+  size_t Insert(const VecType& point);
+
+  /**
+   * Delete the point with the given index from the working tree.  The point
+   * will stay in the dataset of the tree, so the indices of other points do not
+   * change.  The deletion is not visible to readers until the next call to
+   * Publish().  This may only be called by the writer.
+   *
+   * @param index Index of the point in the dataset of the tree.
+   * @return Whether or not the point was found in the tree.
+   */
+  bool Delete(const size_t index);
+
+  /**
+   * Make the current state of the working tree visible to readers, and free
+   * the retired snapshots that readers no longer hold.  This may only be called
+   * by the writer.
+   */
+  void Publish();
+
+  /**
+   * Get the most recently published snapshot of the tree.  This may be called
+   * from any thread, at the same time as the writer modifies the working tree.
+   * The snapshot stays valid as long as the returned pointer is held.
+   */
+  std::shared_ptr<TreeType> Snapshot() const;
+
+  //! Get the working tree.  This may only be used by the writer.
+  const TreeType& WorkingTree() const { return tree; }
+
+  //! Get the number of inserted points not yet added to the working tree.
+  size_t NumPending() const { return numPending; }
+
+  //! Get the current epoch (the number of snapshots published so far).
+  size_t Epoch() const { return epoch; }
+
+  //! Get the number of retired snapshots that are not freed yet because a
+  //! reader may still hold them.
+  size_t NumRetired() const { return retired.size(); }
+
+ private:
+  /**
+   * A node of one or more snapshots, along with everything that has to stay
+   * alive for as long as the node may be searched.
+   */
+  struct SnapshotNode
+  {
+    //! The copy of the node.  Its children are owned by the snapshot nodes in
+    //! children, not by the copy.
+    std::shared_ptr<TreeType> node;
+    //! The snapshot nodes of the children.
+    std::vector<std::shared_ptr<SnapshotNode>> children;
+    //! The node that Parent() of the copy points to, held so that its address
+    //! is not reused while the copy may still be compared against it.
+    std::shared_ptr<TreeType> parent;
+    //! The part of the dataset that the copy refers to.
+    std::shared_ptr<const MatType> dataset;
+  };
+
+  /**
+   * The most recent snapshot of a node of the working tree.
+   */
+  struct NodeCopy
+  {
+    //! The snapshot node.
+    std::shared_ptr<SnapshotNode> snapshot;
+    //! The children the working node had when it was copied.
+    std::vector<const TreeType*> children;
+    //! The version the working node had when it was copied.
+    size_t version;
+  };
+
+  /**
+   * The first columns of the point buffer, along with the buffer itself so that
+   * it stays alive for as long as the columns are used.
+   */
+  struct DatasetView
+  {
+    //! Create an alias of the first cols columns of the given buffer.
+    DatasetView(const std::shared_ptr<MatType>& buffer, const size_t cols) :
+        buffer(buffer),
+        points(buffer->memptr(), buffer->n_rows, cols, false, true)
+    { }
+
+    //! The buffer holding the points.
+    std::shared_ptr<MatType> buffer;
+    //! The columns of the buffer that hold points.
+    MatType points;
+  };
+
+  //! Add buffered points to the working tree.
+  void Flush();
+
+  //! Make room in the point buffer for more points.
+  void Grow();
+
+  //! Make the working tree and new snapshot nodes refer to the first cols
+  //! columns of the point buffer.
+  void SetDatasetSize(const size_t cols);
+
+  //! Copy the nodes of the working tree that changed since the last call, and
+  //! forget about the nodes that are no longer in the tree.
+  void Sync();
+
+  //! Return the snapshot node of the given node of the working tree, copying
+  //! the node and its changed descendants if it changed.
+  std::shared_ptr<SnapshotNode> SyncNode(
+      const TreeType& node,
+      std::unordered_set<const TreeType*>& visited,
+      std::vector<const TreeType*>& orphans);
+
+  //! Return whether the given node of the working tree is the same as its
+  //! last copy.
+  static bool Unchanged(const TreeType& node, const NodeCopy& copy);
+
+  //! Forget the copies of the given node and its descendants, unless they are
+  //! still in the working tree.
+  void Forget(const TreeType* node,
+              const std::unordered_set<const TreeType*>& visited);
+
+  //! Free the retired snapshots that no reader holds any more.
+  void Reclaim();
+
+  //! Delete a copy of a node without deleting its children.
+  static void DeleteNode(TreeType* node);
+
+  //! The working tree, modified only by the writer.
+  TreeType tree;
+  //! The buffer holding the points; the working tree refers to its first
+  //! columns, and the remaining columns hold pending points or are unused.
+  std::shared_ptr<MatType> buffer;
+  //! The number of inserted points not yet added to the working tree.
+  size_t numPending;
+  //! The part of the dataset that new snapshot nodes refer to.
+  std::shared_ptr<const MatType> view;
+  //! The most recent copy of each node of the working tree.
+  std::unordered_map<const TreeType*, NodeCopy> copies;
+  //! The current snapshot.  Only accessed with std::atomic_load() and
+  //! std::atomic_store().
+  std::shared_ptr<TreeType> snapshot;
+  //! The current snapshot, for use by the writer.
+  std::shared_ptr<TreeType> current;
+  //! The snapshots that were replaced, with the epochs that replaced them.
+  std::vector<std::pair<size_t, std::shared_ptr<TreeType>>> retired;
+  //! The number of snapshots published so far.
+  size_t epoch;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "concurrent_rectangle_tree_impl.hpp"
+
+#endif
@@ -0,0 +1,317 @@
+/**
+ * @file concurrent_rectangle_tree_impl.hpp
+ * @author agent
+ *
+ * Implementation of ConcurrentRectangleTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_CONCURRENT_RECTANGLE_TREE_IMPL_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_CONCURRENT_RECTANGLE_TREE_IMPL_HPP
+
+// In case it wasn't included already for some reason.
+#include "concurrent_rectangle_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType>
+ConcurrentRectangleTree<TreeType>::ConcurrentRectangleTree(TreeType&& tree) :
+    tree(std::move(tree)),
+    numPending(0),
+    epoch(0)
+{
+  // Take the points of the tree as the point buffer, and make the tree refer to
+  // the buffer instead.
+  buffer.reset(new MatType(std::move(this->tree.Dataset())));
+  SetDatasetSize(buffer->n_cols);
+
+  Publish();
+}
+
+template<typename TreeType>
+template<typename VecType>
+size_t ConcurrentRectangleTree<TreeType>::Insert(const VecType& point)
+{
+  if (point.n_elem != buffer->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "ConcurrentRectangleTree::Insert(): point has " << point.n_elem
+        << " dimensions, but the tree has " << buffer->n_rows << "!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t index = tree.Dataset().n_cols + numPending;
+  if (index == buffer->n_cols)
+    Grow();
+
+  // Readers only use the columns before the ones of the pending points, so the
+  // point can be written while they search.
+  buffer->col(index) = point;
+  ++numPending;
+  return index;
+}
+
+template<typename TreeType>
+bool ConcurrentRectangleTree<TreeType>::Delete(const size_t index)
+{
+  Flush();
+  if (index >= tree.Dataset().n_cols)
+    return false;
+
+  return tree.DeletePoint(index);
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::Publish()
+{
+  Flush();
+  Sync();
+
+  // If nothing changed, the root was not copied again.
+  const std::shared_ptr<SnapshotNode>& root = copies.at(&tree).snapshot;
+  if (current && current.get() == root->node.get())
+    return;
+
+  // The new snapshot shares ownership of the root snapshot node, which owns
+  // everything else the snapshot needs.
+  std::shared_ptr<TreeType> newSnapshot(root, root->node.get());
+  std::atomic_store(&snapshot, newSnapshot);
+
+  ++epoch;
+  if (current)
+    retired.push_back(std::make_pair(epoch, std::move(current)));
+  current = std::move(newSnapshot);
+
+  Reclaim();
+}
+
+template<typename TreeType>
+std::shared_ptr<TreeType> ConcurrentRectangleTree<TreeType>::Snapshot() const
+{
+  return std::atomic_load(&snapshot);
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::Flush()
+{
+  if (numPending == 0)
+    return;
+
+  // The pending points are already in the buffer; make them part of the
+  // dataset, then insert them into the tree.
+  const size_t firstIndex = tree.Dataset().n_cols;
+  SetDatasetSize(firstIndex + numPending);
+  numPending = 0;
+
+  for (size_t i = firstIndex; i < tree.Dataset().n_cols; ++i)
+    tree.InsertPoint(i);
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::Grow()
+{
+  // Readers may still use the old buffer through their snapshots, so the
+  // points are copied to a new buffer instead of resizing the old one.
+  const size_t numPoints = tree.Dataset().n_cols + numPending;
+  std::shared_ptr<MatType> newBuffer(new MatType(buffer->n_rows,
+      std::max<size_t>(2 * buffer->n_cols, (size_t) 16)));
+  if (numPoints > 0)
+    newBuffer->cols(0, numPoints - 1) = buffer->cols(0, numPoints - 1);
+
+  buffer = std::move(newBuffer);
+  SetDatasetSize(tree.Dataset().n_cols);
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::SetDatasetSize(const size_t cols)
+{
+  // Every node of the working tree points to the same matrix, so it is made an
+  // alias of the buffer in place.  Moving a non-strict alias takes over its
+  // memory instead of copying it.
+  tree.Dataset() = MatType(buffer->memptr(), buffer->n_rows, cols, false,
+      false);
+
+  std::shared_ptr<DatasetView> newView(new DatasetView(buffer, cols));
+  view = std::shared_ptr<const MatType>(newView, &newView->points);
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::Sync()
+{
+  std::unordered_set<const TreeType*> visited;
+  std::vector<const TreeType*> orphans;
+  SyncNode(tree, visited, orphans);
+
+  for (size_t i = 0; i < orphans.size(); ++i)
+    Forget(orphans[i], visited);
+}
+
+template<typename TreeType>
+std::shared_ptr<typename ConcurrentRectangleTree<TreeType>::SnapshotNode>
+ConcurrentRectangleTree<TreeType>::SyncNode(
+    const TreeType& node,
+    std::unordered_set<const TreeType*>& visited,
+    std::vector<const TreeType*>& orphans)
+{
+  visited.insert(&node);
+
+  // The working tree increments the version of every node whose subtree
+  // changed, so the subtree of a node with the same version can be shared as a
+  // whole, unless the node itself changed (a split may move points or children
+  // between siblings without changing the version of each sibling).
+  typename std::unordered_map<const TreeType*, NodeCopy>::const_iterator it =
+      copies.find(&node);
+  if (it != copies.end() && Unchanged(node, it->second))
+    return it->second.snapshot;
+
+  std::shared_ptr<SnapshotNode> snapshotNode(new SnapshotNode());
+  std::vector<const TreeType*> children(node.numChildren);
+  snapshotNode->children.resize(node.numChildren);
+  for (size_t i = 0; i < node.numChildren; ++i)
+  {
+    children[i] = node.children[i];
+    snapshotNode->children[i] = SyncNode(*node.children[i], visited, orphans);
+  }
+
+  TreeType* copy = new TreeType();
+  snapshotNode->node.reset(copy, &DeleteNode);
+  snapshotNode->dataset = view;
+
+  copy->maxNumChildren = node.maxNumChildren;
+  copy->minNumChildren = node.minNumChildren;
+  copy->numChildren = node.numChildren;
+  copy->children.resize(node.children.size(), NULL);
+  for (size_t i = 0; i < node.numChildren; ++i)
+  {
+    SnapshotNode& child = *snapshotNode->children[i];
+    copy->children[i] = child.node.get();
+
+    // Children copied during this call have no parent yet; children shared with
+    // older snapshots keep the parent they already have.
+    if (child.node->parent == NULL)
+    {
+      child.node->parent = copy;
+      child.parent = snapshotNode->node;
+    }
+  }
+  copy->begin = node.begin;
+  copy->count = node.count;
+  copy->numDescendants = node.numDescendants;
+  copy->maxLeafSize = node.maxLeafSize;
+  copy->minLeafSize = node.minLeafSize;
+  copy->bound = node.bound;
+  copy->stat = node.stat;
+  copy->parentDistance = node.parentDistance;
+  copy->dataset = view.get();
+  copy->points = node.points;
+
+  // The recursive calls may have added to the map, so look the node up again.
+  NodeCopy& nodeCopy = copies[&node];
+  for (size_t i = 0; i < nodeCopy.children.size(); ++i)
+  {
+    if (std::find(children.begin(), children.end(), nodeCopy.children[i]) ==
+        children.end())
+      orphans.push_back(nodeCopy.children[i]);
+  }
+  nodeCopy.snapshot = snapshotNode;
+  nodeCopy.children = std::move(children);
+  nodeCopy.version = node.version;
+
+  return snapshotNode;
+}
+
+template<typename TreeType>
+bool ConcurrentRectangleTree<TreeType>::Unchanged(const TreeType& node,
+                                                  const NodeCopy& nodeCopy)
+{
+  const TreeType& copy = *nodeCopy.snapshot->node;
+  if (node.version != nodeCopy.version ||
+      node.numChildren != copy.numChildren ||
+      node.maxNumChildren != copy.maxNumChildren ||
+      node.count != copy.count ||
+      node.numDescendants != copy.numDescendants ||
+      node.parentDistance != copy.parentDistance ||
+      node.bound.Dim() != copy.bound.Dim())
+    return false;
+
+  for (size_t i = 0; i < node.numChildren; ++i)
+    if (node.children[i] != nodeCopy.children[i])
+      return false;
+
+  for (size_t i = 0; i < node.count; ++i)
+    if (node.points[i] != copy.points[i])
+      return false;
+
+  for (size_t d = 0; d < node.bound.Dim(); ++d)
+  {
+    if (node.bound[d].Lo() != copy.bound[d].Lo() ||
+        node.bound[d].Hi() != copy.bound[d].Hi())
+      return false;
+  }
+
+  return true;
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::Forget(
+    const TreeType* node,
+    const std::unordered_set<const TreeType*>& visited)
+{
+  // Nodes that were moved elsewhere in the tree are still needed.  The node may
+  // have been freed, so it is only used as a key.
+  if (visited.count(node) > 0)
+    return;
+
+  typename std::unordered_map<const TreeType*, NodeCopy>::iterator it =
+      copies.find(node);
+  if (it == copies.end())
+    return;
+
+  std::vector<const TreeType*> children = std::move(it->second.children);
+  copies.erase(it);
+  for (size_t i = 0; i < children.size(); ++i)
+    Forget(children[i], visited);
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::Reclaim()
+{
+  // A retired snapshot can no longer be obtained with Snapshot(), so once the
+  // list holds its only reference, no reader can hold it again.
+  size_t kept = 0;
+  for (size_t i = 0; i < retired.size(); ++i)
+  {
+    if (retired[i].second.use_count() == 1)
+    {
+      // Make sure the last reads of the reader that released it happen before
+      // the nodes are freed.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      retired[i].second.reset();
+    }
+    else
+    {
+      if (kept != i)
+        retired[kept] = std::move(retired[i]);
+      ++kept;
+    }
+  }
+
+  retired.resize(kept);
+}
+
+template<typename TreeType>
+void ConcurrentRectangleTree<TreeType>::DeleteNode(TreeType* node)
+{
+  // The children are owned by their own snapshot nodes.
+  node->numChildren = 0;
+  delete node;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
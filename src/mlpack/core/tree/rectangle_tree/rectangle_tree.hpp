@@ -14,12 +14,14 @@
 #define MLPACK_CORE_TREE_RECTANGLE_TREE_RECTANGLE_TREE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <atomic>
 
 #include "../hrectbound.hpp"
 #include "../statistic.hpp"
 #include "r_tree_split.hpp"
 #include "r_tree_descent_heuristic.hpp"
 #include "no_auxiliary_information.hpp"
+#include "bulk_load.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -85,6 +87,10 @@ class RectangleTree
   size_t count;
   //! The number of descendants of this node.
   size_t numDescendants;
+  //! The version of this node, which changes whenever the points or children
+  //! of this node or of one of its descendants change.  No two nodes ever have
+  //! the same version, so a new node can't be mistaken for a deleted one.
+  size_t version;
   //! The max leaf size.
   size_t maxLeafSize;
   //! The minimum leaf size.
@@ -156,6 +162,60 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a rectangle type tree using the given
+   * dataset, packing the points bottom-up with the Sort-Tile-Recursive
+   * algorithm instead of inserting them one at a time.  The points are
+   * partitioned into slabs along each dimension in turn, so that each leaf and
+   * each node is filled to at least half of its capacity, and usually almost
+   * completely; all leaves are on the same level.  Points may still be inserted
+   * and deleted afterwards.
+   *
+   * R, R* and X trees are packed.  For other kinds of trees, whose nodes must
+   * satisfy further invariants (see BulkLoadTraits), the points are inserted in
+   * the packed order.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param bulkLoad Instance of BulkLoad, to select this constructor.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   * @param firstDataIndex The index of the first data point.
+   */
+  RectangleTree(const MatType& data,
+                const BulkLoad bulkLoad,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2,
+                const size_t firstDataIndex = 0);
+
+  /**
+   * Construct this as the root node of a rectangle type tree using the given
+   * dataset, taking ownership of it, and packing the points bottom-up with the
+   * Sort-Tile-Recursive algorithm.  See the constructor above for details.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param bulkLoad Instance of BulkLoad, to select this constructor.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   * @param firstDataIndex The index of the first data point.
+   */
+  RectangleTree(MatType&& data,
+                const BulkLoad bulkLoad,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2,
+                const size_t firstDataIndex = 0);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -542,6 +602,55 @@ class RectangleTree
    */
   void SplitNode(std::vector<bool>& relevels);
 
+  /**
+   * Record that the points or children of this node changed, by giving this
+   * node and all its ancestors a new version.  The splits and the
+   * shrinking of bounds that follow an insertion or deletion only change the
+   * nodes on the path from this node to the root and their children, and
+   * reinsertions go through InsertPoint() and InsertNode() again, so calling
+   * this on each node a point or child is added to or removed from marks every
+   * changed subtree.
+   */
+  void MarkModified();
+
+  //! Return a version that no node has had before.
+  static size_t NewVersion();
+
+  /**
+   * Build the tree under this (empty) root node from the points of the dataset
+   * starting at firstDataIndex, using Sort-Tile-Recursive packing.  Trees that
+   * may not be packed (see BulkLoadTraits) insert the points in packed order.
+   *
+   * @param firstDataIndex The index of the first point to add to the tree.
+   */
+  void BulkLoadTree(const size_t firstDataIndex);
+
+  /**
+   * Partition the items order[first, last) into groups of at most capacity
+   * items with the Sort-Tile-Recursive algorithm: the items are sorted along
+   * dimension dim and cut into slabs, and each slab is partitioned along the
+   * next dimension.  Groups are consecutive in the order vector; the end of
+   * each group is appended to groupEnds.  The groups are as even as possible,
+   * so each holds at least half of capacity items, rounded down (unless there is
+   * only one group).
+   *
+   * @param order Indices of the items; reordered.
+   * @param coords Coordinates of the items, one column per item.
+   * @param first Index in order of the first item to partition.
+   * @param last Index in order one past the last item to partition.
+   * @param dim Dimension to sort along.
+   * @param capacity Maximum number of items in a group.
+   * @param groupEnds Vector to append the ends of the groups to.
+   */
+  template<typename CoordMatType>
+  static void STRPartition(std::vector<size_t>& order,
+                           const CoordMatType& coords,
+                           const size_t first,
+                           const size_t last,
+                           const size_t dim,
+                           const size_t capacity,
+                           std::vector<size_t>& groupEnds);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -563,6 +672,10 @@ class RectangleTree
   //! Give friend access for AuxiliaryInformationType.
   friend AuxiliaryInformation;
 
+  //! Give friend access for ConcurrentRectangleTree, which copies nodes into
+  //! its snapshots.
+  template<typename> friend class ConcurrentRectangleTree;
+
  public:
   /**
    * Condense the bounding rectangles for this node based on the removal of the
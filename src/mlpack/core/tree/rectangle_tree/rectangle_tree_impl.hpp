@@ -18,6 +18,8 @@
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
 
+#include <algorithm>
+
 namespace mlpack {
 namespace tree {
 
@@ -43,6 +45,7 @@ RectangleTree(const MatType& data,
     begin(0),
     count(0),
     numDescendants(0),
+    version(NewVersion()),
     maxLeafSize(maxLeafSize),
     minLeafSize(minLeafSize),
     bound(data.n_rows),
@@ -83,6 +86,7 @@ RectangleTree(MatType&& data,
     begin(0),
     count(0),
     numDescendants(0),
+    version(NewVersion()),
     maxLeafSize(maxLeafSize),
     minLeafSize(minLeafSize),
     bound(data.n_rows),
@@ -101,6 +105,82 @@ RectangleTree(MatType&& data,
     root->InsertPoint(i);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(const MatType& data,
+              const BulkLoad /* bulkLoad */,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren,
+              const size_t firstDataIndex) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    version(NewVersion()),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(data)),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  stat = StatisticType(*this);
+
+  BulkLoadTree(firstDataIndex);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(MatType&& data,
+              const BulkLoad /* bulkLoad */,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren,
+              const size_t firstDataIndex) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    version(NewVersion()),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(std::move(data))),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  stat = StatisticType(*this);
+
+  BulkLoadTree(firstDataIndex);
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -122,6 +202,7 @@ RectangleTree(
     begin(0),
     count(0),
     numDescendants(0),
+    version(NewVersion()),
     maxLeafSize(parentNode->MaxLeafSize()),
     minLeafSize(parentNode->MinLeafSize()),
     bound(parentNode->Bound().Dim()),
@@ -158,6 +239,7 @@ RectangleTree(
     begin(other.Begin()),
     count(other.Count()),
     numDescendants(other.numDescendants),
+    version(NewVersion()),
     maxLeafSize(other.MaxLeafSize()),
     minLeafSize(other.MinLeafSize()),
     bound(other.bound),
@@ -198,6 +280,7 @@ RectangleTree(RectangleTree&& other) :
     begin(other.Begin()),
     count(other.Count()),
     numDescendants(other.numDescendants),
+    version(NewVersion()),
     maxLeafSize(other.MaxLeafSize()),
     minLeafSize(other.MinLeafSize()),
     bound(std::move(other.bound)),
@@ -343,6 +426,7 @@ void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
     if (!auxiliaryInfo.HandlePointInsertion(this, point))
       points[count++] = point;
 
+    MarkModified();
     SplitNode(lvls);
     return;
   }
@@ -378,6 +462,7 @@ void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
     if (!auxiliaryInfo.HandlePointInsertion(this, point))
       points[count++] = point;
 
+    MarkModified();
     SplitNode(relevels);
     return;
   }
@@ -419,6 +504,7 @@ void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
       children[numChildren++] = node;
       node->Parent() = this;
     }
+    MarkModified();
     SplitNode(relevels);
   }
   else
@@ -459,6 +545,7 @@ bool RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
       {
         if (!auxiliaryInfo.HandlePointDeletion(this, i))
           points[i] = points[--count];
+        MarkModified();
 
         RectangleTree* tree = this;
         while (tree != NULL)
@@ -503,6 +590,7 @@ bool RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
       {
         if (!auxiliaryInfo.HandlePointDeletion(this, i))
           points[i] = points[--count];
+        MarkModified();
 
         RectangleTree* tree = this;
         while (tree != NULL)
@@ -548,6 +636,7 @@ bool RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
       {
         children[i] = children[--numChildren]; // Decrement numChildren.
       }
+      MarkModified();
       RectangleTree* tree = this;
       while (tree != NULL)
       {
@@ -893,6 +982,196 @@ void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
   }
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::MarkModified()
+{
+  for (RectangleTree* node = this; node != NULL; node = node->Parent())
+    node->version = NewVersion();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+size_t RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                     AuxiliaryInformationType>::NewVersion()
+{
+  // Trees may be built and modified in several threads at once.
+  static std::atomic<size_t> lastVersion(0);
+  return lastVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+/**
+ * Build the tree bottom-up with Sort-Tile-Recursive packing: the points are
+ * packed into leaves, then the leaves are packed into nodes by their centers,
+ * and so on until the remaining nodes fit in the root.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    BulkLoadTree(const size_t firstDataIndex)
+{
+  const size_t numPoints = (dataset->n_cols > firstDataIndex) ?
+      dataset->n_cols - firstDataIndex : 0;
+
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = firstDataIndex + i;
+
+  std::vector<size_t> groupEnds;
+  STRPartition(order, *dataset, 0, numPoints, 0, maxLeafSize, groupEnds);
+
+  // If the tree can't be packed, or if all the points fit in the root, insert
+  // them in packed order, so that consecutive points go to the same leaf.
+  if (!BulkLoadTraits<SplitType>::Packable || groupEnds.size() <= 1)
+  {
+    for (size_t i = 0; i < numPoints; ++i)
+      InsertPoint(order[i]);
+    return;
+  }
+
+  // Create the leaves.  Their parent is set when they are packed into a node.
+  std::vector<RectangleTree*> level(groupEnds.size());
+  size_t groupBegin = 0;
+  for (size_t i = 0; i < groupEnds.size(); ++i)
+  {
+    RectangleTree* leaf = new RectangleTree(this);
+    for (size_t j = groupBegin; j < groupEnds[i]; ++j)
+    {
+      leaf->points[leaf->count++] = order[j];
+      leaf->bound |= dataset->col(order[j]);
+    }
+    leaf->numDescendants = leaf->count;
+    leaf->stat = StatisticType(*leaf);
+
+    level[i] = leaf;
+    groupBegin = groupEnds[i];
+  }
+
+  // Pack each level into nodes until the remaining nodes fit in the root.
+  while (level.size() > maxNumChildren)
+  {
+    arma::Mat<ElemType> centers(dataset->n_rows, level.size());
+    arma::Col<ElemType> center;
+    for (size_t i = 0; i < level.size(); ++i)
+    {
+      level[i]->bound.Center(center);
+      centers.col(i) = center;
+    }
+
+    std::vector<size_t> nodeOrder(level.size());
+    for (size_t i = 0; i < level.size(); ++i)
+      nodeOrder[i] = i;
+
+    groupEnds.clear();
+    STRPartition(nodeOrder, centers, 0, level.size(), 0, maxNumChildren,
+        groupEnds);
+
+    std::vector<RectangleTree*> nextLevel(groupEnds.size());
+    groupBegin = 0;
+    for (size_t i = 0; i < groupEnds.size(); ++i)
+    {
+      RectangleTree* node = new RectangleTree(this);
+      for (size_t j = groupBegin; j < groupEnds[i]; ++j)
+      {
+        RectangleTree* child = level[nodeOrder[j]];
+        node->children[node->numChildren++] = child;
+        child->parent = node;
+        node->bound |= child->bound;
+        node->numDescendants += child->numDescendants;
+      }
+      node->stat = StatisticType(*node);
+
+      nextLevel[i] = node;
+      groupBegin = groupEnds[i];
+    }
+
+    level.swap(nextLevel);
+  }
+
+  // The remaining nodes are the children of the root.
+  for (size_t i = 0; i < level.size(); ++i)
+  {
+    children[numChildren++] = level[i];
+    level[i]->parent = this;
+    bound |= level[i]->bound;
+    numDescendants += level[i]->numDescendants;
+  }
+
+  stat = StatisticType(*this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename CoordMatType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    STRPartition(std::vector<size_t>& order,
+                 const CoordMatType& coords,
+                 const size_t first,
+                 const size_t last,
+                 const size_t dim,
+                 const size_t capacity,
+                 std::vector<size_t>& groupEnds)
+{
+  const size_t numItems = last - first;
+  const size_t numGroups = (numItems + capacity - 1) / capacity;
+  if (numGroups <= 1)
+  {
+    groupEnds.push_back(last);
+    return;
+  }
+
+  std::sort(order.begin() + first, order.begin() + last,
+      [&coords, dim](const size_t a, const size_t b)
+      {
+        return coords(dim, a) < coords(dim, b);
+      });
+
+  // Along the last dimension each slab is a group.  Otherwise, cut the items
+  // into about numGroups^(1 / remaining dimensions) slabs, so that the groups
+  // are tiled evenly over the remaining dimensions.
+  size_t numSlabs = numGroups;
+  if (dim + 1 < coords.n_rows)
+  {
+    numSlabs = (size_t) std::ceil(std::pow((double) numGroups,
+        1.0 / (coords.n_rows - dim)));
+    numSlabs = std::min(std::max(numSlabs, (size_t) 1), numGroups);
+  }
+
+  for (size_t i = 0; i < numSlabs; ++i)
+  {
+    const size_t slabBegin = first + (i * numItems) / numSlabs;
+    const size_t slabEnd = first + ((i + 1) * numItems) / numSlabs;
+    if (dim + 1 < coords.n_rows)
+    {
+      STRPartition(order, coords, slabBegin, slabEnd, dim + 1, capacity,
+          groupEnds);
+    }
+    else
+    {
+      groupEnds.push_back(slabEnd);
+    }
+  }
+}
+
 //! Default constructor for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
@@ -148,7 +148,8 @@ class SpillTree
   /**
    * Construct this as the root node of a hybrid spill tree using the given
    * dataset.  The dataset will not be modified during the building procedure
-   * (unlike BinarySpaceTree).
+   * (unlike BinarySpaceTree), and it is referenced instead of copied, so it
+   * must outlive the tree.
    *
    * @param data Dataset to create tree from.
    * @param tau Overlapping size.
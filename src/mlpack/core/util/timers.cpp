@@ -51,17 +51,19 @@ std::map<std::string, microseconds>& Timers::GetAllTimers()
 
 microseconds Timers::GetTimer(const std::string& timerName)
 {
+  std::lock_guard<std::mutex> lock(timersMutex);
   return timers[timerName];
 }
 
 bool Timers::GetState(std::string timerName)
 {
-  return timerState[timerName];
+  std::lock_guard<std::mutex> lock(timersMutex);
+  return IsRunning(std::this_thread::get_id(), timerName);
 }
 
 void Timers::PrintTimer(const std::string& timerName)
 {
-  microseconds totalDuration = timers[timerName];
+  microseconds totalDuration = GetTimer(timerName);
   // Convert microseconds to seconds.
   seconds totalDurationSec = duration_cast<seconds>(totalDuration);
   microseconds totalDurationMicroSec =
@@ -127,7 +129,10 @@ high_resolution_clock::time_point Timers::GetTime()
 
 void Timers::StartTimer(const std::string& timerName)
 {
-  if ((timerState[timerName] == 1) && (timerName != "total_time"))
+  std::lock_guard<std::mutex> lock(timersMutex);
+  const std::thread::id threadId = std::this_thread::get_id();
+
+  if (IsRunning(threadId, timerName) && (timerName != "total_time"))
   {
     std::ostringstream error;
     error << "Timer::Start(): timer '" << timerName
@@ -135,7 +140,7 @@ void Timers::StartTimer(const std::string& timerName)
     throw std::runtime_error(error.str());
   }
 
-  timerState[timerName] = true;
+  timerState[threadId][timerName] = true;
 
   high_resolution_clock::time_point currTime = GetTime();
 
@@ -145,12 +150,15 @@ void Timers::StartTimer(const std::string& timerName)
     timers[timerName] = (microseconds) 0;
   }
 
-  timerStartTime[timerName] = currTime;
+  timerStartTime[threadId][timerName] = currTime;
 }
 
 void Timers::StopTimer(const std::string& timerName)
 {
-  if ((timerState[timerName] == 0) && (timerName != "total_time"))
+  std::lock_guard<std::mutex> lock(timersMutex);
+  const std::thread::id threadId = std::this_thread::get_id();
+
+  if (!IsRunning(threadId, timerName) && (timerName != "total_time"))
   {
     std::ostringstream error;
     error << "Timer::Stop(): timer '" << timerName
@@ -158,11 +166,48 @@ void Timers::StopTimer(const std::string& timerName)
     throw std::runtime_error(error.str());
   }
 
-  timerState[timerName] = false;
-
   high_resolution_clock::time_point currTime = GetTime();
 
-  // Calculate the delta time.
-  timers[timerName] += duration_cast<microseconds>(currTime -
-      timerStartTime[timerName]);
+  // Calculate the delta time, if the timer was running in this thread.
+  std::map<std::thread::id, std::map<std::string,
+      high_resolution_clock::time_point>>::iterator threadStart =
+      timerStartTime.find(threadId);
+  if (threadStart != timerStartTime.end())
+  {
+    std::map<std::string, high_resolution_clock::time_point>::iterator start =
+        threadStart->second.find(timerName);
+    if (start != threadStart->second.end())
+    {
+      timers[timerName] += duration_cast<microseconds>(currTime -
+          start->second);
+      threadStart->second.erase(start);
+    }
+
+    // Forget about the thread once none of its timers are running, so that the
+    // maps don't grow with every thread that has ever used a timer.
+    if (threadStart->second.empty())
+      timerStartTime.erase(threadStart);
+  }
+
+  std::map<std::thread::id, std::map<std::string, bool>>::iterator state =
+      timerState.find(threadId);
+  if (state != timerState.end())
+  {
+    state->second.erase(timerName);
+    if (state->second.empty())
+      timerState.erase(state);
+  }
+}
+
+bool Timers::IsRunning(const std::thread::id& threadId,
+                       const std::string& timerName) const
+{
+  std::map<std::thread::id, std::map<std::string, bool>>::const_iterator state =
+      timerState.find(threadId);
+  if (state == timerState.end())
+    return false;
+
+  std::map<std::string, bool>::const_iterator running =
+      state->second.find(timerName);
+  return (running != state->second.end()) && running->second;
 }
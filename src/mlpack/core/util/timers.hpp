@@ -14,7 +14,9 @@
 #define MLPACK_CORE_UTILITIES_TIMERS_HPP
 
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <chrono> // chrono library for cross platform timer calculation
 
 #if defined(_WIN32)
@@ -114,7 +116,7 @@ class Timers
   void StopTimer(const std::string& timerName);
 
   /**
-   * Returns state of the given timer.
+   * Returns state of the given timer in the calling thread.
    *
    * @param timerName The name of the timer in question.
    */
@@ -123,13 +125,23 @@ class Timers
  private:
   //! A map of all the timers that are being tracked.
   std::map<std::string, std::chrono::microseconds> timers;
-  //! A map that contains whether or not each timer is currently running.
-  std::map<std::string, bool> timerState;
-  //! A map for the starting values of the timers.
-  std::map<std::string, std::chrono::high_resolution_clock::time_point>
-      timerStartTime;
+  //! A map that contains whether or not each timer is currently running, for
+  //! each thread; so, the same timer may be run in several threads at once.
+  //! Only running timers have an entry, and a thread is removed from the map
+  //! once all of its timers have stopped.
+  std::map<std::thread::id, std::map<std::string, bool>> timerState;
+  //! A map for the starting values of the running timers, for each thread.
+  std::map<std::thread::id, std::map<std::string,
+      std::chrono::high_resolution_clock::time_point>> timerStartTime;
+  //! Mutex protecting the maps above.
+  std::mutex timersMutex;
 
   std::chrono::high_resolution_clock::time_point GetTime();
+
+  //! Return whether the given timer is running in the given thread.  The
+  //! caller must hold timersMutex.
+  bool IsRunning(const std::thread::id& threadId,
+                 const std::string& timerName) const;
 };
 
 } // namespace mlpack
@@ -65,7 +65,9 @@ class RectifierFunction
   template<typename eT>
   static void Fn(const arma::Mat<eT>& x, arma::Mat<eT>& y)
   {
-    y = arma::max(arma::zeros<arma::Mat<eT> >(x.n_rows, x.n_cols), x);
+    y.set_size(arma::size(x));
+    for (size_t i = 0; i < x.n_elem; i++)
+      y(i) = std::max(eT(0), x(i));
   }
 
   /**
@@ -77,7 +79,7 @@ class RectifierFunction
   template<typename eT>
   static void Fn(const arma::Cube<eT>& x, arma::Cube<eT>& y)
   {
-    y = x;
+    y.set_size(arma::size(x));
     for (size_t s = 0; s < x.n_slices; s++)
       Fn(x.slice(s), y.slice(s));
   }
@@ -102,7 +104,7 @@ class RectifierFunction
   template<typename InputType, typename OutputType>
   static void Deriv(const InputType& y, OutputType& x)
   {
-    x = y;
+    x.set_size(arma::size(y));
 
     for (size_t i = 0; i < y.n_elem; i++)
       x(i) = Deriv(y(i));
@@ -65,7 +65,7 @@ class SoftplusFunction
   template<typename InputVecType, typename OutputVecType>
   static void Fn(const InputVecType& x, OutputVecType& y)
   {
-    y = x;
+    y.set_size(arma::size(x));
 
     for (size_t i = 0; i < x.n_elem; i++)
       y(i) = Fn(x(i));
@@ -114,7 +114,7 @@ class SoftplusFunction
   template<typename InputVecType, typename OutputVecType>
   static void Inv(const InputVecType& y, OutputVecType& x)
   {
-    x = y;
+    x.set_size(arma::size(y));
 
     for (size_t i = 0; i < y.n_elem; i++)
       x(i) = Inv(y(i));
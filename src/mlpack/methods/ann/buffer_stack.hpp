@@ -0,0 +1,81 @@
+/**
+ * @file buffer_stack.hpp
+ * @author agent
+ *
+ * Definition of the BufferStack class, a stack of matrices that keeps the
+ * memory of popped matrices so that it can be reused.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_BUFFER_STACK_HPP
+#define MLPACK_METHODS_ANN_BUFFER_STACK_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A BufferStack holds the values that a network or a layer saves during the
+ * forward pass of each time step (or each sample) and restores in the backward
+ * pass in reverse order.  Unlike a std::vector of matrices, popping a matrix
+ * doesn't free its memory: the next matrix of the same size that is pushed is
+ * copied into it.  So after the first pass, which sizes the buffers, the stack
+ * doesn't allocate memory anymore.
+ *
+ * @tparam MatType Type of the matrices to hold (arma::mat or arma::cube).
+ */
+template<typename MatType = arma::mat>
+class BufferStack
+{
+ public:
+  //! Create an empty stack.
+  BufferStack() : size(0) { }
+
+  /**
+   * Push a copy of the given matrix onto the stack and return the copy.
+   *
+   * @param value Matrix to push.
+   */
+  MatType& Push(const MatType& value)
+  {
+    if (size == buffers.size())
+      buffers.emplace_back();
+
+    // This reuses the memory of the buffer if it has the right size.
+    buffers[size] = value;
+    return buffers[size++];
+  }
+
+  //! Get the matrix on top of the stack.
+  MatType& Top() { return buffers[size - 1]; }
+  //! Get the matrix on top of the stack.
+  const MatType& Top() const { return buffers[size - 1]; }
+
+  //! Remove the matrix on top of the stack, keeping its memory.
+  void Pop() { --size; }
+
+  //! Remove all the matrices of the stack, keeping their memory.
+  void Clear() { size = 0; }
+
+  //! Get the number of matrices on the stack.
+  size_t Size() const { return size; }
+
+  //! Return whether the stack is empty.
+  bool Empty() const { return size == 0; }
+
+ private:
+  //! The buffers; the first size buffers are on the stack.
+  std::vector<MatType> buffers;
+
+  //! The number of matrices on the stack.
+  size_t size;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,327 @@
+/**
+ * @file im2col_convolution.hpp
+ * @author agent
+ *
+ * Implementation of the convolution through im2col and a matrix product.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "border_modes.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the two-dimensional convolution by lowering the input to a column
+ * matrix (im2col), where each column holds the input values under one position
+ * of the filter, so that the convolution becomes a single matrix product.  The
+ * Im2Col() and Col2Im() functions work on all the maps of a 3rd order tensor at
+ * once; the Convolution layer uses them to compute all of its output maps (and
+ * the backward pass and the gradient) with one matrix product each, when it is
+ * given Im2ColConvolution rules.
+ *
+ * FullConvolution: returns the full two-dimensional convolution.
+ * ValidConvolution: returns only those parts of the convolution that are
+ * computed without the zero-padded edges.
+ *
+ * @tparam BorderMode Type of the border mode (FullConvolution or
+ * ValidConvolution).
+ */
+template<typename BorderMode = FullConvolution>
+class Im2ColConvolution
+{
+ public:
+  /*
+   * Lower the given input to a column matrix.  Column (i + j * outputWidth)
+   * holds the input values under the filter when it is applied at output
+   * position (i, j); the value of input(x, y, s) under filter element (ki, kj)
+   * is stored in row (ki + kW * (kj + kH * s)).  Values that fall into the
+   * padding are zero.
+   *
+   * @param input Input to be lowered.
+   * @param kW Width of the filter.
+   * @param kH Height of the filter.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param padW Padding width of the input.
+   * @param padH Padding height of the input.
+   * @param columns Matrix to store the lowered input in.
+   */
+  template<typename eT>
+  static void Im2Col(const arma::Cube<eT>& input,
+                     const size_t kW,
+                     const size_t kH,
+                     const size_t dW,
+                     const size_t dH,
+                     const size_t padW,
+                     const size_t padH,
+                     arma::Mat<eT>& columns)
+  {
+    const size_t outputWidth = (input.n_rows + 2 * padW - kW) / dW + 1;
+    const size_t outputHeight = (input.n_cols + 2 * padH - kH) / dH + 1;
+
+    columns.set_size(kW * kH * input.n_slices, outputWidth * outputHeight);
+
+    for (size_t j = 0; j < outputHeight; ++j)
+    {
+      for (size_t i = 0; i < outputWidth; ++i)
+      {
+        eT* columnPtr = columns.colptr(i + j * outputWidth);
+        for (size_t s = 0; s < input.n_slices; ++s)
+        {
+          for (size_t kj = 0; kj < kH; ++kj)
+          {
+            // Positions are shifted by the padding, so that they can't be
+            // negative.
+            const size_t y = j * dH + kj;
+            if (y < padH || y >= input.n_cols + padH)
+            {
+              std::fill(columnPtr, columnPtr + kW, eT(0));
+              columnPtr += kW;
+              continue;
+            }
+
+            const eT* inputPtr = input.slice(s).colptr(y - padH);
+            for (size_t ki = 0; ki < kW; ++ki, ++columnPtr)
+            {
+              const size_t x = i * dW + ki;
+              *columnPtr = (x < padW || x >= input.n_rows + padW) ? eT(0) :
+                  inputPtr[x - padW];
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /*
+   * Accumulate a column matrix, laid out as by Im2Col(), back into a 3rd order
+   * tensor: each element of the columns is added to the input position it
+   * was taken from.  Elements that fall into the padding are dropped.  This is
+   * the adjoint of Im2Col().
+   *
+   * @param columns Column matrix to accumulate.
+   * @param kW Width of the filter.
+   * @param kH Height of the filter.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param padW Padding width of the input.
+   * @param padH Padding height of the input.
+   * @param output Tensor to accumulate into; it must already have the size of
+   *     the input, and it is set to zero first.
+   */
+  template<typename eT>
+  static void Col2Im(const arma::Mat<eT>& columns,
+                     const size_t kW,
+                     const size_t kH,
+                     const size_t dW,
+                     const size_t dH,
+                     const size_t padW,
+                     const size_t padH,
+                     arma::Cube<eT>& output)
+  {
+    const size_t outputWidth = (output.n_rows + 2 * padW - kW) / dW + 1;
+    const size_t outputHeight = (output.n_cols + 2 * padH - kH) / dH + 1;
+
+    output.zeros();
+
+    for (size_t j = 0; j < outputHeight; ++j)
+    {
+      for (size_t i = 0; i < outputWidth; ++i)
+      {
+        const eT* columnPtr = columns.colptr(i + j * outputWidth);
+        for (size_t s = 0; s < output.n_slices; ++s)
+        {
+          for (size_t kj = 0; kj < kH; ++kj)
+          {
+            const size_t y = j * dH + kj;
+            if (y < padH || y >= output.n_cols + padH)
+            {
+              columnPtr += kW;
+              continue;
+            }
+
+            eT* outputPtr = output.slice(s).colptr(y - padH);
+            for (size_t ki = 0; ki < kW; ++ki, ++columnPtr)
+            {
+              const size_t x = i * dW + ki;
+              if (x >= padW && x < output.n_rows + padW)
+                outputPtr[x - padW] += *columnPtr;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /*
+   * Perform a convolution (valid mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, ValidConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    const arma::Cube<eT> inputCube(const_cast<eT*>(input.memptr()),
+        input.n_rows, input.n_cols, 1, false, true);
+
+    arma::Mat<eT> columns;
+    Im2Col(inputCube, filter.n_rows, filter.n_cols, dW, dH, 0, 0, columns);
+
+    output = columns.t() * arma::vectorise(filter);
+    output.reshape((input.n_rows - filter.n_rows) / dW + 1,
+        (input.n_cols - filter.n_cols) / dH + 1);
+  }
+
+  /*
+   * Perform a convolution (full mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, FullConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t /* dW */ = 1,
+              const size_t /* dH */ = 1)
+  {
+    const arma::Cube<eT> inputCube(const_cast<eT*>(input.memptr()),
+        input.n_rows, input.n_cols, 1, false, true);
+
+    // The full convolution is the valid convolution of the input padded with
+    // the filter size minus one on every side.
+    arma::Mat<eT> columns;
+    Im2Col(inputCube, filter.n_rows, filter.n_cols, 1, 1, filter.n_rows - 1,
+        filter.n_cols - 1, columns);
+
+    output = columns.t() * arma::vectorise(filter);
+    output.reshape(input.n_rows + filter.n_rows - 1,
+        input.n_cols + filter.n_cols - 1);
+  }
+
+  /*
+   * Perform a convolution using 3rd order tensors.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0),
+        filter.slice(0), convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i),
+          filter.slice(i), convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using dense matrix as input and a 3rd order tensors
+   * as filter and output.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Mat<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(0),
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        filter.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < filter.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(i),
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using a 3rd order tensors as input and output and a
+   * dense matrix as filter.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Mat<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0), filter,
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i), filter,
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+};  // class Im2ColConvolution
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,149 @@
+/**
+ * @file data_parallel_function.hpp
+ * @author agent
+ *
+ * Definition of the DataParallelFunction class, which computes the gradients
+ * of the mini-batches of an FFN on several threads at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_DATA_PARALLEL_FUNCTION_HPP
+#define MLPACK_METHODS_ANN_DATA_PARALLEL_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <memory>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A DataParallelFunction presents the training data of a network to an
+ * optimizer as a set of mini-batches: each separable function is one
+ * mini-batch, whose objective and gradient are the sums of the objectives and
+ * gradients of its points.  Any optimizer for separable functions (such as
+ * SGD with any update policy) thus takes one step per mini-batch.
+ *
+ * Each mini-batch is split into numShards contiguous shards, whose gradients
+ * are computed at the same time by different OpenMP threads.  Every shard has
+ * its own copy of the layers of the network (and thus its own activations and
+ * deltas), but all copies use the parameters of the given network, so the
+ * weights are held in memory only once.  The shard gradients are then reduced
+ * pairwise in a tree, ((g0 + g1) + (g2 + g3)) + ..., into the gradient of the
+ * mini-batch.
+ *
+ * The shards and the order of the reduction only depend on numShards, not on
+ * how OpenMP schedules them, so for a fixed number of shards the results are
+ * bitwise reproducible (as long as the network has no random layers such as
+ * Dropout, whose random numbers depend on the thread that draws them).  With
+ * one shard, the gradient is summed in the same order as by a sequential
+ * optimizer.
+ *
+ * The optimizer must update the parameters in place (as all the first-order
+ * optimizers do), since the copies of the network refer to their memory.
+ * Usually this class is used through FFN::TrainParallel().
+ *
+ * @tparam NetworkType Type of the network to train (an FFN).
+ */
+template<typename NetworkType>
+class DataParallelFunction
+{
+ public:
+  /**
+   * Create the function for the given network, which must already hold its
+   * training data and parameters.
+   *
+   * @param network Network to train; its parameters are shared with the
+   *     copies, and it computes the gradient of the first shard itself.
+   * @param batchSize Number of points in each mini-batch.
+   * @param numShards Number of shards each mini-batch is split into; 0 means
+   *     one for each OpenMP thread.
+   */
+  DataParallelFunction(NetworkType& network,
+                       const size_t batchSize,
+                       const size_t numShards = 0);
+
+  /**
+   * Evaluate the objective of the given mini-batch.
+   *
+   * @param parameters Parameters of the network (they are used through the
+   *     network, which refers to the same memory).
+   * @param i Index of the mini-batch.
+   */
+  double Evaluate(const arma::mat& parameters, const size_t i);
+
+  /**
+   * Evaluate the objective of all the mini-batches.
+   *
+   * @param parameters Parameters of the network.
+   */
+  double Evaluate(const arma::mat& parameters);
+
+  /**
+   * Compute the gradient of the objective of the given mini-batch, which is
+   * the sum of the gradients of its points.
+   *
+   * @param parameters Parameters of the network.
+   * @param i Index of the mini-batch.
+   * @param gradient Matrix to store the gradient in.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient);
+
+  //! Return the number of mini-batches.
+  size_t NumFunctions() const { return numBatches; }
+
+  //! Get the number of points in each mini-batch.
+  size_t BatchSize() const { return batchSize; }
+
+  //! Get the number of shards each mini-batch is split into.
+  size_t NumShards() const { return networks.size(); }
+
+ private:
+  /**
+   * Get the first point of the given shard of the given mini-batch.  Shard s
+   * holds the points [ShardBegin(i, s), ShardBegin(i, s + 1)).
+   */
+  size_t ShardBegin(const size_t i, const size_t s) const;
+
+  /**
+   * Sum the matrices of the shards pairwise in a tree, into the first one.
+   */
+  void Reduce(std::vector<arma::mat>& values, const size_t numValues);
+
+  //! Locally-stored number of points in each mini-batch.
+  size_t batchSize;
+
+  //! Locally-stored number of points.
+  size_t numPoints;
+
+  //! Locally-stored number of mini-batches.
+  size_t numBatches;
+
+  //! The network of each shard; the first one is the given network.
+  std::vector<NetworkType*> networks;
+
+  //! Locally-stored copies of the given network.
+  std::vector<std::unique_ptr<NetworkType>> copies;
+
+  //! Locally-stored gradient of each shard.
+  std::vector<arma::mat> shardGradients;
+
+  //! Locally-stored gradient of a single point of each shard.
+  std::vector<arma::mat> pointGradients;
+
+  //! Locally-stored objective of each shard.
+  std::vector<double> shardObjectives;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "data_parallel_function_impl.hpp"
+
+#endif
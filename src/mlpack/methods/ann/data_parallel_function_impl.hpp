@@ -0,0 +1,168 @@
+/**
+ * @file data_parallel_function_impl.hpp
+ * @author agent
+ *
+ * Implementation of the DataParallelFunction class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_DATA_PARALLEL_FUNCTION_IMPL_HPP
+#define MLPACK_METHODS_ANN_DATA_PARALLEL_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "data_parallel_function.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename NetworkType>
+DataParallelFunction<NetworkType>::DataParallelFunction(
+    NetworkType& network,
+    const size_t batchSize,
+    const size_t numShards) :
+    batchSize(batchSize),
+    numPoints(network.predictors.n_cols)
+{
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("DataParallelFunction::DataParallelFunction():"
+        " batchSize must be positive!");
+  }
+
+  if (network.parameter.is_empty())
+  {
+    throw std::invalid_argument("DataParallelFunction::DataParallelFunction():"
+        " the network has no parameters; initialize it first!");
+  }
+
+  numBatches = (numPoints + batchSize - 1) / batchSize;
+
+  size_t shards = numShards;
+  if (shards == 0)
+  {
+    shards = 1;
+    #ifdef HAS_OPENMP
+      shards = omp_get_max_threads();
+    #endif
+  }
+
+  // More shards than points would only leave some of them without work.
+  shards = std::max(std::min(shards, batchSize), (size_t) 1);
+
+  // Copy the network without its data, then point each copy at the data and
+  // the parameters of the given network.
+  arma::mat predictors, responses;
+  std::swap(predictors, network.predictors);
+  std::swap(responses, network.responses);
+
+  networks.push_back(&network);
+  for (size_t s = 1; s < shards; ++s)
+  {
+    copies.emplace_back(new NetworkType(network));
+    copies.back()->ShareParameters(network.parameter);
+    networks.push_back(copies.back().get());
+  }
+
+  std::swap(predictors, network.predictors);
+  std::swap(responses, network.responses);
+
+  for (size_t s = 0; s < copies.size(); ++s)
+  {
+    // A non-strict alias is moved, not copied, by the assignment.
+    copies[s]->predictors = arma::mat(network.predictors.memptr(),
+        network.predictors.n_rows, network.predictors.n_cols, false, false);
+    copies[s]->responses = arma::mat(network.responses.memptr(),
+        network.responses.n_rows, network.responses.n_cols, false, false);
+  }
+
+  shardGradients.resize(shards);
+  pointGradients.resize(shards);
+  shardObjectives.resize(shards);
+}
+
+template<typename NetworkType>
+double DataParallelFunction<NetworkType>::Evaluate(
+    const arma::mat& parameters, const size_t i)
+{
+  const omp_size_t shards = networks.size();
+
+  #pragma omp parallel for num_threads(shards)
+  for (omp_size_t s = 0; s < shards; ++s)
+  {
+    shardObjectives[s] = 0.0;
+    const size_t end = ShardBegin(i, s + 1);
+    for (size_t j = ShardBegin(i, s); j < end; ++j)
+      shardObjectives[s] += networks[s]->Evaluate(parameters, j);
+  }
+
+  double objective = 0.0;
+  for (size_t s = 0; s < networks.size(); ++s)
+    objective += shardObjectives[s];
+
+  return objective;
+}
+
+template<typename NetworkType>
+double DataParallelFunction<NetworkType>::Evaluate(const arma::mat& parameters)
+{
+  double objective = 0.0;
+  for (size_t i = 0; i < numBatches; ++i)
+    objective += Evaluate(parameters, i);
+
+  return objective;
+}
+
+template<typename NetworkType>
+void DataParallelFunction<NetworkType>::Gradient(
+    const arma::mat& parameters, const size_t i, arma::mat& gradient)
+{
+  const omp_size_t shards = networks.size();
+
+  #pragma omp parallel for num_threads(shards)
+  for (omp_size_t s = 0; s < shards; ++s)
+  {
+    shardGradients[s].zeros(parameters.n_rows, parameters.n_cols);
+    const size_t end = ShardBegin(i, s + 1);
+    for (size_t j = ShardBegin(i, s); j < end; ++j)
+    {
+      networks[s]->Gradient(parameters, j, pointGradients[s]);
+      shardGradients[s] += pointGradients[s];
+    }
+  }
+
+  Reduce(shardGradients, shards);
+  gradient = shardGradients[0];
+}
+
+template<typename NetworkType>
+size_t DataParallelFunction<NetworkType>::ShardBegin(
+    const size_t i, const size_t s) const
+{
+  const size_t begin = i * batchSize;
+  const size_t size = std::min(batchSize, numPoints - begin);
+  return begin + (s * size) / networks.size();
+}
+
+template<typename NetworkType>
+void DataParallelFunction<NetworkType>::Reduce(
+    std::vector<arma::mat>& values, const size_t numValues)
+{
+  // At each level, value s takes in value s + step; the pairs of a level are
+  // independent, so they are summed at the same time.
+  for (size_t step = 1; step < numValues; step *= 2)
+  {
+    const omp_size_t pairs = (numValues - step + 2 * step - 1) / (2 * step);
+
+    #pragma omp parallel for
+    for (omp_size_t p = 0; p < pairs; ++p)
+      values[2 * step * p] += values[2 * step * p + step];
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
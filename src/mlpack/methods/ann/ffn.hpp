@@ -17,14 +17,18 @@
 
 #include "visitor/delete_visitor.hpp"
 #include "visitor/delta_visitor.hpp"
+#include "visitor/in_place_visitor.hpp"
 #include "visitor/output_height_visitor.hpp"
 #include "visitor/output_parameter_visitor.hpp"
 #include "visitor/output_width_visitor.hpp"
 #include "visitor/reset_visitor.hpp"
 #include "visitor/weight_size_visitor.hpp"
 #include "visitor/copy_visitor.hpp"
+#include "visitor/quantize_visitor.hpp"
 
 #include "init_rules/network_init.hpp"
+#include "data_parallel_function.hpp"
+#include "quantized_matrix.hpp"
 
 #include <mlpack/methods/ann/layer/layer_types.hpp>
 #include <mlpack/methods/ann/init_rules/random_init.hpp>
@@ -137,6 +141,36 @@ class FFN
   template<typename OptimizerType = mlpack::optimization::RMSProp>
   void Train(arma::mat predictors, arma::mat responses);
 
+  /**
+   * Train the feedforward network on the given input data with data-parallel
+   * mini-batches.  The optimizer sees each mini-batch of batchSize
+   * consecutive points as one separable function, whose gradient is the sum
+   * of the gradients of its points; each mini-batch is split into numShards
+   * shards whose gradients are computed by different threads, each with its
+   * own copy of the layers but sharing the parameters of this network (see
+   * DataParallelFunction).  For a fixed number of shards the result is bitwise
+   * reproducible, unless the network has random layers such as Dropout.
+   *
+   * The optimizer takes one step per mini-batch, so for instance SGD with a
+   * batchSize of 32 behaves like MiniBatchSGD with a batchSize of 32 and a
+   * step size 32 times smaller.  It must update the parameters in place, as
+   * all the first-order optimizers do.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param optimizer Instantiated optimizer used to train the model.
+   * @param batchSize Number of points in each mini-batch.
+   * @param numShards Number of shards each mini-batch is split into; 0 means
+   *     one for each OpenMP thread.
+   */
+  template<typename OptimizerType>
+  void TrainParallel(arma::mat predictors,
+                     arma::mat responses,
+                     OptimizerType& optimizer,
+                     const size_t batchSize,
+                     const size_t numShards = 0);
+
   /**
    * Predict the responses to a given set of predictors. The responses will
    * reflect the output of the given output layer as returned by the
@@ -215,6 +249,42 @@ class FFN
    */
   void ResetParameters();
 
+  /**
+   * Make the network use the memory of the given parameters instead of its own
+   * parameters.  The layers of the network will refer to that memory too, so
+   * the given matrix must not be resized or freed while the network is in use.
+   * This lets several copies of a trained network (for instance the workers of
+   * an InferenceSession) share a single set of parameters.
+   *
+   * @param parameters Parameters to use; they must have as many elements as
+   *     the network has weights.
+   */
+  void ShareParameters(arma::mat& parameters);
+
+  /**
+   * Quantize the trained network for inference.  The Linear, LinearNoBias,
+   * Convolution and Lookup layers of the network are replaced by their
+   * quantized versions (QuantizedLinear, QuantizedConvolution and
+   * QuantizedLookup), which store the weights of each output channel in 8-bit
+   * integers with their own scale, or in half precision floats; all the other
+   * layers stay as they are.  The given calibration data is run through the
+   * network first, to find the range of the input of each layer; in the int8
+   * format the inputs are quantized to that range, so the calibration data
+   * should be representative of the data the network will be used on.
+   *
+   * The weights of the quantized layers are removed from Parameters(), which
+   * then only holds the weights of the other layers.  Layers held by other
+   * layers (such as Sequential) are not quantized.  A quantized network can
+   * still be used with Predict(), but it should not be trained any more: the
+   * quantized layers have no trainable parameters.
+   *
+   * @param calibrationData Input points used to find the input ranges.
+   * @param type Format to quantize the weights to (INT8_QUANTIZATION or
+   *     FP16_QUANTIZATION).
+   */
+  void Quantize(const arma::mat& calibrationData,
+                const QuantizationType type = INT8_QUANTIZATION);
+
   //! Serialize the model.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
@@ -281,6 +351,13 @@ class FFN
    */
   void ResetDeterministic();
 
+  /**
+   * Find the activation layers that can run in place on the output of the
+   * layer before them (a Linear, LinearNoBias or Convolution layer, whose
+   * output isn't needed once the activation has been computed).
+   */
+  void FuseLayers();
+
   /**
    * Reset the gradient for all modules that implement the Gradient function.
    */
@@ -371,6 +448,15 @@ class FFN
 
   //! Locally-stored copy visitor
   CopyVisitor copyVisitor;
+
+  //! For each layer, whether its forward pass runs in place on the output of
+  //! the layer before it.  Empty until the first forward pass.
+  std::vector<bool> inPlace;
+
+  // The data-parallel function needs to make copies of the network that share
+  // its data.
+  template<typename>
+  friend class DataParallelFunction;
 }; // class FFN
 
 } // namespace ann
@@ -156,7 +156,8 @@ double FFN<OutputLayerType, InitializationRuleType>::Backward(
   outputLayer.Backward(std::move(boost::apply_visitor(outputParameterVisitor,
       network.back())), std::move(currentTarget), std::move(error));
 
-  gradients = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+  // This only allocates memory if gradients doesn't have the right size yet.
+  gradients.zeros(parameter.n_rows, parameter.n_cols);
 
   Backward();
   ResetGradients(gradients);
@@ -165,6 +166,30 @@ double FFN<OutputLayerType, InitializationRuleType>::Backward(
   return res;
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+template<typename OptimizerType>
+void FFN<OutputLayerType, InitializationRuleType>::TrainParallel(
+    arma::mat predictors,
+    arma::mat responses,
+    OptimizerType& optimizer,
+    const size_t batchSize,
+    const size_t numShards)
+{
+  ResetData(std::move(predictors), std::move(responses));
+  if (parameter.is_empty())
+    ResetParameters();
+
+  DataParallelFunction<NetworkType> function(*this, batchSize, numShards);
+
+  // Train the model.
+  Timer::Start("ffn_optimization");
+  const double out = optimizer.Optimize(function, parameter);
+  Timer::Stop("ffn_optimization");
+
+  Log::Info << "FFN::TrainParallel(): final objective of trained model is "
+      << out << "." << std::endl;
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void FFN<OutputLayerType, InitializationRuleType>::Predict(
     arma::mat predictors, arma::mat& results)
@@ -180,23 +205,17 @@ void FFN<OutputLayerType, InitializationRuleType>::Predict(
     ResetDeterministic();
   }
 
-  arma::mat resultsTemp;
-  Forward(std::move(arma::mat(predictors.colptr(0),
-      predictors.n_rows, 1, false, true)));
-  resultsTemp = boost::apply_visitor(outputParameterVisitor,
-      network.back()).col(0);
-
-  results = arma::mat(resultsTemp.n_elem, predictors.n_cols);
-  results.col(0) = resultsTemp.col(0);
-
-  for (size_t i = 1; i < predictors.n_cols; i++)
+  for (size_t i = 0; i < predictors.n_cols; i++)
   {
     Forward(std::move(arma::mat(predictors.colptr(i),
         predictors.n_rows, 1, false, true)));
 
-    resultsTemp = boost::apply_visitor(outputParameterVisitor,
+    // Copy the output of the last layer straight into the results.
+    const arma::mat& output = boost::apply_visitor(outputParameterVisitor,
         network.back());
-    results.col(i) = resultsTemp.col(0);
+    if (i == 0)
+      results.set_size(output.n_elem, predictors.n_cols);
+    results.col(i) = output.col(0);
   }
 }
 
@@ -274,6 +293,127 @@ void FFN<OutputLayerType, InitializationRuleType>::ResetParameters()
   networkInit.Initialize(network, parameter);
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::ShareParameters(
+    arma::mat& parameters)
+{
+  size_t weights = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+    weights += boost::apply_visitor(weightSizeVisitor, network[i]);
+
+  if (parameters.n_elem != weights)
+  {
+    std::ostringstream oss;
+    oss << "FFN::ShareParameters(): the given parameters have "
+        << parameters.n_elem << " elements, but the network has " << weights
+        << " weights!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // This makes parameter an alias of the given memory, without a copy.
+  parameter = arma::mat(parameters.memptr(), parameters.n_rows,
+      parameters.n_cols, false, false);
+
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+        offset), network[i]);
+
+    boost::apply_visitor(resetVisitor, network[i]);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::Quantize(
+    const arma::mat& calibrationData, const QuantizationType type)
+{
+  if (parameter.is_empty())
+  {
+    throw std::invalid_argument("FFN::Quantize(): the network has no "
+        "parameters; train it first!");
+  }
+
+  if (calibrationData.n_cols == 0)
+  {
+    throw std::invalid_argument("FFN::Quantize(): no calibration data "
+        "given!");
+  }
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  // Find the largest absolute value of the input of each layer.  The points
+  // are passed one at a time, as in Predict(), since some layers only take a
+  // single point.
+  std::vector<double> ranges(network.size(), 0.0);
+  for (size_t i = 0; i < calibrationData.n_cols; ++i)
+  {
+    Forward(std::move(arma::mat(const_cast<double*>(
+        calibrationData.colptr(i)), calibrationData.n_rows, 1, false, true)));
+
+    ranges[0] = std::max(ranges[0],
+        arma::max(arma::abs(calibrationData.col(i))));
+    for (size_t j = 1; j < network.size(); ++j)
+    {
+      const arma::mat& input = boost::apply_visitor(outputParameterVisitor,
+          network[j - 1]);
+      ranges[j] = std::max(ranges[j],
+          arma::max(arma::vectorise(arma::abs(input))));
+    }
+  }
+
+  // Replace the layers that can be quantized, and collect the weights of the
+  // other layers into the new (smaller) parameters.
+  std::vector<LayerTypes> quantized(network.size());
+  std::vector<size_t> sizes(network.size());
+  size_t weights = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    sizes[i] = boost::apply_visitor(weightSizeVisitor, network[i]);
+    quantized[i] = boost::apply_visitor(QuantizeVisitor(ranges[i], type),
+        network[i]);
+    if (quantized[i].which() == network[i].which())
+      weights += sizes[i];
+  }
+
+  arma::mat newParameter(weights, 1);
+  for (size_t i = 0, offset = 0, newOffset = 0; i < network.size(); ++i)
+  {
+    if (quantized[i].which() != network[i].which())
+    {
+      boost::apply_visitor(deleteVisitor, network[i]);
+      network[i] = quantized[i];
+    }
+    else if (sizes[i] != 0)
+    {
+      newParameter.rows(newOffset, newOffset + sizes[i] - 1) =
+          parameter.rows(offset, offset + sizes[i] - 1);
+      newOffset += sizes[i];
+    }
+
+    offset += sizes[i];
+  }
+
+  parameter = std::move(newParameter);
+
+  // The quantized layers keep their own output, so the activations after them
+  // can't run in place any more.
+  FuseLayers();
+
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+        offset), network[i]);
+
+    boost::apply_visitor(resetVisitor, network[i]);
+  }
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void FFN<OutputLayerType, InitializationRuleType>::ResetDeterministic()
 {
@@ -314,6 +454,10 @@ void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
     }
   }
 
+  // Layers may have been added since the last forward pass.
+  if (inPlace.size() != network.size())
+    FuseLayers();
+
   for (size_t i = 1; i < network.size(); ++i)
   {
     if (!reset)
@@ -325,6 +469,24 @@ void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
       boost::apply_visitor(SetInputHeightVisitor(height), network[i]);
     }
 
+    if (inPlace[i])
+    {
+      // Make the output of the layer an alias of its input, so that the
+      // activation overwrites the output of the layer before it.  That output
+      // may have been reallocated (e.g. for a different batch size), in which
+      // case the alias has to be made again.
+      arma::mat& input = boost::apply_visitor(outputParameterVisitor,
+          network[i - 1]);
+      arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+          network[i]);
+      if (output.memptr() != input.memptr() || output.n_rows != input.n_rows ||
+          output.n_cols != input.n_cols)
+      {
+        output = arma::mat(input.memptr(), input.n_rows, input.n_cols, false,
+            false);
+      }
+    }
+
     boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
         outputParameterVisitor, network[i - 1])), std::move(
         boost::apply_visitor(outputParameterVisitor, network[i]))), network[i]);
@@ -413,6 +575,25 @@ void FFN<OutputLayerType, InitializationRuleType>::Serialize(
   }
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::FuseLayers()
+{
+  // Drop the aliases made by earlier forward passes, since the layers they
+  // point into may have been replaced.
+  for (size_t i = 0; i < inPlace.size(); ++i)
+  {
+    if (inPlace[i])
+      boost::apply_visitor(outputParameterVisitor, network[i]).reset();
+  }
+
+  inPlace.assign(network.size(), false);
+  for (size_t i = 1; i < network.size(); ++i)
+  {
+    inPlace[i] = boost::apply_visitor(InPlaceOutputVisitor(), network[i - 1]) &&
+        boost::apply_visitor(InPlaceVisitor(), network[i]);
+  }
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
 {
@@ -434,6 +615,7 @@ void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
   std::swap(inputParameter, network.inputParameter);
   std::swap(outputParameter, network.outputParameter);
   std::swap(gradient, network.gradient);
+  std::swap(inPlace, network.inPlace);
 };
 
 template<typename OutputLayerType, typename InitializationRuleType>
@@ -455,7 +637,8 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(network.delta),
     inputParameter(network.inputParameter),
     outputParameter(network.outputParameter),
-    gradient(network.gradient)
+    gradient(network.gradient),
+    inPlace(network.inPlace)
 {
   // Build new layers according to source network
   for (size_t i = 0; i < network.network.size(); ++i)
@@ -463,6 +646,20 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     this->network.push_back(boost::apply_visitor(copyVisitor,
         network.network[i]));
   }
+
+  // The copied layers hold their own copies of the weights; make them use the
+  // copied parameters instead, so that changes to Parameters() reach them.
+  if (!parameter.is_empty())
+  {
+    size_t offset = 0;
+    for (size_t i = 0; i < this->network.size(); ++i)
+    {
+      offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+          offset), this->network[i]);
+
+      boost::apply_visitor(resetVisitor, this->network[i]);
+    }
+  }
 };
 
 template<typename OutputLayerType, typename InitializationRuleType>
@@ -484,7 +681,8 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(std::move(network.delta)),
     inputParameter(std::move(network.inputParameter)),
     outputParameter(std::move(network.outputParameter)),
-    gradient(std::move(network.gradient))
+    gradient(std::move(network.gradient)),
+    inPlace(std::move(network.inPlace))
 {
   this->network = std::move(network.network);
 };
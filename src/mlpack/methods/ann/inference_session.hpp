@@ -0,0 +1,185 @@
+/**
+ * @file inference_session.hpp
+ * @author agent
+ *
+ * Definition of the InferenceSession class, which serves predictions of a
+ * trained FFN or RNN to many threads at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_INFERENCE_SESSION_HPP
+#define MLPACK_METHODS_ANN_INFERENCE_SESSION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * An InferenceSession serves the predictions of a trained network to any
+ * number of threads.  FFN::Predict() and RNN::Predict() modify the state of
+ * the network, so a network can't be used by several threads at once; an
+ * InferenceSession instead holds a pool of worker threads, each with its own
+ * copy of the layers of the network (and thus its own activations).  All the
+ * copies use one shared copy of the parameters of the network, so the weights
+ * are held in memory only once no matter how many workers there are.
+ *
+ * Predict() may be called from any thread.  Requests that arrive at about the
+ * same time are combined into a single batch, which one worker runs through
+ * the network with one forward pass.  A worker that finds a request waiting
+ * collects further requests until the batch holds maxBatchSize points or the
+ * oldest request has waited for maxDelay microseconds, whichever comes first;
+ * so maxDelay bounds the latency added by batching.
+ *
+ * @code
+ * FFN<> model;
+ * // ... build and train the model ...
+ *
+ * InferenceSession<FFN<>> session(model, 4);
+ *
+ * // In any number of threads.
+ * arma::mat results;
+ * session.Predict(queries, results);
+ * @endcode
+ *
+ * Each point of an FFN is one column; each point of an RNN is one column that
+ * holds a whole input sequence, as for RNN::Predict().  Every sequence starts
+ * from the initial state of the recurrent cells.
+ *
+ * The workers are made by copying the given network, so layers that hold
+ * other layers (such as Sequential or Concat) are not supported: their copies
+ * would share the inner layers.
+ *
+ * @tparam NetworkType Type of network to serve (FFN or RNN).
+ */
+template<typename NetworkType>
+class InferenceSession
+{
+ public:
+  /**
+   * Create the session and start its workers.  The parameters of the given
+   * network are copied once; the network itself isn't used after the
+   * constructor returns.
+   *
+   * @param network Trained network to serve.
+   * @param numWorkers Number of worker threads; 0 means one for each hardware
+   *     thread.
+   * @param maxBatchSize Maximum number of points in one batch.
+   * @param maxDelay Maximum number of microseconds a request waits for other
+   *     requests to be batched with it.
+   */
+  InferenceSession(const NetworkType& network,
+                   const size_t numWorkers = 0,
+                   const size_t maxBatchSize = 64,
+                   const size_t maxDelay = 1000);
+
+  /**
+   * Stop the workers.  Requests that are still queued are finished first.
+   * No thread may call Predict() while (or after) the session is destroyed.
+   */
+  ~InferenceSession();
+
+  //! Sessions can't be copied: the workers refer to the session.
+  InferenceSession(const InferenceSession&) = delete;
+  //! Sessions can't be copied: the workers refer to the session.
+  InferenceSession& operator=(const InferenceSession&) = delete;
+
+  /**
+   * Predict the responses to the given points, as the Predict() function of
+   * the network would.  This may be called from any number of threads at
+   * once; it blocks until the results are available.
+   *
+   * @param predictors Input points.
+   * @param results Matrix to store the predicted responses in.
+   */
+  void Predict(const arma::mat& predictors, arma::mat& results);
+
+  //! Get the shared parameters of the network.
+  const arma::mat& Parameters() const { return parameter; }
+
+  //! Get the number of worker threads.
+  size_t NumWorkers() const { return workers.size(); }
+
+  //! Get the maximum number of points in one batch.
+  size_t MaxBatchSize() const { return maxBatchSize; }
+
+  //! Get the maximum number of microseconds a request waits for a batch.
+  size_t MaxDelay() const { return maxDelay; }
+
+ private:
+  //! A call to Predict() waiting for its results.
+  struct Request
+  {
+    //! The input points.
+    const arma::mat* predictors;
+    //! The matrix to store the results in.
+    arma::mat* results;
+    //! When the request was queued.
+    std::chrono::steady_clock::time_point arrival;
+    //! Whether or not the results are ready.
+    bool done;
+    //! The exception thrown while running the request, if any.
+    std::exception_ptr exception;
+  };
+
+  /**
+   * The loop of a worker thread: wait for requests, batch them, and run them
+   * through the given copy of the network, until the session is stopped.
+   *
+   * @param network The copy of the network owned by this worker.
+   */
+  void Work(NetworkType& network);
+
+  //! The parameters shared by all workers.
+  arma::mat parameter;
+
+  //! Maximum number of points in one batch.
+  size_t maxBatchSize;
+
+  //! Maximum number of microseconds a request waits for a batch.
+  size_t maxDelay;
+
+  //! The copies of the network, one for each worker.
+  std::vector<std::unique_ptr<NetworkType>> networks;
+
+  //! The worker threads.
+  std::vector<std::thread> workers;
+
+  //! Protects the queue and the state of the requests.
+  std::mutex mutex;
+
+  //! Signaled when a request is queued or the session is stopped.
+  std::condition_variable queued;
+
+  //! Signaled when a batch of requests is done.
+  std::condition_variable finished;
+
+  //! The requests that no worker has taken yet, oldest first.
+  std::deque<Request*> queue;
+
+  //! The number of points in the queued requests.
+  size_t queuedPoints;
+
+  //! Whether or not the workers should stop.
+  bool stop;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "inference_session_impl.hpp"
+
+#endif
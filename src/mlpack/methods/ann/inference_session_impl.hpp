@@ -0,0 +1,204 @@
+/**
+ * @file inference_session_impl.hpp
+ * @author agent
+ *
+ * Implementation of the InferenceSession class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_INFERENCE_SESSION_IMPL_HPP
+#define MLPACK_METHODS_ANN_INFERENCE_SESSION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "inference_session.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename NetworkType>
+InferenceSession<NetworkType>::InferenceSession(const NetworkType& network,
+                                                const size_t numWorkers,
+                                                const size_t maxBatchSize,
+                                                const size_t maxDelay) :
+    parameter(network.Parameters()),
+    maxBatchSize(maxBatchSize),
+    maxDelay(maxDelay),
+    queuedPoints(0),
+    stop(false)
+{
+  if (parameter.is_empty())
+  {
+    throw std::invalid_argument("InferenceSession::InferenceSession(): the "
+        "network has no parameters; train or initialize it first!");
+  }
+
+  if (maxBatchSize == 0)
+  {
+    throw std::invalid_argument("InferenceSession::InferenceSession(): "
+        "maxBatchSize must be positive!");
+  }
+
+  size_t threads = numWorkers;
+  if (threads == 0)
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  // Each copy holds its own copy of the weights until it is pointed at the
+  // shared parameters, so make the copies one after the other.
+  for (size_t i = 0; i < threads; ++i)
+  {
+    networks.emplace_back(new NetworkType(network));
+    networks.back()->ShareParameters(parameter);
+  }
+
+  try
+  {
+    for (size_t i = 0; i < threads; ++i)
+    {
+      workers.emplace_back(&InferenceSession::Work, this,
+          std::ref(*networks[i]));
+    }
+  }
+  catch (...)
+  {
+    // The destructor won't run, so stop the workers that did start.
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    queued.notify_all();
+    for (std::thread& worker : workers)
+      worker.join();
+
+    throw;
+  }
+}
+
+template<typename NetworkType>
+InferenceSession<NetworkType>::~InferenceSession()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  queued.notify_all();
+
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+template<typename NetworkType>
+void InferenceSession<NetworkType>::Predict(const arma::mat& predictors,
+                                            arma::mat& results)
+{
+  if (predictors.n_cols == 0)
+  {
+    results.reset();
+    return;
+  }
+
+  Request request;
+  request.predictors = &predictors;
+  request.results = &results;
+  request.arrival = std::chrono::steady_clock::now();
+  request.done = false;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  queue.push_back(&request);
+  queuedPoints += predictors.n_cols;
+  queued.notify_all();
+
+  finished.wait(lock, [&request] { return request.done; });
+
+  if (request.exception)
+    std::rethrow_exception(request.exception);
+}
+
+template<typename NetworkType>
+void InferenceSession<NetworkType>::Work(NetworkType& network)
+{
+  std::vector<Request*> batch;
+  arma::mat input, output;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true)
+  {
+    queued.wait(lock, [this] { return stop || !queue.empty(); });
+    if (queue.empty())
+      return;
+
+    // Wait for more requests until the batch is full or the oldest request
+    // has waited for maxDelay; another worker may take the requests meanwhile.
+    while (!stop && !queue.empty() && queuedPoints < maxBatchSize)
+    {
+      const std::chrono::steady_clock::time_point deadline =
+          queue.front()->arrival + std::chrono::microseconds(maxDelay);
+      if (queued.wait_until(lock, deadline) == std::cv_status::timeout)
+        break;
+    }
+
+    if (queue.empty())
+      continue;
+
+    // Take the oldest requests that fit into the batch; a request with more
+    // than maxBatchSize points is run on its own.  Only points with the same
+    // dimensionality can be batched.
+    batch.clear();
+    size_t points = 0;
+    const size_t dimensionality = queue.front()->predictors->n_rows;
+    while (!queue.empty() &&
+           queue.front()->predictors->n_rows == dimensionality &&
+           (batch.empty() ||
+            points + queue.front()->predictors->n_cols <= maxBatchSize))
+    {
+      batch.push_back(queue.front());
+      points += queue.front()->predictors->n_cols;
+      queuedPoints -= queue.front()->predictors->n_cols;
+      queue.pop_front();
+    }
+
+    // The requesting threads wait until their requests are done, so the
+    // batch can be run without holding the lock.
+    lock.unlock();
+
+    std::exception_ptr exception;
+    try
+    {
+      input.set_size(dimensionality, points);
+      for (size_t i = 0, col = 0; i < batch.size(); ++i)
+      {
+        input.cols(col, col + batch[i]->predictors->n_cols - 1) =
+            *batch[i]->predictors;
+        col += batch[i]->predictors->n_cols;
+      }
+
+      network.Forward(std::move(input), output);
+
+      for (size_t i = 0, col = 0; i < batch.size(); ++i)
+      {
+        *batch[i]->results = output.cols(col,
+            col + batch[i]->predictors->n_cols - 1);
+        col += batch[i]->predictors->n_cols;
+      }
+    }
+    catch (...)
+    {
+      exception = std::current_exception();
+    }
+
+    lock.lock();
+    for (Request* request : batch)
+    {
+      request->exception = exception;
+      request->done = true;
+    }
+    finished.notify_all();
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -82,9 +82,11 @@ class BaseLayer
                 arma::Mat<eT>&& gy,
                 arma::Mat<eT>&& g)
   {
-    arma::Mat<eT> derivative;
-    ActivationFunction::Deriv(input, derivative);
-    g = gy % derivative;
+    // Multiply each derivative with the error as soon as it is computed, so
+    // that the derivatives are never stored.
+    g.set_size(arma::size(gy));
+    for (size_t i = 0; i < gy.n_elem; i++)
+      g[i] = gy[i] * ActivationFunction::Deriv(input[i]);
   }
 
   //! Get the input parameter.
@@ -18,6 +18,7 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
 
 #include "layer_types.hpp"
 
@@ -28,6 +29,13 @@ namespace ann /** Artificial Neural Network. */ {
  * Implementation of the Convolution class. The Convolution class represents a
  * single layer of a neural network.
  *
+ * If the Im2ColConvolution rules are used (ValidConvolution for the forward
+ * pass and the gradient, FullConvolution for the backward pass), the layer
+ * lowers the whole input to a column matrix once and computes all output maps
+ * with one matrix product, and the backward pass and the gradient with one
+ * matrix product each, instead of convolving every pair of input and output
+ * maps separately.
+ *
  * @tparam ForwardConvolutionRule Convolution to perform forward process.
  * @tparam BackwardConvolutionRule Convolution to perform backward process.
  * @tparam GradientConvolutionRule Convolution to calculate gradient.
@@ -161,6 +169,30 @@ class Convolution
   //! Modify the output height.
   size_t& OutputHeight() { return outputHeight; }
 
+  //! Get the number of input maps.
+  size_t InputSize() const { return inSize; }
+
+  //! Get the number of output maps.
+  size_t OutputSize() const { return outSize; }
+
+  //! Get the filter/kernel width.
+  size_t KernelWidth() const { return kW; }
+
+  //! Get the filter/kernel height.
+  size_t KernelHeight() const { return kH; }
+
+  //! Get the stride of the filter in x-direction.
+  size_t StrideWidth() const { return dW; }
+
+  //! Get the stride of the filter in y-direction.
+  size_t StrideHeight() const { return dH; }
+
+  //! Get the padding width.
+  size_t PadWidth() const { return padW; }
+
+  //! Get the padding height.
+  size_t PadHeight() const { return padH; }
+
   /**
    * Serialize the layer
    */
@@ -252,8 +284,8 @@ class Convolution
            size_t hPad,
            arma::Cube<eT>& output)
   {
-    output = arma::zeros(input.n_rows + wPad * 2,
-        input.n_cols + hPad * 2, input.n_slices);
+    output.zeros(input.n_rows + wPad * 2, input.n_cols + hPad * 2,
+        input.n_slices);
 
     for (size_t i = 0; i < input.n_slices; ++i)
     {
@@ -321,6 +353,24 @@ class Convolution
   //! Locally-stored transformed gradient parameter.
   arma::cube gradientTemp;
 
+  //! Locally-stored input lowered to columns (im2col).
+  arma::mat inputColumns;
+
+  //! Locally-stored error lowered to columns (im2col).
+  arma::mat errorColumns;
+
+  //! Whether the forward pass is computed with im2col.
+  static const bool forwardIm2Col = std::is_same<ForwardConvolutionRule,
+      Im2ColConvolution<ValidConvolution> >::value;
+
+  //! Whether the backward pass is computed with col2im.
+  static const bool backwardIm2Col = std::is_same<BackwardConvolutionRule,
+      Im2ColConvolution<FullConvolution> >::value;
+
+  //! Whether the gradient is computed with im2col.
+  static const bool gradientIm2Col = std::is_same<GradientConvolutionRule,
+      Im2ColConvolution<ValidConvolution> >::value;
+
   //! Locally-stored delta object.
   OutputDataType delta;
 
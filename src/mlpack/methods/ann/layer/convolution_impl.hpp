@@ -113,24 +113,54 @@ void Convolution<
     OutputDataType
 >::Forward(const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, inSize);
-
-  if (padW != 0 || padH != 0)
+  // Copy the input into the existing cube, which only allocates memory if
+  // the size of the input changed.  The input must hold exactly one sample.
+  inputTemp.set_size(inputWidth, inputHeight, inSize);
+  if (input.n_elem != inputTemp.n_elem)
   {
-    Pad(inputTemp, padW, padH, inputPaddedTemp);
+    std::ostringstream oss;
+    oss << "Convolution::Forward(): the input has " << input.n_elem
+        << " elements, but a " << inputWidth << "x" << inputHeight << "x"
+        << inSize << " input was expected!";
+    throw std::invalid_argument(oss.str());
   }
+  std::copy(input.begin(), input.end(), inputTemp.begin());
 
   size_t wConv = ConvOutSize(inputWidth, kW, dW, padW);
   size_t hConv = ConvOutSize(inputHeight, kH, dH, padH);
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(wConv, hConv, outSize);
+  if (forwardIm2Col)
+  {
+    // Lower the input (padding included) to columns, so that all output maps
+    // are computed with a single matrix product.
+    Im2ColConvolution<ValidConvolution>::Im2Col(inputTemp, kW, kH, dW, dH,
+        padW, padH, inputColumns);
+
+    // The output maps are written directly into the output.
+    output.set_size(wConv * hConv * outSize, 1);
+    arma::Mat<eT> outputMaps(output.memptr(), wConv * hConv, outSize, false,
+        true);
+    outputMaps = inputColumns.t() * arma::Mat<eT>(weight.memptr(),
+        kW * kH * inSize, outSize, false, true);
+    outputMaps.each_row() += bias.t();
+
+    outputWidth = wConv;
+    outputHeight = hConv;
+    return;
+  }
+
+  if (padW != 0 || padH != 0)
+  {
+    Pad(inputTemp, padW, padH, inputPaddedTemp);
+  }
+
+  outputTemp.zeros(wConv, hConv, outSize);
 
+  arma::Mat<eT> convOutput;
   for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
   {
     for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
     {
-      arma::Mat<eT> convOutput;
-
       if (padW != 0 || padH != 0)
       {
         ForwardConvolutionRule::Convolution(inputPaddedTemp.slice(inMap),
@@ -148,7 +178,7 @@ void Convolution<
     outputTemp.slice(outMap) += bias(outMap);
   }
 
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
+  output = arma::vectorise(outputTemp);
 
   outputWidth = outputTemp.n_rows;
   outputHeight = outputTemp.n_cols;
@@ -171,19 +201,35 @@ void Convolution<
 >::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(),
-        outputWidth, outputHeight, outSize);
-  gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
-      inputTemp.n_cols, inputTemp.n_slices);
+  if (backwardIm2Col)
+  {
+    // Propagate the error of all output maps to the columns of the lowered
+    // input with one matrix product, then accumulate them into the input maps.
+    const arma::Mat<eT> mappedError(gy.memptr(), outputWidth * outputHeight,
+        outSize, false, true);
+    errorColumns = arma::Mat<eT>(weight.memptr(), kW * kH * inSize, outSize,
+        false, true) * mappedError.t();
+
+    // The input maps are accumulated directly into g.
+    g.set_size(inputTemp.n_elem, 1);
+    arma::Cube<eT> inputMaps(g.memptr(), inputTemp.n_rows, inputTemp.n_cols,
+        inputTemp.n_slices, false, true);
+    Im2ColConvolution<FullConvolution>::Col2Im(errorColumns, kW, kH, dW, dH,
+        padW, padH, inputMaps);
+    return;
+  }
+
+  const arma::cube mappedError(gy.memptr(), outputWidth, outputHeight,
+      outSize, false, true);
+  gTemp.zeros(inputTemp.n_rows, inputTemp.n_cols, inputTemp.n_slices);
 
+  arma::Mat<eT> rotatedFilter, output;
   for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
   {
     for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
     {
-      arma::Mat<eT> rotatedFilter;
       Rotate180(weight.slice(outMapIdx), rotatedFilter);
 
-      arma::Mat<eT> output;
       BackwardConvolutionRule::Convolution(mappedError.slice(outMap),
           rotatedFilter, output, dW, dH);
 
@@ -201,7 +247,7 @@ void Convolution<
     }
   }
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g = arma::vectorise(gTemp);
 }
 
 template<
@@ -223,27 +269,49 @@ void Convolution<
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  arma::cube mappedError;
-  if (padW != 0 && padH != 0)
+  if (gradientIm2Col)
   {
-    mappedError = arma::cube(error.memptr(), outputWidth / padW,
-        outputHeight / padH, outSize);
+    // The forward pass already lowered the input, unless it used another
+    // rule.
+    if (!forwardIm2Col)
+    {
+      Im2ColConvolution<ValidConvolution>::Im2Col(inputTemp, kW, kH, dW, dH,
+          padW, padH, inputColumns);
+    }
+
+    const arma::Mat<eT> mappedError(error.memptr(), outputWidth * outputHeight,
+        outSize, false, true);
+
+    // The gradient of the weights of all pairs of input and output maps, in
+    // the layout of the weights.
+    arma::Mat<eT> weightGradient(gradient.memptr(), kW * kH * inSize, outSize,
+        false, true);
+    weightGradient = inputColumns * mappedError;
+
+    gradient.submat(weight.n_elem, 0, weight.n_elem + outSize - 1, 0) =
+        arma::sum(mappedError).t();
+    return;
   }
-  else
+
+  const bool padded = (padW != 0 && padH != 0);
+  const arma::cube mappedError(error.memptr(),
+      padded ? outputWidth / padW : outputWidth,
+      padded ? outputHeight / padH : outputHeight, outSize, false, true);
+
+  // The forward pass didn't pad the input if it used im2col.
+  if (forwardIm2Col && (padW != 0 || padH != 0))
   {
-    mappedError = arma::cube(error.memptr(), outputWidth,
-        outputHeight, outSize);
+    Pad(inputTemp, padW, padH, inputPaddedTemp);
   }
 
-  gradientTemp = arma::zeros<arma::Cube<eT> >(weight.n_rows, weight.n_cols,
-      weight.n_slices);
+  gradientTemp.zeros(weight.n_rows, weight.n_cols, weight.n_slices);
 
+  arma::Cube<eT> inputSlices, deltaSlices, output;
   for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
   {
     for (size_t inMap = 0, s = outMap; inMap < inSize; inMap++, outMapIdx++,
         s += outSize)
     {
-      arma::Cube<eT> inputSlices;
       if (padW != 0 || padH != 0)
       {
         inputSlices = inputPaddedTemp.slices(inMap, inMap);
@@ -253,9 +321,8 @@ void Convolution<
         inputSlices = inputTemp.slices(inMap, inMap);
       }
 
-      arma::Cube<eT> deltaSlices = mappedError.slices(outMap, outMap);
+      deltaSlices = mappedError.slices(outMap, outMap);
 
-      arma::Cube<eT> output;
       GradientConvolutionRule::Convolution(inputSlices, deltaSlices,
           output, dW, dH);
 
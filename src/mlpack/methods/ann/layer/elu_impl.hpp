@@ -39,9 +39,9 @@ template<typename DataType>
 void ELU<InputDataType, OutputDataType>::Backward(
     const DataType&& input, DataType&& gy, DataType&& g)
 {
-  DataType derivative;
-  Deriv(input, derivative);
-  g = gy % derivative;
+  g.set_size(arma::size(gy));
+  for (size_t i = 0; i < gy.n_elem; i++)
+    g[i] = gy[i] * Deriv(input[i]);
 }
 
 template<typename InputDataType, typename OutputDataType>
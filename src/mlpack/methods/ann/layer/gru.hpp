@@ -25,17 +25,11 @@
 #ifndef MLPACK_METHODS_ANN_LAYER_GRU_HPP
 #define MLPACK_METHODS_ANN_LAYER_GRU_HPP
 
-#include <list>
 #include <limits>
 
 #include <mlpack/prereqs.hpp>
 
-#include "../visitor/delta_visitor.hpp"
-#include "../visitor/output_parameter_visitor.hpp"
-
 #include "layer_types.hpp"
-#include "add_merge.hpp"
-#include "sequential.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -43,7 +37,19 @@ namespace ann /** Artificial Neural Network. */ {
 /**
  * An implementation of a gru network layer.
  *
- * This cell can be used in RNN networks.
+ * This cell can be used in RNN networks.  The update and reset gates are
+ * computed together: at each time step the input of the whole batch is
+ * multiplied with the input weights of all gates in one matrix product and
+ * the previous output with the recurrent weights of both gates in another,
+ * and the activations are computed in place.  The activations of each time
+ * step are stored for the backward pass through time; their memory is reused
+ * for the next sequence.
+ *
+ * The parameters are laid out as the weights (3 * outSize x inSize) and biases
+ * (3 * outSize) of the input to gate connections, followed by the weights
+ * (2 * outSize x outSize) of the output to update and reset gate connections
+ * and the weights (outSize x outSize) of the output to hidden state
+ * connections.
  *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
@@ -70,6 +76,11 @@ class GRU
   GRU(const size_t inSize, const size_t outSize, const size_t rho =
       std::numeric_limits<size_t>::max());
 
+  /*
+   * Reset the layer parameter.
+   */
+  void Reset();
+
   /**
    * Ordinary feed forward pass of a neural network, evaluating the function
    * f(x) by propagating the activity forward through f.
@@ -104,7 +115,7 @@ class GRU
   template<typename eT>
   void Gradient(arma::Mat<eT>&& input,
                 arma::Mat<eT>&& /* error */,
-                arma::Mat<eT>&& /* gradient */);
+                arma::Mat<eT>&& gradient);
 
   /*
    * Resets the cell to accept a new input.
@@ -147,9 +158,6 @@ class GRU
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
-  //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
-
   /**
    * Serialize the layer
    */
@@ -172,32 +180,17 @@ class GRU
   //! Locally-stored weight object.
   OutputDataType weights;
 
-  //! Locally-stored input 2 gate module.
-  LayerTypes input2GateModule;
-
-  //! Locally-stored output 2 gate module.
-  LayerTypes output2GateModule;
+  //! Locally-stored input to gate weights.
+  OutputDataType input2GateWeight;
 
-  //! Locally-stored output hidden state 2 gate module.
-  LayerTypes outputHidden2GateModule;
+  //! Locally-stored input to gate bias.
+  OutputDataType input2GateBias;
 
-  //! Locally-stored input gate module.
-  LayerTypes inputGateModule;
+  //! Locally-stored output to update and reset gate weights.
+  OutputDataType output2GateWeight;
 
-  //! Locally-stored hidden state module.
-  LayerTypes hiddenStateModule;
-
-  //! Locally-stored forget gate module.
-  LayerTypes forgetGateModule;
-
-  //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
-
-  //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
-
-  //! Locally-stored list of network modules.
-  std::vector<LayerTypes> network;
+  //! Locally-stored output to hidden state weights.
+  OutputDataType outputHidden2GateWeight;
 
   //! Locally-stored number of forward steps.
   size_t forwardStep;
@@ -208,24 +201,30 @@ class GRU
   //! Locally-stored number of gradient steps.
   size_t gradientStep;
 
-  //! Locally-stored output parameters.
-  std::list<arma::mat> outParameter;
+  //! Locally-stored number of time steps held for BPTT.
+  size_t storedSteps;
 
-  //! Matrix of all zeroes to initialize the output
-  arma::mat allZeros;
+  //! Locally-stored previous output.
+  arma::mat prevOutput;
 
-  //! Iterator pointed to the last output produced by the cell
-  std::list<arma::mat>::iterator prevOutput;
+  //! Locally-stored reset gate times the previous output.
+  arma::mat resetOutput;
 
-  //! Iterator pointed to the last output processed by backward
-  std::list<arma::mat>::iterator backIterator;
+  //! Locally-stored gate activations of each time step.
+  std::vector<arma::mat> gateActivation;
 
-  //! Iterator pointed to the last output processed by gradient
-  std::list<arma::mat>::iterator gradIterator;
+  //! Locally-stored previous output of each time step.
+  std::vector<arma::mat> prevOutParameter;
 
-  //! Locally-stored previous error.
+  //! Locally-stored error of the gates of the current step.
   arma::mat prevError;
 
+  //! Locally-stored error of the reset gate times the previous output.
+  arma::mat resetError;
+
+  //! Locally-stored error of the output passed to the previous step.
+  arma::mat recurrentError;
+
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
 
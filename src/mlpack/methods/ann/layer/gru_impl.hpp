@@ -16,9 +16,8 @@
 // In case it hasn't yet been included.
 #include "gru.hpp"
 
-#include "../visitor/forward_visitor.hpp"
-#include "../visitor/backward_visitor.hpp"
-#include "../visitor/gradient_visitor.hpp"
+#include "../activation_functions/logistic_function.hpp"
+#include "../activation_functions/tanh_function.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -41,39 +40,30 @@ GRU<InputDataType, OutputDataType>::GRU(
     forwardStep(0),
     backwardStep(0),
     gradientStep(0),
+    storedSteps(0),
     deterministic(false)
 {
-  // Input specific linear layers(for zt, rt, ot).
-  input2GateModule = new Linear<>(inSize, 3 * outSize);
-
-  // Previous output gates (for zt and rt).
-  output2GateModule = new LinearNoBias<>(outSize, 2 * outSize);
-
-  // Previous output gate for ot.
-  outputHidden2GateModule = new LinearNoBias<>(outSize, outSize);
-
-  network.push_back(input2GateModule);
-  network.push_back(output2GateModule);
-  network.push_back(outputHidden2GateModule);
-
-  inputGateModule = new SigmoidLayer<>();
-  forgetGateModule = new SigmoidLayer<>();
-  hiddenStateModule = new TanHLayer<>();
-
-  network.push_back(inputGateModule);
-  network.push_back(hiddenStateModule);
-  network.push_back(forgetGateModule);
-
-  prevError = arma::zeros<arma::mat>(3 * outSize, batchSize);
-
-  allZeros = arma::zeros<arma::mat>(outSize, batchSize);
-
-  outParameter.push_back(std::move(arma::mat(allZeros.memptr(),
-    allZeros.n_rows, allZeros.n_cols, false, true)));
+  weights.set_size(3 * outSize * inSize + 3 * outSize +
+      2 * outSize * outSize + outSize * outSize, 1);
+}
 
-  prevOutput = outParameter.begin();
-  backIterator = outParameter.end();
-  gradIterator = outParameter.end();
+template<typename InputDataType, typename OutputDataType>
+void GRU<InputDataType, OutputDataType>::Reset()
+{
+  // Input specific weights and biases (for zt, rt, ot).
+  input2GateWeight = arma::mat(weights.memptr(), 3 * outSize, inSize, false,
+      false);
+  input2GateBias = arma::mat(weights.memptr() + input2GateWeight.n_elem,
+      3 * outSize, 1, false, false);
+
+  // Previous output weights (for zt and rt).
+  const size_t offset = input2GateWeight.n_elem + input2GateBias.n_elem;
+  output2GateWeight = arma::mat(weights.memptr() + offset, 2 * outSize,
+      outSize, false, false);
+
+  // Previous output weights for ot.
+  outputHidden2GateWeight = arma::mat(weights.memptr() + offset +
+      output2GateWeight.n_elem, outSize, outSize, false, false);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -81,198 +71,151 @@ template<typename eT>
 void GRU<InputDataType, OutputDataType>::Forward(
     arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  if (input.n_cols != batchSize)
+  batchSize = input.n_cols;
+
+  // The first step of each BPTT chain starts from a zero output.
+  if (forwardStep == 0 || prevOutput.n_cols != batchSize)
+    prevOutput.zeros(outSize, batchSize);
+
+  // In deterministic mode the activations aren't needed for BPTT, so the
+  // memory of the first step is used for every step.
+  const size_t step = deterministic ? 0 : storedSteps;
+  if (step == gateActivation.size())
   {
-    batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
+    gateActivation.emplace_back();
+    prevOutParameter.emplace_back();
   }
 
-  // Process the input linearly(zt, rt, ot).
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-      boost::apply_visitor(outputParameterVisitor, input2GateModule))),
-      input2GateModule);
-
-  // Process the output(zt, rt) linearly.
-  boost::apply_visitor(ForwardVisitor(std::move(*prevOutput), std::move(
-      boost::apply_visitor(outputParameterVisitor, output2GateModule))),
-      output2GateModule);
-
-  // Merge the outputs(zt and rt).
-  output = (boost::apply_visitor(outputParameterVisitor,
-      input2GateModule).submat(0, 0, 2 * outSize - 1, batchSize - 1) +
-      boost::apply_visitor(outputParameterVisitor, output2GateModule));
-
-  // Pass the first outSize through inputGate(it).
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      0, 0, 1 * outSize - 1, batchSize - 1)), std::move(boost::apply_visitor(
-      outputParameterVisitor, inputGateModule))), inputGateModule);
-
-  // Pass the second through forgetGate.
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      1 * outSize, 0, 2 * outSize - 1, batchSize - 1)), std::move(
-      boost::apply_visitor(outputParameterVisitor, forgetGateModule))),
-      forgetGateModule);
-
-  arma::mat modInput = (boost::apply_visitor(outputParameterVisitor,
-      forgetGateModule) % *prevOutput);
-
-  // Pass that through the outputHidden2GateModule.
-  boost::apply_visitor(ForwardVisitor(std::move(modInput), std::move(
-      boost::apply_visitor(outputParameterVisitor, outputHidden2GateModule))),
-      outputHidden2GateModule);
-
-  // Merge for ot.
-  arma::mat outputH = boost::apply_visitor(outputParameterVisitor,
-      input2GateModule).submat(2 * outSize, 0, 3 * outSize - 1, batchSize - 1) +
-      boost::apply_visitor(outputParameterVisitor, outputHidden2GateModule);
-
-  // Pass it through hiddenGate.
-  boost::apply_visitor(ForwardVisitor(std::move(outputH), std::move(
-      boost::apply_visitor(outputParameterVisitor, hiddenStateModule))),
-      hiddenStateModule);
-
-  // Update the output (nextOutput): cmul1 + cmul2
-  // Where cmul1 is input gate * prevOutput and
-  // cmul2 is (1 - input gate) * hidden gate.
-  output = (boost::apply_visitor(outputParameterVisitor, inputGateModule)
-      % (*prevOutput - boost::apply_visitor(outputParameterVisitor,
-      hiddenStateModule))) + boost::apply_visitor(outputParameterVisitor,
-      hiddenStateModule);
+  if (!deterministic)
+    prevOutParameter[step] = prevOutput;
 
-  forwardStep++;
-  if (forwardStep == rho)
+  // Process the input (zt, rt, ot) and the previous output (zt, rt) linearly,
+  // with one matrix product each.
+  arma::mat& gates = gateActivation[step];
+  gates = input2GateWeight * input;
+  gates.each_col() += input2GateBias;
+  if (forwardStep > 0)
+    gates.rows(0, 2 * outSize - 1) += output2GateWeight * prevOutput;
+
+  // Pass zt and rt through the sigmoid, in place.
+  for (size_t j = 0; j < batchSize; ++j)
   {
-    forwardStep = 0;
-    if (!deterministic)
-    {
-      outParameter.push_back(std::move(arma::mat(allZeros.memptr(),
-        allZeros.n_rows, allZeros.n_cols, false, true)));
-      prevOutput = --outParameter.end();
-    }
-    else
-    {
-      *prevOutput = std::move(arma::mat(allZeros.memptr(),
-        allZeros.n_rows, allZeros.n_cols, false, true));
-    }
+    double* gate = gates.colptr(j);
+    for (size_t i = 0; i < 2 * outSize; ++i)
+      gate[i] = LogisticFunction::Fn(gate[i]);
   }
-  else if (!deterministic)
+
+  // Add the previous output gated by rt to ot.
+  if (forwardStep > 0)
   {
-    outParameter.push_back(output);
-    prevOutput = --outParameter.end();
+    resetOutput = gates.rows(outSize, 2 * outSize - 1) % prevOutput;
+    gates.rows(2 * outSize, 3 * outSize - 1) += outputHidden2GateWeight *
+        resetOutput;
   }
-  else
+
+  // Pass ot through tanh, in place, and compute the output: zt * prevOutput +
+  // (1 - zt) * ot.
+  output.set_size(outSize, batchSize);
+  for (size_t j = 0; j < batchSize; ++j)
   {
-    if (forwardStep == 1)
-    {
-      outParameter.clear();
-      outParameter.push_back(output);
+    double* gate = gates.colptr(j);
+    const double* prevOut = prevOutput.colptr(j);
+    eT* out = output.colptr(j);
 
-      prevOutput = outParameter.begin();
-    }
-    else
+    for (size_t i = 0; i < outSize; ++i)
     {
-      *prevOutput = output;
+      const double hiddenState = TanhFunction::Fn(gate[2 * outSize + i]);
+      gate[2 * outSize + i] = hiddenState;
+      out[i] = gate[i] * (prevOut[i] - hiddenState) + hiddenState;
     }
   }
+
+  prevOutput = output;
+
+  forwardStep++;
+  if (forwardStep == rho)
+    forwardStep = 0;
+
+  if (!deterministic)
+    storedSteps++;
 }
 
 template<typename InputDataType, typename OutputDataType>
 template<typename eT>
 void GRU<InputDataType, OutputDataType>::Backward(
-  const arma::Mat<eT>&& input, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
+  const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  if (input.n_cols != batchSize)
+  const size_t step = storedSteps - backwardStep - 1;
+
+  // The error of the next step flows back into this step, unless the next
+  // step started a new BPTT chain.
+  const bool nextStep = (backwardStep != 0) && ((step + 1) % rho != 0);
+
+  const arma::mat& gates = gateActivation[step];
+  const arma::mat& prevOutputStep = prevOutParameter[step];
+
+  prevError.set_size(3 * outSize, gy.n_cols);
+  recurrentError.set_size(outSize, gy.n_cols);
+
+  // Delta zt and delta ot; the output error times zt flows straight back to
+  // the previous output.
+  for (size_t j = 0; j < gy.n_cols; ++j)
   {
-    batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
+    const double* gate = gates.colptr(j);
+    const double* prevOut = prevOutputStep.colptr(j);
+    const eT* gyCol = gy.colptr(j);
+    double* error = prevError.colptr(j);
+    double* recurrentErrorCol = recurrentError.colptr(j);
+
+    for (size_t i = 0; i < outSize; ++i)
+    {
+      double outputError = gyCol[i];
+      if (nextStep)
+        outputError += recurrentErrorCol[i];
+
+      const double updateGate = gate[i];
+      const double hiddenState = gate[2 * outSize + i];
+
+      error[i] = outputError * (prevOut[i] - hiddenState) *
+          LogisticFunction::Deriv(updateGate);
+      error[2 * outSize + i] = outputError * (1 - updateGate) *
+          TanhFunction::Deriv(hiddenState);
+      recurrentErrorCol[i] = outputError * updateGate;
+    }
   }
 
-  if ((outParameter.size() - backwardStep  - 1) % rho != 0 && backwardStep != 0)
+  // Delta rt.
+  resetError = outputHidden2GateWeight.t() * prevError.rows(2 * outSize,
+      3 * outSize - 1);
+  for (size_t j = 0; j < gy.n_cols; ++j)
   {
-    gy += boost::apply_visitor(deltaVisitor, output2GateModule);
+    const double* gate = gates.colptr(j);
+    const double* prevOut = prevOutputStep.colptr(j);
+    const double* resetErrorCol = resetError.colptr(j);
+    double* error = prevError.colptr(j);
+    double* recurrentErrorCol = recurrentError.colptr(j);
+
+    for (size_t i = 0; i < outSize; ++i)
+    {
+      const double resetGate = gate[outSize + i];
+      error[outSize + i] = resetErrorCol[i] * prevOut[i] *
+          LogisticFunction::Deriv(resetGate);
+      recurrentErrorCol[i] += resetErrorCol[i] * resetGate;
+    }
   }
 
-  if (backIterator == outParameter.end())
+  // Add the error of the previous output through zt and rt.  The first step
+  // of a BPTT chain starts from a zero output, so nothing flows further back.
+  if (step % rho != 0)
   {
-    backIterator = --(--outParameter.end());
+    recurrentError += output2GateWeight.t() * prevError.rows(0,
+        2 * outSize - 1);
   }
 
-  // Delta zt.
-  arma::mat dZt = gy % (*backIterator -
-      boost::apply_visitor(outputParameterVisitor,
-      hiddenStateModule));
-
-  // Delta ot.
-  arma::mat dOt = gy % (arma::ones<arma::vec>(outSize) -
-      boost::apply_visitor(outputParameterVisitor, inputGateModule));
-
-  // Delta of input gate.
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, inputGateModule)), std::move(dZt),
-      std::move(boost::apply_visitor(deltaVisitor, inputGateModule))),
-      inputGateModule);
-
-  // Delta of hidden gate.
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, hiddenStateModule)), std::move(dOt),
-      std::move(boost::apply_visitor(deltaVisitor, hiddenStateModule))),
-      hiddenStateModule);
-
-  // Delta of outputHidden2GateModule.
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, outputHidden2GateModule)),
-      std::move(boost::apply_visitor(deltaVisitor, hiddenStateModule)),
-      std::move(boost::apply_visitor(deltaVisitor, outputHidden2GateModule))),
-      outputHidden2GateModule);
-
-  // Delta rt.
-  arma::mat dRt = boost::apply_visitor(deltaVisitor, outputHidden2GateModule) %
-      *backIterator;
-
-  // Delta of forget gate.
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, forgetGateModule)), std::move(dRt),
-      std::move(boost::apply_visitor(deltaVisitor, forgetGateModule))),
-      forgetGateModule);
-
-  // Put delta zt.
-  prevError.submat(0, 0, 1 * outSize - 1, batchSize - 1) = boost::apply_visitor(
-      deltaVisitor, inputGateModule);
-
-  // Put delta rt.
-  prevError.submat(1 * outSize, 0, 2 * outSize - 1, batchSize - 1) =
-      boost::apply_visitor(deltaVisitor, forgetGateModule);
-
-  // Put delta ot.
-  prevError.submat(2 * outSize, 0, 3 * outSize - 1, batchSize - 1) =
-      boost::apply_visitor(deltaVisitor, hiddenStateModule);
-
-  // Get delta ht - 1 for input gate and forget gate.
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, input2GateModule)),
-      std::move(prevError.submat(0, 0, 2 * outSize - 1, batchSize - 1)),
-      std::move(boost::apply_visitor(deltaVisitor, output2GateModule))),
-      output2GateModule);
-
-  // Add delta ht - 1 from hidden state.
-  boost::apply_visitor(deltaVisitor, output2GateModule) +=
-      boost::apply_visitor(deltaVisitor, outputHidden2GateModule) %
-      boost::apply_visitor(outputParameterVisitor, forgetGateModule);
-
-  // Add delta ht - 1 from ht.
-  boost::apply_visitor(deltaVisitor, output2GateModule) += gy %
-      boost::apply_visitor(outputParameterVisitor, inputGateModule);
-
   // Get delta input.
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, input2GateModule)), std::move(prevError),
-      std::move(boost::apply_visitor(deltaVisitor, input2GateModule))),
-      input2GateModule);
+  g = input2GateWeight.t() * prevError;
 
   backwardStep++;
-  backIterator--;
-
-  g = boost::apply_visitor(deltaVisitor, input2GateModule);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -280,49 +223,51 @@ template<typename eT>
 void GRU<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& input,
     arma::Mat<eT>&& /* error */,
-    arma::Mat<eT>&& /* gradient */)
+    arma::Mat<eT>&& gradient)
 {
-  if (input.n_cols != batchSize)
+  const size_t step = storedSteps - gradientStep - 1;
+
+  const size_t offset = input2GateWeight.n_elem + input2GateBias.n_elem;
+  arma::Mat<eT> input2GateGradient(gradient.memptr(),
+      input2GateWeight.n_rows, input2GateWeight.n_cols, false, true);
+  arma::Mat<eT> input2GateBiasGradient(gradient.memptr() +
+      input2GateWeight.n_elem, input2GateBias.n_rows, 1, false, true);
+  arma::Mat<eT> output2GateGradient(gradient.memptr() + offset,
+      output2GateWeight.n_rows, output2GateWeight.n_cols, false, true);
+  arma::Mat<eT> outputHidden2GateGradient(gradient.memptr() + offset +
+      output2GateWeight.n_elem, outputHidden2GateWeight.n_rows,
+      outputHidden2GateWeight.n_cols, false, true);
+
+  input2GateGradient = prevError * input.t();
+  input2GateBiasGradient = arma::mean(prevError, 1);
+
+  if (step % rho != 0)
   {
-    batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
+    const arma::mat& prevOutputStep = prevOutParameter[step];
+    output2GateGradient = prevError.rows(0, 2 * outSize - 1) *
+        prevOutputStep.t();
+
+    resetOutput = gateActivation[step].rows(outSize, 2 * outSize - 1) %
+        prevOutputStep;
+    outputHidden2GateGradient = prevError.rows(2 * outSize,
+        3 * outSize - 1) * resetOutput.t();
   }
-
-  if (gradIterator == outParameter.end())
+  else
   {
-    gradIterator = --(--outParameter.end());
+    output2GateGradient.zeros();
+    outputHidden2GateGradient.zeros();
   }
 
-  boost::apply_visitor(GradientVisitor(std::move(input), std::move(prevError)),
-      input2GateModule);
-
-  boost::apply_visitor(GradientVisitor(
-      std::move(*gradIterator),
-      std::move(prevError.submat(0, 0, 2 * outSize - 1, batchSize - 1))),
-      output2GateModule);
-
-  boost::apply_visitor(GradientVisitor(
-      *gradIterator % boost::apply_visitor(outputParameterVisitor,
-      forgetGateModule),
-      std::move(prevError.submat(2 * outSize, 0, 3 * outSize - 1,
-      batchSize - 1))), outputHidden2GateModule);
-
-  gradIterator--;
+  gradientStep++;
 }
 
 template<typename InputDataType, typename OutputDataType>
 void GRU<InputDataType, OutputDataType>::ResetCell()
 {
-  outParameter.clear();
-  outParameter.push_back(std::move(arma::mat(allZeros.memptr(),
-    allZeros.n_rows, allZeros.n_cols, false, true)));
-
-  prevOutput = outParameter.begin();
-  backIterator = outParameter.end();
-  gradIterator = outParameter.end();
-
   forwardStep = 0;
   backwardStep = 0;
+  gradientStep = 0;
+  storedSteps = 0;
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -33,11 +33,11 @@ template<typename InputType, typename OutputType>
 void HardTanH<InputDataType, OutputDataType>::Forward(
     const InputType&& input, OutputType&& output)
 {
-  output = input;
+  output.set_size(arma::size(input));
   for (size_t i = 0; i < input.n_elem; i++)
   {
-    output(i) = (output(i) > maxValue ? maxValue :
-        (output(i) < minValue ? minValue : output(i)));
+    output(i) = (input(i) > maxValue ? maxValue :
+        (input(i) < minValue ? minValue : input(i)));
   }
 }
 
@@ -46,13 +46,10 @@ template<typename DataType>
 void HardTanH<InputDataType, OutputDataType>::Backward(
     const DataType&& input, DataType&& gy, DataType&& g)
 {
-  g = gy;
-  for (size_t i = 0; i < input.n_elem; i++)
+  g.set_size(arma::size(gy));
+  for (size_t i = 0; i < gy.n_elem; i++)
   {
-    if (input(i) < minValue || input(i) > maxValue)
-    {
-      g(i) = 0;
-    }
+    g(i) = (input(i) < minValue || input(i) > maxValue) ? 0 : gy(i);
   }
 }
 
@@ -17,12 +17,7 @@
 
 #include <limits>
 
-#include "../visitor/delta_visitor.hpp"
-#include "../visitor/output_parameter_visitor.hpp"
-
 #include "layer_types.hpp"
-#include "add_merge.hpp"
-#include "sequential.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -30,9 +25,18 @@ namespace ann /** Artificial Neural Network. */ {
 /**
  * An implementation of a lstm network layer.
  *
- * This class allows specification of the type of the activation functions used
- * for the gates and cells and also of the type of the function used to
- * initialize and update the peephole weights.
+ * The four gates (input gate, hidden state, forget gate and output gate) are
+ * computed together: at each time step the input of the whole batch is
+ * multiplied with the input weights of all gates in one matrix product, the
+ * previous output with the recurrent weights of all gates in another, and the
+ * gate activations and the new cell are computed in place in a single pass.
+ * The activations of each time step are stored so that the backward pass
+ * through time can be computed in the same way; the memory of the stored
+ * activations is reused for the next sequence.
+ *
+ * The parameters are laid out as the weights (4 * outSize x inSize) and biases
+ * (4 * outSize) of the input to gate connections, followed by the weights
+ * (4 * outSize x outSize) of the output to gate connections.
  *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
@@ -59,6 +63,11 @@ class LSTM
   LSTM(const size_t inSize, const size_t outSize, const size_t rho =
       std::numeric_limits<size_t>::max());
 
+  /*
+   * Reset the layer parameter.
+   */
+  void Reset();
+
   /**
    * Ordinary feed forward pass of a neural network, evaluating the function
    * f(x) by propagating the activity forward through f.
@@ -93,7 +102,7 @@ class LSTM
   template<typename eT>
   void Gradient(arma::Mat<eT>&& input,
                 arma::Mat<eT>&& /* error */,
-                arma::Mat<eT>&& /* gradient */);
+                arma::Mat<eT>&& gradient);
 
   /*
    * Resets the cell to accept a new input.
@@ -136,9 +145,6 @@ class LSTM
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
-  //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
-
   /**
    * Serialize the layer
    */
@@ -161,44 +167,14 @@ class LSTM
   //! Locally-stored weight object.
   OutputDataType weights;
 
-  //! Locally-stored previous output.
-  std::list<arma::mat>::iterator prevOutput;
-
-  //! Locally-stored previous cell state.
-  std::list<arma::mat>::iterator prevCell;
-
-  //! Locally-stored input 2 gate module.
-  LayerTypes input2GateModule;
-
-  //! Locally-stored output 2 gate module.
-  LayerTypes output2GateModule;
-
-  //! Locally-stored input gate module.
-  LayerTypes inputGateModule;
+  //! Locally-stored input to gate weights.
+  OutputDataType input2GateWeight;
 
-  //! Locally-stored hidden state module.
-  LayerTypes hiddenStateModule;
+  //! Locally-stored input to gate bias.
+  OutputDataType input2GateBias;
 
-  //! Locally-stored forget gate module.
-  LayerTypes forgetGateModule;
-
-  //! Locally-stored output gate module.
-  LayerTypes outputGateModule;
-
-  //! Locally-stored cell module.
-  LayerTypes cellModule;
-
-  //! Locally-stored cell activation module.
-  LayerTypes cellActivationModule;
-
-  //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
-
-  //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
-
-  //! Locally-stored list of network modules.
-  std::vector<LayerTypes> network;
+  //! Locally-stored output to gate weights.
+  OutputDataType output2GateWeight;
 
   //! Locally-stored number of forward steps.
   size_t forwardStep;
@@ -209,26 +185,35 @@ class LSTM
   //! Locally-stored number of gradient steps.
   size_t gradientStep;
 
-  //! Locally-stored cell parameters.
-  std::list<arma::mat> cellParameter;
+  //! Locally-stored number of time steps held for BPTT.
+  size_t storedSteps;
 
-  //! Locally-stored output parameters.
-  std::list<arma::mat> outParameter;
+  //! Locally-stored previous output.
+  arma::mat prevOutput;
+
+  //! Locally-stored previous cell state.
+  arma::mat prevCell;
 
-  //! Matrix of all zeroes to initialize the output and the cell
-  arma::mat allZeros;
+  //! Locally-stored gate activations of each time step.
+  std::vector<arma::mat> gateActivation;
 
-  //! Iterator pointed to the last cell output processed by backward
-  std::list<arma::mat>::iterator backIterator;
+  //! Locally-stored cell activations of each time step.
+  std::vector<arma::mat> cellActivation;
 
-  //! Iterator pointed to the last output processed by gradient
-  std::list<arma::mat>::iterator gradIterator;
+  //! Locally-stored previous cell state of each time step.
+  std::vector<arma::mat> prevCellParameter;
 
-  //! Locally-stored previous error.
+  //! Locally-stored previous output of each time step.
+  std::vector<arma::mat> prevOutParameter;
+
+  //! Locally-stored error of the gates of the current step.
   arma::mat prevError;
 
-  //! Locally-stored foget gate error.
-  arma::mat forgetGateError;
+  //! Locally-stored error of the output passed to the previous step.
+  arma::mat recurrentError;
+
+  //! Locally-stored error of the cell passed to the previous step.
+  arma::mat cellError;
 
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
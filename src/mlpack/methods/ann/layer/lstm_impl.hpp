@@ -16,9 +16,8 @@
 // In case it hasn't yet been included.
 #include "lstm.hpp"
 
-#include "../visitor/forward_visitor.hpp"
-#include "../visitor/backward_visitor.hpp"
-#include "../visitor/gradient_visitor.hpp"
+#include "../activation_functions/logistic_function.hpp"
+#include "../activation_functions/tanh_function.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -41,45 +40,22 @@ LSTM<InputDataType, OutputDataType>::LSTM(
     forwardStep(0),
     backwardStep(0),
     gradientStep(0),
+    storedSteps(0),
     deterministic(false)
 {
-  input2GateModule = new Linear<>(inSize, 4 * outSize);
-  output2GateModule = new LinearNoBias<>(outSize, 4 * outSize);
-
-  network.push_back(input2GateModule);
-  network.push_back(output2GateModule);
-
-  inputGateModule = new SigmoidLayer<>();
-  hiddenStateModule = new TanHLayer<>();
-  forgetGateModule = new SigmoidLayer<>();
-  outputGateModule = new SigmoidLayer<>();
-
-  network.push_back(inputGateModule);
-  network.push_back(hiddenStateModule);
-  network.push_back(forgetGateModule);
-  network.push_back(outputGateModule);
-
-  cellModule = new IdentityLayer<>();
-  cellActivationModule = new TanHLayer<>();
-
-  network.push_back(cellModule);
-  network.push_back(cellActivationModule);
-
-  prevError = arma::zeros<arma::mat>(4 * outSize, batchSize);
-
-  allZeros = arma::zeros<arma::mat>(outSize, batchSize);
-
-  outParameter.push_back(std::move(arma::mat(allZeros.memptr(),
-    allZeros.n_rows, allZeros.n_cols, false, false)));
-
-  cellParameter.push_back(std::move(arma::mat(allZeros.memptr(),
-    allZeros.n_rows, allZeros.n_cols, false, false)));
-
-  prevOutput = outParameter.begin();
-  prevCell = cellParameter.begin();
+  weights.set_size(4 * outSize * inSize + 4 * outSize +
+      4 * outSize * outSize, 1);
+}
 
-  backIterator = cellParameter.end();
-  gradIterator = outParameter.end();
+template<typename InputDataType, typename OutputDataType>
+void LSTM<InputDataType, OutputDataType>::Reset()
+{
+  input2GateWeight = arma::mat(weights.memptr(), 4 * outSize, inSize, false,
+      false);
+  input2GateBias = arma::mat(weights.memptr() + input2GateWeight.n_elem,
+      4 * outSize, 1, false, false);
+  output2GateWeight = arma::mat(weights.memptr() + input2GateWeight.n_elem +
+      input2GateBias.n_elem, 4 * outSize, outSize, false, false);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -87,207 +63,145 @@ template<typename eT>
 void LSTM<InputDataType, OutputDataType>::Forward(
     arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  if (input.n_cols != batchSize)
+  batchSize = input.n_cols;
+
+  // The first step of each BPTT chain starts from a zero output and cell.
+  if (forwardStep == 0 || prevOutput.n_cols != batchSize)
   {
-    batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
+    prevOutput.zeros(outSize, batchSize);
+    prevCell.zeros(outSize, batchSize);
   }
 
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-      boost::apply_visitor(outputParameterVisitor, input2GateModule))),
-      input2GateModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(*prevOutput), std::move(
-      boost::apply_visitor(outputParameterVisitor, output2GateModule))),
-      output2GateModule);
-
-  output = boost::apply_visitor(outputParameterVisitor, input2GateModule) +
-      boost::apply_visitor(outputParameterVisitor, output2GateModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      0, 0, 1 * outSize - 1, batchSize - 1)), std::move(boost::apply_visitor(
-      outputParameterVisitor, inputGateModule))), inputGateModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      1 * outSize, 0, 2 * outSize - 1, batchSize - 1)), std::move(
-      boost::apply_visitor(outputParameterVisitor, hiddenStateModule))),
-      hiddenStateModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      2 * outSize, 0, 3 * outSize - 1, batchSize - 1)), std::move(
-      boost::apply_visitor(outputParameterVisitor, forgetGateModule))),
-      forgetGateModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      3 * outSize, 0, 4 * outSize - 1, batchSize - 1)), std::move(
-      boost::apply_visitor(outputParameterVisitor, outputGateModule))),
-      outputGateModule);
-
-  // Update the cell (nextCell): cmul1 + cmul2
-  // where cmul1 is input gate * hidden state and
-  // cmul2 is forget gate * cell (prevCell).
-  arma::mat tempPrevCell = (boost::apply_visitor(outputParameterVisitor,
-      inputGateModule) % boost::apply_visitor(outputParameterVisitor,
-      hiddenStateModule)) + (boost::apply_visitor(outputParameterVisitor,
-      forgetGateModule) % *prevCell);
-
-  boost::apply_visitor(ForwardVisitor(std::move(tempPrevCell), std::move(
-      boost::apply_visitor(outputParameterVisitor, cellModule))), cellModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, cellModule)), std::move(boost::apply_visitor(
-      outputParameterVisitor, cellActivationModule))), cellActivationModule);
-
-  output = boost::apply_visitor(outputParameterVisitor,
-      cellActivationModule) % boost::apply_visitor(outputParameterVisitor,
-      outputGateModule);
-
-  forwardStep++;
-  if (forwardStep == rho)
+  // In deterministic mode the activations aren't needed for BPTT, so the
+  // memory of the first step is used for every step.
+  const size_t step = deterministic ? 0 : storedSteps;
+  if (step == gateActivation.size())
   {
-    forwardStep = 0;
-    if (!deterministic)
-    {
-      outParameter.push_back(std::move(arma::mat(allZeros.memptr(),
-        allZeros.n_rows, allZeros.n_cols, false, false)));
-
-      cellParameter.push_back(std::move(arma::mat(allZeros.memptr(),
-        allZeros.n_rows, allZeros.n_cols, false, false)));
-
-      prevOutput = --outParameter.end();
-      prevCell = --cellParameter.end();
-    }
-    else
-    {
-      *prevOutput = std::move(arma::mat(allZeros.memptr(),
-        allZeros.n_rows, allZeros.n_cols, false, false));
-
-      *prevCell = std::move(arma::mat(allZeros.memptr(),
-        allZeros.n_rows, allZeros.n_cols, false, false));
-    }
+    gateActivation.emplace_back();
+    cellActivation.emplace_back();
+    prevCellParameter.emplace_back();
+    prevOutParameter.emplace_back();
   }
-  else if (!deterministic)
+
+  if (!deterministic)
   {
-    outParameter.push_back(output);
-    cellParameter.push_back(std::move(tempPrevCell));
-    prevOutput = --outParameter.end();
-    prevCell = --cellParameter.end();
+    prevCellParameter[step] = prevCell;
+    prevOutParameter[step] = prevOutput;
   }
-  else
-  {
-    if (forwardStep == 1)
-    {
-      outParameter.clear();
-      cellParameter.clear();
 
-      outParameter.push_back(output);
-      cellParameter.push_back(std::move(tempPrevCell));
+  // Compute the input of all four gates with one matrix product for the
+  // input and one for the previous output.
+  arma::mat& gates = gateActivation[step];
+  gates = input2GateWeight * input;
+  gates.each_col() += input2GateBias;
+  if (forwardStep > 0)
+    gates += output2GateWeight * prevOutput;
+
+  arma::mat& cellActivationStep = cellActivation[step];
+  cellActivationStep.set_size(outSize, batchSize);
+  output.set_size(outSize, batchSize);
+
+  // Apply the gate activations in place, and update the cell (input gate *
+  // hidden state + forget gate * previous cell) and the output (output gate *
+  // tanh(cell)).
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    double* gate = gates.colptr(j);
+    double* cell = prevCell.colptr(j);
+    double* cellAct = cellActivationStep.colptr(j);
+    eT* out = output.colptr(j);
 
-      prevOutput = outParameter.begin();
-      prevCell = cellParameter.begin();
-    }
-    else
+    for (size_t i = 0; i < outSize; ++i)
     {
-      *prevOutput = output;
-      *prevCell = std::move(tempPrevCell);
+      const double inputGate = LogisticFunction::Fn(gate[i]);
+      const double hiddenState = TanhFunction::Fn(gate[outSize + i]);
+      const double forgetGate = LogisticFunction::Fn(gate[2 * outSize + i]);
+      const double outputGate = LogisticFunction::Fn(gate[3 * outSize + i]);
+
+      gate[i] = inputGate;
+      gate[outSize + i] = hiddenState;
+      gate[2 * outSize + i] = forgetGate;
+      gate[3 * outSize + i] = outputGate;
+
+      cell[i] = inputGate * hiddenState + forgetGate * cell[i];
+      cellAct[i] = TanhFunction::Fn(cell[i]);
+      out[i] = outputGate * cellAct[i];
     }
   }
+
+  prevOutput = output;
+
+  forwardStep++;
+  if (forwardStep == rho)
+    forwardStep = 0;
+
+  if (!deterministic)
+    storedSteps++;
 }
 
 template<typename InputDataType, typename OutputDataType>
 template<typename eT>
 void LSTM<InputDataType, OutputDataType>::Backward(
-  const arma::Mat<eT>&& input, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
+  const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  if (input.n_cols != batchSize)
-  {
-    batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
-  }
+  const size_t step = storedSteps - backwardStep - 1;
 
-  if ((outParameter.size() - backwardStep  - 1) % rho != 0 && backwardStep != 0)
-  {
-    gy += boost::apply_visitor(deltaVisitor, output2GateModule);
-  }
+  // The errors of the next step flow back into this step, unless the next
+  // step started a new BPTT chain.
+  const bool nextStep = (backwardStep != 0) && ((step + 1) % rho != 0);
 
-  if (backIterator == cellParameter.end())
-  {
-    backIterator = --(--cellParameter.end());
-  }
+  const arma::mat& gates = gateActivation[step];
+  const arma::mat& cellActivationStep = cellActivation[step];
+  const arma::mat& prevCellStep = prevCellParameter[step];
 
-  arma::mat g1 = boost::apply_visitor(outputParameterVisitor,
-      cellActivationModule) % gy;
+  prevError.set_size(4 * outSize, gy.n_cols);
+  cellError.set_size(outSize, gy.n_cols);
 
-  arma::mat g2 = boost::apply_visitor(outputParameterVisitor,
-      outputGateModule) % gy;
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, cellActivationModule)), std::move(g2),
-      std::move(boost::apply_visitor(deltaVisitor, cellActivationModule))),
-      cellActivationModule);
-
-  arma::mat cellActivationError = boost::apply_visitor(deltaVisitor,
-      cellActivationModule);
-
-  if (backwardStep > 0)
+  for (size_t j = 0; j < gy.n_cols; ++j)
   {
-    cellActivationError += forgetGateError;
+    const double* gate = gates.colptr(j);
+    const double* cellAct = cellActivationStep.colptr(j);
+    const double* prevCellCol = prevCellStep.colptr(j);
+    const eT* gyCol = gy.colptr(j);
+    double* error = prevError.colptr(j);
+    double* cellErrorCol = cellError.colptr(j);
+
+    for (size_t i = 0; i < outSize; ++i)
+    {
+      const double inputGate = gate[i];
+      const double hiddenState = gate[outSize + i];
+      const double forgetGate = gate[2 * outSize + i];
+      const double outputGate = gate[3 * outSize + i];
+
+      double outputError = gyCol[i];
+      if (nextStep)
+        outputError += recurrentError(i, j);
+
+      double cellErr = outputError * outputGate *
+          TanhFunction::Deriv(cellAct[i]);
+      if (nextStep)
+        cellErr += cellErrorCol[i];
+
+      error[i] = cellErr * hiddenState * LogisticFunction::Deriv(inputGate);
+      error[outSize + i] = cellErr * inputGate *
+          TanhFunction::Deriv(hiddenState);
+      error[2 * outSize + i] = cellErr * prevCellCol[i] *
+          LogisticFunction::Deriv(forgetGate);
+      error[3 * outSize + i] = outputError * cellAct[i] *
+          LogisticFunction::Deriv(outputGate);
+
+      cellErrorCol[i] = cellErr * forgetGate;
+    }
   }
 
-  arma::mat g4 = boost::apply_visitor(outputParameterVisitor,
-      inputGateModule) % cellActivationError;
-
-  arma::mat g5 = boost::apply_visitor(outputParameterVisitor,
-      hiddenStateModule) % cellActivationError;
-
-  forgetGateError = boost::apply_visitor(outputParameterVisitor,
-      forgetGateModule) % cellActivationError;
-
-  arma::mat g7 = *backIterator % cellActivationError;
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, inputGateModule)), std::move(g5),
-      std::move(boost::apply_visitor(deltaVisitor, inputGateModule))),
-      inputGateModule);
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, hiddenStateModule)), std::move(g4),
-      std::move(boost::apply_visitor(deltaVisitor, hiddenStateModule))),
-      hiddenStateModule);
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, forgetGateModule)), std::move(g7),
-      std::move(boost::apply_visitor(deltaVisitor, forgetGateModule))),
-      forgetGateModule);
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, outputGateModule)), std::move(g1),
-      std::move(boost::apply_visitor(deltaVisitor, outputGateModule))),
-      outputGateModule);
-
-  prevError.submat(0, 0, 1 * outSize - 1, batchSize - 1) = boost::apply_visitor(
-      deltaVisitor, inputGateModule);
-  prevError.submat(1 * outSize, 0, 2 * outSize - 1, batchSize - 1) =
-      boost::apply_visitor(deltaVisitor, hiddenStateModule);
-  prevError.submat(2 * outSize, 0, 3 * outSize - 1, batchSize - 1) =
-      boost::apply_visitor(deltaVisitor, forgetGateModule);
-  prevError.submat(3 * outSize, 0, 4 * outSize - 1, batchSize - 1) =
-      boost::apply_visitor(deltaVisitor, outputGateModule);
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, input2GateModule)), std::move(prevError),
-      std::move(boost::apply_visitor(deltaVisitor, input2GateModule))),
-      input2GateModule);
+  // The first step of a BPTT chain starts from a zero output, so nothing
+  // flows further back.
+  if (step % rho != 0)
+    recurrentError = output2GateWeight.t() * prevError;
 
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, output2GateModule)), std::move(prevError),
-      std::move(boost::apply_visitor(deltaVisitor, output2GateModule))),
-      output2GateModule);
+  g = input2GateWeight.t() * prevError;
 
   backwardStep++;
-  backIterator--;
-
-  g = boost::apply_visitor(deltaVisitor, input2GateModule);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -295,42 +209,36 @@ template<typename eT>
 void LSTM<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& input,
     arma::Mat<eT>&& /* error */,
-    arma::Mat<eT>&& /* gradient */)
+    arma::Mat<eT>&& gradient)
 {
-  if (gradIterator == outParameter.end())
-  {
-    gradIterator = --(--outParameter.end());
-  }
+  const size_t step = storedSteps - gradientStep - 1;
 
-  boost::apply_visitor(GradientVisitor(std::move(input), std::move(prevError)),
-      input2GateModule);
+  arma::Mat<eT> input2GateGradient(gradient.memptr(),
+      input2GateWeight.n_rows, input2GateWeight.n_cols, false, true);
+  arma::Mat<eT> input2GateBiasGradient(gradient.memptr() +
+      input2GateWeight.n_elem, input2GateBias.n_rows, 1, false, true);
+  arma::Mat<eT> output2GateGradient(gradient.memptr() +
+      input2GateWeight.n_elem + input2GateBias.n_elem,
+      output2GateWeight.n_rows, output2GateWeight.n_cols, false, true);
 
-  boost::apply_visitor(GradientVisitor(
-      std::move(*gradIterator),
-      std::move(prevError)), output2GateModule);
+  input2GateGradient = prevError * input.t();
+  input2GateBiasGradient = arma::mean(prevError, 1);
+
+  if (step % rho != 0)
+    output2GateGradient = prevError * prevOutParameter[step].t();
+  else
+    output2GateGradient.zeros();
 
-  gradIterator--;
+  gradientStep++;
 }
 
 template<typename InputDataType, typename OutputDataType>
 void LSTM<InputDataType, OutputDataType>::ResetCell()
 {
-  outParameter.clear();
-  outParameter.push_back(std::move(arma::mat(allZeros.memptr(),
-    allZeros.n_rows, allZeros.n_cols, false, false)));
-
-  cellParameter.clear();
-  cellParameter.push_back(std::move(arma::mat(allZeros.memptr(),
-    allZeros.n_rows, allZeros.n_cols, false, false)));
-
-  prevOutput = outParameter.begin();
-  prevCell = cellParameter.begin();
-
-  backIterator = cellParameter.end();
-  gradIterator = outParameter.end();
-
   forwardStep = 0;
   backwardStep = 0;
+  gradientStep = 0;
+  storedSteps = 0;
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_ANN_LAYER_MAX_POOLING_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/ann/buffer_stack.hpp>
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -266,7 +267,7 @@ class MaxPooling
   arma::Col<size_t> indicesCol;
 
   //! Locally-stored pooling indicies.
-  std::vector<arma::cube> poolingIndices;
+  BufferStack<arma::cube> poolingIndices;
 }; // class MaxPooling
 
 } // namespace ann
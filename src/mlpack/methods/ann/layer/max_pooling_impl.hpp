@@ -54,7 +54,10 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
   const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
   const size_t slices = input.n_elem / (inputWidth * inputHeight);
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, slices);
+  // Copy the input into the existing cube, which only allocates memory if
+  // the size of the input changed.
+  inputTemp.set_size(inputWidth, inputHeight, slices);
+  std::copy(input.begin(), input.end(), inputTemp.begin());
 
   if (floor)
   {
@@ -69,12 +72,11 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
     offset = 1;
   }
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(outputWidth, outputHeight,
-      slices);
+  outputTemp.zeros(outputWidth, outputHeight, slices);
 
   if (!deterministic)
   {
-    poolingIndices.push_back(outputTemp);
+    poolingIndices.Push(outputTemp);
   }
 
   if (!reset)
@@ -93,7 +95,7 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
     if (!deterministic)
     {
       PoolingOperation(inputTemp.slice(s), outputTemp.slice(s),
-        poolingIndices.back().slice(s));
+        poolingIndices.Top().slice(s));
     }
     else
     {
@@ -102,7 +104,7 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
     }
   }
 
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
+  output = arma::vectorise(outputTemp);
 
   outputWidth = outputTemp.n_rows;
   outputHeight = outputTemp.n_cols;
@@ -114,21 +116,20 @@ template<typename eT>
 void MaxPooling<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(), outputWidth,
-      outputHeight, outSize);
+  const arma::cube mappedError(gy.memptr(), outputWidth, outputHeight,
+      outSize, false, true);
 
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
-      inputTemp.n_cols, inputTemp.n_slices);
+  gTemp.zeros(inputTemp.n_rows, inputTemp.n_cols, inputTemp.n_slices);
 
   for (size_t s = 0; s < mappedError.n_slices; s++)
   {
     Unpooling(mappedError.slice(s), gTemp.slice(s),
-        poolingIndices.back().slice(s));
+        poolingIndices.Top().slice(s));
   }
 
-  poolingIndices.pop_back();
+  poolingIndices.Pop();
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g = arma::vectorise(gTemp);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -0,0 +1,139 @@
+/**
+ * @file quantized_convolution_impl.hpp
+ * @author agent
+ *
+ * Implementation of the QuantizedConvolution class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_QUANTIZED_CONVOLUTION_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_QUANTIZED_CONVOLUTION_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "quantized_convolution.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename InputDataType, typename OutputDataType>
+QuantizedConvolution<InputDataType, OutputDataType>::QuantizedConvolution() :
+    inputScale(1.0)
+{
+  // Nothing to do here.
+}
+
+template<typename InputDataType, typename OutputDataType>
+QuantizedConvolution<InputDataType, OutputDataType>::QuantizedConvolution(
+    const size_t inSize,
+    const size_t outSize,
+    const size_t kW,
+    const size_t kH,
+    const size_t dW,
+    const size_t dH,
+    const size_t padW,
+    const size_t padH,
+    const size_t inputWidth,
+    const size_t inputHeight,
+    const arma::mat& weight,
+    const arma::vec& bias,
+    const double inputScale,
+    const QuantizationType type) :
+    inSize(inSize),
+    outSize(outSize),
+    kW(kW),
+    kH(kH),
+    dW(dW),
+    dH(dH),
+    padW(padW),
+    padH(padH),
+    inputWidth(inputWidth),
+    inputHeight(inputHeight),
+    outputWidth(0),
+    outputHeight(0),
+    weights(weight, type),
+    bias(bias),
+    inputScale(inputScale)
+{
+  if (weight.n_rows != kW * kH * inSize || weight.n_cols != outSize ||
+      bias.n_elem != outSize)
+  {
+    throw std::invalid_argument("QuantizedConvolution::QuantizedConvolution():"
+        " the filters and the bias don't match the size of the layer!");
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void QuantizedConvolution<InputDataType, OutputDataType>::Forward(
+    const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
+{
+  // The input must hold exactly one sample.
+  inputTemp.set_size(inputWidth, inputHeight, inSize);
+  if (input.n_elem != inputTemp.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "QuantizedConvolution::Forward(): the input has " << input.n_elem
+        << " elements, but a " << inputWidth << "x" << inputHeight << "x"
+        << inSize << " input was expected!";
+    throw std::invalid_argument(oss.str());
+  }
+  std::copy(input.begin(), input.end(), inputTemp.begin());
+
+  // Lower the input (padding included) to columns; each output map is then
+  // one row of the quantized product.
+  Im2ColConvolution<ValidConvolution>::Im2Col(inputTemp, kW, kH, dW, dH, padW,
+      padH, inputColumns);
+  weights.TransMultiply(inputColumns, inputScale, outputMaps);
+  outputMaps.each_col() += bias;
+
+  outputWidth = (inputWidth + 2 * padW - kW) / dW + 1;
+  outputHeight = (inputHeight + 2 * padH - kH) / dH + 1;
+
+  output = arma::vectorise(outputMaps.t());
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void QuantizedConvolution<InputDataType, OutputDataType>::Backward(
+    const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
+{
+  const arma::Mat<eT> mappedError(gy.memptr(), outputWidth * outputHeight,
+      outSize, false, true);
+
+  arma::mat weight;
+  weights.Dequantize(weight);
+
+  arma::cube gTemp(inputWidth, inputHeight, inSize);
+  Im2ColConvolution<ValidConvolution>::Col2Im(arma::mat(weight *
+      mappedError.t()), kW, kH, dW, dH, padW, padH, gTemp);
+
+  g = arma::vectorise(gTemp);
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename Archive>
+void QuantizedConvolution<InputDataType, OutputDataType>::Serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(inSize, "inSize");
+  ar & data::CreateNVP(outSize, "outSize");
+  ar & data::CreateNVP(kW, "kW");
+  ar & data::CreateNVP(kH, "kH");
+  ar & data::CreateNVP(dW, "dW");
+  ar & data::CreateNVP(dH, "dH");
+  ar & data::CreateNVP(padW, "padW");
+  ar & data::CreateNVP(padH, "padH");
+  ar & data::CreateNVP(inputWidth, "inputWidth");
+  ar & data::CreateNVP(inputHeight, "inputHeight");
+  ar & data::CreateNVP(weights, "weights");
+  ar & data::CreateNVP(bias, "bias");
+  ar & data::CreateNVP(inputScale, "inputScale");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file quantized_lookup.hpp
+ * @author agent
+ *
+ * Definition of the QuantizedLookup class, a Lookup layer whose embeddings are
+ * stored in int8 or fp16 for inference.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_QUANTIZED_LOOKUP_HPP
+#define MLPACK_METHODS_ANN_LAYER_QUANTIZED_LOOKUP_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/ann/quantized_matrix.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * The QuantizedLookup layer is the quantized version of a trained Lookup
+ * layer; it is built by FFN::Quantize().  Each embedding is stored with its own
+ * scale in int8, or in fp16, and is dequantized when it is looked up.  The
+ * input holds indices, so it isn't quantized.
+ *
+ * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ */
+template <
+    typename InputDataType = arma::mat,
+    typename OutputDataType = arma::mat
+>
+class QuantizedLookup
+{
+ public:
+  //! Create the QuantizedLookup object.
+  QuantizedLookup();
+
+  /**
+   * Create the QuantizedLookup object from the given embeddings.
+   *
+   * @param weights Embeddings (outSize x inSize), one in each column.
+   * @param type Format to quantize the embeddings to.
+   */
+  QuantizedLookup(const arma::mat& weights, const QuantizationType type);
+
+  /**
+   * Ordinary feed forward pass of a neural network, evaluating the function
+   * f(x) by propagating the activity forward through f.
+   *
+   * @param input Input data used for evaluating the specified function.
+   * @param output Resulting output activation.
+   */
+  template<typename eT>
+  void Forward(const arma::Mat<eT>&& input, arma::Mat<eT>&& output);
+
+  /**
+   * Ordinary feed backward pass of a neural network, calculating the function
+   * f(x) by propagating x backwards trough f. Using the results from the feed
+   * forward pass.
+   *
+   * @param input The propagated input activation.
+   * @param gy The backpropagated error.
+   * @param g The calculated gradient.
+   */
+  template<typename eT>
+  void Backward(const arma::Mat<eT>&& /* input */,
+                const arma::Mat<eT>&& gy,
+                arma::Mat<eT>&& g);
+
+  //! Get the quantized embeddings.
+  const QuantizedMatrix& Weights() const { return weights; }
+
+  //! Get the input parameter.
+  InputDataType const& InputParameter() const { return inputParameter; }
+  //! Modify the input parameter.
+  InputDataType& InputParameter() { return inputParameter; }
+
+  //! Get the output parameter.
+  OutputDataType const& OutputParameter() const { return outputParameter; }
+  //! Modify the output parameter.
+  OutputDataType& OutputParameter() { return outputParameter; }
+
+  //! Get the delta.
+  OutputDataType const& Delta() const { return delta; }
+  //! Modify the delta.
+  OutputDataType& Delta() { return delta; }
+
+  /**
+   * Serialize the layer
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Locally-stored quantized embeddings.
+  QuantizedMatrix weights;
+
+  //! Locally-stored delta object.
+  OutputDataType delta;
+
+  //! Locally-stored input parameter object.
+  InputDataType inputParameter;
+
+  //! Locally-stored output parameter object.
+  OutputDataType outputParameter;
+}; // class QuantizedLookup
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantized_lookup_impl.hpp"
+
+#endif
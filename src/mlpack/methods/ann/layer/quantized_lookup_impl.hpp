@@ -0,0 +1,66 @@
+/**
+ * @file quantized_lookup_impl.hpp
+ * @author agent
+ *
+ * Implementation of the QuantizedLookup class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_QUANTIZED_LOOKUP_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_QUANTIZED_LOOKUP_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "quantized_lookup.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename InputDataType, typename OutputDataType>
+QuantizedLookup<InputDataType, OutputDataType>::QuantizedLookup()
+{
+  // Nothing to do here.
+}
+
+template<typename InputDataType, typename OutputDataType>
+QuantizedLookup<InputDataType, OutputDataType>::QuantizedLookup(
+    const arma::mat& weights, const QuantizationType type) :
+    weights(weights, type)
+{
+  // Nothing to do here.
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void QuantizedLookup<InputDataType, OutputDataType>::Forward(
+    const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
+{
+  output.set_size(weights.Rows(), input.n_elem);
+  for (size_t i = 0; i < input.n_elem; ++i)
+    weights.Column(size_t(input[i]) - 1, output.colptr(i));
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename eT>
+void QuantizedLookup<InputDataType, OutputDataType>::Backward(
+    const arma::Mat<eT>&& /* input */,
+    const arma::Mat<eT>&& gy,
+    arma::Mat<eT>&& g)
+{
+  g = gy;
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename Archive>
+void QuantizedLookup<InputDataType, OutputDataType>::Serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(weights, "weights");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -19,6 +19,7 @@
 #include "../visitor/output_parameter_visitor.hpp"
 #include "../visitor/reset_visitor.hpp"
 #include "../visitor/weight_size_visitor.hpp"
+#include "../buffer_stack.hpp"
 
 #include "layer_types.hpp"
 #include "add_merge.hpp"
@@ -220,7 +221,7 @@ class RecurrentAttention
   std::vector<arma::mat> feedbackOutputParameter;
 
   //! List of all module parameters for the backward pass (BBTT).
-  std::vector<arma::mat> moduleOutputParameter;
+  BufferStack<arma::mat> moduleOutputParameter;
 
   //! Locally-stored delta object.
   OutputDataType delta;
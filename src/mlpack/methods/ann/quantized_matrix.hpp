@@ -0,0 +1,157 @@
+/**
+ * @file quantized_matrix.hpp
+ * @author agent
+ *
+ * Definition of the QuantizedMatrix class, which stores a weight matrix in 8-bit
+ * integers or 16-bit floats for quantized inference.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZED_MATRIX_HPP
+#define MLPACK_METHODS_ANN_QUANTIZED_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * The formats a network can be quantized to; see FFN::Quantize().
+ */
+enum QuantizationType
+{
+  //! Symmetric 8-bit integers, with one scale for each output channel.
+  INT8_QUANTIZATION,
+  //! IEEE 754 half precision (16-bit) floats.
+  FP16_QUANTIZATION
+};
+
+/**
+ * Convert a single precision float to the bits of the nearest half precision
+ * float (ties are rounded to even).  Values that are too large become
+ * infinity.
+ *
+ * @param value Value to convert.
+ */
+inline arma::u16 FloatToHalf(const float value);
+
+/**
+ * Convert the bits of a half precision float to a single precision float.  The
+ * conversion is exact.
+ *
+ * @param half Bits of the half precision value.
+ */
+inline float HalfToFloat(const arma::u16 half);
+
+/**
+ * A QuantizedMatrix holds a weight matrix in a compact format: either in 8-bit
+ * integers, with one scale for each column, or in half precision floats.  Each
+ * column is one channel: it holds the weights of one output unit (or one
+ * output map, or one embedding), so that each channel gets the scale that fits
+ * its own range.  The int8 format takes an eighth of the memory of a matrix of
+ * doubles, the fp16 format a quarter.
+ *
+ * The products are computed without dequantizing the whole matrix.  In the
+ * int8 format the input is quantized too, with the given (calibrated) scale,
+ * and the products are accumulated in 32-bit integers; in the fp16 format each
+ * column is converted once per call and used for all the input points.
+ */
+class QuantizedMatrix
+{
+ public:
+  //! Create an empty matrix.
+  QuantizedMatrix();
+
+  /**
+   * Quantize the given matrix.
+   *
+   * @param matrix Matrix to quantize; each column is one channel.
+   * @param type Format to quantize to.
+   */
+  QuantizedMatrix(const arma::mat& matrix, const QuantizationType type);
+
+  /**
+   * Compute the product of the transpose of this matrix with the given input,
+   * that is output(c, j) = sum_k matrix(k, c) * input(k, j).
+   *
+   * @param input Input points, one in each column.
+   * @param inputScale Scale of the int8 quantization of the input: input
+   *     values are mapped to round(value / inputScale) and clipped to
+   *     [-127, 127].  It is ignored for the fp16 format.
+   * @param output Matrix to store the product in.
+   */
+  void TransMultiply(const arma::mat& input,
+                     const double inputScale,
+                     arma::mat& output);
+
+  /**
+   * Write the (dequantized) given column of the matrix to the given memory.
+   *
+   * @param column Index of the column.
+   * @param output Memory to write the n_rows values of the column to.
+   */
+  void Column(const size_t column, double* output) const;
+
+  /**
+   * Dequantize the whole matrix.
+   *
+   * @param matrix Matrix to store the dequantized values in.
+   */
+  void Dequantize(arma::mat& matrix) const;
+
+  //! Get the format of the matrix.
+  QuantizationType Type() const { return type; }
+
+  //! Get the number of rows.
+  size_t Rows() const { return rows; }
+  //! Get the number of columns (channels).
+  size_t Cols() const { return cols; }
+
+  //! Get the scale of each column (int8 format only).
+  const arma::vec& Scales() const { return scales; }
+
+  //! Get the number of bytes used to store the weights and the scales.
+  size_t MemoryUsage() const;
+
+  /**
+   * Serialize the matrix.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The format of the matrix.
+  QuantizationType type;
+
+  //! The number of rows.
+  size_t rows;
+
+  //! The number of columns.
+  size_t cols;
+
+  //! The weights in the int8 format.
+  arma::Mat<arma::s8> int8Weights;
+
+  //! The scale of each column in the int8 format.
+  arma::vec scales;
+
+  //! The bits of the weights in the fp16 format.
+  arma::Mat<arma::u16> halfWeights;
+
+  //! Locally-stored quantized input (int8 format).
+  arma::Mat<arma::s8> quantizedInput;
+
+  //! Locally-stored converted column (fp16 format).
+  arma::vec column;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantized_matrix_impl.hpp"
+
+#endif
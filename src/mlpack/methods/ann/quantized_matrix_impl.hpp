@@ -0,0 +1,240 @@
+/**
+ * @file quantized_matrix_impl.hpp
+ * @author agent
+ *
+ * Implementation of the QuantizedMatrix class and of the half precision
+ * conversions.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZED_MATRIX_IMPL_HPP
+#define MLPACK_METHODS_ANN_QUANTIZED_MATRIX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantized_matrix.hpp"
+
+#include <cstring>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline arma::u16 FloatToHalf(const float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  const uint32_t sign = (bits >> 16) & 0x8000;
+  const uint32_t absBits = bits & 0x7FFFFFFF;
+
+  // Infinity and NaN; NaN stays a (quiet) NaN.
+  if (absBits >= 0x7F800000)
+    return sign | 0x7C00 | ((absBits > 0x7F800000) ? 0x0200 : 0);
+
+  // Values of 65520 and above round to infinity.
+  if (absBits >= 0x477FF000)
+    return sign | 0x7C00;
+
+  // Values below 2^-14 become subnormal numbers (or zero).
+  if (absBits < 0x38800000)
+  {
+    // Values of 2^-25 and below round to zero.
+    if (absBits <= 0x33000000)
+      return sign;
+
+    const uint32_t mantissa = (absBits & 0x007FFFFF) | 0x00800000;
+    const uint32_t shift = 126 - (absBits >> 23);
+    uint32_t half = mantissa >> shift;
+
+    const uint32_t rest = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half & 1)))
+      ++half;
+
+    return sign | half;
+  }
+
+  // Normal numbers: rebias the exponent and round the mantissa.  A carry out
+  // of the mantissa correctly increments the exponent.
+  uint32_t half = (absBits - 0x38000000) >> 13;
+  const uint32_t rest = absBits & 0x1FFF;
+  if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+    ++half;
+
+  return sign | half;
+}
+
+inline float HalfToFloat(const arma::u16 half)
+{
+  const uint32_t sign = uint32_t(half & 0x8000) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1F;
+  const uint32_t mantissa = half & 0x03FF;
+
+  if (exponent == 0)
+  {
+    // Zero and subnormal numbers.
+    const float value = std::ldexp(float(mantissa), -24);
+    return sign ? -value : value;
+  }
+
+  uint32_t bits;
+  if (exponent == 31)
+    bits = sign | 0x7F800000 | (mantissa << 13);
+  else
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+inline QuantizedMatrix::QuantizedMatrix() :
+    type(INT8_QUANTIZATION),
+    rows(0),
+    cols(0)
+{
+  // Nothing to do here.
+}
+
+inline QuantizedMatrix::QuantizedMatrix(const arma::mat& matrix,
+                                        const QuantizationType type) :
+    type(type),
+    rows(matrix.n_rows),
+    cols(matrix.n_cols)
+{
+  if (type == FP16_QUANTIZATION)
+  {
+    halfWeights.set_size(rows, cols);
+    for (size_t i = 0; i < matrix.n_elem; ++i)
+      halfWeights[i] = FloatToHalf(float(matrix[i]));
+
+    return;
+  }
+
+  // Symmetric quantization: the largest weight (in absolute value) of each
+  // column is mapped to 127.
+  int8Weights.set_size(rows, cols);
+  scales.set_size(cols);
+  for (size_t c = 0; c < cols; ++c)
+  {
+    const double range = (rows == 0) ? 0.0 :
+        arma::max(arma::abs(matrix.col(c)));
+    scales[c] = (range > 0.0) ? (range / 127.0) : 1.0;
+
+    const double* weightPtr = matrix.colptr(c);
+    arma::s8* quantizedPtr = int8Weights.colptr(c);
+    for (size_t k = 0; k < rows; ++k)
+    {
+      const double value = std::round(weightPtr[k] / scales[c]);
+      quantizedPtr[k] = arma::s8(std::min(127.0, std::max(-127.0, value)));
+    }
+  }
+}
+
+inline void QuantizedMatrix::TransMultiply(const arma::mat& input,
+                                           const double inputScale,
+                                           arma::mat& output)
+{
+  if (input.n_rows != rows)
+  {
+    std::ostringstream oss;
+    oss << "QuantizedMatrix::TransMultiply(): the input has " << input.n_rows
+        << " rows, but the matrix has " << rows << " rows!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  output.set_size(cols, input.n_cols);
+
+  if (type == FP16_QUANTIZATION)
+  {
+    // Convert each column once and use it for all the points.
+    column.set_size(rows);
+    for (size_t c = 0; c < cols; ++c)
+    {
+      Column(c, column.memptr());
+      for (size_t j = 0; j < input.n_cols; ++j)
+      {
+        output(c, j) = arma::dot(column, arma::vec(
+            const_cast<double*>(input.colptr(j)), rows, false, true));
+      }
+    }
+
+    return;
+  }
+
+  // Quantize the input with the calibrated scale.
+  quantizedInput.set_size(input.n_rows, input.n_cols);
+  const double inverseScale = 1.0 / inputScale;
+  for (size_t i = 0; i < input.n_elem; ++i)
+  {
+    const double value = std::round(input[i] * inverseScale);
+    quantizedInput[i] = arma::s8(std::min(127.0, std::max(-127.0, value)));
+  }
+
+  // Both operands of each dot product are contiguous, so the inner loop is
+  // easy to vectorize; 32-bit accumulators can't overflow for fewer than 2^17
+  // rows.
+  for (size_t j = 0; j < input.n_cols; ++j)
+  {
+    const arma::s8* inputPtr = quantizedInput.colptr(j);
+    for (size_t c = 0; c < cols; ++c)
+    {
+      const arma::s8* weightPtr = int8Weights.colptr(c);
+      int32_t sum = 0;
+      for (size_t k = 0; k < rows; ++k)
+        sum += int32_t(weightPtr[k]) * int32_t(inputPtr[k]);
+
+      output(c, j) = sum * scales[c] * inputScale;
+    }
+  }
+}
+
+inline void QuantizedMatrix::Column(const size_t column, double* output) const
+{
+  if (type == FP16_QUANTIZATION)
+  {
+    const arma::u16* halfPtr = halfWeights.colptr(column);
+    for (size_t k = 0; k < rows; ++k)
+      output[k] = HalfToFloat(halfPtr[k]);
+  }
+  else
+  {
+    const arma::s8* weightPtr = int8Weights.colptr(column);
+    for (size_t k = 0; k < rows; ++k)
+      output[k] = weightPtr[k] * scales[column];
+  }
+}
+
+inline void QuantizedMatrix::Dequantize(arma::mat& matrix) const
+{
+  matrix.set_size(rows, cols);
+  for (size_t c = 0; c < cols; ++c)
+    Column(c, matrix.colptr(c));
+}
+
+inline size_t QuantizedMatrix::MemoryUsage() const
+{
+  if (type == FP16_QUANTIZATION)
+    return halfWeights.n_elem * sizeof(arma::u16);
+
+  return int8Weights.n_elem * sizeof(arma::s8) +
+      scales.n_elem * sizeof(double);
+}
+
+template<typename Archive>
+void QuantizedMatrix::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(type, "type");
+  ar & data::CreateNVP(rows, "rows");
+  ar & data::CreateNVP(cols, "cols");
+  ar & data::CreateNVP(int8Weights, "int8Weights");
+  ar & data::CreateNVP(scales, "scales");
+  ar & data::CreateNVP(halfWeights, "halfWeights");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
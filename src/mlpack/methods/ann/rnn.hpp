@@ -18,8 +18,11 @@
 #include "visitor/delta_visitor.hpp"
 #include "visitor/output_parameter_visitor.hpp"
 #include "visitor/reset_visitor.hpp"
+#include "visitor/weight_size_visitor.hpp"
+#include "visitor/copy_visitor.hpp"
 
 #include "init_rules/network_init.hpp"
+#include "buffer_stack.hpp"
 
 #include <mlpack/methods/ann/layer/layer_types.hpp>
 #include <mlpack/methods/ann/init_rules/random_init.hpp>
@@ -88,6 +91,9 @@ class RNN
       OutputLayerType outputLayer = OutputLayerType(),
       InitializationRuleType initializeRule = InitializationRuleType());
 
+  //! Copy constructor.
+  RNN(const RNN&);
+
   //! Destructor to release allocated memory.
   ~RNN();
 
@@ -144,6 +150,18 @@ class RNN
    */
   void Predict(arma::mat predictors, arma::mat& results);
 
+  /**
+   * Perform the forward pass of a batch of sequences, one sequence in each
+   * column of the given inputs.  Unlike Predict(), all sequences are run
+   * through the network together, and each of them starts from the initial
+   * state of the recurrent cells.
+   *
+   * @param inputs The input sequences.
+   * @param results The predicted results; column i holds the outputs of every
+   *     step of sequence i.
+   */
+  void Forward(arma::mat inputs, arma::mat& results);
+
   /**
    * Evaluate the recurrent neural network with the given parameters. This
    * function is usually called by the optimizer to train the model.
@@ -202,6 +220,18 @@ class RNN
   //! Modify the initial point for the optimization.
   arma::mat& Parameters() { return parameter; }
 
+  /**
+   * Make the network use the memory of the given parameters instead of its own
+   * parameters.  The layers of the network will refer to that memory too, so
+   * the given matrix must not be resized or freed while the network is in use.
+   * This lets several copies of a trained network (for instance the workers of
+   * an InferenceSession) share a single set of parameters.
+   *
+   * @param parameters Parameters to use; they must have as many elements as
+   *     the network has weights.
+   */
+  void ShareParameters(arma::mat& parameters);
+
   //! Return the maximum length of backpropagation through time.
   const size_t& Rho() const { return rho; }
   //! Modify the maximum length of backpropagation through time.
@@ -317,7 +347,10 @@ class RNN
   OutputParameterVisitor outputParameterVisitor;
 
   //! List of all module parameters for the backward pass (BBTT).
-  std::vector<arma::mat> moduleOutputParameter;
+  BufferStack<arma::mat> moduleOutputParameter;
+
+  //! The gradient of the current time step.
+  arma::mat currentGradient;
 
   //! Locally-stored weight size visitor.
   WeightSizeVisitor weightSizeVisitor;
@@ -328,6 +361,9 @@ class RNN
   //! Locally-stored delete visitor.
   DeleteVisitor deleteVisitor;
 
+  //! Locally-stored copy visitor.
+  CopyVisitor copyVisitor;
+
   //! The current evaluation mode (training or testing).
   bool deterministic;
 }; // class RNN
@@ -76,6 +76,47 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
   ResetDeterministic();
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+RNN<OutputLayerType, InitializationRuleType>::RNN(const RNN& network) :
+    rho(network.rho),
+    prevRho(network.prevRho),
+    outputLayer(network.outputLayer),
+    initializeRule(network.initializeRule),
+    inputSize(network.inputSize),
+    outputSize(network.outputSize),
+    targetSize(network.targetSize),
+    reset(network.reset),
+    single(network.single),
+    predictors(network.predictors),
+    responses(network.responses),
+    parameter(network.parameter),
+    numFunctions(network.numFunctions),
+    error(network.error),
+    currentInput(network.currentInput),
+    deterministic(network.deterministic)
+{
+  // Build new layers according to source network.
+  for (size_t i = 0; i < network.network.size(); ++i)
+  {
+    this->network.push_back(boost::apply_visitor(copyVisitor,
+        network.network[i]));
+  }
+
+  // The copied layers hold their own copies of the weights; make them use the
+  // copied parameters instead, so that changes to Parameters() reach them.
+  if (!parameter.is_empty())
+  {
+    size_t offset = 0;
+    for (size_t i = 0; i < this->network.size(); ++i)
+    {
+      offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+          offset), this->network[i]);
+
+      boost::apply_visitor(resetVisitor, this->network[i]);
+    }
+  }
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 RNN<OutputLayerType, InitializationRuleType>::~RNN()
 {
@@ -184,6 +225,44 @@ void RNN<OutputLayerType, InitializationRuleType>::Predict(
   }
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+void RNN<OutputLayerType, InitializationRuleType>::Forward(
+    arma::mat inputs, arma::mat& results)
+{
+  if (parameter.is_empty())
+  {
+    ResetParameters();
+  }
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  if (!inputSize)
+  {
+    inputSize = inputs.n_rows / rho;
+  }
+
+  ResetCells();
+
+  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  {
+    currentInput = inputs.rows(seqNum * inputSize,
+        (seqNum + 1) * inputSize - 1);
+    Forward(std::move(currentInput));
+
+    const arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+        network.back());
+    if (seqNum == 0)
+      results.set_size(output.n_rows * rho, inputs.n_cols);
+
+    results.rows(seqNum * output.n_rows, (seqNum + 1) * output.n_rows - 1) =
+        output;
+  }
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void RNN<OutputLayerType, InitializationRuleType>::SinglePredict(
     const arma::mat& predictors, arma::mat& results)
@@ -237,8 +316,8 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
   for (size_t seqNum = 0; seqNum < rho; ++seqNum)
   {
     currentInput = input.rows(seqNum * inputSize, (seqNum + 1) * inputSize - 1);
-    arma::mat currentTarget = target.rows(seqNum * targetSize,
-        (seqNum + 1) * targetSize - 1);
+    arma::mat currentTarget(target.memptr() + seqNum * targetSize, targetSize,
+        1, false, true);
 
     Forward(std::move(currentInput));
 
@@ -285,8 +364,9 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
 
   Evaluate(parameters, i, false);
 
-  arma::mat currentGradient = arma::zeros<arma::mat>(parameter.n_rows,
-      parameter.n_cols);
+  // The gradient of each time step is computed in currentGradient; this only
+  // allocates memory for the first sample.
+  currentGradient.zeros(parameter.n_rows, parameter.n_cols);
   ResetGradients(currentGradient);
 
   arma::mat input = arma::mat(predictors.colptr(i), predictors.n_rows,
@@ -298,8 +378,8 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
   {
     currentGradient.zeros();
 
-    arma::mat currentTarget = target.rows((rho - seqNum - 1) * targetSize,
-        (rho - seqNum) * targetSize - 1);
+    arma::mat currentTarget(target.memptr() + (rho - seqNum - 1) * targetSize,
+        targetSize, 1, false, true);
     currentInput = input.rows((rho - seqNum - 1) * inputSize,
         (rho - seqNum) * inputSize - 1);
 
@@ -336,6 +416,37 @@ void RNN<OutputLayerType, InitializationRuleType>::ResetParameters()
   networkInit.Initialize(network, parameter);
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+void RNN<OutputLayerType, InitializationRuleType>::ShareParameters(
+    arma::mat& parameters)
+{
+  size_t weights = 0;
+  for (LayerTypes& layer : network)
+    weights += boost::apply_visitor(weightSizeVisitor, layer);
+
+  if (parameters.n_elem != weights)
+  {
+    std::ostringstream oss;
+    oss << "RNN::ShareParameters(): the given parameters have "
+        << parameters.n_elem << " elements, but the network has " << weights
+        << " weights!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // This makes parameter an alias of the given memory, without a copy.
+  parameter = arma::mat(parameters.memptr(), parameters.n_rows,
+      parameters.n_cols, false, false);
+
+  size_t offset = 0;
+  for (LayerTypes& layer : network)
+  {
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+        offset), layer);
+
+    boost::apply_visitor(resetVisitor, layer);
+  }
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void RNN<OutputLayerType, InitializationRuleType>::ResetDeterministic()
 {
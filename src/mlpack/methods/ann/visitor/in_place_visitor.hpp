@@ -0,0 +1,111 @@
+/**
+ * @file in_place_visitor.hpp
+ * @author agent
+ *
+ * This file provides InPlaceVisitor and InPlaceOutputVisitor, which find the
+ * activation layers that can run in place on the output of the layer before
+ * them.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_IN_PLACE_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_IN_PLACE_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/layer/convolution.hpp>
+#include <mlpack/methods/ann/layer/linear.hpp>
+#include <mlpack/methods/ann/layer/linear_no_bias.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * InPlaceVisitor returns whether the forward pass of a layer gives the right
+ * result when its input and output are the same memory.  That holds for the
+ * elementwise activation layers, whose backward pass only uses their output,
+ * and which have no gradient.
+ */
+class InPlaceVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Any other layer can't run in place.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  //! The logistic, tanh and rectifier layers can run in place.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(BaseLayer<LogisticFunction,
+                            InputDataType,
+                            OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(BaseLayer<TanhFunction,
+                            InputDataType,
+                            OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(BaseLayer<RectifierFunction,
+                            InputDataType,
+                            OutputDataType>* layer) const;
+
+  //! The ELU layer can run in place.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(ELU<InputDataType, OutputDataType>* layer) const;
+
+  //! The HardTanH layer can run in place.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(HardTanH<InputDataType, OutputDataType>* layer) const;
+
+  //! The LeakyReLU layer can run in place.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(LeakyReLU<InputDataType, OutputDataType>* layer) const;
+};
+
+/**
+ * InPlaceOutputVisitor returns whether the output of a layer may be overwritten
+ * by the layer after it, once the forward pass of the layer is done.  That
+ * holds for the Linear, LinearNoBias and Convolution layers, whose backward
+ * pass and gradient don't use their output.
+ */
+class InPlaceOutputVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! The output of any other layer must be kept.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  //! The output of the Linear layer may be overwritten.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(Linear<InputDataType, OutputDataType>* layer) const;
+
+  //! The output of the LinearNoBias layer may be overwritten.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(LinearNoBias<InputDataType, OutputDataType>* layer) const;
+
+  //! The output of the Convolution layer may be overwritten.
+  template<
+      typename ForwardConvolutionRule,
+      typename BackwardConvolutionRule,
+      typename GradientConvolutionRule,
+      typename InputDataType,
+      typename OutputDataType
+  >
+  bool operator()(Convolution<ForwardConvolutionRule,
+                              BackwardConvolutionRule,
+                              GradientConvolutionRule,
+                              InputDataType,
+                              OutputDataType>* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "in_place_visitor_impl.hpp"
+
+#endif
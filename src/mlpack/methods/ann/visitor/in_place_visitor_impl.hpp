@@ -0,0 +1,113 @@
+/**
+ * @file in_place_visitor_impl.hpp
+ * @author agent
+ *
+ * Implementation of the InPlaceVisitor and InPlaceOutputVisitor classes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_IN_PLACE_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_IN_PLACE_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "in_place_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! InPlaceVisitor visitor class.
+template<typename LayerType>
+inline bool InPlaceVisitor::operator()(LayerType* /* layer */) const
+{
+  return false;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool InPlaceVisitor::operator()(
+    BaseLayer<LogisticFunction, InputDataType, OutputDataType>* /* layer */)
+    const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool InPlaceVisitor::operator()(
+    BaseLayer<TanhFunction, InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool InPlaceVisitor::operator()(
+    BaseLayer<RectifierFunction, InputDataType, OutputDataType>* /* layer */)
+    const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool InPlaceVisitor::operator()(
+    ELU<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool InPlaceVisitor::operator()(
+    HardTanH<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool InPlaceVisitor::operator()(
+    LeakyReLU<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+//! InPlaceOutputVisitor visitor class.
+template<typename LayerType>
+inline bool InPlaceOutputVisitor::operator()(LayerType* /* layer */) const
+{
+  return false;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool InPlaceOutputVisitor::operator()(
+    Linear<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool InPlaceOutputVisitor::operator()(
+    LinearNoBias<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+inline bool InPlaceOutputVisitor::operator()(
+    Convolution<ForwardConvolutionRule,
+                BackwardConvolutionRule,
+                GradientConvolutionRule,
+                InputDataType,
+                OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
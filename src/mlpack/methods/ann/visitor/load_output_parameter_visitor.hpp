@@ -16,6 +16,7 @@
 
 #include <mlpack/methods/ann/layer/layer_traits.hpp>
 #include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/buffer_stack.hpp>
 
 #include <boost/variant.hpp>
 
@@ -30,7 +31,7 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
 {
  public:
   //! Restore the output parameter given a parameter set.
-  LoadOutputParameterVisitor(std::vector<arma::mat>&& parameter);
+  LoadOutputParameterVisitor(BufferStack<arma::mat>&& parameter);
 
   //! Restore the output parameter.
   template<typename LayerType>
@@ -38,7 +39,7 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
 
  private:
   //! The parameter set.
-  std::vector<arma::mat>&& parameter;
+  BufferStack<arma::mat>&& parameter;
 
   //! Restore the output parameter for a module which doesn't implement the
   //! Model() function.
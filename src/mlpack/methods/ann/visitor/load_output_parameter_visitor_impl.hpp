@@ -20,7 +20,7 @@ namespace ann {
 
 //! LoadOutputParameterVisitor visitor class.
 inline LoadOutputParameterVisitor::LoadOutputParameterVisitor(
-    std::vector<arma::mat>&& parameter) : parameter(std::move(parameter))
+    BufferStack<arma::mat>&& parameter) : parameter(std::move(parameter))
 {
   /* Nothing to do here. */
 }
@@ -36,8 +36,8 @@ inline typename std::enable_if<
     !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
 LoadOutputParameterVisitor::OutputParameter(T* layer) const
 {
-  layer->OutputParameter() = parameter.back();
-  parameter.pop_back();
+  layer->OutputParameter() = parameter.Top();
+  parameter.Pop();
 }
 
 template<typename T>
@@ -51,8 +51,8 @@ LoadOutputParameterVisitor::OutputParameter(T* layer) const
         layer->Model()[layer->Model().size() - i - 1]);
   }
 
-  layer->OutputParameter() = parameter.back();
-  parameter.pop_back();
+  layer->OutputParameter() = parameter.Top();
+  parameter.Pop();
 }
 
 } // namespace ann
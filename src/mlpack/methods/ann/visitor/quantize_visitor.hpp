@@ -0,0 +1,87 @@
+/**
+ * @file quantize_visitor.hpp
+ * @author agent
+ *
+ * This file provides an abstraction for the quantization of a trained layer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/layer/convolution.hpp>
+#include <mlpack/methods/ann/layer/linear.hpp>
+#include <mlpack/methods/ann/layer/linear_no_bias.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * QuantizeVisitor returns the quantized version of a trained Linear,
+ * LinearNoBias, Convolution or Lookup layer, as a new layer; any other layer
+ * is returned as it is.  The given layer isn't modified.
+ */
+class QuantizeVisitor : public boost::static_visitor<LayerTypes>
+{
+ public:
+  /**
+   * Create the visitor.
+   *
+   * @param inputRange The largest absolute value of the input of the layer,
+   *     which is mapped to the largest int8 value.
+   * @param type Format to quantize the weights to.
+   */
+  QuantizeVisitor(const double inputRange, const QuantizationType type);
+
+  //! Return the given layer, which can't be quantized.
+  template<typename LayerType>
+  LayerTypes operator()(LayerType* layer) const;
+
+  //! Quantize the given Linear layer.
+  template<typename InputDataType, typename OutputDataType>
+  LayerTypes operator()(Linear<InputDataType, OutputDataType>* layer) const;
+
+  //! Quantize the given LinearNoBias layer.
+  template<typename InputDataType, typename OutputDataType>
+  LayerTypes operator()(
+      LinearNoBias<InputDataType, OutputDataType>* layer) const;
+
+  //! Quantize the given Lookup layer.
+  template<typename InputDataType, typename OutputDataType>
+  LayerTypes operator()(Lookup<InputDataType, OutputDataType>* layer) const;
+
+  //! Quantize the given Convolution layer.
+  template<
+      typename ForwardConvolutionRule,
+      typename BackwardConvolutionRule,
+      typename GradientConvolutionRule,
+      typename InputDataType,
+      typename OutputDataType
+  >
+  LayerTypes operator()(Convolution<ForwardConvolutionRule,
+                                    BackwardConvolutionRule,
+                                    GradientConvolutionRule,
+                                    InputDataType,
+                                    OutputDataType>* layer) const;
+
+ private:
+  //! The scale of the int8 quantization of the input.
+  double inputScale;
+
+  //! The format to quantize to.
+  QuantizationType type;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantize_visitor_impl.hpp"
+
+#endif
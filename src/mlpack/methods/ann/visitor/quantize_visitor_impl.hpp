@@ -0,0 +1,104 @@
+/**
+ * @file quantize_visitor_impl.hpp
+ * @author agent
+ *
+ * Implementation of the QuantizeVisitor class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_QUANTIZE_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantize_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! QuantizeVisitor visitor class.
+inline QuantizeVisitor::QuantizeVisitor(const double inputRange,
+                                        const QuantizationType type) :
+    inputScale((inputRange > 0.0) ? (inputRange / 127.0) : 1.0),
+    type(type)
+{
+  /* Nothing to do here. */
+}
+
+template<typename LayerType>
+inline LayerTypes QuantizeVisitor::operator()(LayerType* layer) const
+{
+  return layer;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline LayerTypes QuantizeVisitor::operator()(
+    Linear<InputDataType, OutputDataType>* layer) const
+{
+  // The weights are followed by the bias in the parameters of the layer.
+  arma::mat& parameters = layer->Parameters();
+  const size_t weights = layer->OutputSize() * layer->InputSize();
+
+  return new QuantizedLinear<InputDataType, OutputDataType>(
+      arma::mat(parameters.memptr(), layer->OutputSize(), layer->InputSize(),
+      false, true), arma::vec(parameters.memptr() + weights,
+      layer->OutputSize(), false, true), inputScale, type);
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline LayerTypes QuantizeVisitor::operator()(
+    LinearNoBias<InputDataType, OutputDataType>* layer) const
+{
+  arma::mat& parameters = layer->Parameters();
+
+  return new QuantizedLinear<InputDataType, OutputDataType>(
+      arma::mat(parameters.memptr(), layer->OutputSize(), layer->InputSize(),
+      false, true), arma::vec(), inputScale, type);
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline LayerTypes QuantizeVisitor::operator()(
+    Lookup<InputDataType, OutputDataType>* layer) const
+{
+  // The input holds indices, so only the embeddings are quantized.
+  return new QuantizedLookup<InputDataType, OutputDataType>(
+      layer->Parameters(), type);
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+inline LayerTypes QuantizeVisitor::operator()(
+    Convolution<ForwardConvolutionRule,
+                BackwardConvolutionRule,
+                GradientConvolutionRule,
+                InputDataType,
+                OutputDataType>* layer) const
+{
+  // The filters of output map i are the slices (i * inSize) to
+  // ((i + 1) * inSize - 1) of the weights, so each column of this alias holds
+  // all the filters of one output map; the bias follows the filters.
+  arma::mat& parameters = layer->Parameters();
+  const size_t filterSize = layer->KernelWidth() * layer->KernelHeight() *
+      layer->InputSize();
+
+  return new QuantizedConvolution<InputDataType, OutputDataType>(
+      layer->InputSize(), layer->OutputSize(), layer->KernelWidth(),
+      layer->KernelHeight(), layer->StrideWidth(), layer->StrideHeight(),
+      layer->PadWidth(), layer->PadHeight(), layer->InputWidth(),
+      layer->InputHeight(), arma::mat(parameters.memptr(), filterSize,
+      layer->OutputSize(), false, true), arma::vec(parameters.memptr() +
+      filterSize * layer->OutputSize(), layer->OutputSize(), false, true),
+      inputScale, type);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,7 @@
 
 #include <mlpack/methods/ann/layer/layer_traits.hpp>
 #include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/buffer_stack.hpp>
 
 #include <boost/variant.hpp>
 
@@ -29,7 +30,7 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
 {
  public:
   //! Save the output parameter into the given parameter set.
-  SaveOutputParameterVisitor(std::vector<arma::mat>&& parameter);
+  SaveOutputParameterVisitor(BufferStack<arma::mat>&& parameter);
 
   //! Save the output parameter.
   template<typename LayerType>
@@ -37,7 +38,7 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
 
  private:
   //! The parameter set.
-  std::vector<arma::mat>&& parameter;
+  BufferStack<arma::mat>&& parameter;
 
   //! Save the output parameter for a module which doesn't implement the
   //! Model() function.
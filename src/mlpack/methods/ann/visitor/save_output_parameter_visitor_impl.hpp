@@ -20,7 +20,7 @@ namespace ann {
 
 //! SaveOutputParameterVisitor visitor class.
 inline SaveOutputParameterVisitor::SaveOutputParameterVisitor(
-    std::vector<arma::mat>&& parameter) : parameter(std::move(parameter))
+    BufferStack<arma::mat>&& parameter) : parameter(std::move(parameter))
 {
   /* Nothing to do here. */
 }
@@ -36,7 +36,7 @@ inline typename std::enable_if<
     !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
 SaveOutputParameterVisitor::OutputParameter(T* layer) const
 {
-  parameter.push_back(layer->OutputParameter());
+  parameter.Push(layer->OutputParameter());
 }
 
 template<typename T>
@@ -44,7 +44,7 @@ inline typename std::enable_if<
     HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
 SaveOutputParameterVisitor::OutputParameter(T* layer) const
 {
-  parameter.push_back(layer->OutputParameter());
+  parameter.Push(layer->OutputParameter());
 
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
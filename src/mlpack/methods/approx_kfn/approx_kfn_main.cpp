@@ -97,6 +97,12 @@ PARAM_INT_IN("num_projections", "Number of projections to use in each hash "
     "table.", "p", 5);
 PARAM_STRING_IN("algorithm", "Algorithm to use: 'ds' or 'qdafn'.", "a", "ds");
 
+PARAM_INT_IN("threads", "Number of threads to use for search (0 uses all "
+    "available threads; only has an effect if mlpack was built with OpenMP).",
+    "T", 0);
+PARAM_INT_IN("batch_size", "Number of query points to process at once during "
+    "search.", "b", 256);
+
 PARAM_UMATRIX_OUT("neighbors", "Matrix to save neighbor indices to.", "n");
 PARAM_MATRIX_OUT("distances", "Matrix to save furthest neighbor distances to.",
     "d");
@@ -174,6 +180,14 @@ void mlpackMain()
         << CLI::GetParam<int>("num_projections") << "); must be greater than 0!"
         << endl;
 
+  if (CLI::GetParam<int>("threads") < 0)
+    Log::Fatal << "Invalid --threads value (" << CLI::GetParam<int>("threads")
+        << "); must be 0 or greater!" << endl;
+  if (CLI::GetParam<int>("batch_size") <= 0)
+    Log::Fatal << "Invalid --batch_size value ("
+        << CLI::GetParam<int>("batch_size") << "); must be greater than 0!"
+        << endl;
+
   if (CLI::HasParam("calculate_error") && !CLI::HasParam("k"))
     Log::Warn << "--calculate_error ignored because --k is not specified."
         << endl;
@@ -227,6 +241,8 @@ void mlpackMain()
   {
     arma::mat querySet; // This may or may not be used.
     const size_t k = (size_t) CLI::GetParam<int>("k");
+    const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
+    const size_t threads = (size_t) CLI::GetParam<int>("threads");
 
     arma::Mat<size_t> neighbors;
     arma::mat distances;
@@ -240,7 +256,8 @@ void mlpackMain()
       Timer::Start("drusilla_select_search");
       Log::Info << "Searching for " << k << " furthest neighbors with "
           << "DrusillaSelect..." << endl;
-      m.ds.Search(set, k, neighbors, distances);
+      m.ds.NumThreads() = threads;
+      m.ds.Search(set, k, neighbors, distances, batchSize);
       Timer::Stop("drusilla_select_search");
     }
     else
@@ -248,7 +265,8 @@ void mlpackMain()
       Timer::Start("qdafn_search");
       Log::Info << "Searching for " << k << " furthest neighbors with "
           << "QDAFN..." << endl;
-      m.qdafn.Search(set, k, neighbors, distances);
+      m.qdafn.NumThreads() = threads;
+      m.qdafn.Search(set, k, neighbors, distances, batchSize);
       Timer::Stop("qdafn_search");
     }
     Log::Info << "Search complete." << endl;
@@ -83,15 +83,22 @@ class DrusillaSelect
    * the k'th row in that column will refer to the k'th candidate neighbor or
    * distance for that query point.
    *
+   * Query points are processed in batches of batchSize points; the distances
+   * between a batch and the candidate set are computed at once, and batches
+   * are searched in parallel with NumThreads() threads when OpenMP is
+   * available.
+   *
    * @param querySet Set of query points to search.
    * @param k Number of furthest neighbors to search for.
    * @param neighbors Matrix to store resulting neighbors in.
    * @param distances Matrix to store resulting distances in.
+   * @param batchSize Number of query points to process at once.
    */
   void Search(const MatType& querySet,
               const size_t k,
               arma::Mat<size_t>& neighbors,
-              arma::mat& distances);
+              arma::mat& distances,
+              const size_t batchSize = 256);
 
   /**
    * Serialize the model.
@@ -109,6 +116,13 @@ class DrusillaSelect
   //! Modify the indices of points in the candidate set.  Be careful!
   arma::Col<size_t>& CandidateIndices() { return candidateIndices; }
 
+  //! Get the number of threads used for search (0 means one for each
+  //! available OpenMP thread).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for search (0 means one for each
+  //! available OpenMP thread).
+  size_t& NumThreads() { return numThreads; }
+
  private:
   //! The reference set.
   MatType candidateSet;
@@ -119,6 +133,13 @@ class DrusillaSelect
   size_t l;
   //! The number of points in each projection.
   size_t m;
+
+  //! The number of threads used for search; 0 means all available threads.
+  //! This is not serialized.
+  size_t numThreads;
+
+  //! Get the number of threads to search with.
+  size_t SearchThreads() const;
 };
 
 } // namespace neighbor
@@ -16,9 +16,6 @@
 #include "drusilla_select.hpp"
 
 #include <queue>
-#include <mlpack/methods/neighbor_search/neighbor_search_rules.hpp>
-#include <mlpack/methods/neighbor_search/sort_policies/furthest_neighbor_sort.hpp>
-#include <mlpack/core/tree/binary_space_tree.hpp>
 #include <algorithm>
 
 namespace mlpack {
@@ -32,7 +29,8 @@ DrusillaSelect<MatType>::DrusillaSelect(const MatType& referenceSet,
     candidateSet(referenceSet.n_cols, l * m),
     candidateIndices(l * m),
     l(l),
-    m(m)
+    m(m),
+    numThreads(0)
 {
   if (l == 0)
     throw std::invalid_argument("DrusillaSelect::DrusillaSelect(): invalid "
@@ -50,7 +48,8 @@ DrusillaSelect<MatType>::DrusillaSelect(const size_t l, const size_t m) :
     candidateSet(0, l * m),
     candidateIndices(l * m),
     l(l),
-    m(m)
+    m(m),
+    numThreads(0)
 {
   if (l == 0)
     throw std::invalid_argument("DrusillaSelect::DrusillaSelect(): invalid "
@@ -169,7 +168,8 @@ template<typename MatType>
 void DrusillaSelect<MatType>::Search(const MatType& querySet,
                                      const size_t k,
                                      arma::Mat<size_t>& neighbors,
-                                     arma::mat& distances)
+                                     arma::mat& distances,
+                                     const size_t batchSize)
 {
   if (candidateSet.n_cols == 0)
     throw std::runtime_error("DrusillaSelect::Search(): candidate set not "
@@ -179,23 +179,83 @@ void DrusillaSelect<MatType>::Search(const MatType& querySet,
     throw std::invalid_argument("DrusillaSelect::Search(): requested k is "
         "greater than number of points in candidate set!  Increase l or m.");
 
-  // We'll use the NeighborSearchRules class to perform our brute-force search.
-  // Note that we aren't using trees for our search, so we can use 'int' as a
-  // TreeType.
-  metric::EuclideanDistance metric;
-  NeighborSearchRules<FurthestNeighborSort, metric::EuclideanDistance,
-      tree::KDTree<metric::EuclideanDistance, tree::EmptyStatistic, MatType>>
-      rules(candidateSet, querySet, k, metric, 0, false);
+  if (batchSize == 0)
+    throw std::invalid_argument("DrusillaSelect::Search(): batchSize must be "
+        "greater than 0!");
 
-  for (size_t q = 0; q < querySet.n_cols; ++q)
-    for (size_t r = 0; r < candidateSet.n_cols; ++r)
-      rules.BaseCase(q, r);
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
 
-  rules.GetResults(neighbors, distances);
+  // We compute the squared distances between every candidate and every point
+  // in a batch of query points at once, using
+  //   ||q - c||^2 = ||q||^2 + ||c||^2 - 2 c^T q,
+  // so that most of the work is a single matrix multiplication.
+  const arma::mat candidateNorms(arma::trans(arma::mat(
+      arma::sum(arma::square(candidateSet), 0))));
 
-  // Map the neighbors back to their original indices in the reference set.
-  for (size_t i = 0; i < neighbors.n_elem; ++i)
-    neighbors[i] = candidateIndices[neighbors[i]];
+  const size_t numBatches = (querySet.n_cols + batchSize - 1) / batchSize;
+
+  #pragma omp parallel num_threads(SearchThreads())
+  {
+    arma::mat batchDistances;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numBatches; ++b)
+    {
+      const size_t begin = b * batchSize;
+      const size_t end = std::min(begin + batchSize, (size_t) querySet.n_cols);
+
+      batchDistances = candidateSet.t() * querySet.cols(begin, end - 1);
+      batchDistances *= -2.0;
+      batchDistances.each_col() += candidateNorms.col(0);
+      batchDistances.each_row() += arma::mat(arma::sum(arma::square(
+          querySet.cols(begin, end - 1)), 0)).row(0);
+
+      for (size_t q = begin; q < end; ++q)
+      {
+        // Find the k furthest candidates.  The top of the queue is the closest
+        // of the current results.
+        typedef std::pair<double, size_t> Candidate;
+        std::vector<Candidate> clist(k, std::make_pair(-DBL_MAX, size_t(-1)));
+        std::priority_queue<Candidate, std::vector<Candidate>,
+            std::greater<Candidate>> pq(std::greater<Candidate>(),
+            std::move(clist));
+
+        for (size_t r = 0; r < candidateSet.n_cols; ++r)
+        {
+          const double dist = batchDistances(r, q - begin);
+          if (dist > pq.top().first)
+          {
+            pq.pop();
+            pq.push(std::make_pair(dist, r));
+          }
+        }
+
+        // Roundoff can make the squared distance slightly negative.  Also,
+        // map the neighbors back to their original indices in the reference
+        // set.
+        for (size_t j = 1; j <= k; ++j)
+        {
+          neighbors(k - j, q) = candidateIndices[pq.top().second];
+          distances(k - j, q) = std::sqrt(std::max(pq.top().first, 0.0));
+          pq.pop();
+        }
+      }
+    }
+  }
+}
+
+// Get the number of threads to search with.
+template<typename MatType>
+size_t DrusillaSelect<MatType>::SearchThreads() const
+{
+  size_t threads = numThreads;
+  #ifdef HAS_OPENMP
+    if (threads == 0)
+      threads = omp_get_max_threads();
+  #endif
+
+  return std::max(threads, (size_t) 1);
 }
 
 //! Serialize the model.
@@ -73,11 +73,22 @@ class QDAFN
    * can contain just one point, that is okay.)  The results will be stored in
    * the given neighbors and distances matrices, in the same format as the
    * mlpack NeighborSearch and LSHSearch classes.
+   *
+   * Query points are processed in batches of batchSize points; each batch is
+   * projected at once, and batches are searched in parallel with NumThreads()
+   * threads when OpenMP is available.
+   *
+   * @param querySet Set of query points to search.
+   * @param k Number of furthest neighbors to search for.
+   * @param neighbors Matrix to store resulting neighbors in.
+   * @param distances Matrix to store resulting distances in.
+   * @param batchSize Number of query points to process at once.
    */
   void Search(const MatType& querySet,
               const size_t k,
               arma::Mat<size_t>& neighbors,
-              arma::mat& distances);
+              arma::mat& distances,
+              const size_t batchSize = 256);
 
   //! Serialize the model.
   template<typename Archive>
@@ -91,6 +102,13 @@ class QDAFN
   //! Modify the candidate set for the given projection table.  Careful!
   MatType& CandidateSet(const size_t t) { return candidateSet[t]; }
 
+  //! Get the number of threads used for search (0 means one for each
+  //! available OpenMP thread).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for search (0 means one for each
+  //! available OpenMP thread).
+  size_t& NumThreads() { return numThreads; }
+
  private:
   //! The number of projections.
   size_t l;
@@ -108,6 +126,45 @@ class QDAFN
 
   // Candidate sets; one element in the vector for each table.
   std::vector<MatType> candidateSet;
+
+  //! The number of threads used for search; 0 means all available threads.
+  //! This is not serialized.
+  size_t numThreads;
+
+  //! Get the number of threads to search with.
+  size_t SearchThreads() const;
+
+  /**
+   * Compute the distance between the given query point and each of the given
+   * candidates, where candidate i is column locations[i] of the candidate set
+   * of table tables[i].
+   *
+   * @param querySet Set of query points.
+   * @param queryIndex Index of query point.
+   * @param tables Table of each candidate.
+   * @param locations Location of each candidate in its table.
+   * @param buffer Scratch space (may be used by an overload).
+   * @param candidateDistances Vector to store distances in.
+   */
+  template<typename QueryMatType>
+  void CandidateDistances(const QueryMatType& querySet,
+                          const size_t queryIndex,
+                          const arma::Col<size_t>& tables,
+                          const arma::Col<size_t>& locations,
+                          arma::mat& buffer,
+                          arma::rowvec& candidateDistances) const;
+
+  /**
+   * Compute the distance between the given query point and each of the given
+   * candidates, for dense data.  The candidates are gathered into the buffer,
+   * so that the distances can be computed with vectorized operations.
+   */
+  void CandidateDistances(const arma::mat& querySet,
+                          const size_t queryIndex,
+                          const arma::Col<size_t>& tables,
+                          const arma::Col<size_t>& locations,
+                          arma::mat& buffer,
+                          arma::rowvec& candidateDistances) const;
 };
 
 } // namespace neighbor
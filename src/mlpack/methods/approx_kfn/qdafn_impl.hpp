@@ -23,7 +23,10 @@ namespace neighbor {
 
 // Non-training constructor.
 template<typename MatType>
-QDAFN<MatType>::QDAFN(const size_t l, const size_t m) : l(l), m(m)
+QDAFN<MatType>::QDAFN(const size_t l, const size_t m) :
+    l(l),
+    m(m),
+    numThreads(0)
 {
   if (l == 0)
     throw std::invalid_argument("QDAFN::QDAFN(): l must be greater than 0!");
@@ -37,7 +40,8 @@ QDAFN<MatType>::QDAFN(const MatType& referenceSet,
                       const size_t l,
                       const size_t m) :
     l(l),
-    m(m)
+    m(m),
+    numThreads(0)
 {
   if (l == 0)
     throw std::invalid_argument("QDAFN::QDAFN(): l must be greater than 0!");
@@ -94,81 +98,175 @@ template<typename MatType>
 void QDAFN<MatType>::Search(const MatType& querySet,
                             const size_t k,
                             arma::Mat<size_t>& neighbors,
-                            arma::mat& distances)
+                            arma::mat& distances,
+                            const size_t batchSize)
 {
   if (k > m)
     throw std::invalid_argument("QDAFN::Search(): requested k is greater than "
         "value of m!");
+  if (batchSize == 0)
+    throw std::invalid_argument("QDAFN::Search(): batchSize must be greater "
+        "than 0!");
 
   neighbors.set_size(k, querySet.n_cols);
   neighbors.fill(size_t() - 1);
   distances.zeros(k, querySet.n_cols);
 
-  // Search for each point.
-  for (size_t q = 0; q < querySet.n_cols; ++q)
+  const size_t numBatches = (querySet.n_cols + batchSize - 1) / batchSize;
+
+  // Search for each batch of points in parallel.
+  #pragma omp parallel num_threads(SearchThreads())
   {
-    // Initialize a priority queue.
-    // The size_t represents the index of the table, and the double represents
-    // the value of l_i * S_i - l_i * query (see line 6 of Algorithm 1).
-    std::priority_queue<std::pair<double, size_t>> queue;
-    for (size_t i = 0; i < l; ++i)
+    // Each thread reuses these buffers for all of its batches.
+    arma::mat queryProjections;
+    arma::Col<size_t> tableLocations(l);
+    arma::Col<size_t> visitedTables(m);
+    arma::Col<size_t> visitedLocations(m);
+    arma::mat visitedBuffer;
+    arma::rowvec visitedDistances(m);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numBatches; ++b)
     {
-      const double val = sValues(0, i) - arma::dot(querySet.col(q),
-          lines.col(i));
-      queue.push(std::make_pair(val, i));
-    }
+      const size_t begin = b * batchSize;
+      const size_t end = std::min(begin + batchSize, (size_t) querySet.n_cols);
 
-    // To track where we are in each S table, we keep the next index to look at
-    // in each table (they start at 0).
-    arma::Col<size_t> tableLocations = arma::zeros<arma::Col<size_t>>(l);
+      // Project the whole batch onto the lines at once.
+      queryProjections = lines.t() * querySet.cols(begin, end - 1);
 
-    // Now that the queue is initialized, iterate over m elements.
-    std::vector<std::pair<double, size_t>> v(k, std::make_pair(-1.0,
-        size_t(-1)));
-    std::priority_queue<std::pair<double, size_t>>
-        resultsQueue(std::less<std::pair<double, size_t>>(), std::move(v));
-    for (size_t i = 0; i < m; ++i)
-    {
-      std::pair<size_t, double> p = queue.top();
-      queue.pop();
+      for (size_t q = begin; q < end; ++q)
+      {
+        // Initialize a priority queue.
+        // The size_t represents the index of the table, and the double
+        // represents the value of l_i * S_i - l_i * query (see line 6 of
+        // Algorithm 1).
+        std::priority_queue<std::pair<double, size_t>> queue;
+        for (size_t i = 0; i < l; ++i)
+        {
+          const double val = sValues(0, i) - queryProjections(i, q - begin);
+          queue.push(std::make_pair(val, i));
+        }
 
-      // Get index of reference point to look at.
-      const size_t tableIndex = tableLocations[p.second];
+        // To track where we are in each S table, we keep the next index to
+        // look at in each table (they start at 0).
+        tableLocations.zeros();
 
-      // Calculate distance from query point.
-      const double dist = mlpack::metric::EuclideanDistance::Evaluate(
-          querySet.col(q), candidateSet[p.second].col(tableIndex));
+        // Now that the queue is initialized, iterate over m elements.  The
+        // order in which candidates are visited does not depend on their
+        // distances, so we collect all of them first and compute the distances
+        // afterwards.
+        for (size_t i = 0; i < m; ++i)
+        {
+          const std::pair<double, size_t> p = queue.top();
+          queue.pop();
 
-      // Is this neighbor good enough to insert into the results?
-      if (dist > resultsQueue.top().first)
-      {
-        resultsQueue.pop();
-        resultsQueue.push(std::make_pair(dist, sIndices(tableIndex, p.second)));
-      }
+          // Get index of reference point to look at.
+          const size_t tableIndex = tableLocations[p.second];
+          visitedTables[i] = p.second;
+          visitedLocations[i] = tableIndex;
 
-      // Now (line 14) get the next element and insert into the queue.  Do this
-      // by adjusting the previous value.  Don't insert anything if we are at
-      // the end of the search, though.
-      if (i < m - 1)
-      {
-        tableLocations[p.second]++;
-        const double val = p.first - sValues(tableIndex, p.second) +
-            sValues(tableIndex + 1, p.second);
+          // Now (line 14) get the next element and insert into the queue.  Do
+          // this by adjusting the previous value.  Don't insert anything if we
+          // are at the end of the search, though.
+          if (i < m - 1)
+          {
+            tableLocations[p.second]++;
+            const double val = p.first - sValues(tableIndex, p.second) +
+                sValues(tableIndex + 1, p.second);
+
+            queue.push(std::make_pair(val, p.second));
+          }
+        }
+
+        CandidateDistances(querySet, q, visitedTables, visitedLocations,
+            visitedBuffer, visitedDistances);
+
+        // Find the k furthest of the visited candidates.
+        std::vector<std::pair<double, size_t>> v(k, std::make_pair(-1.0,
+            size_t(-1)));
+        std::priority_queue<std::pair<double, size_t>,
+            std::vector<std::pair<double, size_t>>,
+            std::greater<std::pair<double, size_t>>>
+            resultsQueue(std::greater<std::pair<double, size_t>>(),
+            std::move(v));
+        for (size_t i = 0; i < m; ++i)
+        {
+          // Is this neighbor good enough to insert into the results?
+          if (visitedDistances[i] > resultsQueue.top().first)
+          {
+            resultsQueue.pop();
+            resultsQueue.push(std::make_pair(visitedDistances[i],
+                sIndices(visitedLocations[i], visitedTables[i])));
+          }
+        }
 
-        queue.push(std::make_pair(val, p.second));
+        // Extract the results.
+        for (size_t j = 1; j <= k; ++j)
+        {
+          neighbors(k - j, q) = resultsQueue.top().second;
+          distances(k - j, q) = resultsQueue.top().first;
+          resultsQueue.pop();
+        }
       }
     }
+  }
+}
 
-    // Extract the results.
-    for (size_t j = 1; j <= k; ++j)
-    {
-      neighbors(k - j, q) = resultsQueue.top().second;
-      distances(k - j, q) = resultsQueue.top().first;
-      resultsQueue.pop();
-    }
+// Compute the distances between a query point and a set of candidates.
+template<typename MatType>
+template<typename QueryMatType>
+void QDAFN<MatType>::CandidateDistances(
+    const QueryMatType& querySet,
+    const size_t queryIndex,
+    const arma::Col<size_t>& tables,
+    const arma::Col<size_t>& locations,
+    arma::mat& /* buffer */,
+    arma::rowvec& candidateDistances) const
+{
+  for (size_t i = 0; i < tables.n_elem; ++i)
+  {
+    candidateDistances[i] = metric::EuclideanDistance::Evaluate(
+        querySet.col(queryIndex), candidateSet[tables[i]].col(locations[i]));
   }
 }
 
+// Compute the distances between a query point and a set of candidates, for
+// dense data.
+template<typename MatType>
+void QDAFN<MatType>::CandidateDistances(
+    const arma::mat& querySet,
+    const size_t queryIndex,
+    const arma::Col<size_t>& tables,
+    const arma::Col<size_t>& locations,
+    arma::mat& buffer,
+    arma::rowvec& candidateDistances) const
+{
+  // Gather the candidates into contiguous memory; then the distances are
+  // computed with elementwise operations and a sum over each column, which
+  // vectorize well.  This is much faster than computing each distance
+  // separately.
+  buffer.set_size(querySet.n_rows, tables.n_elem);
+  for (size_t i = 0; i < tables.n_elem; ++i)
+    buffer.col(i) = candidateSet[tables[i]].col(locations[i]);
+
+  buffer.each_col() -= querySet.col(queryIndex);
+  buffer %= buffer;
+  candidateDistances = arma::sqrt(arma::sum(buffer));
+}
+
+// Get the number of threads to search with.
+template<typename MatType>
+size_t QDAFN<MatType>::SearchThreads() const
+{
+  size_t threads = numThreads;
+  #ifdef HAS_OPENMP
+    if (threads == 0)
+      threads = omp_get_max_threads();
+  #endif
+
+  return std::max(threads, (size_t) 1);
+}
+
 template<typename MatType>
 template<typename Archive>
 void QDAFN<MatType>::Serialize(Archive& ar, const unsigned int /* version */)
@@ -23,7 +23,7 @@ template<typename MetricType, typename TreeType>
 class DTBRules
 {
  public:
-  DTBRules(const arma::mat& dataSet,
+  DTBRules(const typename TreeType::Mat& dataSet,
            UnionFind& connections,
            arma::vec& neighborsDistances,
            arma::Col<size_t>& neighborsInComponent,
@@ -99,7 +99,7 @@ class DTBRules
 
  private:
   //! The data points.
-  const arma::mat& dataSet;
+  const typename TreeType::Mat& dataSet;
 
   //! Stores the tree structure so far
   UnionFind& connections;
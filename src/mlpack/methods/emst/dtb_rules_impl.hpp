@@ -17,7 +17,7 @@ namespace emst {
 
 template<typename MetricType, typename TreeType>
 DTBRules<MetricType, TreeType>::
-DTBRules(const arma::mat& dataSet,
+DTBRules(const typename TreeType::Mat& dataSet,
          UnionFind& connections,
          arma::vec& neighborsDistances,
          arma::Col<size_t>& neighborsInComponent,
@@ -88,8 +88,8 @@ double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
       (size_t) referenceNode.Stat().ComponentMembership())
     return DBL_MAX;
 
-  const arma::vec queryPoint = dataSet.unsafe_col(queryIndex);
-  const double distance = referenceNode.MinDistance(queryPoint);
+  const double distance = referenceNode.MinDistance(
+      dataSet.unsafe_col(queryIndex));
 
   // If all the points in the reference node are farther than the candidate
   // nearest neighbor for the query's component, we prune.
@@ -64,6 +64,9 @@ PARAM_FLAG("naive", "Compute the MST using O(n^2) naive algorithm.", "n");
 PARAM_INT_IN("leaf_size", "Leaf size in the kd-tree.  One-element leaves give "
     "the empirically best performance, but at the cost of greater memory "
     "requirements.", "l", 1);
+PARAM_FLAG("float", "If set, the tree is built and searched in single "
+    "precision, which uses half the memory; the lengths of the edges of the "
+    "spanning tree are then recomputed in double precision.", "f");
 
 using namespace mlpack;
 using namespace mlpack::emst;
@@ -78,16 +81,32 @@ void mlpackMain()
         << endl;
 
   arma::mat dataPoints = std::move(CLI::GetParam<arma::mat>("input"));
+  const bool useFloat = CLI::HasParam("float");
 
   // Do naive computation if necessary.
   if (CLI::GetParam<bool>("naive"))
   {
     Log::Info << "Running naive algorithm." << endl;
 
-    DualTreeBoruvka<> naive(dataPoints, true);
-
     arma::mat naiveResults;
-    naive.ComputeMST(naiveResults);
+    if (useFloat)
+    {
+      const arma::fmat floatPoints = arma::conv_to<arma::fmat>::from(
+          dataPoints);
+      DualTreeBoruvka<EuclideanDistance, arma::fmat> naive(floatPoints, true);
+      naive.ComputeMST(naiveResults);
+
+      // Recompute the lengths of the edges in double precision.
+      for (size_t i = 0; i < naiveResults.n_cols; ++i)
+        naiveResults(2, i) = EuclideanDistance::Evaluate(
+            dataPoints.col(size_t(naiveResults(0, i))),
+            dataPoints.col(size_t(naiveResults(1, i))));
+    }
+    else
+    {
+      DualTreeBoruvka<> naive(dataPoints, true);
+      naive.ComputeMST(naiveResults);
+    }
 
     if (CLI::HasParam("output"))
       CLI::GetParam<arma::mat>("output") = std::move(naiveResults);
@@ -107,19 +126,35 @@ void mlpackMain()
     // by hand.
     const size_t leafSize = (size_t) CLI::GetParam<int>("leaf_size");
 
-    Timer::Start("tree_building");
     std::vector<size_t> oldFromNew;
-    KDTree<EuclideanDistance, DTBStat, arma::mat> tree(dataPoints, oldFromNew,
-        leafSize);
     metric::LMetric<2, true> metric;
-    Timer::Stop("tree_building");
+    arma::mat results;
+    if (useFloat)
+    {
+      Timer::Start("tree_building");
+      KDTree<EuclideanDistance, DTBStat, arma::fmat> tree(
+          arma::conv_to<arma::fmat>::from(dataPoints), oldFromNew, leafSize);
+      Timer::Stop("tree_building");
 
-    DualTreeBoruvka<> dtb(&tree, metric);
+      DualTreeBoruvka<EuclideanDistance, arma::fmat> dtb(&tree, metric);
 
-    // Run the DTB algorithm.
-    Log::Info << "Calculating minimum spanning tree." << endl;
-    arma::mat results;
-    dtb.ComputeMST(results);
+      // Run the DTB algorithm.
+      Log::Info << "Calculating minimum spanning tree." << endl;
+      dtb.ComputeMST(results);
+    }
+    else
+    {
+      Timer::Start("tree_building");
+      KDTree<EuclideanDistance, DTBStat, arma::mat> tree(dataPoints, oldFromNew,
+          leafSize);
+      Timer::Stop("tree_building");
+
+      DualTreeBoruvka<> dtb(&tree, metric);
+
+      // Run the DTB algorithm.
+      Log::Info << "Calculating minimum spanning tree." << endl;
+      dtb.ComputeMST(results);
+    }
 
     // Unmap the results.
     arma::mat unmappedResults(results.n_rows, results.n_cols);
@@ -139,7 +174,13 @@ void mlpackMain()
         unmappedResults(1, i) = indexA;
       }
 
-      unmappedResults(2, i) = results(2, i);
+      // In single precision, recompute the length of the edge in double
+      // precision.
+      if (useFloat)
+        unmappedResults(2, i) = EuclideanDistance::Evaluate(
+            dataPoints.col(indexA), dataPoints.col(indexB));
+      else
+        unmappedResults(2, i) = results(2, i);
     }
 
     if (CLI::HasParam("output"))
@@ -248,6 +248,13 @@ class FastMKS
   //! Modify whether or not brute-force (naive) search is used.
   bool& Naive() { return naive; }
 
+  //! Get the number of threads used for search (0 means one for each
+  //! available OpenMP thread).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for search (0 means one for each
+  //! available OpenMP thread).
+  size_t& NumThreads() { return numThreads; }
+
   //! Serialize the model.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
@@ -267,6 +274,8 @@ class FastMKS
   bool singleMode;
   //! If true, naive (brute-force) search is used.
   bool naive;
+  //! The number of threads used for search; 0 means all available threads.
+  size_t numThreads;
 
   //! The instantiated inner-product metric induced by the given kernel.
   metric::IPMetric<KernelType> metric;
@@ -285,6 +294,41 @@ class FastMKS
   //! Use a priority queue to represent the list of candidate points.
   typedef std::priority_queue<Candidate, std::vector<Candidate>,
       CandidateCmp> CandidateList;
+
+  /**
+   * Brute-force search: compute the kernel between each query point and each
+   * reference point.  Blocks of query points are compared with blocks of
+   * reference points at once (see BlockKernel()), and blocks of query points
+   * are handled in parallel.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of max-kernel candidates to search for.
+   * @param indices Matrix to store resulting indices of max-kernel search in.
+   * @param kernels Matrix to store resulting max-kernel values in.
+   * @param sameSet If true, the query set is the reference set, and a point
+   *      will not be returned as its own candidate.
+   */
+  void NaiveSearch(const MatType& querySet,
+                   const size_t k,
+                   arma::Mat<size_t>& indices,
+                   arma::mat& kernels,
+                   const bool sameSet);
+
+  /**
+   * Split the query tree into disjoint subtrees that together hold every query
+   * point, so that the subtrees can be searched in parallel.  The bounds of the
+   * nodes above the subtrees are reset, since those nodes are not visited.
+   *
+   * @param queryTree Query tree to split.
+   * @param numThreads Number of threads the subtrees will be searched with.
+   * @param queryNodes Vector to store the roots of the subtrees in.
+   */
+  static void SplitQueryTree(Tree& queryTree,
+                             const size_t numThreads,
+                             std::vector<Tree*>& queryNodes);
+
+  //! Get the number of threads to search with.
+  size_t SearchThreads() const;
 };
 
 } // namespace fastmks
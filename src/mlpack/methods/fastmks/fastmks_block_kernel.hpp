@@ -0,0 +1,90 @@
+/**
+ * @file fastmks_block_kernel.hpp
+ * @author agent
+ *
+ * Evaluation of a kernel between every pair of points in two blocks of points.
+ * This is used by brute-force FastMKS; for kernels that are functions of the
+ * inner product (or of the squared distance), the whole block can be computed
+ * with a single matrix multiplication.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_FASTMKS_FASTMKS_BLOCK_KERNEL_HPP
+#define MLPACK_METHODS_FASTMKS_FASTMKS_BLOCK_KERNEL_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
+#include <mlpack/core/kernels/polynomial_kernel.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+
+namespace mlpack {
+namespace fastmks {
+
+/**
+ * Compute the kernel between each reference point and each query point, so
+ * that kernels(r, q) = K(querySet.col(q), referenceSet.col(r)).  This generic
+ * version simply calls Evaluate() for each pair of points.
+ *
+ * @param kernel Kernel to evaluate.
+ * @param querySet Block of query points.
+ * @param referenceSet Block of reference points.
+ * @param kernels Matrix to store kernel evaluations in.
+ */
+template<typename KernelType, typename MatType>
+void BlockKernel(KernelType& kernel,
+                 const MatType& querySet,
+                 const MatType& referenceSet,
+                 arma::mat& kernels)
+{
+  kernels.set_size(referenceSet.n_cols, querySet.n_cols);
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+    for (size_t r = 0; r < referenceSet.n_cols; ++r)
+      kernels(r, q) = kernel.Evaluate(querySet.col(q), referenceSet.col(r));
+}
+
+//! Compute the linear kernel for a block of points with one matrix product.
+inline void BlockKernel(kernel::LinearKernel& /* kernel */,
+                        const arma::mat& querySet,
+                        const arma::mat& referenceSet,
+                        arma::mat& kernels)
+{
+  kernels = referenceSet.t() * querySet;
+}
+
+//! Compute the polynomial kernel for a block of points with one matrix product.
+inline void BlockKernel(kernel::PolynomialKernel& kernel,
+                        const arma::mat& querySet,
+                        const arma::mat& referenceSet,
+                        arma::mat& kernels)
+{
+  kernels = referenceSet.t() * querySet;
+  kernels += kernel.Offset();
+  kernels = arma::pow(kernels, kernel.Degree());
+}
+
+/**
+ * Compute the Gaussian kernel for a block of points with one matrix product,
+ * using ||q - r||^2 = ||q||^2 + ||r||^2 - 2 <q, r>.
+ */
+inline void BlockKernel(kernel::GaussianKernel& kernel,
+                        const arma::mat& querySet,
+                        const arma::mat& referenceSet,
+                        arma::mat& kernels)
+{
+  kernels = -2.0 * (referenceSet.t() * querySet);
+  kernels.each_col() += arma::trans(arma::sum(arma::square(referenceSet)));
+  kernels.each_row() += arma::sum(arma::square(querySet));
+
+  // Roundoff can make the squared distance of (nearly) identical points
+  // slightly negative.
+  kernels.transform([](double d) { return (d < 0.0) ? 0.0 : d; });
+  kernels = arma::exp(kernel.Gamma() * kernels);
+}
+
+} // namespace fastmks
+} // namespace mlpack
+
+#endif
@@ -16,9 +16,14 @@
 #include "fastmks.hpp"
 
 #include "fastmks_rules.hpp"
+#include "fastmks_block_kernel.hpp"
 
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace fastmks {
 
@@ -35,7 +40,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const bool singleMode,
     treeOwner(true),
     setOwner(true),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    numThreads(0)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -58,7 +64,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(
     treeOwner(true),
     setOwner(false),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    numThreads(0)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -82,6 +89,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const MatType& referenceSet,
     setOwner(false),
     singleMode(singleMode),
     naive(naive),
+    numThreads(0),
     metric(kernel)
 {
   Timer::Start("tree_building");
@@ -107,6 +115,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(Tree* referenceTree,
     setOwner(false),
     singleMode(singleMode),
     naive(false),
+    numThreads(0),
     metric(referenceTree->Metric())
 {
   // Nothing to do.
@@ -124,6 +133,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const FastMKS& other) :
     setOwner(other.referenceTree == NULL),
     singleMode(other.singleMode),
     naive(other.naive),
+    numThreads(other.numThreads),
     metric(other.metric)
 {
   // Set reference set correctly.
@@ -145,6 +155,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(FastMKS&& other) :
     setOwner(other.setOwner),
     singleMode(other.singleMode),
     naive(other.naive),
+    numThreads(other.numThreads),
     metric(std::move(other.metric))
 {
   // Clear information from the other.
@@ -154,6 +165,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(FastMKS&& other) :
   other.setOwner = false;
   other.singleMode = false;
   other.naive = false;
+  other.numThreads = 0;
 }
 
 template<typename KernelType,
@@ -189,6 +201,7 @@ FastMKS<KernelType, MatType, TreeType>::operator=(const FastMKS& other)
 
   singleMode = other.singleMode;
   naive = other.naive;
+  numThreads = other.numThreads;
 }
 
 template<typename KernelType,
@@ -304,33 +317,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        const double eval = metric.Kernel().Evaluate(querySet.col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    NaiveSearch(querySet, k, indices, kernels, false);
 
     Timer::Stop("computing_products");
 
@@ -345,10 +332,28 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     typedef FastMKSRules<KernelType, Tree> RuleType;
     RuleType rules(*referenceSet, querySet, k, metric.Kernel());
 
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+    // Each thread gets its own rules object, which shares its results with
+    // 'rules'.  If the first point of each node is not its centroid, Score()
+    // caches kernel evaluations in the (shared) tree, so we cannot search in
+    // parallel.
+    size_t baseCases = 0;
+    size_t scores = 0;
+    #pragma omp parallel if (tree::TreeTraits<Tree>::FirstPointIsCentroid) \
+        num_threads(SearchThreads()) reduction(+: baseCases, scores)
+    {
+      RuleType threadRules(rules);
+      typename Tree::template SingleTreeTraverser<RuleType>
+          traverser(threadRules);
+
+      #pragma omp for schedule(dynamic, 16)
+      for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
 
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+      baseCases += threadRules.BaseCases();
+      scores += threadRules.Scores();
+    }
+    rules.BaseCases() += baseCases;
+    rules.Scores() += scores;
 
     Log::Info << rules.BaseCases() << " base cases." << std::endl;
     Log::Info << rules.Scores() << " scores." << std::endl;
@@ -403,9 +408,29 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   typedef FastMKSRules<KernelType, Tree> RuleType;
   RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel());
 
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+  // Split the query tree into disjoint subtrees, and let each thread traverse
+  // its subtrees against the whole reference tree.  The query statistics of
+  // different subtrees are disjoint, and the results are shared with 'rules'.
+  std::vector<Tree*> queryNodes;
+  const size_t threads = SearchThreads();
+  SplitQueryTree(*queryTree, threads, queryNodes);
 
-  traverser.Traverse(*queryTree, *referenceTree);
+  size_t baseCases = 0;
+  size_t scores = 0;
+  #pragma omp parallel num_threads(threads) reduction(+: baseCases, scores)
+  {
+    RuleType threadRules(rules);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(threadRules);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) queryNodes.size(); ++i)
+      traverser.Traverse(*queryNodes[i], *referenceTree);
+
+    baseCases += threadRules.BaseCases();
+    scores += threadRules.Scores();
+  }
+  rules.BaseCases() += baseCases;
+  rules.Scores() += scores;
 
   Log::Info << rules.BaseCases() << " base cases." << std::endl;
   Log::Info << rules.Scores() << " scores." << std::endl;
@@ -433,36 +458,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < referenceSet->n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        if (q == r)
-          continue; // Don't return the point as its own candidate.
-
-        const double eval = metric.Kernel().Evaluate(referenceSet->col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    NaiveSearch(*referenceSet, k, indices, kernels, true);
 
     Timer::Stop("computing_products");
 
@@ -477,13 +473,28 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     typedef FastMKSRules<KernelType, Tree> RuleType;
     RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel());
 
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    // Save the number of pruned nodes.
-    const size_t numPrunes = traverser.NumPrunes();
+    // Search in parallel, as in the query set case.
+    size_t baseCases = 0;
+    size_t scores = 0;
+    size_t numPrunes = 0;
+    #pragma omp parallel if (tree::TreeTraits<Tree>::FirstPointIsCentroid) \
+        num_threads(SearchThreads()) reduction(+: baseCases, scores, numPrunes)
+    {
+      RuleType threadRules(rules);
+      typename Tree::template SingleTreeTraverser<RuleType>
+          traverser(threadRules);
+
+      #pragma omp for schedule(dynamic, 16)
+      for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
+
+      baseCases += threadRules.BaseCases();
+      scores += threadRules.Scores();
+      // Save the number of pruned nodes.
+      numPrunes += traverser.NumPrunes();
+    }
+    rules.BaseCases() += baseCases;
+    rules.Scores() += scores;
 
     Log::Info << "Pruned " << numPrunes << " nodes." << std::endl;
 
@@ -502,6 +513,148 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   Search(referenceTree, k, indices, kernels);
 }
 
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::NaiveSearch(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels,
+    const bool sameSet)
+{
+  // The block sizes are chosen so that a block of kernel evaluations fits
+  // comfortably in cache.
+  const size_t queryBlockSize = 128;
+  const size_t referenceBlockSize = 512;
+  const size_t numQueryBlocks = (querySet.n_cols + queryBlockSize - 1) /
+      queryBlockSize;
+
+  #pragma omp parallel num_threads(SearchThreads())
+  {
+    arma::mat blockKernels;
+    std::vector<CandidateList> pqueues;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numQueryBlocks; ++b)
+    {
+      const size_t queryBegin = b * queryBlockSize;
+      const size_t queryEnd = std::min(queryBegin + queryBlockSize,
+          (size_t) querySet.n_cols);
+      const MatType queryBlock = querySet.cols(queryBegin, queryEnd - 1);
+
+      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+      pqueues.assign(queryBlock.n_cols,
+          CandidateList(CandidateCmp(), std::vector<Candidate>(k, def)));
+
+      for (size_t refBegin = 0; refBegin < referenceSet->n_cols;
+           refBegin += referenceBlockSize)
+      {
+        const size_t refEnd = std::min(refBegin + referenceBlockSize,
+            (size_t) referenceSet->n_cols);
+        const MatType referenceBlock = referenceSet->cols(refBegin, refEnd - 1);
+
+        // blockKernels(r, q) holds the kernel between query point q and
+        // reference point r of the blocks.
+        BlockKernel(metric.Kernel(), queryBlock, referenceBlock, blockKernels);
+
+        for (size_t q = 0; q < queryBlock.n_cols; ++q)
+        {
+          CandidateList& pqueue = pqueues[q];
+          for (size_t r = 0; r < referenceBlock.n_cols; ++r)
+          {
+            // Don't return the point as its own candidate.
+            if (sameSet && (queryBegin + q == refBegin + r))
+              continue;
+
+            const double eval = blockKernels(r, q);
+            if (eval > pqueue.top().first)
+            {
+              Candidate c = std::make_pair(eval, refBegin + r);
+              pqueue.pop();
+              pqueue.push(c);
+            }
+          }
+        }
+      }
+
+      for (size_t q = 0; q < queryBlock.n_cols; ++q)
+      {
+        CandidateList& pqueue = pqueues[q];
+        for (size_t j = 1; j <= k; j++)
+        {
+          indices(k - j, queryBegin + q) = pqueue.top().second;
+          kernels(k - j, queryBegin + q) = pqueue.top().first;
+          pqueue.pop();
+        }
+      }
+    }
+  }
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::SplitQueryTree(
+    Tree& queryTree,
+    const size_t numThreads,
+    std::vector<Tree*>& queryNodes)
+{
+  queryNodes.clear();
+  queryNodes.push_back(&queryTree);
+
+  // Aim for a few subtrees per thread, so that the work can be balanced.
+  const size_t targetNodes = (numThreads > 1) ? 4 * numThreads : 1;
+
+  // Expand the subtrees level by level.  A node can only be replaced by its
+  // children if all of its points are held by its children too.
+  bool expanded = true;
+  while (expanded && queryNodes.size() < targetNodes)
+  {
+    expanded = false;
+    std::vector<Tree*> nextNodes;
+    for (size_t i = 0; i < queryNodes.size(); ++i)
+    {
+      Tree& node = *queryNodes[i];
+      if (node.NumChildren() > 0 &&
+          (tree::TreeTraits<Tree>::HasSelfChildren || node.NumPoints() == 0))
+      {
+        // This node will not be visited, so its bound must not be used.
+        node.Stat().Bound() = -DBL_MAX;
+        for (size_t c = 0; c < node.NumChildren(); ++c)
+          nextNodes.push_back(&node.Child(c));
+        expanded = true;
+      }
+      else
+      {
+        nextNodes.push_back(&node);
+      }
+    }
+
+    queryNodes.swap(nextNodes);
+  }
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+size_t FastMKS<KernelType, MatType, TreeType>::SearchThreads() const
+{
+  size_t threads = numThreads;
+  #ifdef HAS_OPENMP
+    if (threads == 0)
+      threads = omp_get_max_threads();
+  #endif
+
+  return std::max(threads, (size_t) 1);
+}
+
 //! Serialize the model.
 template<typename KernelType,
          typename MatType,
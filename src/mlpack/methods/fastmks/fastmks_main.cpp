@@ -78,6 +78,9 @@ PARAM_INT_IN("k", "Number of maximum kernels to find.", "k", 0);
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single", "If true, single-tree search is used (as opposed to "
     "dual-tree search.", "S");
+PARAM_INT_IN("threads", "Number of threads to use for search (0 uses all "
+    "available threads; only has an effect if mlpack was built with OpenMP).",
+    "T", 0);
 
 PARAM_MATRIX_OUT("kernels", "Output matrix of kernels.", "p");
 PARAM_UMATRIX_OUT("indices", "Output matrix of indices.", "i");
@@ -124,6 +127,10 @@ void mlpackMain()
     Log::Warn << "--query_file ignored, because no search task is specified "
         << "(i.e., --k is not specified)!" << endl;
 
+  if (CLI::GetParam<int>("threads") < 0)
+    Log::Fatal << "Invalid number of threads (" << CLI::GetParam<int>("threads")
+        << "); must be 0 or greater!" << endl;
+
   // Check on kernel type.
   const string kernelType = CLI::GetParam<string>("kernel");
   if ((kernelType != "linear") && (kernelType != "polynomial") &&
@@ -215,6 +222,8 @@ void mlpackMain()
   // Set search preferences.
   model.Naive() = CLI::HasParam("naive");
   model.SingleMode() = CLI::HasParam("single");
+  if (CLI::HasParam("threads"))
+    model.NumThreads() = (size_t) CLI::GetParam<int>("threads");
 
   // Should we do search?
   if (CLI::HasParam("k"))
@@ -17,6 +17,7 @@ using namespace mlpack::kernel;
 
 FastMKSModel::FastMKSModel(const int kernelType) :
     kernelType(kernelType),
+    numThreads(0),
     linear(NULL),
     polynomial(NULL),
     cosine(NULL),
@@ -30,6 +31,7 @@ FastMKSModel::FastMKSModel(const int kernelType) :
 
 FastMKSModel::FastMKSModel(const FastMKSModel& other) :
     kernelType(other.kernelType),
+    numThreads(other.numThreads),
     linear(other.linear == NULL ? NULL :
         new FastMKS<LinearKernel>(*other.linear)),
     polynomial(other.polynomial == NULL ? NULL :
@@ -50,6 +52,7 @@ FastMKSModel::FastMKSModel(const FastMKSModel& other) :
 
 FastMKSModel::FastMKSModel(FastMKSModel&& other) :
     kernelType(other.kernelType),
+    numThreads(other.numThreads),
     linear(other.linear),
     polynomial(other.polynomial),
     cosine(other.cosine),
@@ -60,6 +63,7 @@ FastMKSModel::FastMKSModel(FastMKSModel&& other) :
 {
   // Clear other object.
   other.kernelType = KernelTypes::LINEAR_KERNEL;
+  other.numThreads = 0;
   other.linear = NULL;
   other.polynomial = NULL;
   other.cosine = NULL;
@@ -90,6 +94,7 @@ FastMKSModel& FastMKSModel::operator=(const FastMKSModel& other)
   hyptan = NULL;
 
   kernelType = other.kernelType;
+  numThreads = other.numThreads;
   if (other.linear)
     linear = new FastMKS<LinearKernel>(*other.linear);
   if (other.polynomial)
@@ -260,25 +265,25 @@ void FastMKSModel::Search(const size_t k,
   switch (kernelType)
   {
     case LINEAR_KERNEL:
-      linear->Search(k, indices, kernels);
+      Search(*linear, k, indices, kernels);
       break;
     case POLYNOMIAL_KERNEL:
-      polynomial->Search(k, indices, kernels);
+      Search(*polynomial, k, indices, kernels);
       break;
     case COSINE_DISTANCE:
-      cosine->Search(k, indices, kernels);
+      Search(*cosine, k, indices, kernels);
       break;
     case GAUSSIAN_KERNEL:
-      gaussian->Search(k, indices, kernels);
+      Search(*gaussian, k, indices, kernels);
       break;
     case EPANECHNIKOV_KERNEL:
-      epan->Search(k, indices, kernels);
+      Search(*epan, k, indices, kernels);
       break;
     case TRIANGULAR_KERNEL:
-      triangular->Search(k, indices, kernels);
+      Search(*triangular, k, indices, kernels);
       break;
     case HYPTAN_KERNEL:
-      hyptan->Search(k, indices, kernels);
+      Search(*hyptan, k, indices, kernels);
       break;
     default:
       throw std::invalid_argument("invalid model type");
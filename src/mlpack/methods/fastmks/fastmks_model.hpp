@@ -91,6 +91,13 @@ class FastMKSModel
   //! Modify the kernel type.
   int& KernelType() { return kernelType; }
 
+  //! Get the number of threads used for search (0 means one for each
+  //! available OpenMP thread).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for search (0 means one for each
+  //! available OpenMP thread).
+  size_t& NumThreads() { return numThreads; }
+
   /**
    * Search with a different query set.
    *
@@ -132,6 +139,10 @@ class FastMKSModel
   //! The type of kernel we are using.
   int kernelType;
 
+  //! The number of threads used for search; 0 means all available threads.
+  //! This is not serialized.
+  size_t numThreads;
+
   //! This will only be non-NULL if this is the type of kernel we are using.
   FastMKS<kernel::LinearKernel>* linear;
   //! This will only be non-NULL if this is the type of kernel we are using.
@@ -155,6 +166,13 @@ class FastMKSModel
               arma::Mat<size_t>& indices,
               arma::mat& kernels,
               const double base);
+
+  //! Execute the search with the reference set as the query set.
+  template<typename FastMKSType>
+  void Search(FastMKSType& f,
+              const size_t k,
+              arma::Mat<size_t>& indices,
+              arma::mat& kernels);
 };
 
 } // namespace fastmks
@@ -132,6 +132,11 @@ void FastMKSModel::Serialize(Archive& ar, const unsigned int /* version */)
 
   ar & CreateNVP(kernelType, "kernelType");
 
+  // The number of threads is a property of the machine, not of the model, so
+  // it is not saved; a loaded model uses all available threads.
+  if (Archive::is_loading::value)
+    numThreads = 0;
+
   if (Archive::is_loading::value)
   {
     // Clean memory.
@@ -200,6 +205,7 @@ void FastMKSModel::Search(FastMKSType& f,
                           arma::mat& kernels,
                           const double base)
 {
+  f.NumThreads() = numThreads;
   if (f.Naive() || f.SingleMode())
   {
     f.Search(querySet, k, indices, kernels);
@@ -214,6 +220,16 @@ void FastMKSModel::Search(FastMKSType& f,
   }
 }
 
+template<typename FastMKSType>
+void FastMKSModel::Search(FastMKSType& f,
+                          const size_t k,
+                          arma::Mat<size_t>& indices,
+                          arma::mat& kernels)
+{
+  f.NumThreads() = numThreads;
+  f.Search(k, indices, kernels);
+}
+
 } // namespace fastmks
 } // namespace mlpack
 
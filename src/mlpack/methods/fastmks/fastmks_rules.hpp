@@ -48,6 +48,17 @@ class FastMKSRules
                const size_t k,
                KernelType& kernel);
 
+  /**
+   * Construct a FastMKSRules object for use by another thread during a parallel
+   * search.  The new object shares the candidate lists and the precomputed
+   * self-kernels of the given object, but keeps its own traversal information
+   * and statistics.  Two threads must never search for the same query point at
+   * the same time.
+   *
+   * @param other FastMKSRules object to share results with.
+   */
+  FastMKSRules(FastMKSRules& other);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -148,8 +159,10 @@ class FastMKSRules
   typedef boost::heap::priority_queue<Candidate,
       boost::heap::compare<CandidateCmp>> CandidateList;
 
-  //! Set of candidates for each point.
-  std::vector<CandidateList> candidates;
+  //! Storage for the candidates of each point, if this object holds them.
+  std::vector<CandidateList> candidateStorage;
+  //! Set of candidates for each point (possibly held by another object).
+  std::vector<CandidateList>& candidates;
 
   //! Number of points to search for.
   const size_t k;
@@ -169,6 +182,15 @@ class FastMKSRules
   //! The last kernel evaluation resulting from BaseCase().
   double lastKernel;
 
+  //! For trees where the first point is the centroid, the last kernel
+  //! evaluation of a node in Score() is the kernel between the query and the
+  //! node's first point.  So we store it by point here, instead of in the
+  //! (shared) tree statistic; this allows each thread to hold its own.
+  arma::vec lastPointKernels;
+
+  //! Get the last kernel evaluation made by Score() for the given node.
+  double& LastScoreKernel(TreeType& node);
+
   //! Calculate the bound for a given query node.
   double CalculateBound(TreeType& queryNode) const;
 
@@ -26,6 +26,7 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     KernelType& kernel) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(candidateStorage),
     k(k),
     kernel(kernel),
     lastQueryIndex(-1),
@@ -45,6 +46,9 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     referenceKernels[i] = sqrt(kernel.Evaluate(referenceSet.col(i),
                                                referenceSet.col(i)));
 
+  if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+    lastPointKernels.set_size(referenceSet.n_cols);
+
   // Set to invalid memory, so that the first node combination does not try to
   // dereference null pointers.
   traversalInfo.LastQueryNode() = (TreeType*) this;
@@ -61,7 +65,33 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
   for (size_t i = 0; i < k; i++)
     pqueue.push(def);
   std::vector<CandidateList> tmp(querySet.n_cols, pqueue);
-  candidates.swap(tmp);
+  candidateStorage.swap(tmp);
+}
+
+template<typename KernelType, typename TreeType>
+FastMKSRules<KernelType, TreeType>::FastMKSRules(FastMKSRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(other.candidates),
+    k(other.k),
+    queryKernels(other.queryKernels.memptr(), other.queryKernels.n_elem, false,
+        true),
+    referenceKernels(other.referenceKernels.memptr(),
+        other.referenceKernels.n_elem, false, true),
+    kernel(other.kernel),
+    lastQueryIndex(-1),
+    lastReferenceIndex(-1),
+    lastKernel(0.0),
+    baseCases(0),
+    scores(0)
+{
+  if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+    lastPointKernels.set_size(referenceSet.n_cols);
+
+  // Set to invalid memory, so that the first node combination does not try to
+  // dereference null pointers.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
 }
 
 template<typename KernelType, typename TreeType>
@@ -138,7 +168,7 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
     double maxKernelBound;
     const double parentDist = referenceNode.ParentDistance();
     const double combinedDistBound = parentDist + furthestDist;
-    const double lastKernel = referenceNode.Parent()->Stat().LastKernel();
+    const double lastKernel = LastScoreKernel(*referenceNode.Parent());
     if (kernel::KernelTraits<KernelType>::IsNormalized)
     {
       const double squaredDist = std::pow(combinedDistBound, 2.0);
@@ -175,7 +205,7 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
         referenceNode.Parent() != NULL &&
         referenceNode.Point(0) == referenceNode.Parent()->Point(0))
     {
-      kernelEval = referenceNode.Parent()->Stat().LastKernel();
+      kernelEval = LastScoreKernel(*referenceNode.Parent());
     }
     else
     {
@@ -190,7 +220,7 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
     kernelEval = kernel.Evaluate(querySet.col(queryIndex), refCenter);
   }
 
-  referenceNode.Stat().LastKernel() = kernelEval;
+  LastScoreKernel(referenceNode) = kernelEval;
 
   double maxKernel;
   if (kernel::KernelTraits<KernelType>::IsNormalized)
@@ -516,6 +546,17 @@ double FastMKSRules<KernelType, TreeType>::CalculateBound(TreeType& queryNode)
   return (interA > interB) ? interA : interB;
 }
 
+template<typename KernelType, typename TreeType>
+inline force_inline
+double& FastMKSRules<KernelType, TreeType>::LastScoreKernel(TreeType& node)
+{
+  // This optimizes out, since the condition is known at compile time.
+  if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+    return lastPointKernels[node.Point(0)];
+  else
+    return node.Stat().LastKernel();
+}
+
 /**
  * Helper function to insert a point into the list of candidate points.
  *
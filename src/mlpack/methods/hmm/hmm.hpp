@@ -17,6 +17,8 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/dists/discrete_distribution.hpp>
 
+#include "hmm_emission.hpp"
+
 namespace mlpack {
 namespace hmm /** Hidden Markov Models. */ {
 
@@ -158,6 +160,10 @@ class HMM
    * log-likelihood of the model between iterations is less than the tolerance,
    * the Baum-Welch algorithm terminates.
    *
+   * If mlpack is built with OpenMP, the forward-backward pass of each sequence
+   * is run in parallel, and (when EmissionTrainTraits allows it) the emission
+   * distributions are refit in parallel.
+   *
    * @note
    * Train() can be called multiple times with different sequences; each time it
    * is called, it uses the current parameters of the HMM as a starting point
@@ -297,6 +303,99 @@ class HMM
   void Smooth(const arma::mat& dataSeq,
               arma::mat& smoothSeq) const;
 
+  /**
+   * An incremental forward filter over a stream of observations.  Each call to
+   * Update() absorbs one or more observations in O(states^2) time per
+   * observation, so that a stream can be scored as it arrives instead of
+   * recomputing the forward algorithm over the whole sequence.  The filtered
+   * state distribution P(X_t | o_{0:t}) and the log-likelihood of all
+   * observations so far are then available, as is the fixed-lag smoothed
+   * distribution P(X_{t - lag} | o_{0:t}).
+   *
+   * The FilterState holds a reference to the HMM, which must outlive it;
+   * modifying the HMM while filtering means that subsequent observations are
+   * filtered with the new parameters.
+   *
+   * @code
+   * HMM<GaussianDistribution> hmm; // Already trained.
+   * HMM<GaussianDistribution>::FilterState filter(hmm, 5);
+   * while (...)
+   * {
+   *   const double loglik = filter.Update(observation);
+   *   arma::vec smoothed;
+   *   filter.Smooth(smoothed); // P(X_{t - 5} | o_{0:t}).
+   * }
+   * @endcode
+   */
+  class FilterState
+  {
+   public:
+    /**
+     * Create the filter for the given HMM, with no observations absorbed yet.
+     *
+     * @param hmm HMM to filter with.
+     * @param lag Number of time steps of history to keep for fixed-lag
+     *     smoothing.
+     */
+    FilterState(const HMM& hmm, const size_t lag = 0);
+
+    /**
+     * Absorb the given observations (one per column) into the filter, and
+     * return the log-likelihood of all observations absorbed so far.
+     *
+     * @param observations Block of one or more observations.
+     * @return Log-likelihood of the sequence so far.
+     */
+    double Update(const arma::mat& observations);
+
+    /**
+     * Forget all observations, so that the next observation is the start of a
+     * new sequence.
+     */
+    void Reset();
+
+    /**
+     * Compute the fixed-lag smoothed state distribution: the probability of
+     * each state at time t - lag, given all the observations up to time t.  If
+     * fewer than lag + 1 observations have been absorbed, this is the
+     * distribution at the first time step.  If no observations have been
+     * absorbed, this is the initial state distribution.
+     *
+     * @param stateProb Vector to store the smoothed state distribution in.
+     */
+    void Smooth(arma::vec& stateProb) const;
+
+    /**
+     * Return the filtered state distribution: the probability of each state at
+     * the current time step, given all the observations so far.
+     */
+    arma::vec StateProb() const;
+
+    //! Get the log-likelihood of all observations so far.
+    double LogLikelihood() const { return logLikelihood; }
+    //! Get the number of observations absorbed so far.
+    size_t Observations() const { return observations; }
+    //! Get the lag used for smoothing.
+    size_t Lag() const { return lag; }
+
+   private:
+    //! The HMM being filtered with.
+    const HMM* hmm;
+    //! Number of time steps of history kept for smoothing.
+    size_t lag;
+    //! Number of observations absorbed so far.
+    size_t observations;
+    //! Log-likelihood of the observations so far.
+    double logLikelihood;
+
+    //! Ring buffer of the last lag + 1 forward probabilities.
+    arma::mat forwardWindow;
+    //! Ring buffer of the last lag + 1 (rescaled) emission probabilities.
+    arma::mat emissionWindow;
+    //! Ring buffer of the last lag + 1 scaling factors.
+    arma::vec scaleWindow;
+  };
+
   //! Return the vector of initial state probabilities.
   const arma::vec& Initial() const { return initial; }
   //! Modify the vector of initial state probabilities.
@@ -359,6 +458,60 @@ class HMM
                 const arma::vec& scales,
                 arma::mat& backwardProb) const;
 
+  /**
+   * Compute the log-probability of each observation in the given data sequence
+   * under each emission distribution.  The returned matrix has rows equal to
+   * the number of hidden states and columns equal to the number of
+   * observations.
+   *
+   * @param dataSeq Data sequence to compute log-probabilities for.
+   * @param logEmissionProb Matrix in which log-probabilities will be saved.
+   */
+  void LogEmissionProbability(const arma::mat& dataSeq,
+                              arma::mat& logEmissionProb) const;
+
+  /**
+   * Compute the probability of each observation in the given data sequence
+   * under each emission distribution, up to a per-observation factor.  Each
+   * column is divided by its largest element, and the log of that element is
+   * stored in logOffsets, so that the probabilities do not underflow even when
+   * the densities themselves would.
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param emissionProb Matrix in which rescaled probabilities will be saved.
+   * @param logOffsets Vector in which the log of each column's scaling factor
+   *     will be saved.
+   */
+  void EmissionProbability(const arma::mat& dataSeq,
+                           arma::mat& emissionProb,
+                           arma::vec& logOffsets) const;
+
+  /**
+   * The Forward algorithm, given the (possibly rescaled) emission probabilities
+   * of each observation under each state, as computed by
+   * EmissionProbability().
+   *
+   * @param emissionProb Emission probabilities of each observation.
+   * @param scales Vector in which scaling factors will be saved.
+   * @param forwardProb Matrix in which forward probabilities will be saved.
+   */
+  void ScaledForward(const arma::mat& emissionProb,
+                     arma::vec& scales,
+                     arma::mat& forwardProb) const;
+
+  /**
+   * The Backward algorithm, given the emission probabilities of each
+   * observation under each state and the scaling factors found by
+   * ScaledForward() with the same emission probabilities.
+   *
+   * @param emissionProb Emission probabilities of each observation.
+   * @param scales Vector of scaling factors.
+   * @param backwardProb Matrix in which backward probabilities will be saved.
+   */
+  void ScaledBackward(const arma::mat& emissionProb,
+                      const arma::vec& scales,
+                      arma::mat& backwardProb) const;
+
   //! Set of emission probability distributions; one for each state.
   std::vector<Distribution> emission;
 
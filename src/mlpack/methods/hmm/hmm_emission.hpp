@@ -0,0 +1,107 @@
+/**
+ * @file hmm_emission.hpp
+ * @author agent
+ *
+ * Helpers for evaluating and refitting the emission distributions of an HMM.
+ * The forward-backward algorithm needs the log-probability of every
+ * observation of a sequence under every state; for distributions that can
+ * evaluate a whole matrix of observations at once, that is done with a single
+ * call per state.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HMM_HMM_EMISSION_HPP
+#define MLPACK_METHODS_HMM_HMM_EMISSION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/methods/gmm/gmm.hpp>
+
+namespace mlpack {
+namespace hmm {
+
+/**
+ * Compute the log-probability of each observation (column) of the given
+ * sequence under the given distribution.  This generic version calls
+ * Probability() once for each observation.
+ *
+ * @param distribution Emission distribution to evaluate.
+ * @param dataSeq Sequence of observations.
+ * @param logProbs Vector to store log-probabilities in.
+ */
+template<typename Distribution>
+void EmissionLogProbability(const Distribution& distribution,
+                            const arma::mat& dataSeq,
+                            arma::vec& logProbs)
+{
+  logProbs.set_size(dataSeq.n_cols);
+  for (size_t t = 0; t < dataSeq.n_cols; ++t)
+    logProbs[t] = std::log(distribution.Probability(dataSeq.unsafe_col(t)));
+}
+
+//! Compute the log-probability of a Gaussian for a whole sequence at once.
+inline void EmissionLogProbability(
+    const distribution::GaussianDistribution& distribution,
+    const arma::mat& dataSeq,
+    arma::vec& logProbs)
+{
+  distribution.LogProbability(dataSeq, logProbs);
+}
+
+/**
+ * Compute the log-probability of a GMM for a whole sequence at once, using the
+ * log-sum-exp of the (vectorized) log-probabilities of each component.  Unlike
+ * GMM::Probability(), this does not underflow for high-dimensional data.
+ */
+inline void EmissionLogProbability(const gmm::GMM& distribution,
+                                   const arma::mat& dataSeq,
+                                   arma::vec& logProbs)
+{
+  arma::mat componentLogProbs(distribution.Gaussians(), dataSeq.n_cols);
+  arma::vec componentLogProb;
+  for (size_t i = 0; i < distribution.Gaussians(); ++i)
+  {
+    distribution.Component(i).LogProbability(dataSeq, componentLogProb);
+    componentLogProbs.row(i) = std::log(distribution.Weights()[i]) +
+        componentLogProb.t();
+  }
+
+  logProbs.set_size(dataSeq.n_cols);
+  for (size_t t = 0; t < dataSeq.n_cols; ++t)
+  {
+    const double maxLogProb = componentLogProbs.col(t).max();
+    if (maxLogProb == -std::numeric_limits<double>::infinity())
+      logProbs[t] = maxLogProb;
+    else
+      logProbs[t] = maxLogProb + std::log(arma::accu(
+          arma::exp(componentLogProbs.col(t) - maxLogProb)));
+  }
+}
+
+/**
+ * Whether or not the emission distributions of an HMM may be refit in parallel
+ * during the M-step of Baum-Welch.  This is only safe if training does not use
+ * the global random number generator; GMMs are refit with EM from a random
+ * k-means initialization, so they are trained serially.
+ */
+template<typename Distribution>
+struct EmissionTrainTraits
+{
+  //! If true, each emission distribution can be trained in its own thread.
+  static const bool ParallelTrain = true;
+};
+
+//! GMMs use random initialization when trained, so train them serially.
+template<>
+struct EmissionTrainTraits<gmm::GMM>
+{
+  static const bool ParallelTrain = false;
+};
+
+} // namespace hmm
+} // namespace mlpack
+
+#endif
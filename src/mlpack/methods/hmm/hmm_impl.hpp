@@ -91,10 +91,13 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   // Maximum iterations?
   size_t iterations = 1000;
 
-  // Find length of all sequences and ensure they are the correct size.
+  // Find length of all sequences and ensure they are the correct size.  We
+  // also record where each sequence starts in the list of all observations.
   size_t totalLength = 0;
+  std::vector<size_t> seqOffsets(dataSeq.size());
   for (size_t seq = 0; seq < dataSeq.size(); seq++)
   {
+    seqOffsets[seq] = totalLength;
     totalLength += dataSeq[seq].n_cols;
 
     if (dataSeq[seq].n_rows != dimensionality)
@@ -103,11 +106,18 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
           << dimensionality << " dimensions)." << std::endl;
   }
 
-  // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
-  std::vector<arma::vec> emissionProb(transition.n_cols,
-      arma::vec(totalLength));
+  // These are used later for training of each distribution.  The observations
+  // don't change between iterations, so we assemble the list of them once.
+  // Column j of emissionProb holds the probability of each observation having
+  // come from state j.
+  arma::mat emissionProb(totalLength, transition.n_cols);
   arma::mat emissionList(dimensionality, totalLength);
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+  {
+    if (dataSeq[seq].n_cols > 0)
+      emissionList.cols(seqOffsets[seq], seqOffsets[seq] +
+          dataSeq[seq].n_cols - 1) = dataSeq[seq];
+  }
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
@@ -123,49 +133,67 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
     // Reset log likelihood.
     loglik = 0;
 
-    // Sum over time.
-    size_t sumTime = 0;
-
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    // The E-step is independent for each sequence, so each thread handles a
+    // subset of the sequences and keeps its own sufficient statistics; these
+    // are combined once all the sequences have been processed.
+    #pragma omp parallel
     {
-      arma::mat stateProb;
-      arma::mat forward;
-      arma::mat backward;
-      arma::vec scales;
-
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += Estimate(dataSeq[seq], stateProb, forward, backward, scales);
-
-      // Add to estimate of initial probability for state j.
-      for (size_t j = 0; j < transition.n_cols; ++j)
-        newInitial[j] += stateProb(j, 0);
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; ++t)
+      arma::vec threadInitial(transition.n_rows, arma::fill::zeros);
+      arma::mat threadTransition(transition.n_rows, transition.n_cols,
+          arma::fill::zeros);
+      double threadLoglik = 0;
+
+      arma::mat seqEmissionProb, stateProb, forward, backward, next;
+      arma::vec logOffsets, scales;
+
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t seq = 0; seq < (omp_size_t) dataSeq.size(); ++seq)
       {
-        for (size_t j = 0; j < transition.n_cols; ++j)
+        const size_t length = dataSeq[seq].n_cols;
+        if (length == 0)
+          continue;
+
+        // Run the forward-backward algorithm on this sequence and add its
+        // log-likelihood.  This is the E-step.
+        EmissionProbability(dataSeq[seq], seqEmissionProb, logOffsets);
+        ScaledForward(seqEmissionProb, scales, forward);
+        ScaledBackward(seqEmissionProb, scales, backward);
+        stateProb = forward % backward;
+        threadLoglik += arma::accu(arma::log(scales)) + arma::accu(logOffsets);
+
+        // Add to estimate of initial probability for state j.
+        threadInitial += stateProb.col(0);
+
+        // Now accumulate the statistics for the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij
+        //           E_i(seq[d][t]) b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d]))
+        //           sum_{t | seq[d][t] = j} f(i, t) b(i, t)
+        // The sum over t for T_ij is a single matrix product; we postpone
+        // multiplication of the old T_ij until later.  The rescaling of the
+        // emission probabilities cancels with the rescaling of the scales.
+        if (length > 1)
         {
-          if (t < dataSeq[seq].n_cols - 1)
-          {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < transition.n_rows; i++)
-              newTransition(i, j) += forward(j, t) * backward(i, t + 1) *
-                  emission[i].Probability(dataSeq[seq].unsafe_col(t + 1)) /
-                  scales[t + 1];
-          }
-
-          // Add to list of emission observations, for Distribution::Train().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = stateProb(j, t);
+          next = backward.cols(1, length - 1) %
+              seqEmissionProb.cols(1, length - 1);
+          for (size_t t = 1; t < length; ++t)
+            if (scales[t] > 0.0)
+              next.col(t - 1) /= scales[t];
+
+          threadTransition += next * forward.cols(0, length - 2).t();
         }
-        sumTime++;
+
+        // Store the state probabilities, for Distribution::Train().
+        emissionProb.rows(seqOffsets[seq], seqOffsets[seq] + length - 1) =
+            stateProb.t();
+      }
+
+      #pragma omp critical(HMMTrainAccumulate)
+      {
+        newInitial += threadInitial;
+        newTransition += threadTransition;
+        loglik += threadLoglik;
       }
     }
 
@@ -191,9 +219,13 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
         transition.col(i).fill(1.0 / (double) transition.n_rows);
     }
 
-    // Now estimate emission probabilities.
-    for (size_t state = 0; state < transition.n_cols; state++)
-      emission[state].Train(emissionList, emissionProb[state]);
+    // Now estimate emission probabilities.  Each distribution is fit
+    // independently, so this can be done in parallel if the distribution's
+    // training is thread-safe.
+    #pragma omp parallel for schedule(dynamic) \
+        if (EmissionTrainTraits<Distribution>::ParallelTrain)
+    for (omp_size_t state = 0; state < (omp_size_t) transition.n_cols; state++)
+      emission[state].Train(emissionList, emissionProb.unsafe_col(state));
 
     Log::Debug << "Iteration " << iter << ": log-likelihood " << loglik
         << "." << std::endl;
@@ -314,16 +346,24 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
                                    arma::mat& backwardProb,
                                    arma::vec& scales) const
 {
-  // First run the forward-backward algorithm.
-  Forward(dataSeq, scales, forwardProb);
-  Backward(dataSeq, scales, backwardProb);
+  // First run the forward-backward algorithm.  The emission probabilities are
+  // only computed once, and are rescaled to avoid underflow.
+  arma::mat emissionProb;
+  arma::vec logOffsets;
+  EmissionProbability(dataSeq, emissionProb, logOffsets);
+  ScaledForward(emissionProb, scales, forwardProb);
+  ScaledBackward(emissionProb, scales, backwardProb);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
   stateProb = forwardProb % backwardProb;
 
-  // Finally assemble the log-likelihood and return it.
-  return accu(log(scales));
+  // Finally assemble the log-likelihood and return it.  The scales we return
+  // have to include the rescaling of the emission probabilities.
+  const double logLikelihood = accu(log(scales)) + accu(logOffsets);
+  scales %= exp(logOffsets);
+
+  return logLikelihood;
 }
 
 /**
@@ -411,16 +451,16 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
   // will be using the rows of the transition matrix.
   arma::mat logTrans(log(trans(transition)));
 
+  // Compute the log-probability of every observation under every state.
+  arma::mat logEmissionProb;
+  LogEmissionProbability(dataSeq, logEmissionProb);
+
   // The calculation of the first state is slightly different; the probability
   // of the first state being state j is the maximum probability that the state
   // came to be j from another state.
-  logStateProb.col(0).zeros();
+  logStateProb.col(0) = log(initial) + logEmissionProb.col(0);
   for (size_t state = 0; state < transition.n_rows; state++)
-  {
-    logStateProb(state, 0) = log(initial[state] *
-        emission[state].Probability(dataSeq.unsafe_col(0)));
     stateSeqBack(state, 0) = state;
-  }
 
   // Store the best first state.
   arma::uword index;
@@ -432,9 +472,8 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
     for (size_t j = 0; j < transition.n_rows; j++)
     {
       arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
-      logStateProb(j, t) = prob.max(index) +
-          log(emission[j].Probability(dataSeq.unsafe_col(t)));
-        stateSeqBack(j, t) = index;
+      logStateProb(j, t) = prob.max(index) + logEmissionProb(j, t);
+      stateSeqBack(j, t) = index;
     }
   }
 
@@ -454,13 +493,15 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
 template<typename Distribution>
 double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
 {
-  arma::mat forward;
-  arma::vec scales;
+  arma::mat emissionProb, forward;
+  arma::vec logOffsets, scales;
 
-  Forward(dataSeq, scales, forward);
+  EmissionProbability(dataSeq, emissionProb, logOffsets);
+  ScaledForward(emissionProb, scales, forward);
 
-  // The log-likelihood is the log of the scales for each time step.
-  return accu(log(scales));
+  // The log-likelihood is the log of the scales for each time step, plus the
+  // log of the factors the emission probabilities were rescaled by.
+  return accu(log(scales)) + accu(logOffsets);
 }
 
 /**
@@ -505,6 +546,121 @@ void HMM<Distribution>::Smooth(const arma::mat& dataSeq,
     smoothSeq += emission[i].Mean() * stateProb.row(i);
 }
 
+/**
+ * Create the filter for the given HMM.
+ */
+template<typename Distribution>
+HMM<Distribution>::FilterState::FilterState(const HMM& hmm,
+                                            const size_t lag) :
+    hmm(&hmm),
+    lag(lag),
+    observations(0),
+    logLikelihood(0.0),
+    forwardWindow(hmm.Transition().n_rows, lag + 1),
+    emissionWindow(hmm.Transition().n_rows, lag + 1),
+    scaleWindow(lag + 1)
+{
+  // Nothing to do.
+}
+
+/**
+ * Absorb the given observations into the filter.  This is one step of the
+ * Forward procedure for each observation.
+ */
+template<typename Distribution>
+double HMM<Distribution>::FilterState::Update(const arma::mat& newObservations)
+{
+  if (newObservations.n_rows != hmm->Dimensionality())
+    Log::Fatal << "HMM::FilterState::Update(): observations have "
+        << "dimensionality " << newObservations.n_rows << " (expected "
+        << hmm->Dimensionality() << " dimensions)." << std::endl;
+
+  // Compute the emission probabilities of the whole block at once.
+  arma::mat emissionProb;
+  arma::vec logOffsets;
+  hmm->EmissionProbability(newObservations, emissionProb, logOffsets);
+
+  for (size_t i = 0; i < newObservations.n_cols; ++i)
+  {
+    // Time step t is stored in slot t % (lag + 1) of the ring buffers.
+    const size_t slot = observations % (lag + 1);
+    if (observations == 0)
+    {
+      forwardWindow.col(slot) = hmm->initial % emissionProb.col(i);
+    }
+    else
+    {
+      const size_t lastSlot = (observations - 1) % (lag + 1);
+      forwardWindow.col(slot) = (hmm->transition *
+          forwardWindow.col(lastSlot)) % emissionProb.col(i);
+    }
+
+    // Normalize the forward probabilities and keep the scale for smoothing.
+    const double scale = accu(forwardWindow.col(slot));
+    if (scale > 0.0)
+      forwardWindow.col(slot) /= scale;
+
+    emissionWindow.col(slot) = emissionProb.col(i);
+    scaleWindow[slot] = scale;
+    logLikelihood += std::log(scale) + logOffsets[i];
+    ++observations;
+  }
+
+  return logLikelihood;
+}
+
+/**
+ * Forget all observations.
+ */
+template<typename Distribution>
+void HMM<Distribution>::FilterState::Reset()
+{
+  observations = 0;
+  logLikelihood = 0.0;
+}
+
+/**
+ * Compute the fixed-lag smoothed state distribution by running the Backward
+ * procedure over the stored window.
+ */
+template<typename Distribution>
+void HMM<Distribution>::FilterState::Smooth(arma::vec& stateProb) const
+{
+  if (observations == 0)
+  {
+    stateProb = hmm->initial;
+    return;
+  }
+
+  // Step backwards from the current time step to time t - lag (or to the first
+  // time step, if we haven't seen that many observations).
+  const size_t steps = std::min(lag, observations - 1);
+  size_t slot = (observations - 1) % (lag + 1);
+  arma::vec backward(hmm->transition.n_rows, arma::fill::ones);
+  for (size_t s = 0; s < steps; ++s)
+  {
+    backward = hmm->transition.t() * (backward % emissionWindow.col(slot));
+    if (scaleWindow[slot] > 0.0)
+      backward /= scaleWindow[slot];
+
+    slot = (slot + lag) % (lag + 1);
+  }
+
+  stateProb = forwardWindow.col(slot) % backward;
+}
+
+/**
+ * Return the filtered state distribution.
+ */
+template<typename Distribution>
+arma::vec HMM<Distribution>::FilterState::StateProb() const
+{
+  if (observations == 0)
+    return hmm->initial;
+
+  return forwardWindow.col((observations - 1) % (lag + 1));
+}
+
 /**
  * The Forward procedure (part of the Forward-Backward algorithm).
  */
@@ -512,20 +668,92 @@ template<typename Distribution>
 void HMM<Distribution>::Forward(const arma::mat& dataSeq,
                                 arma::vec& scales,
                                 arma::mat& forwardProb) const
+{
+  arma::mat emissionProb;
+  arma::vec logOffsets;
+  EmissionProbability(dataSeq, emissionProb, logOffsets);
+  ScaledForward(emissionProb, scales, forwardProb);
+
+  // The forward probabilities are normalized, so they are unaffected by the
+  // rescaling of the emission probabilities, but the scales are not.
+  scales %= exp(logOffsets);
+}
+
+template<typename Distribution>
+void HMM<Distribution>::Backward(const arma::mat& dataSeq,
+                                 const arma::vec& scales,
+                                 arma::mat& backwardProb) const
+{
+  // The given scales include the magnitude of the emission probabilities, so
+  // we cannot use rescaled emission probabilities here.
+  arma::mat emissionProb;
+  arma::vec logOffsets;
+  EmissionProbability(dataSeq, emissionProb, logOffsets);
+  emissionProb.each_row() %= exp(logOffsets).t();
+
+  ScaledBackward(emissionProb, scales, backwardProb);
+}
+
+/**
+ * Compute the log-probability of each observation under each state.
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogEmissionProbability(const arma::mat& dataSeq,
+                                               arma::mat& logEmissionProb) const
+{
+  logEmissionProb.set_size(transition.n_rows, dataSeq.n_cols);
+
+  // One call per state; for many distributions this is vectorized over the
+  // whole sequence.
+  arma::vec logProbs;
+  for (size_t state = 0; state < transition.n_rows; state++)
+  {
+    hmm::EmissionLogProbability(emission[state], dataSeq, logProbs);
+    logEmissionProb.row(state) = logProbs.t();
+  }
+}
+
+/**
+ * Compute the probability of each observation under each state, rescaled so
+ * that the largest probability of each observation is 1.
+ */
+template<typename Distribution>
+void HMM<Distribution>::EmissionProbability(const arma::mat& dataSeq,
+                                            arma::mat& emissionProb,
+                                            arma::vec& logOffsets) const
+{
+  LogEmissionProbability(dataSeq, emissionProb);
+
+  logOffsets.set_size(dataSeq.n_cols);
+  for (size_t t = 0; t < dataSeq.n_cols; t++)
+  {
+    // If no state can emit this observation, leave the probabilities at 0;
+    // the scale for this time step will then be 0 too.
+    logOffsets[t] = emissionProb.col(t).max();
+    if (!std::isfinite(logOffsets[t]))
+      logOffsets[t] = 0.0;
+  }
+
+  emissionProb.each_row() -= logOffsets.t();
+  emissionProb = exp(emissionProb);
+}
+
+template<typename Distribution>
+void HMM<Distribution>::ScaledForward(const arma::mat& emissionProb,
+                                      arma::vec& scales,
+                                      arma::mat& forwardProb) const
 {
   // Our goal is to calculate the forward probabilities:
   //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardProb.zeros(transition.n_rows, dataSeq.n_cols);
-  scales.zeros(dataSeq.n_cols);
+  forwardProb.zeros(transition.n_rows, emissionProb.n_cols);
+  scales.zeros(emissionProb.n_cols);
 
   // The first entry in the forward algorithm uses the initial state
   // probabilities.  Note that MATLAB assumes that the starting state (at
   // t = -1) is state 0; this is not our assumption here.  To force that
   // behavior, you could append a single starting state to every single data
   // sequence and that should produce results in line with MATLAB.
-  for (size_t state = 0; state < transition.n_rows; state++)
-    forwardProb(state, 0) = initial(state) *
-        emission[state].Probability(dataSeq.unsafe_col(0));
+  forwardProb.col(0) = initial % emissionProb.col(0);
 
   // Then normalize the column.
   scales[0] = accu(forwardProb.col(0));
@@ -533,17 +761,13 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
     forwardProb.col(0) /= scales[0];
 
   // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  for (size_t t = 1; t < emissionProb.n_cols; t++)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      forwardProb(j, t) = accu(forwardProb.col(t - 1) %
-          trans(transition.row(j))) *
-          emission[j].Probability(dataSeq.unsafe_col(t));
-    }
+    // The forward probability of state j at time t is the sum over all states
+    // of the probability of the previous state transitioning to the current
+    // state and emitting the given observation.
+    forwardProb.col(t) = (transition * forwardProb.col(t - 1)) %
+        emissionProb.col(t);
 
     // Normalize probability.
     scales[t] = accu(forwardProb.col(t));
@@ -553,34 +777,31 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
 }
 
 template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& scales,
-                                 arma::mat& backwardProb) const
+void HMM<Distribution>::ScaledBackward(const arma::mat& emissionProb,
+                                       const arma::vec& scales,
+                                       arma::mat& backwardProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardProb.zeros(transition.n_rows, dataSeq.n_cols);
+  backwardProb.zeros(transition.n_rows, emissionProb.n_cols);
 
   // The last element probability is 1.
-  backwardProb.col(dataSeq.n_cols - 1).fill(1);
+  backwardProb.col(emissionProb.n_cols - 1).fill(1);
 
   // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
+  const arma::mat transitionT = transition.t();
+  for (size_t t = emissionProb.n_cols - 2; t + 1 > 0; t--)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < transition.n_rows; state++)
-        backwardProb(j, t) += transition(state, j) * backwardProb(state, t + 1)
-            * emission[state].Probability(dataSeq.unsafe_col(t + 1));
-
-      // Normalize by the weights from the forward algorithm.
-      if (scales[t + 1] > 0.0)
-        backwardProb(j, t) /= scales[t + 1];
-    }
+    // The backward probability of state j at time t is the sum over all state
+    // of the probability of the next state having been a transition from the
+    // current state multiplied by the probability of each of those states
+    // emitting the given observation.
+    backwardProb.col(t) = transitionT * (backwardProb.col(t + 1) %
+        emissionProb.col(t + 1));
+
+    // Normalize by the weights from the forward algorithm.
+    if (scales[t + 1] > 0.0)
+      backwardProb.col(t) /= scales[t + 1];
   }
 }
 
@@ -18,6 +18,10 @@
 
 #include <mlpack/methods/gmm/gmm.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::hmm;
 using namespace mlpack::distribution;
@@ -37,19 +41,34 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Sequence Log-Likelihood", "This "
     PRINT_DATASET("seq") + " with the pre-trained HMM " + PRINT_MODEL("hmm") +
     ", the following command may be used: "
     "\n\n" +
-    PRINT_CALL("hmm_loglik", "input", "seq", "input_model", "hmm"));
+    PRINT_CALL("hmm_loglik", "input", "seq", "input_model", "hmm") +
+    "\n\n"
+    "Many sequences can be evaluated at once by concatenating them in " +
+    PRINT_PARAM_STRING("input") + " and giving the length of each sequence "
+    "with the " + PRINT_PARAM_STRING("lengths") + " parameter; the sequences "
+    "are then evaluated in parallel (if mlpack was built with OpenMP), the "
+    "log-likelihood of each sequence is given by the " +
+    PRINT_PARAM_STRING("log_likelihoods") + " output parameter, and " +
+    PRINT_PARAM_STRING("log_likelihood") + " holds their sum.");
 
 PARAM_MATRIX_IN_REQ("input", "File containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "File containing HMM.", "m");
+PARAM_UROW_IN("lengths", "Lengths of the consecutive sequences in the input, "
+    "if it holds a batch of sequences.", "l");
+PARAM_INT_IN("threads", "Number of threads to use for a batch of sequences (0 "
+    "uses all available threads; only has an effect if mlpack was built with "
+    "OpenMP).", "T", 0);
 
 PARAM_DOUBLE_OUT("log_likelihood", "Log-likelihood of the sequence.");
+PARAM_ROW_OUT("log_likelihoods", "Log-likelihood of each sequence, if "
+    "lengths are given.", "L");
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
 struct Loglik
 {
   template<typename HMMType>
-  static void Apply(HMMType& hmm, void* /* extraInfo */)
+  static void Apply(HMMType& hmm, int* threads)
   {
     // Load the data sequence.
     mat dataSeq = std::move(CLI::GetParam<mat>("input"));
@@ -68,14 +87,63 @@ struct Loglik
           << "not equal to the dimensionality of the HMM ("
           << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
-    const double loglik = hmm.LogLikelihood(dataSeq);
+    if (!CLI::HasParam("lengths"))
+    {
+      const double loglik = hmm.LogLikelihood(dataSeq);
+
+      CLI::GetParam<double>("log_likelihood") = loglik;
+      return;
+    }
+
+    // Find where each sequence of the batch starts.
+    const arma::Row<size_t>& lengths =
+        CLI::GetParam<arma::Row<size_t>>("lengths");
+    if (accu(lengths) != dataSeq.n_cols)
+      Log::Fatal << "Sum of sequence lengths (" << accu(lengths) << ") is not "
+          << "equal to the number of observations (" << dataSeq.n_cols << ")!"
+          << endl;
+    if (any(lengths == 0))
+      Log::Fatal << "Sequence lengths must be positive!" << endl;
 
-    CLI::GetParam<double>("log_likelihood") = loglik;
+    arma::Row<size_t> offsets(lengths.n_elem);
+    size_t offset = 0;
+    for (size_t i = 0; i < lengths.n_elem; ++i)
+    {
+      offsets[i] = offset;
+      offset += lengths[i];
+    }
+
+    // Each sequence is independent, so evaluate them in parallel.  The number
+    // of threads to use is passed in.
+    arma::rowvec logliks(lengths.n_elem);
+    #pragma omp parallel for schedule(dynamic) num_threads(*threads)
+    for (omp_size_t i = 0; i < (omp_size_t) lengths.n_elem; ++i)
+    {
+      // Alias the columns of the sequence, to avoid a copy.
+      const mat sequence(dataSeq.colptr(offsets[i]), dataSeq.n_rows,
+          lengths[i], false, true);
+      logliks[i] = hmm.LogLikelihood(sequence);
+    }
+
+    CLI::GetParam<double>("log_likelihood") = accu(logliks);
+    CLI::GetParam<arma::rowvec>("log_likelihoods") = std::move(logliks);
   }
 };
 
 void mlpackMain()
 {
+  if (CLI::GetParam<int>("threads") < 0)
+    Log::Fatal << "Invalid number of threads (" << CLI::GetParam<int>("threads")
+        << "); must be 0 or greater!" << endl;
+
+  // Only the batch of sequences is processed with this many threads; the
+  // global OpenMP setting is left alone.
+  int threads = CLI::GetParam<int>("threads");
+#ifdef HAS_OPENMP
+  if (threads == 0)
+    threads = omp_get_max_threads();
+#endif
+
   // Load model, and calculate the log-likelihood of the sequence.
-  CLI::GetParam<HMMModel>("input_model").PerformAction<Loglik>((void*) NULL);
+  CLI::GetParam<HMMModel>("input_model").PerformAction<Loglik, int>(&threads);
 }
@@ -19,6 +19,10 @@
 
 #include <mlpack/methods/gmm/gmm.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::hmm;
 using namespace mlpack::distribution;
@@ -41,10 +45,22 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction", "This "
     ", the following command could be used:"
     "\n\n" +
     PRINT_CALL("hmm_viterbi", "input", "obs", "input_model", "hmm", "output",
-        "states"));
+        "states") +
+    "\n\n"
+    "Many sequences can be processed at once by concatenating them in " +
+    PRINT_PARAM_STRING("input") + " and giving the length of each sequence "
+    "with the " + PRINT_PARAM_STRING("lengths") + " parameter; the sequences "
+    "are then processed in parallel (if mlpack was built with OpenMP), and the "
+    "predicted state sequences are concatenated in the same way in " +
+    PRINT_PARAM_STRING("output") + ".");
 
 PARAM_MATRIX_IN_REQ("input", "Matrix containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "Trained HMM to use.", "m");
+PARAM_UROW_IN("lengths", "Lengths of the consecutive sequences in the input, "
+    "if it holds a batch of sequences.", "l");
+PARAM_INT_IN("threads", "Number of threads to use for a batch of sequences (0 "
+    "uses all available threads; only has an effect if mlpack was built with "
+    "OpenMP).", "T", 0);
 PARAM_UMATRIX_OUT("output", "File to save predicted state sequence to.", "o");
 
 // Because we don't know what the type of our HMM is, we need to write a
@@ -52,7 +68,7 @@ PARAM_UMATRIX_OUT("output", "File to save predicted state sequence to.", "o");
 struct Viterbi
 {
   template<typename HMMType>
-  static void Apply(HMMType& hmm, void* /* extraInfo */)
+  static void Apply(HMMType& hmm, int* threads)
   {
     // Load observations.
     mat dataSeq = std::move(CLI::GetParam<arma::mat>("input"));
@@ -72,7 +88,44 @@ struct Viterbi
           << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
     arma::Row<size_t> sequence;
-    hmm.Predict(dataSeq, sequence);
+    if (!CLI::HasParam("lengths"))
+    {
+      hmm.Predict(dataSeq, sequence);
+    }
+    else
+    {
+      // Find where each sequence of the batch starts.
+      const arma::Row<size_t>& lengths =
+          CLI::GetParam<arma::Row<size_t>>("lengths");
+      if (accu(lengths) != dataSeq.n_cols)
+        Log::Fatal << "Sum of sequence lengths (" << accu(lengths) << ") is "
+            << "not equal to the number of observations (" << dataSeq.n_cols
+            << ")!" << endl;
+      if (any(lengths == 0))
+        Log::Fatal << "Sequence lengths must be positive!" << endl;
+
+      arma::Row<size_t> offsets(lengths.n_elem);
+      size_t offset = 0;
+      for (size_t i = 0; i < lengths.n_elem; ++i)
+      {
+        offsets[i] = offset;
+        offset += lengths[i];
+      }
+
+      // Each sequence is independent, so predict them in parallel.  The
+      // number of threads to use is passed in.
+      sequence.set_size(dataSeq.n_cols);
+      #pragma omp parallel for schedule(dynamic) num_threads(*threads)
+      for (omp_size_t i = 0; i < (omp_size_t) lengths.n_elem; ++i)
+      {
+        // Alias the columns of the sequence, to avoid a copy.
+        const mat observations(dataSeq.colptr(offsets[i]), dataSeq.n_rows,
+            lengths[i], false, true);
+        arma::Row<size_t> states;
+        hmm.Predict(observations, states);
+        sequence.cols(offsets[i], offsets[i] + lengths[i] - 1) = states;
+      }
+    }
 
     // Save output.
     if (CLI::HasParam("output"))
@@ -82,9 +135,21 @@ struct Viterbi
 
 void mlpackMain()
 {
+  if (CLI::GetParam<int>("threads") < 0)
+    Log::Fatal << "Invalid number of threads (" << CLI::GetParam<int>("threads")
+        << "); must be 0 or greater!" << endl;
+
+  // Only the batch of sequences is processed with this many threads; the
+  // global OpenMP setting is left alone.
+  int threads = CLI::GetParam<int>("threads");
+#ifdef HAS_OPENMP
+  if (threads == 0)
+    threads = omp_get_max_threads();
+#endif
+
   if (!CLI::HasParam("output"))
     Log::Warn << "--output_file (-o) is not specified; no results will be "
         << "saved!" << endl;
 
-  CLI::GetParam<HMMModel>("input_model").PerformAction<Viterbi>((void*) NULL);
+  CLI::GetParam<HMMModel>("input_model").PerformAction<Viterbi, int>(&threads);
 }
@@ -241,6 +241,41 @@ class LSHSearch
               const size_t numTablesToSearch = 0,
               size_t T = 0);
 
+  /**
+   * Insert new points into the model.  The points are appended to the
+   * reference set (so the index of the first new point is the number of points
+   * the model held before the call), and are hashed with the existing
+   * projections.  If the model does not already own its reference set, a copy
+   * of the reference set is made.
+   *
+   * The new points are held in an overflow table until the next compaction,
+   * which happens automatically once enough points have been inserted or
+   * removed.  An exception is thrown if the model has not been trained.
+   *
+   * @param newPoints Points to insert.
+   */
+  void Insert(const arma::mat& newPoints);
+
+  /**
+   * Remove the given points from the model, so that they are no longer
+   * returned as neighbors.  The points are marked as removed in the hash
+   * tables, but they are kept in the reference set so that the indices of all
+   * other points do not change.  To reclaim the memory used by removed points,
+   * retrain the model with Train().  Points that were already removed are
+   * ignored.  An exception is thrown if the model has not been trained.
+   *
+   * @param indices Indices of points to remove.
+   */
+  void Remove(const arma::uvec& indices);
+
+  /**
+   * Merge all points inserted since the last compaction into the second hash
+   * table and drop all removed points from it.  This is called automatically by
+   * Insert() and Remove() when necessary, and before the model is saved.  An
+   * exception is thrown if the model has not been trained.
+   */
+  void Compact();
+
   /**
    * Compute the recall (% of neighbors found) given the neighbors returned by
    * LSHSearch::Search and a "ground truth" set of neighbors.  The recall
@@ -281,10 +316,30 @@ class LSHSearch
   //! Get the bucket size of the second hash.
   size_t BucketSize() const { return bucketSize; }
 
-  //! Get the second hash table.
-  const std::vector<arma::Col<size_t>>& SecondHashTable() const
+  //! Get the second hash table.  This is stored in compressed sparse row
+  //! (CSR) format: the contents of the bucket in row i are held in
+  //! SecondHashTable()[BucketOffsets()[i]] through
+  //! SecondHashTable()[BucketOffsets()[i + 1] - 1].  Note that earlier
+  //! versions of mlpack returned a std::vector<arma::Col<size_t>> with one
+  //! element per bucket here; code that expects that form should use
+  //! SecondHashTableBuckets() instead.
+  const arma::Col<uint32_t>& SecondHashTable() const
       { return secondHashTable; }
 
+  /**
+   * Get the second hash table with one element per nonempty bucket, as
+   * SecondHashTable() returned in earlier versions of mlpack.  Element i holds
+   * the indices of the points in the bucket in row i, including any points
+   * inserted with Insert() and excluding any removed with Remove().  The table
+   * is built on each call, so this is slower than SecondHashTable().
+   */
+  std::vector<arma::Col<size_t>> SecondHashTableBuckets() const;
+
+  //! Get the offsets of each row of the second hash table (of length one more
+  //! than the number of nonempty buckets).  Points that have been inserted or
+  //! removed since the last call to Compact() are not reflected here.
+  const arma::Col<size_t>& BucketOffsets() const { return bucketOffsets; }
+
   //! Get the projection tables.
   const arma::cube& Projections() { return projections; }
 
@@ -298,25 +353,95 @@ class LSHSearch
 
  private:
   /**
-   * This function takes a query and hashes it into each of the hash tables to
-   * get keys for the query and then the key is hashed to a bucket of the second
-   * hash table and all the points (if any) in those buckets are collected as
-   * the potential neighbor candidates.
+   * This function takes the projections of a query into each of the hash
+   * tables, computes the keys for the query, and then the key is hashed to a
+   * bucket of the second hash table and all the points (if any) in those
+   * buckets are collected as the potential neighbor candidates.
    *
-   * @param queryPoint The query point currently being processed.
-   * @param referenceIndices The list of neighbor candidates obtained from
-   *    hashing the query into all the hash tables and eventually into
-   *    multiple buckets of the second hash table.
-   * @param numTablesToSearch The number of tables to perform the search in. If
-   *    0, all tables are searched.
+   * Duplicate candidates are discarded with the given stamp array: a reference
+   * point is only added if its entry in candidateStamps is not already equal
+   * to the given stamp.  So, as long as each query uses a distinct stamp,
+   * candidateStamps never needs to be cleared.
+   *
+   * @param queryCodesNotFloored The projection location of the query in each
+   *    table to search (with the offsets already added); this should have
+   *    size numProj x numTablesToSearch.
+   * @param queryCodes The floored codes of the query in each table to search
+   *    (i.e. floor(queryCodesNotFloored / hashWidth)).
+   * @param primaryBuckets The primary bucket of the query in the second hash
+   *    table, for each table to search.
    * @param T The number of additional probing bins for multiprobe LSH. If 0,
    *    single-probe is used.
+   * @param candidateStamps Stamp array of length referenceSet->n_cols.
+   * @param stamp Stamp to use for this query; must not be 0.
+   * @param candidates Buffer to store candidates in; this is grown when
+   *    necessary, but never shrunk.
+   * @return The number of distinct candidates stored in the buffer.
+   */
+  size_t ReturnIndicesFromTable(const arma::mat& queryCodesNotFloored,
+                                const arma::mat& queryCodes,
+                                const size_t* primaryBuckets,
+                                const size_t T,
+                                arma::Col<size_t>& candidateStamps,
+                                const size_t stamp,
+                                arma::uvec& candidates) const;
+
+  /**
+   * Add the contents of the given bucket of the second hash table to the
+   * candidate buffer, skipping any points that have already been stamped for
+   * this query.
+   *
+   * @param hashInd Bucket in the second hash table.
+   * @param candidateStamps Stamp array of length referenceSet->n_cols.
+   * @param stamp Stamp to use for this query.
+   * @param candidates Buffer to store candidates in.
+   * @param numCandidates Number of candidates currently in the buffer; this
+   *    will be incremented for each new candidate.
+   */
+  void AddBucketCandidates(const size_t hashInd,
+                           arma::Col<size_t>& candidateStamps,
+                           const size_t stamp,
+                           arma::uvec& candidates,
+                           size_t& numCandidates) const;
+
+  /**
+   * Make sure that threadCandidateStamps holds a stamp array for each OpenMP
+   * thread, each of length at least referenceSet->n_cols.  Existing stamps are
+   * kept, so the arrays are only allocated by the first search and grown after
+   * points are inserted.
    */
-  template<typename VecType>
-  void ReturnIndicesFromTable(const VecType& queryPoint,
-                              arma::uvec& referenceIndices,
-                              size_t numTablesToSearch,
-                              const size_t T) const;
+  void PrepareCandidateStamps();
+
+  /**
+   * Project a block of queries into every table that will be searched, using
+   * a single matrix multiplication, and compute the primary bucket of each of
+   * those queries in the second hash table.  The output matrices are reused
+   * if they are already the right size.
+   *
+   * @param queryBlock Block of query points.
+   * @param numTablesToSearch Number of tables that will be searched.
+   * @param codesNotFloored Output projection locations; column i holds the
+   *    numProj x numTablesToSearch locations of query i.
+   * @param codes Output floored codes, in the same layout as codesNotFloored.
+   * @param primaryBuckets Output buckets; column i holds the primary bucket of
+   *    query i in each of the tables that will be searched.
+   */
+  void ProjectQueries(const arma::mat& queryBlock,
+                      const size_t numTablesToSearch,
+                      arma::mat& codesNotFloored,
+                      arma::mat& codes,
+                      arma::Mat<size_t>& primaryBuckets) const;
+
+  /**
+   * Compute the bucket in the second hash table that each of the given points
+   * is hashed to, for each table.
+   *
+   * @param points Points to hash.
+   * @param secondHashVectors Output keys; the key of point j in table i is
+   *    stored in (i, j).
+   */
+  void SecondHashKeys(const arma::mat& points,
+                      arma::Mat<size_t>& secondHashVectors) const;
 
   /**
    * This is a helper function that computes the distance of the query to the
@@ -443,21 +568,55 @@ class LSHSearch
   //! The bucket size of the second hash.
   size_t bucketSize;
 
-  //! The final hash table; should be (< secondHashSize) vectors each with
-  //! (<= bucketSize) elements.
-  std::vector<arma::Col<size_t>> secondHashTable;
+  //! The final hash table, stored in CSR format; all of the (< secondHashSize)
+  //! nonempty buckets, each with (<= bucketSize) elements, are concatenated.
+  arma::Col<uint32_t> secondHashTable;
 
-  //! The number of elements present in each hash bucket; should be
-  //! secondHashSize.
-  arma::Col<size_t> bucketContentSize;
+  //! The offset of each bucket in secondHashTable; the number of elements in
+  //! the bucket in row i is bucketOffsets[i + 1] - bucketOffsets[i].
+  arma::Col<size_t> bucketOffsets;
 
   //! For a particular hash value, points to the row in secondHashTable
   //! corresponding to this value. Length secondHashSize.
   arma::Col<size_t> bucketRowInHashTable;
 
+  //! Points inserted since the last compaction, for each row of the second
+  //! hash table.  This is empty if no points have been inserted.
+  std::vector<std::vector<uint32_t>> overflowTable;
+
+  //! The total number of points held in overflowTable.
+  size_t overflowSize;
+
+  //! The number of removed points in secondHashTable.
+  size_t numTombstones;
+
+  //! For each point of the reference set, whether it has been removed with
+  //! Remove().  Points past the end (or all points, if this is empty) have not
+  //! been removed.
+  std::vector<bool> removedPoints;
+
+  //! The number of points that have been removed with Remove().
+  size_t numRemoved;
+
+  //! The value that marks a removed point in secondHashTable.
+  static constexpr uint32_t tombstone = std::numeric_limits<uint32_t>::max();
+
   //! The number of distance evaluations.
   size_t distanceEvaluations;
 
+  //! Scratch space for Search(): one stamp array for each thread, used to
+  //! discard duplicate candidates.  These are kept between searches so that
+  //! they don't need to be allocated and cleared each time.  Not serialized.
+  std::vector<arma::Col<size_t>> threadCandidateStamps;
+
+  //! The stamp after the last one used by a query; the stamps in
+  //! threadCandidateStamps are all smaller than this.
+  size_t nextStamp;
+
+  //! The number of queries that are projected into the tables at once during
+  //! Search().
+  static constexpr size_t queryBlockSize = 256;
+
   //! Candidate represents a possible candidate neighbor (distance, index).
   typedef std::pair<double, size_t> Candidate;
 
@@ -479,7 +638,7 @@ class LSHSearch
 
 //! Set the serialization version of the LSHSearch class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::LSHSearch<SortPolicy>, 1);
+    mlpack::neighbor::LSHSearch<SortPolicy>, 3);
 
 // Include implementation.
 #include "lsh_search_impl.hpp"
@@ -15,6 +15,10 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/math/random.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace neighbor {
 
@@ -34,7 +38,11 @@ LSHSearch(const arma::mat& referenceSet,
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
-  distanceEvaluations(0)
+  overflowSize(0),
+  numTombstones(0),
+  numRemoved(0),
+  distanceEvaluations(0),
+  nextStamp(0)
 {
   // Pass work to training function.
   Train(referenceSet, numProj, numTables, hashWidthIn, secondHashSize,
@@ -56,7 +64,11 @@ LSHSearch(const arma::mat& referenceSet,
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
-  distanceEvaluations(0)
+  overflowSize(0),
+  numTombstones(0),
+  numRemoved(0),
+  distanceEvaluations(0),
+  nextStamp(0)
 {
   // Pass work to training function
   Train(referenceSet, numProj, numTables, hashWidthIn, secondHashSize,
@@ -73,7 +85,11 @@ LSHSearch<SortPolicy>::LSHSearch() :
     hashWidth(0),
     secondHashSize(99901),
     bucketSize(500),
-    distanceEvaluations(0)
+    overflowSize(0),
+    numTombstones(0),
+    numRemoved(0),
+    distanceEvaluations(0),
+    nextStamp(0)
 {
 }
 
@@ -91,9 +107,15 @@ LSHSearch<SortPolicy>::LSHSearch(const LSHSearch& other) :
     secondHashWeights(other.secondHashWeights),
     bucketSize(other.bucketSize),
     secondHashTable(other.secondHashTable),
-    bucketContentSize(other.bucketContentSize),
+    bucketOffsets(other.bucketOffsets),
     bucketRowInHashTable(other.bucketRowInHashTable),
-    distanceEvaluations(other.distanceEvaluations)
+    overflowTable(other.overflowTable),
+    overflowSize(other.overflowSize),
+    numTombstones(other.numTombstones),
+    removedPoints(other.removedPoints),
+    numRemoved(other.numRemoved),
+    distanceEvaluations(other.distanceEvaluations),
+    nextStamp(0)
 {
   // Nothing to do.
 }
@@ -112,9 +134,16 @@ LSHSearch<SortPolicy>::LSHSearch(LSHSearch&& other) :
     secondHashWeights(std::move(other.secondHashWeights)),
     bucketSize(other.bucketSize),
     secondHashTable(std::move(other.secondHashTable)),
-    bucketContentSize(std::move(other.bucketContentSize)),
+    bucketOffsets(std::move(other.bucketOffsets)),
     bucketRowInHashTable(std::move(other.bucketRowInHashTable)),
-    distanceEvaluations(other.distanceEvaluations)
+    overflowTable(std::move(other.overflowTable)),
+    overflowSize(other.overflowSize),
+    numTombstones(other.numTombstones),
+    removedPoints(std::move(other.removedPoints)),
+    numRemoved(other.numRemoved),
+    distanceEvaluations(other.distanceEvaluations),
+    threadCandidateStamps(std::move(other.threadCandidateStamps)),
+    nextStamp(other.nextStamp)
 {
   // Reset other model to defaults.
   other.referenceSet = new arma::mat();
@@ -124,7 +153,13 @@ LSHSearch<SortPolicy>::LSHSearch(LSHSearch&& other) :
   other.hashWidth = 0;
   other.secondHashSize = 99901;
   other.bucketSize = 500;
+  other.overflowSize = 0;
+  other.numTombstones = 0;
+  other.removedPoints.clear();
+  other.numRemoved = 0;
   other.distanceEvaluations = 0;
+  other.threadCandidateStamps.clear();
+  other.nextStamp = 0;
 }
 
 // Copy operator.
@@ -145,9 +180,16 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(const LSHSearch& other)
   secondHashWeights = other.secondHashWeights;
   bucketSize = other.bucketSize;
   secondHashTable = other.secondHashTable;
-  bucketContentSize = other.bucketContentSize;
+  bucketOffsets = other.bucketOffsets;
   bucketRowInHashTable = other.bucketRowInHashTable;
+  overflowTable = other.overflowTable;
+  overflowSize = other.overflowSize;
+  numTombstones = other.numTombstones;
+  removedPoints = other.removedPoints;
+  numRemoved = other.numRemoved;
   distanceEvaluations = other.distanceEvaluations;
+  threadCandidateStamps.clear();
+  nextStamp = 0;
 
   return *this;
 }
@@ -170,9 +212,16 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(LSHSearch&& other)
   secondHashWeights = std::move(other.secondHashWeights);
   bucketSize = other.bucketSize;
   secondHashTable = std::move(other.secondHashTable);
-  bucketContentSize = std::move(other.bucketContentSize);
+  bucketOffsets = std::move(other.bucketOffsets);
   bucketRowInHashTable = std::move(other.bucketRowInHashTable);
+  overflowTable = std::move(other.overflowTable);
+  overflowSize = other.overflowSize;
+  numTombstones = other.numTombstones;
+  removedPoints = std::move(other.removedPoints);
+  numRemoved = other.numRemoved;
   distanceEvaluations = other.distanceEvaluations;
+  threadCandidateStamps = std::move(other.threadCandidateStamps);
+  nextStamp = other.nextStamp;
 
   // Reset other model to defaults.
   other.referenceSet = new arma::mat();
@@ -182,7 +231,13 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(LSHSearch&& other)
   other.hashWidth = 0;
   other.secondHashSize = 99901;
   other.bucketSize = 500;
+  other.overflowSize = 0;
+  other.numTombstones = 0;
+  other.removedPoints.clear();
+  other.numRemoved = 0;
   other.distanceEvaluations = 0;
+  other.threadCandidateStamps.clear();
+  other.nextStamp = 0;
 
   return *this;
 }
@@ -205,11 +260,25 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
                                   const size_t bucketSize,
                                   const arma::cube &projection)
 {
-  // Set new reference set.
-  if (this->referenceSet && ownsSet)
-    delete this->referenceSet;
-  this->referenceSet = &referenceSet;
-  this->ownsSet = false;
+  // The second hash table holds 32-bit indices.
+  if (referenceSet.n_cols > std::numeric_limits<uint32_t>::max())
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Train(): reference set has " << referenceSet.n_cols
+        << " points, but at most " << std::numeric_limits<uint32_t>::max()
+        << " points are supported!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Set new reference set.  (If we are retraining on the reference set we
+  // already hold, there is nothing to do.)
+  if (this->referenceSet != &referenceSet)
+  {
+    if (this->referenceSet && ownsSet)
+      delete this->referenceSet;
+    this->referenceSet = &referenceSet;
+    this->ownsSet = false;
+  }
 
   // Set new parameters.
   this->numProj = numProj;
@@ -281,10 +350,80 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
         "tables provided must be equal to numProj");
   }
 
-  // We will store the second hash vectors in this matrix; the second hash
-  // vector for table i will be held in row i.  We have to use int and not
-  // size_t, otherwise negative numbers are cast to 0.
-  arma::Mat<size_t> secondHashVectors(numTables, referenceSet.n_cols);
+  // Step IV and V: compute the key of each point in each table; the second
+  // hash vector for table i will be held in row i.
+  arma::Mat<size_t> secondHashVectors;
+  SecondHashKeys(referenceSet, secondHashVectors);
+
+  // Now, using the hash vectors for each table, count the number of rows we
+  // have in the second hash table.
+  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
+  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
+    secondHashBinCounts[secondHashVectors[i]]++;
+
+  // Enforce the maximum bucket size.
+  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
+  secondHashBinCounts.transform([effectiveBucketSize](size_t val)
+      { return std::min(val, effectiveBucketSize); });
+
+  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
+
+  // The second hash table is stored in CSR format.  First, we assign a row to
+  // each nonempty bucket (in the order the buckets are encountered) and compute
+  // the offset of each row in the table.
+  bucketOffsets.zeros(numRowsInTable + 1);
+  size_t currentRow = 0;
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      const size_t hashInd = secondHashVectors(i, j);
+      if (bucketRowInHashTable[hashInd] == secondHashSize)
+      {
+        bucketRowInHashTable[hashInd] = currentRow;
+        bucketOffsets[currentRow + 1] = secondHashBinCounts[hashInd];
+        currentRow++;
+      }
+    }
+  }
+  bucketOffsets = arma::cumsum(bucketOffsets);
+
+  // Next we must assign each point in each table to the right row of the
+  // second hash table.  'nextPosition' holds the position at which the next
+  // point of each row will be inserted.
+  secondHashTable.set_size(bucketOffsets[numRowsInTable]);
+  overflowTable.clear();
+  overflowSize = 0;
+  numTombstones = 0;
+  removedPoints.clear();
+  numRemoved = 0;
+  threadCandidateStamps.clear();
+  nextStamp = 0;
+  arma::Col<size_t> nextPosition = bucketOffsets.head(numRowsInTable);
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      // The point ID is 'j'.  If the row is not full, add the point.
+      const size_t row = bucketRowInHashTable[secondHashVectors(i, j)];
+      if (nextPosition[row] < bucketOffsets[row + 1])
+        secondHashTable[nextPosition[row]++] = (uint32_t) j;
+    }
+  }
+
+  Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
+            << "maximum length of " << arma::max(secondHashBinCounts) << ", "
+            << "totaling " << arma::accu(secondHashBinCounts) << " elements."
+            << std::endl;
+}
+
+// Compute the second-level hash keys of a set of points.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::SecondHashKeys(
+    const arma::mat& points,
+    arma::Mat<size_t>& secondHashVectors) const
+{
+  secondHashVectors.set_size(numTables, points.n_cols);
 
   for (size_t i = 0; i < numTables; i++)
   {
@@ -293,16 +432,14 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
 
     // The following code performs the task of hashing each point to a
     // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
-    // 'referenceSet.n_cols') key matrix.
+    // 'points.n_cols') key matrix.
     //
     // For a single table, let the 'numProj' projections be denoted by 'proj_i'
     // and the corresponding offset be 'offset_i'.  Then the key of a single
     // point is obtained as:
     // key = { floor((<proj_i, point> + offset_i) / 'hashWidth') forall i }
-    arma::mat offsetMat = arma::repmat(offsets.unsafe_col(i), 1,
-                                       referenceSet.n_cols);
-    arma::mat hashMat = projections.slice(i).t() * (referenceSet);
-    hashMat += offsetMat;
+    arma::mat hashMat = projections.slice(i).t() * points;
+    hashMat.each_col() += offsets.unsafe_col(i);
     hashMat /= hashWidth;
 
     // Step V: Putting the points in the 'secondHashTable' by hashing the key.
@@ -325,56 +462,6 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
       }
     }
   }
-
-  // Now, using the hash vectors for each table, count the number of rows we
-  // have in the second hash table.
-  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
-  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
-    secondHashBinCounts[secondHashVectors[i]]++;
-
-  // Enforce the maximum bucket size.
-  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
-  secondHashBinCounts.transform([effectiveBucketSize](size_t val)
-      { return std::min(val, effectiveBucketSize); });
-
-  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
-  bucketContentSize.zeros(numRowsInTable);
-  secondHashTable.resize(numRowsInTable);
-
-  // Next we must assign each point in each table to the right second hash
-  // table.
-  size_t currentRow = 0;
-  for (size_t i = 0; i < numTables; ++i)
-  {
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
-    for (size_t j = 0; j < secondHashVectors.n_cols; j++)
-    {
-      // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVectors(i, j);
-      // The point ID is 'j'.
-
-      // If this is currently an empty bucket, start a new row keep track of
-      // which row corresponds to the bucket.
-      const size_t maxSize = secondHashBinCounts[hashInd];
-      if (bucketRowInHashTable[hashInd] == secondHashSize)
-      {
-        bucketRowInHashTable[hashInd] = currentRow;
-        secondHashTable[currentRow].set_size(maxSize);
-        currentRow++;
-      }
-
-      // If this vector in the hash table is not full, add the point.
-      const size_t index = bucketRowInHashTable[hashInd];
-      if (bucketContentSize[index] < maxSize)
-        secondHashTable[index](bucketContentSize[index]++) = j;
-    } // Loop over all points in the reference set.
-  } // Loop over tables.
-
-  Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
-            << "maximum length of " << arma::max(secondHashBinCounts) << ", "
-            << "totaling " << arma::accu(secondHashBinCounts) << " elements."
-            << std::endl;
 }
 
 // Base case where the query set is the reference set.  (So, we can't return
@@ -727,155 +814,192 @@ void LSHSearch<SortPolicy>::GetAdditionalProbingBins(
 }
 
 template<typename SortPolicy>
-template<typename VecType>
-void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
-    const VecType& queryPoint,
-    arma::uvec& referenceIndices,
-    size_t numTablesToSearch,
-    const size_t T) const
+void LSHSearch<SortPolicy>::ProjectQueries(
+    const arma::mat& queryBlock,
+    const size_t numTablesToSearch,
+    arma::mat& codesNotFloored,
+    arma::mat& codes,
+    arma::Mat<size_t>& primaryBuckets) const
 {
-  // Decide on the number of tables to look into.
-  if (numTablesToSearch == 0) // If no user input is given, search all.
-    numTablesToSearch = numTables;
-
-  // Sanity check to make sure that the existing number of tables is not
-  // exceeded.
-  if (numTablesToSearch > numTables)
-    numTablesToSearch = numTables;
-
-  // Hash the query in each of the 'numTablesToSearch' hash tables using the
-  // 'numProj' projections for each table. This gives us 'numTablesToSearch'
-  // keys for the query where each key is a 'numProj' dimensional integer
-  // vector.
-
-  // Compute the projection of the query in each table.
-  arma::mat allProjInTables(numProj, numTablesToSearch);
-  arma::mat queryCodesNotFloored(numProj, numTablesToSearch);
-  for (size_t i = 0; i < numTablesToSearch; i++)
-    queryCodesNotFloored.unsafe_col(i) = projections.slice(i).t() * queryPoint;
-
-  queryCodesNotFloored += offsets.cols(0, numTablesToSearch - 1);
-  allProjInTables = arma::floor(queryCodesNotFloored / hashWidth);
-
-  // Use hashMat to store the primary probing codes and any additional codes
-  // from multiprobe LSH.
-  arma::Mat<size_t> hashMat;
-  hashMat.set_size(T + 1, numTablesToSearch);
-
-  // Compute the primary hash value of each key of the query into a bucket of
-  // the secondHashTable using the secondHashWeights.
-  hashMat.row(0) = arma::conv_to<arma::Row<size_t>> // Floor by typecasting
-      ::from(secondHashWeights.t() * allProjInTables);
+  // The projection tables are stored contiguously in the cube, so the first
+  // 'numTablesToSearch' tables can be used as a single matrix of size
+  // dims x (numProj * numTablesToSearch).  Then all of the queries in the block
+  // can be projected into all of the tables with one matrix multiplication.
+  const arma::mat allProjections(const_cast<double*>(projections.memptr()),
+      projections.n_rows, numProj * numTablesToSearch, false, true);
+  codesNotFloored = allProjections.t() * queryBlock;
+
+  // The offsets are also stored contiguously, in the same order as the rows of
+  // codesNotFloored.
+  const arma::vec allOffsets(const_cast<double*>(offsets.memptr()),
+      numProj * numTablesToSearch, false, true);
+  codesNotFloored.each_col() += allOffsets;
+  codes = arma::floor(codesNotFloored / hashWidth);
+
+  // Compute the primary hash value of each key of each query into a bucket of
+  // the secondHashTable using the secondHashWeights.  Viewing the codes as a
+  // matrix with one key per column, this is again a single multiplication.
+  const arma::mat keys(codes.memptr(), numProj,
+      numTablesToSearch * codes.n_cols, false, true);
+  const arma::Row<size_t> hashes = arma::conv_to<arma::Row<size_t>> // Floor by
+      ::from(secondHashWeights.t() * keys);                         // typecast.
+
   // Mod to compute 2nd-level codes.
-  for (size_t i = 0; i < numTablesToSearch; i++)
-    hashMat(0, i) = (hashMat(0, i) % secondHashSize);
+  primaryBuckets.set_size(numTablesToSearch, codes.n_cols);
+  for (size_t i = 0; i < hashes.n_elem; ++i)
+    primaryBuckets[i] = hashes[i] % secondHashSize;
+}
 
-  // Compute hash codes of additional probing bins.
-  if (T > 0)
+template<typename SortPolicy>
+inline force_inline
+void LSHSearch<SortPolicy>::AddBucketCandidates(
+    const size_t hashInd,
+    arma::Col<size_t>& candidateStamps,
+    const size_t stamp,
+    arma::uvec& candidates,
+    size_t& numCandidates) const
+{
+  // Find the row of the bucket; if the bucket is empty, there is nothing to do.
+  const size_t tableRow = bucketRowInHashTable[hashInd];
+  if (tableRow >= secondHashSize)
+    return;
+
+  // Points inserted since the last compaction are held in the overflow table.
+  const size_t numOverflow = (tableRow < overflowTable.size()) ?
+      overflowTable[tableRow].size() : 0;
+
+  // Rows created since the last compaction have no entries in the CSR table.
+  size_t begin = 0, end = 0;
+  if (tableRow + 1 < bucketOffsets.n_elem)
   {
-    for (size_t i = 0; i < numTablesToSearch; ++i)
-    {
-      // Construct this table's probing sequence of length T.
-      arma::mat additionalProbingBins;
-      GetAdditionalProbingBins(allProjInTables.unsafe_col(i),
-                                queryCodesNotFloored.unsafe_col(i),
-                                T,
-                                additionalProbingBins);
+    begin = bucketOffsets[tableRow];
+    end = bucketOffsets[tableRow + 1];
+  }
 
-      // Map each probing bin to a bin in secondHashTable (just like we did for
-      // the primary hash table).
-      hashMat(arma::span(1, T), i) = // Compute code of rows 1:end of column i
-        arma::conv_to< arma::Col<size_t> >:: // floor by typecasting to size_t
-        from(secondHashWeights.t() * additionalProbingBins);
-      for (size_t p = 1; p < T + 1; ++p)
-        hashMat(p, i) = (hashMat(p, i) % secondHashSize);
+  // Make sure the buffer can hold every point in the bucket.  Growing
+  // geometrically means that a thread's buffer quickly stops being resized.
+  const size_t bucketPoints = (end - begin) + numOverflow;
+  if (numCandidates + bucketPoints > candidates.n_elem)
+    candidates.resize(std::max(2 * candidates.n_elem,
+        numCandidates + bucketPoints));
+
+  // Store every point in the bucket that hasn't already been seen for this
+  // query, skipping points that have been removed.
+  for (size_t j = begin; j < end; ++j)
+  {
+    const size_t index = secondHashTable[j];
+    if (index != tombstone && candidateStamps[index] != stamp)
+    {
+      candidateStamps[index] = stamp;
+      candidates[numCandidates++] = index;
     }
   }
 
-  // Count number of points hashed in the same bucket as the query.
-  size_t maxNumPoints = 0;
-  for (size_t i = 0; i < numTablesToSearch; ++i)
+  for (size_t j = 0; j < numOverflow; ++j)
   {
-    for (size_t p = 0; p < T + 1; ++p)
+    const size_t index = overflowTable[tableRow][j];
+    if (candidateStamps[index] != stamp)
     {
-      const size_t hashInd = hashMat(p, i); // find query's bucket
-      const size_t tableRow = bucketRowInHashTable[hashInd];
-      if (tableRow < secondHashSize)
-        maxNumPoints += bucketContentSize[tableRow]; // count bucket contents
+      candidateStamps[index] = stamp;
+      candidates[numCandidates++] = index;
     }
   }
+}
 
-  // There are two ways to proceed here:
-  // Either allocate a maxNumPoints-size vector, place all candidates, and run
-  // unique on the vector to discard duplicates.
-  // Or allocate a referenceSet->n_cols size vector (i.e. number of reference
-  // points) of zeros, and mark found indices as 1.
-  // Option 1 runs faster for small maxNumPoints but worse for larger values, so
-  // we choose based on a heuristic.
-  const float cutoff = 0.1;
-  const float selectivity = static_cast<float>(maxNumPoints) /
-      static_cast<float>(referenceSet->n_cols);
-
-  if (selectivity > cutoff)
+template<typename SortPolicy>
+size_t LSHSearch<SortPolicy>::ReturnIndicesFromTable(
+    const arma::mat& queryCodesNotFloored,
+    const arma::mat& queryCodes,
+    const size_t* primaryBuckets,
+    const size_t T,
+    arma::Col<size_t>& candidateStamps,
+    const size_t stamp,
+    arma::uvec& candidates) const
+{
+  size_t numCandidates = 0;
+  for (size_t i = 0; i < queryCodes.n_cols; ++i) // For all tables.
   {
-    // Heuristic: larger maxNumPoints means we should use find() because it
-    // should be faster.
-    // Reference points hashed in the same bucket as the query are set to >0.
-    arma::Col<size_t> refPointsConsidered;
-    refPointsConsidered.zeros(referenceSet->n_cols);
+    // Retrieve the candidates from the query's bucket.
+    AddBucketCandidates(primaryBuckets[i], candidateStamps, stamp, candidates,
+        numCandidates);
 
-    for (size_t i = 0; i < numTablesToSearch; ++i) // for all tables
+    // Retrieve the candidates from any additional probing bins.
+    if (T > 0)
     {
-      for (size_t p = 0; p < T + 1; ++p) // For entire probing sequence.
-      {
-        // get the sequence code
-        size_t hashInd = hashMat(p, i);
-        size_t tableRow = bucketRowInHashTable[hashInd];
+      // Construct this table's probing sequence of length T.
+      arma::mat additionalProbingBins;
+      GetAdditionalProbingBins(queryCodes.unsafe_col(i),
+                               queryCodesNotFloored.unsafe_col(i),
+                               T,
+                               additionalProbingBins);
 
-        if (tableRow < secondHashSize && bucketContentSize[tableRow] > 0)
-        {
-          // Pick the indices in the bucket corresponding to hashInd.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsidered[ secondHashTable[tableRow](j) ]++;
-        }
+      // Map each probing bin to a bin in secondHashTable (just like we did for
+      // the primary hash table).
+      const arma::Row<size_t> additionalBuckets =
+          arma::conv_to<arma::Row<size_t>>:: // Floor by typecasting to size_t.
+          from(secondHashWeights.t() * additionalProbingBins);
+      for (size_t p = 0; p < T; ++p)
+      {
+        AddBucketCandidates(additionalBuckets[p] % secondHashSize,
+            candidateStamps, stamp, candidates, numCandidates);
       }
     }
-
-    // Only keep reference points found in at least one bucket.
-    referenceIndices = arma::find(refPointsConsidered > 0);
-    return;
   }
-  else
-  {
-    // Heuristic: smaller maxNumPoints means we should use unique() because it
-    // should be faster.
-    // Allocate space for the query's potential neighbors.
-    arma::uvec refPointsConsideredSmall;
-    refPointsConsideredSmall.zeros(maxNumPoints);
 
-    // Retrieve candidates.
-    size_t start = 0;
+  return numCandidates;
+}
 
-    for (size_t i = 0; i < numTablesToSearch; ++i) // For all tables
-    {
-      for (size_t p = 0; p < T + 1; ++p)
-      {
-        const size_t hashInd =  hashMat(p, i); // Find the query's bucket.
-        const size_t tableRow = bucketRowInHashTable[hashInd];
+// Get the second hash table with one element per bucket.
+template<typename SortPolicy>
+std::vector<arma::Col<size_t>> LSHSearch<SortPolicy>::SecondHashTableBuckets()
+    const
+{
+  // Rows created by Insert() since the last compaction exist only in the
+  // overflow table.
+  const size_t numCSRRows = (bucketOffsets.n_elem == 0) ? 0 :
+      bucketOffsets.n_elem - 1;
+  const size_t numRows = std::max(numCSRRows, overflowTable.size());
+
+  std::vector<arma::Col<size_t>> buckets(numRows);
+  for (size_t i = 0; i < numRows; ++i)
+  {
+    const size_t begin = (i < numCSRRows) ? bucketOffsets[i] : 0;
+    const size_t end = (i < numCSRRows) ? bucketOffsets[i + 1] : 0;
+    const size_t numOverflow = (i < overflowTable.size()) ?
+        overflowTable[i].size() : 0;
+    buckets[i].set_size(end - begin + numOverflow);
+
+    // Skip any points that have been removed.
+    size_t position = 0;
+    for (size_t j = begin; j < end; ++j)
+      if (secondHashTable[j] != tombstone)
+        buckets[i][position++] = secondHashTable[j];
+    for (size_t j = 0; j < numOverflow; ++j)
+      buckets[i][position++] = overflowTable[i][j];
+
+    buckets[i].resize(position);
+  }
 
-        if (tableRow < secondHashSize)
-        {
-          // Store all secondHashTable points in the candidates set.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsideredSmall(start++) = secondHashTable[tableRow](j);
-       }
-      }
-    }
+  return buckets;
+}
 
-    // Keep only one copy of each candidate.
-    referenceIndices = arma::unique(refPointsConsideredSmall);
-    return;
-  }
+// Make sure that there is a stamp array for each thread.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::PrepareCandidateStamps()
+{
+  size_t threads = 1;
+  #ifdef HAS_OPENMP
+    threads = omp_get_max_threads();
+  #endif
+
+  if (threadCandidateStamps.size() < threads)
+    threadCandidateStamps.resize(threads);
+
+  // Points may have been inserted since the last search.  Any new entries are
+  // filled with 0, which is never used as a stamp.
+  for (size_t i = 0; i < threadCandidateStamps.size(); ++i)
+    if (threadCandidateStamps[i].n_elem < referenceSet->n_cols)
+      threadCandidateStamps[i].resize(referenceSet->n_cols);
 }
 
 // Search for nearest neighbors in a given query set.
@@ -897,12 +1021,13 @@ void LSHSearch<SortPolicy>::Search(const arma::mat& querySet,
     throw std::invalid_argument(oss.str());
   }
 
-  if (k > referenceSet->n_cols)
+  // Removed points are still in the reference set, but can't be returned.
+  if (k > referenceSet->n_cols - numRemoved)
   {
     std::ostringstream oss;
     oss << "LSHSearch::Search(): requested " << k << " approximate nearest "
-        << "neighbors, but reference set has " << referenceSet->n_cols
-        << " points!" << std::endl;
+        << "neighbors, but reference set has " << referenceSet->n_cols -
+        numRemoved << " points!" << std::endl;
     throw std::invalid_argument(oss.str());
   }
 
@@ -914,6 +1039,11 @@ void LSHSearch<SortPolicy>::Search(const arma::mat& querySet,
   if (k == 0)
     return;
 
+  // Decide on the number of tables to look into.  If no user input is given,
+  // or too many tables are requested, search all of them.
+  const size_t tablesToSearch = (numTablesToSearch == 0 ||
+      numTablesToSearch > numTables) ? numTables : numTablesToSearch;
+
   // If the user requested more than the available number of additional probing
   // bins, set Teffective to maximum T. Maximum T is 2^numProj - 1
   size_t Teffective = T;
@@ -931,32 +1061,66 @@ void LSHSearch<SortPolicy>::Search(const arma::mat& querySet,
         <<" additional probing bins per table per query." << std::endl;
 
   size_t avgIndicesReturned = 0;
+  const size_t numBlocks = (querySet.n_cols + queryBlockSize - 1) /
+      queryBlockSize;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
+  // Each query gets a stamp that is distinct from those of every earlier
+  // search, so that the stamp arrays never need to be cleared.
+  PrepareCandidateStamps();
+  const size_t firstStamp = nextStamp;
+  nextStamp += querySet.n_cols;
+
+  // Parallelization to process more than one block of queries at a time.  Each
+  // thread holds its own candidate buffers, so that no allocation is needed for
+  // each individual query.
+  #pragma omp parallel \
       shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
       reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running
-    // #pragma omp atomic
-    avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    size_t threadId = 0;
+    #ifdef HAS_OPENMP
+      threadId = omp_get_thread_num();
+    #endif
+    arma::Col<size_t>& threadStamps = threadCandidateStamps[threadId];
+    arma::uvec candidates;
+    arma::mat codesNotFloored, codes;
+    arma::Mat<size_t> primaryBuckets;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+    {
+      // Hash every query in the block into every hash table.
+      const size_t begin = b * queryBlockSize;
+      const size_t end = std::min(begin + queryBlockSize,
+          (size_t) querySet.n_cols);
+      ProjectQueries(querySet.cols(begin, end - 1), tablesToSearch,
+          codesNotFloored, codes, primaryBuckets);
+
+      for (size_t i = begin; i < end; ++i)
+      {
+        // Now hash the query into the 'secondHashTable' to obtain the neighbor
+        // candidates.
+        const arma::mat queryCodesNotFloored(codesNotFloored.colptr(i - begin),
+            numProj, tablesToSearch, false, true);
+        const arma::mat queryCodes(codes.colptr(i - begin), numProj,
+            tablesToSearch, false, true);
+        const size_t numCandidates = ReturnIndicesFromTable(
+            queryCodesNotFloored, queryCodes, primaryBuckets.colptr(i - begin),
+            Teffective, threadStamps, firstStamp + i + 1, candidates);
+
+        // An informative book-keeping for the number of neighbor candidates
+        // returned on average.
+        avgIndicesReturned += numCandidates;
+
+        // Sequentially go through all the candidates and save the best 'k'
+        // candidates.
+        const arma::uvec refIndices(candidates.memptr(), numCandidates, false,
+            true);
+        BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+      }
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -980,6 +1144,11 @@ Search(const size_t k,
   resultingNeighbors.set_size(k, referenceSet->n_cols);
   distances.set_size(k, referenceSet->n_cols);
 
+  // Decide on the number of tables to look into.  If no user input is given,
+  // or too many tables are requested, search all of them.
+  const size_t tablesToSearch = (numTablesToSearch == 0 ||
+      numTablesToSearch > numTables) ? numTables : numTablesToSearch;
+
   // If the user requested more than the available number of additional probing
   // bins, set Teffective to maximum T. Maximum T is 2^numProj - 1
   size_t Teffective = T;
@@ -997,32 +1166,66 @@ Search(const size_t k,
       " additional probing bins per table per query."<< std::endl;
 
   size_t avgIndicesReturned = 0;
+  const size_t numBlocks = (referenceSet->n_cols + queryBlockSize - 1) /
+      queryBlockSize;
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
+  // Each query gets a stamp that is distinct from those of every earlier
+  // search, so that the stamp arrays never need to be cleared.
+  PrepareCandidateStamps();
+  const size_t firstStamp = nextStamp;
+  nextStamp += referenceSet->n_cols;
+
+  // Parallelization to process more than one block of queries at a time.  Each
+  // thread holds its own candidate buffers, so that no allocation is needed for
+  // each individual query.
+  #pragma omp parallel \
       shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
       reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(referenceSet->col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running.
-    // #pragma omp atomic
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    size_t threadId = 0;
+    #ifdef HAS_OPENMP
+      threadId = omp_get_thread_num();
+    #endif
+    arma::Col<size_t>& threadStamps = threadCandidateStamps[threadId];
+    arma::uvec candidates;
+    arma::mat codesNotFloored, codes;
+    arma::Mat<size_t> primaryBuckets;
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+    {
+      // Hash every query in the block into every hash table.
+      const size_t begin = b * queryBlockSize;
+      const size_t end = std::min(begin + queryBlockSize,
+          (size_t) referenceSet->n_cols);
+      ProjectQueries(referenceSet->cols(begin, end - 1), tablesToSearch,
+          codesNotFloored, codes, primaryBuckets);
+
+      for (size_t i = begin; i < end; ++i)
+      {
+        // Now hash the query into the 'secondHashTable' to obtain the neighbor
+        // candidates.
+        const arma::mat queryCodesNotFloored(codesNotFloored.colptr(i - begin),
+            numProj, tablesToSearch, false, true);
+        const arma::mat queryCodes(codes.colptr(i - begin), numProj,
+            tablesToSearch, false, true);
+        const size_t numCandidates = ReturnIndicesFromTable(
+            queryCodesNotFloored, queryCodes, primaryBuckets.colptr(i - begin),
+            Teffective, threadStamps, firstStamp + i + 1, candidates);
+
+        // An informative book-keeping for the number of neighbor candidates
+        // returned on average.
+        avgIndicesReturned += numCandidates;
+
+        // Sequentially go through all the candidates and save the best 'k'
+        // candidates.
+        const arma::uvec refIndices(candidates.memptr(), numCandidates, false,
+            true);
+        BaseCase(i, refIndices, k, resultingNeighbors, distances);
+      }
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -1033,6 +1236,235 @@ Search(const size_t k,
       std::endl;
 }
 
+// Insert new points into the model.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Insert(const arma::mat& newPoints)
+{
+  if (bucketOffsets.n_elem == 0)
+  {
+    throw std::invalid_argument("LSHSearch::Insert(): the model must be "
+        "trained before points can be inserted!");
+  }
+
+  if (newPoints.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Insert(): dimensionality of new points ("
+        << newPoints.n_rows << ") is not equal to the dimensionality the model "
+        << "was trained on (" << referenceSet->n_rows << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t oldSize = referenceSet->n_cols;
+  if (oldSize + newPoints.n_cols > std::numeric_limits<uint32_t>::max())
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Insert(): inserting " << newPoints.n_cols << " points "
+        << "would give more than " << std::numeric_limits<uint32_t>::max()
+        << " points, which is not supported!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // We have to modify the reference set, so we need our own copy of it.
+  arma::mat* newReferenceSet = ownsSet ? const_cast<arma::mat*>(referenceSet) :
+      new arma::mat(*referenceSet);
+  newReferenceSet->insert_cols(oldSize, newPoints);
+  referenceSet = newReferenceSet;
+  ownsSet = true;
+
+  // Hash the new points into each table.
+  arma::Mat<size_t> secondHashVectors;
+  SecondHashKeys(newPoints, secondHashVectors);
+
+  // Every row must have a (possibly empty) list in the overflow table.
+  const size_t numCSRRows = bucketOffsets.n_elem - 1;
+  if (overflowTable.size() < numCSRRows)
+    overflowTable.resize(numCSRRows);
+
+  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      // If this is currently an empty bucket, start a new row.
+      const size_t hashInd = secondHashVectors(i, j);
+      if (bucketRowInHashTable[hashInd] == secondHashSize)
+      {
+        bucketRowInHashTable[hashInd] = overflowTable.size();
+        overflowTable.emplace_back();
+      }
+
+      // Add the point only if the bucket is not full.
+      const size_t row = bucketRowInHashTable[hashInd];
+      const size_t rowSize = overflowTable[row].size() + ((row < numCSRRows) ?
+          bucketOffsets[row + 1] - bucketOffsets[row] : 0);
+      if (rowSize < effectiveBucketSize)
+      {
+        overflowTable[row].push_back((uint32_t) (oldSize + j));
+        ++overflowSize;
+      }
+    }
+  }
+
+  if (overflowSize + numTombstones > secondHashTable.n_elem / 4)
+    Compact();
+}
+
+// Remove points from the model.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Remove(const arma::uvec& indices)
+{
+  if (bucketOffsets.n_elem == 0)
+  {
+    throw std::invalid_argument("LSHSearch::Remove(): the model must be "
+        "trained before points can be removed!");
+  }
+
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    if (indices[i] >= referenceSet->n_cols)
+    {
+      std::ostringstream oss;
+      oss << "LSHSearch::Remove(): index " << indices[i] << " is out of range "
+          << "(reference set has " << referenceSet->n_cols << " points)!"
+          << std::endl;
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  // Mark the points as removed, skipping any that already were.
+  if (removedPoints.size() < referenceSet->n_cols)
+    removedPoints.resize(referenceSet->n_cols, false);
+  arma::uvec newIndices(indices.n_elem);
+  size_t numNewIndices = 0;
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    if (!removedPoints[indices[i]])
+    {
+      removedPoints[indices[i]] = true;
+      newIndices[numNewIndices++] = indices[i];
+    }
+  }
+  newIndices.resize(numNewIndices);
+  numRemoved += numNewIndices;
+
+  // Find the buckets that each point was hashed into.
+  arma::Mat<size_t> secondHashVectors;
+  SecondHashKeys(referenceSet->cols(newIndices), secondHashVectors);
+
+  const size_t numCSRRows = bucketOffsets.n_elem - 1;
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < newIndices.n_elem; ++j)
+    {
+      const size_t row = bucketRowInHashTable[secondHashVectors(i, j)];
+      if (row == secondHashSize)
+        continue;
+
+      // The point appears at most once per table, so we only remove one copy.
+      // It can be in the CSR table, where it is replaced with a tombstone...
+      bool found = false;
+      if (row < numCSRRows)
+      {
+        for (size_t k = bucketOffsets[row]; k < bucketOffsets[row + 1]; ++k)
+        {
+          if (secondHashTable[k] == newIndices[j])
+          {
+            secondHashTable[k] = tombstone;
+            ++numTombstones;
+            found = true;
+            break;
+          }
+        }
+      }
+
+      // ...or it can be in the overflow table, where it can just be erased.
+      if (!found && row < overflowTable.size())
+      {
+        std::vector<uint32_t>& overflowRow = overflowTable[row];
+        for (size_t k = 0; k < overflowRow.size(); ++k)
+        {
+          if (overflowRow[k] == newIndices[j])
+          {
+            overflowRow[k] = overflowRow.back();
+            overflowRow.pop_back();
+            --overflowSize;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  if (overflowSize + numTombstones > secondHashTable.n_elem / 4)
+    Compact();
+}
+
+// Merge the overflow table into the CSR table and drop all tombstones.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Compact()
+{
+  if (bucketOffsets.n_elem == 0)
+  {
+    throw std::invalid_argument("LSHSearch::Compact(): the model must be "
+        "trained before it can be compacted!");
+  }
+
+  if (overflowSize == 0 && numTombstones == 0)
+  {
+    overflowTable.clear();
+    return;
+  }
+
+  const size_t numCSRRows = bucketOffsets.n_elem - 1;
+  const size_t numRows = std::max(numCSRRows, overflowTable.size());
+
+  // Count the live points in each row.
+  arma::Col<size_t> rowSizes(numRows, arma::fill::zeros);
+  for (size_t row = 0; row < numCSRRows; ++row)
+    for (size_t k = bucketOffsets[row]; k < bucketOffsets[row + 1]; ++k)
+      if (secondHashTable[k] != tombstone)
+        ++rowSizes[row];
+  for (size_t row = 0; row < overflowTable.size(); ++row)
+    rowSizes[row] += overflowTable[row].size();
+
+  // Rows that are now empty are dropped, so we have to renumber the rows.
+  arma::Col<size_t> newRow(numRows);
+  size_t numNewRows = 0;
+  for (size_t row = 0; row < numRows; ++row)
+    newRow[row] = (rowSizes[row] > 0) ? numNewRows++ : secondHashSize;
+  for (size_t i = 0; i < bucketRowInHashTable.n_elem; ++i)
+    if (bucketRowInHashTable[i] != secondHashSize)
+      bucketRowInHashTable[i] = newRow[bucketRowInHashTable[i]];
+
+  // Now build the new CSR table.
+  arma::Col<size_t> newOffsets(numNewRows + 1);
+  newOffsets[0] = 0;
+  arma::Col<uint32_t> newTable(arma::accu(rowSizes));
+  for (size_t row = 0; row < numRows; ++row)
+  {
+    if (newRow[row] == secondHashSize)
+      continue;
+
+    size_t position = newOffsets[newRow[row]];
+    if (row < numCSRRows)
+      for (size_t k = bucketOffsets[row]; k < bucketOffsets[row + 1]; ++k)
+        if (secondHashTable[k] != tombstone)
+          newTable[position++] = secondHashTable[k];
+    if (row < overflowTable.size())
+      for (size_t k = 0; k < overflowTable[row].size(); ++k)
+        newTable[position++] = overflowTable[row][k];
+
+    newOffsets[newRow[row] + 1] = position;
+  }
+
+  secondHashTable = std::move(newTable);
+  bucketOffsets = std::move(newOffsets);
+  overflowTable.clear();
+  overflowSize = 0;
+  numTombstones = 0;
+}
+
 template<typename SortPolicy>
 double LSHSearch<SortPolicy>::ComputeRecall(
     const arma::Mat<size_t>& foundNeighbors,
@@ -1067,12 +1499,25 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
 {
   using data::CreateNVP;
 
+  // Any points inserted or removed since the last compaction are merged into
+  // the CSR table before saving, so that the format does not change.
+  if (Archive::is_saving::value && bucketOffsets.n_elem > 0)
+    Compact();
+
   // If we are loading, we are going to own the reference set.
   if (Archive::is_loading::value)
   {
     if (ownsSet)
       delete referenceSet;
     ownsSet = true;
+
+    overflowTable.clear();
+    overflowSize = 0;
+    numTombstones = 0;
+    removedPoints.clear();
+    numRemoved = 0;
+    threadCandidateStamps.clear();
+    nextStamp = 0;
   }
   ar & CreateNVP(referenceSet, "referenceSet");
 
@@ -1104,81 +1549,105 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
   ar & CreateNVP(secondHashSize, "secondHashSize");
   ar & CreateNVP(secondHashWeights, "secondHashWeights");
   ar & CreateNVP(bucketSize, "bucketSize");
-  // needs specific handling for new version
 
-  // Backward compatibility: in older versions of LSHSearch, the secondHashTable
-  // was stored as an arma::Mat<size_t>.  So we need to properly load that, then
-  // prune it down to size.
-  if (version == 0)
+  // Current versions of LSHSearch store the second hash table in CSR format.
+  if (version >= 2)
+  {
+    ar & CreateNVP(secondHashTable, "secondHashTable");
+    ar & CreateNVP(bucketOffsets, "bucketOffsets");
+    ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
+  }
+  else
   {
-    arma::Mat<size_t> tmpSecondHashTable;
-    ar & CreateNVP(tmpSecondHashTable, "secondHashTable");
+    // Older versions can only be loaded.  We load the old representation of
+    // the second hash table (one vector per row), and then pack it.
+    std::vector<arma::Col<size_t>> tmpSecondHashTable;
+    arma::Col<size_t> bucketContentSize;
+
+    // Backward compatibility: in version 0, the secondHashTable was stored as
+    // an arma::Mat<size_t>.  So we need to properly load that, then prune it
+    // down to size.
+    if (version == 0)
+    {
+      arma::Mat<size_t> tmpSecondHashMat;
+      ar & CreateNVP(tmpSecondHashMat, "secondHashTable");
 
-    // The old secondHashTable was stored in row-major format, so we transpose
-    // it.
-    tmpSecondHashTable = tmpSecondHashTable.t();
+      // The old secondHashTable was stored in row-major format, so we
+      // transpose it.
+      tmpSecondHashMat = tmpSecondHashMat.t();
 
-    secondHashTable.resize(tmpSecondHashTable.n_cols);
-    for (size_t i = 0; i < tmpSecondHashTable.n_cols; ++i)
+      tmpSecondHashTable.resize(tmpSecondHashMat.n_cols);
+      for (size_t i = 0; i < tmpSecondHashMat.n_cols; ++i)
+      {
+        // Find length of each column.  We know we are at the end of the list
+        // when the value referenceSet->n_cols is seen.
+        size_t len = 0;
+        for (; len < tmpSecondHashMat.n_rows; ++len)
+          if (tmpSecondHashMat(len, i) == referenceSet->n_cols)
+            break;
+
+        // Set the size of the new column correctly.
+        tmpSecondHashTable[i].set_size(len);
+        for (size_t j = 0; j < len; ++j)
+          tmpSecondHashTable[i](j) = tmpSecondHashMat(j, i);
+      }
+    }
+    else
     {
-      // Find length of each column.  We know we are at the end of the list when
-      // the value referenceSet->n_cols is seen.
-
-      size_t len = 0;
-      for (; len < tmpSecondHashTable.n_rows; ++len)
-        if (tmpSecondHashTable(len, i) == referenceSet->n_cols)
-          break;
+      size_t tables;
+      ar & CreateNVP(tables, "numSecondHashTables");
 
-      // Set the size of the new column correctly.
-      secondHashTable[i].set_size(len);
-      for (size_t j = 0; j < len; ++j)
-        secondHashTable[i](j) = tmpSecondHashTable(j, i);
+      tmpSecondHashTable.resize(tables);
+      for (size_t i = 0; i < tmpSecondHashTable.size(); ++i)
+      {
+        std::ostringstream oss;
+        oss << "secondHashTable" << i;
+        ar & CreateNVP(tmpSecondHashTable[i], oss.str());
+      }
     }
-  }
-  else
-  {
-    size_t tables;
-    if (Archive::is_saving::value)
-      tables = secondHashTable.size();
-    ar & CreateNVP(tables, "numSecondHashTables");
 
-    // Set size of second hash table if needed.
-    if (Archive::is_loading::value)
+    // Backward compatibility: version 0 held bucketContentSize for all
+    // possible buckets (of size secondHashSize), but version 1 holds a
+    // compressed representation.
+    if (version == 0)
     {
-      secondHashTable.clear();
-      secondHashTable.resize(tables);
+      // The vector was stored in the old uncompressed form.  So we need to
+      // shrink it.  But we can't do that until we have bucketRowInHashTable, so
+      // we also have to load that.
+      arma::Col<size_t> tmpBucketContentSize;
+      ar & CreateNVP(tmpBucketContentSize, "bucketContentSize");
+      ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
+
+      // Compress into a smaller vector by just dropping all of the zeros.
+      bucketContentSize.zeros(tmpSecondHashTable.size());
+      for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
+        if (tmpBucketContentSize[i] > 0)
+          bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
     }
-
-    for (size_t i = 0; i < secondHashTable.size(); ++i)
+    else
     {
-      std::ostringstream oss;
-      oss << "secondHashTable" << i;
-      ar & CreateNVP(secondHashTable[i], oss.str());
+      ar & CreateNVP(bucketContentSize, "bucketContentSize");
+      ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
     }
-  }
 
-  // Backward compatibility: old versions of LSHSearch held bucketContentSize
-  // for all possible buckets (of size secondHashSize), but now we hold a
-  // compressed representation.
-  if (version == 0)
-  {
-    // The vector was stored in the old uncompressed form.  So we need to shrink
-    // it.  But we can't do that until we have bucketRowInHashTable, so we also
-    // have to load that.
-    arma::Col<size_t> tmpBucketContentSize;
-    ar & CreateNVP(tmpBucketContentSize, "bucketContentSize");
-    ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
+    // Now pack the rows into CSR format.
+    bucketOffsets.zeros(tmpSecondHashTable.size() + 1);
+    for (size_t i = 0; i < tmpSecondHashTable.size(); ++i)
+      bucketOffsets[i + 1] = bucketOffsets[i] + bucketContentSize[i];
 
-    // Compress into a smaller vector by just dropping all of the zeros.
-    bucketContentSize.set_size(secondHashTable.size());
-    for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
-      if (tmpBucketContentSize[i] > 0)
-        bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
+    secondHashTable.set_size(bucketOffsets[tmpSecondHashTable.size()]);
+    for (size_t i = 0; i < tmpSecondHashTable.size(); ++i)
+      for (size_t j = 0; j < bucketContentSize[i]; ++j)
+        secondHashTable[bucketOffsets[i] + j] = tmpSecondHashTable[i][j];
   }
-  else
+
+  // Removed points are kept in the reference set, so we have to remember which
+  // they are.  Older versions did not support removal.
+  if (version >= 3)
   {
-    ar & CreateNVP(bucketContentSize, "bucketContentSize");
-    ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
+    ar & CreateNVP(removedPoints, "removedPoints");
+    if (Archive::is_loading::value)
+      numRemoved = std::count(removedPoints.begin(), removedPoints.end(), true);
   }
 
   ar & CreateNVP(distanceEvaluations, "distanceEvaluations");
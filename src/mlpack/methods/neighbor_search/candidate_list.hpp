@@ -0,0 +1,347 @@
+/**
+ * @file candidate_list.hpp
+ * @author agent
+ *
+ * Policies for holding the k best candidate neighbors of each query point
+ * during a neighbor search.  SortedCandidateList keeps each list in a sorted
+ * array, which is fastest for the small values of k usually used;
+ * HeapCandidateList keeps each list in a binary heap, which is faster for large
+ * k; AdaptiveCandidateList chooses between the two based on k.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_CANDIDATE_LIST_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_CANDIDATE_LIST_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <queue>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The SortedCandidateList holds the k best candidates of every query point in
+ * one contiguous block of memory, with the candidates of each query point
+ * sorted from best to worst.  The worst candidate of a query point is then
+ * available in constant time, and a new candidate is inserted by counting the
+ * candidates that are better than it (a loop without branches that the
+ * compiler can vectorize) and shifting the worse candidates down by one.  For
+ * small k (up to a few dozen) this is much faster than a heap; for large k,
+ * HeapCandidateList may be faster.
+ *
+ * Calling Reset() again with no more query points than before does not
+ * allocate any memory, so a list may be reused for many searches.
+ *
+ * @tparam SortPolicy The sort policy for distances.
+ */
+template<typename SortPolicy>
+class SortedCandidateList
+{
+ public:
+  //! Create an empty candidate list; call Reset() before using it.
+  SortedCandidateList() : k(0), numQueries(0) { }
+
+  /**
+   * Prepare the candidate lists for the given number of query points.  Each
+   * list will hold k candidates with the worst possible distance.
+   *
+   * @param k Number of candidates to hold for each query point.
+   * @param numQueries Number of query points.
+   */
+  void Reset(const size_t k, const size_t numQueries)
+  {
+    this->k = k;
+    this->numQueries = numQueries;
+    distances.assign(k * numQueries, SortPolicy::WorstDistance());
+    indices.assign(k * numQueries, size_t() - 1);
+  }
+
+  //! Get the distance of the worst candidate of the given query point.  If no
+  //! candidates are held, no candidate can be added, so this is the best
+  //! possible distance.
+  double WorstDistance(const size_t queryIndex) const
+  {
+    if (k == 0)
+      return SortPolicy::BestDistance();
+
+    return distances[queryIndex * k + k - 1];
+  }
+
+  /**
+   * Insert a candidate into the list of the given query point, if it is better
+   * than the worst candidate of that list.
+   *
+   * @param queryIndex Index of query point.
+   * @param neighbor Index of reference point.
+   * @param distance Distance from query point to reference point.
+   */
+  void Insert(const size_t queryIndex,
+              const size_t neighbor,
+              const double distance)
+  {
+    if (k == 0)
+      return;
+
+    double* queryDistances = distances.data() + queryIndex * k;
+    size_t* queryIndices = indices.data() + queryIndex * k;
+
+    if (SortPolicy::IsBetter(queryDistances[k - 1], distance))
+      return;
+
+    // The new candidate goes after every candidate that is at least as good.
+    size_t position = 0;
+    for (size_t i = 0; i < k - 1; ++i)
+      position += SortPolicy::IsBetter(queryDistances[i], distance);
+
+    for (size_t i = k - 1; i > position; --i)
+    {
+      queryDistances[i] = queryDistances[i - 1];
+      queryIndices[i] = queryIndices[i - 1];
+    }
+
+    queryDistances[position] = distance;
+    queryIndices[position] = neighbor;
+  }
+
+  /**
+   * Store the candidates of each query point, from best to worst, in the
+   * columns of the given matrices.
+   *
+   * @param neighbors Matrix to store indices of candidates in.
+   * @param distances Matrix to store distances of candidates in.
+   */
+  void GetResults(arma::Mat<size_t>& neighbors, arma::mat& distances)
+  {
+    neighbors.set_size(k, numQueries);
+    distances.set_size(k, numQueries);
+    std::copy(indices.begin(), indices.end(), neighbors.memptr());
+    std::copy(this->distances.begin(), this->distances.end(),
+        distances.memptr());
+  }
+
+ private:
+  //! Number of candidates held for each query point.
+  size_t k;
+  //! Number of query points.
+  size_t numQueries;
+  //! Distances of the candidates; the candidates of query point i are held in
+  //! elements [i * k, (i + 1) * k).
+  std::vector<double> distances;
+  //! Indices of the candidates, in the same order as distances.
+  std::vector<size_t> indices;
+};
+
+/**
+ * The HeapCandidateList holds the k best candidates of each query point in a
+ * binary heap with the worst candidate on top.  Inserting a candidate takes
+ * O(log k) time, so this may be faster than SortedCandidateList when k is
+ * large.
+ *
+ * @tparam SortPolicy The sort policy for distances.
+ */
+template<typename SortPolicy>
+class HeapCandidateList
+{
+ public:
+  //! Create an empty candidate list; call Reset() before using it.
+  HeapCandidateList() : k(0) { }
+
+  /**
+   * Prepare the candidate lists for the given number of query points.  Each
+   * list will hold k candidates with the worst possible distance.
+   *
+   * @param k Number of candidates to hold for each query point.
+   * @param numQueries Number of query points.
+   */
+  void Reset(const size_t k, const size_t numQueries)
+  {
+    this->k = k;
+
+    const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
+        size_t() - 1);
+    std::vector<Candidate> vect(k, def);
+    CandidateHeap pqueue(CandidateCmp(), std::move(vect));
+
+    candidates.clear();
+    candidates.resize(numQueries, pqueue);
+  }
+
+  //! Get the distance of the worst candidate of the given query point.  If no
+  //! candidates are held, no candidate can be added, so this is the best
+  //! possible distance.
+  double WorstDistance(const size_t queryIndex) const
+  {
+    if (k == 0)
+      return SortPolicy::BestDistance();
+
+    return candidates[queryIndex].top().first;
+  }
+
+  /**
+   * Insert a candidate into the list of the given query point, if it is better
+   * than the worst candidate of that list.
+   *
+   * @param queryIndex Index of query point.
+   * @param neighbor Index of reference point.
+   * @param distance Distance from query point to reference point.
+   */
+  void Insert(const size_t queryIndex,
+              const size_t neighbor,
+              const double distance)
+  {
+    if (k == 0)
+      return;
+
+    CandidateHeap& pqueue = candidates[queryIndex];
+    Candidate c = std::make_pair(distance, neighbor);
+
+    if (CandidateCmp()(c, pqueue.top()))
+    {
+      pqueue.pop();
+      pqueue.push(c);
+    }
+  }
+
+  /**
+   * Store the candidates of each query point, from best to worst, in the
+   * columns of the given matrices.  This empties the heaps.
+   *
+   * @param neighbors Matrix to store indices of candidates in.
+   * @param distances Matrix to store distances of candidates in.
+   */
+  void GetResults(arma::Mat<size_t>& neighbors, arma::mat& distances)
+  {
+    neighbors.set_size(k, candidates.size());
+    distances.set_size(k, candidates.size());
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+      CandidateHeap& pqueue = candidates[i];
+      for (size_t j = 1; j <= k; j++)
+      {
+        neighbors(k - j, i) = pqueue.top().second;
+        distances(k - j, i) = pqueue.top().first;
+        pqueue.pop();
+      }
+    }
+  }
+
+ private:
+  //! Candidate represents a possible candidate neighbor (distance, index).
+  typedef std::pair<double, size_t> Candidate;
+
+  //! Compare two candidates based on the distance.
+  struct CandidateCmp {
+    bool operator()(const Candidate& c1, const Candidate& c2)
+    {
+      return !SortPolicy::IsBetter(c2.first, c1.first);
+    };
+  };
+
+  //! Use a priority queue to represent the list of candidate neighbors.
+  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
+      CandidateHeap;
+
+  //! Number of candidates held for each query point.
+  size_t k;
+  //! Set of candidate neighbors for each point.
+  std::vector<CandidateHeap> candidates;
+};
+
+/**
+ * The AdaptiveCandidateList uses a SortedCandidateList when k is small enough
+ * for its O(k) insertions to be faster than the O(log k) insertions of a heap,
+ * and a HeapCandidateList otherwise.  The choice is made each time Reset() is
+ * called, so a single NeighborSearch object works well for any k.  This is the
+ * default candidate list of NeighborSearch.
+ *
+ * @tparam SortPolicy The sort policy for distances.
+ */
+template<typename SortPolicy>
+class AdaptiveCandidateList
+{
+ public:
+  //! The largest k for which a SortedCandidateList is used.
+  static const size_t MaxSortedK = 32;
+
+  //! Create an empty candidate list; call Reset() before using it.
+  AdaptiveCandidateList() : useSorted(true) { }
+
+  /**
+   * Prepare the candidate lists for the given number of query points.  Each
+   * list will hold k candidates with the worst possible distance.
+   *
+   * @param k Number of candidates to hold for each query point.
+   * @param numQueries Number of query points.
+   */
+  void Reset(const size_t k, const size_t numQueries)
+  {
+    useSorted = (k <= MaxSortedK);
+    if (useSorted)
+    {
+      sorted.Reset(k, numQueries);
+      heap.Reset(0, 0);
+    }
+    else
+    {
+      heap.Reset(k, numQueries);
+      sorted.Reset(0, 0);
+    }
+  }
+
+  //! Get the distance of the worst candidate of the given query point.
+  double WorstDistance(const size_t queryIndex) const
+  {
+    return useSorted ? sorted.WorstDistance(queryIndex) :
+        heap.WorstDistance(queryIndex);
+  }
+
+  /**
+   * Insert a candidate into the list of the given query point, if it is better
+   * than the worst candidate of that list.
+   *
+   * @param queryIndex Index of query point.
+   * @param neighbor Index of reference point.
+   * @param distance Distance from query point to reference point.
+   */
+  void Insert(const size_t queryIndex,
+              const size_t neighbor,
+              const double distance)
+  {
+    if (useSorted)
+      sorted.Insert(queryIndex, neighbor, distance);
+    else
+      heap.Insert(queryIndex, neighbor, distance);
+  }
+
+  /**
+   * Store the candidates of each query point, from best to worst, in the
+   * columns of the given matrices.
+   *
+   * @param neighbors Matrix to store indices of candidates in.
+   * @param distances Matrix to store distances of candidates in.
+   */
+  void GetResults(arma::Mat<size_t>& neighbors, arma::mat& distances)
+  {
+    if (useSorted)
+      sorted.GetResults(neighbors, distances);
+    else
+      heap.GetResults(neighbors, distances);
+  }
+
+ private:
+  //! Whether the sorted list is in use (otherwise the heap is).
+  bool useSorted;
+  //! The list used when k is small.
+  SortedCandidateList<SortPolicy> sorted;
+  //! The list used when k is large.
+  HeapCandidateList<SortPolicy> heap;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
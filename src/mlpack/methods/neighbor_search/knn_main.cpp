@@ -103,6 +103,58 @@ PARAM_FLAG("single_mode", "(Deprecated) If true, single-tree search is used "
     "'--algorithm single_tree' instead.", "S");
 PARAM_DOUBLE_IN("epsilon", "If specified, will do approximate nearest neighbor "
     "search with given relative error.", "e", 0);
+PARAM_FLAG("float", "If set, the tree is built and searched in single "
+    "precision, which uses half the memory; the distances to the neighbors "
+    "that are found are then recomputed in double precision.  Only 'kd' and "
+    "'ball' trees are supported, and models cannot be loaded or saved.", "f");
+
+// Search in single precision with the given type of tree, then recompute the
+// distances to the neighbors that were found (and their order) in double
+// precision.  If the query set is empty, the reference set is searched.
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void SearchFloat(const arma::mat& referenceSet,
+                 const arma::mat& querySet,
+                 const size_t k,
+                 const size_t leafSize,
+                 const NeighborSearchMode searchMode,
+                 const double epsilon,
+                 arma::Mat<size_t>& neighbors,
+                 arma::mat& distances)
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::fmat,
+      TreeType> FloatKNN;
+
+  Timer::Start("tree_building");
+  std::vector<size_t> oldFromNew;
+  typename FloatKNN::Tree tree(arma::conv_to<arma::fmat>::from(referenceSet),
+      oldFromNew, leafSize);
+  Timer::Stop("tree_building");
+
+  FloatKNN knn(std::move(tree), searchMode, epsilon);
+
+  // The tree rearranged the reference points, so the results must be mapped
+  // back to the original indices.
+  arma::Mat<size_t> mappedNeighbors;
+  arma::mat mappedDistances;
+  if (querySet.n_elem > 0)
+  {
+    knn.Search(arma::conv_to<arma::fmat>::from(querySet), k, mappedNeighbors,
+        mappedDistances);
+    Unmap(mappedNeighbors, mappedDistances, oldFromNew, neighbors, distances);
+    Rerank<NearestNeighborSort>(querySet, referenceSet, neighbors, distances,
+        EuclideanDistance());
+  }
+  else
+  {
+    knn.Search(k, mappedNeighbors, mappedDistances);
+    Unmap(mappedNeighbors, mappedDistances, oldFromNew, oldFromNew, neighbors,
+        distances);
+    Rerank<NearestNeighborSort>(referenceSet, referenceSet, neighbors,
+        distances, EuclideanDistance());
+  }
+}
 
 void mlpackMain()
 {
@@ -197,8 +249,27 @@ void mlpackMain()
     Log::Fatal << "Invalid epsilon: " << epsilon << ".  Must be non-negative. "
         << endl;
 
+  // Single-precision search is done without a model.
+  const bool useFloat = CLI::HasParam("float");
+  if (useFloat)
+  {
+    if (CLI::HasParam("input_model") || CLI::HasParam("output_model"))
+      Log::Fatal << "--float (-f) cannot be used with --input_model_file (-m) "
+          << "or --output_model_file (-M)!" << endl;
+
+    const string treeType = CLI::GetParam<string>("tree_type");
+    if (treeType != "kd" && treeType != "ball")
+      Log::Fatal << "--float (-f) is only supported with 'kd' and 'ball' trees,"
+          << " not '" << treeType << "'!" << endl;
+
+    if (CLI::HasParam("random_basis"))
+      Log::Fatal << "--random_basis (-R) cannot be used with --float (-f)!"
+          << endl;
+  }
+
   // We either have to load the reference data, or we have to load the model.
   KNNModel knn;
+  arma::mat floatReferenceSet;
 
   const string algorithm = CLI::GetParam<string>("algorithm");
   NeighborSearchMode searchMode = DUAL_TREE_MODE;
@@ -299,7 +370,11 @@ void mlpackMain()
         << referenceSet.n_rows << " x " << referenceSet.n_cols << ")."
         << endl;
 
-    knn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode, epsilon);
+    if (useFloat)
+      floatReferenceSet = std::move(referenceSet);
+    else
+      knn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode,
+          epsilon);
   }
   else
   {
@@ -339,18 +414,26 @@ void mlpackMain()
     // Sanity check on k value: must be greater than 0, must be less than the
     // number of reference points.  Since it is unsigned, we only test the upper
     // bound.
-    if (k > knn.Dataset().n_cols)
+    const size_t numReferencePoints = useFloat ? floatReferenceSet.n_cols :
+        knn.Dataset().n_cols;
+    if (k > numReferencePoints)
     {
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
       Log::Fatal << "than or equal to the number of reference points (";
-      Log::Fatal << knn.Dataset().n_cols << ")." << endl;
+      Log::Fatal << numReferencePoints << ")." << endl;
     }
 
     // Now run the search.
     arma::Mat<size_t> neighbors;
     arma::mat distances;
 
-    if (CLI::HasParam("query"))
+    if (useFloat && knn.TreeType() == KNNModel::BALL_TREE)
+      SearchFloat<BallTree>(floatReferenceSet, queryData, k, size_t(lsInt),
+          searchMode, epsilon, neighbors, distances);
+    else if (useFloat)
+      SearchFloat<KDTree>(floatReferenceSet, queryData, k, size_t(lsInt),
+          searchMode, epsilon, neighbors, distances);
+    else if (CLI::HasParam("query"))
       knn.Search(std::move(queryData), k, neighbors, distances);
     else
       knn.Search(k, neighbors, distances);
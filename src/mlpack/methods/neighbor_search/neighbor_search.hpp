@@ -24,6 +24,7 @@
 #include "neighbor_search_stat.hpp"
 #include "sort_policies/nearest_neighbor_sort.hpp"
 #include "neighbor_search_rules.hpp"
+#include "rerank.hpp"
 
 namespace mlpack {
 // Neighbor-search routines. These include all-nearest-neighbors and
@@ -65,6 +66,9 @@ enum NeighborSearchMode
  *     (defaults to the tree's default traverser).
  * @tparam SingleTreeTraversalType The type of single tree traversal to use
  *     (defaults to the tree's default traverser).
+ * @tparam CandidateListType The policy used to hold the candidate neighbors of
+ *     each query point during search; AdaptiveCandidateList uses a sorted array
+ *     for small k and a heap for large k.
  */
 template<typename SortPolicy = NearestNeighborSort,
          typename MetricType = mlpack::metric::EuclideanDistance,
@@ -79,7 +83,8 @@ template<typename SortPolicy = NearestNeighborSort,
          template<typename RuleType> class SingleTreeTraversalType =
              TreeType<MetricType,
                       NeighborSearchStat<SortPolicy>,
-                      MatType>::template SingleTreeTraverser>
+                      MatType>::template SingleTreeTraverser,
+         typename CandidateListType = AdaptiveCandidateList<SortPolicy>>
 class NeighborSearch
 {
  public:
@@ -189,6 +194,34 @@ class NeighborSearch
       const double epsilon = 0,
       const MetricType metric = MetricType());
 
+  /**
+   * Initialize the NeighborSearch object with the given pre-constructed
+   * reference tree, without copying it or taking ownership of it.  The tree
+   * must stay valid as long as this object uses it.  Searches with a query set
+   * do not modify the reference tree, so several NeighborSearch objects may
+   * share one tree and search it at the same time from different threads (for
+   * instance, a snapshot taken from a ConcurrentRectangleTree).  Monochromatic
+   * searches (Search() without a query set) in dual-tree mode do modify the
+   * statistics of the tree.
+   *
+   * @note
+   * Mapping the points of the matrix back to their original indices is not done
+   * when this constructor is used, so if the tree type you are using maps
+   * points (like BinarySpaceTree), then you will have to perform the re-mapping
+   * manually.
+   * @endnote
+   *
+   * @param referenceTree Pre-built tree for reference points.
+   * @param mode Neighbor search mode.
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric Instantiated distance metric.
+   */
+  NeighborSearch(
+      Tree* referenceTree,
+      const NeighborSearchMode mode = DUAL_TREE_MODE,
+      const double epsilon = 0,
+      const MetricType metric = MetricType());
+
   /**
    * Create a NeighborSearch object without any reference data.  If Search() is
    * called before a reference set is set with Train(), an exception will be
@@ -244,6 +277,12 @@ class NeighborSearch
    * the mlpack abstractions, even though calling this "training" is maybe a bit
    * of a stretch.
    *
+   * If the tree type rearranges the dataset, this method will copy the given
+   * set.  You can avoid this copy by using the Train() method that takes a
+   * rvalue reference to the set, or, to keep the set where it is, by building a
+   * BinarySpaceTree or Octree on it with BorrowDataset and passing the tree to
+   * Train(Tree&&); the results then refer to the columns of the given set.
+   *
    * @param referenceSet New set of reference data.
    */
   void Train(const MatType& referenceSet);
@@ -434,6 +473,10 @@ class NeighborSearch
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  //! The candidate lists of the last search; these are kept so that repeated
+  //! searches do not have to allocate them again.
+  CandidateListType candidates;
+
   //! The NSModel class should have access to internal members.
   template<typename SortPol>
   friend class TrainVisitor;
@@ -53,12 +53,14 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
-SingleTreeTraversalType>::NeighborSearch(const MatType& referenceSetIn,
-                                         const NeighborSearchMode mode,
-                                         const double epsilon,
-                                         const MetricType metric) :
+SingleTreeTraversalType, CandidateListType>::NeighborSearch(
+    const MatType& referenceSetIn,
+    const NeighborSearchMode mode,
+    const double epsilon,
+    const MetricType metric) :
     referenceTree(mode == NAIVE_MODE ? NULL :
         BuildTree<Tree>(referenceSetIn, oldFromNewReferences)),
     referenceSet(mode == NAIVE_MODE ? &referenceSetIn :
@@ -84,12 +86,14 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
-SingleTreeTraversalType>::NeighborSearch(MatType&& referenceSetIn,
-                                         const NeighborSearchMode mode,
-                                         const double epsilon,
-                                         const MetricType metric) :
+SingleTreeTraversalType, CandidateListType>::NeighborSearch(
+    MatType&& referenceSetIn,
+    const NeighborSearchMode mode,
+    const double epsilon,
+    const MetricType metric) :
     referenceTree(mode == NAIVE_MODE ? NULL :
         BuildTree<Tree>(std::move(referenceSetIn), oldFromNewReferences)),
     referenceSet(mode == NAIVE_MODE ?  new MatType(std::move(referenceSetIn)) :
@@ -115,12 +119,14 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
-SingleTreeTraversalType>::NeighborSearch(const Tree& referenceTree,
-                                         const NeighborSearchMode mode,
-                                         const double epsilon,
-                                         const MetricType metric) :
+SingleTreeTraversalType, CandidateListType>::NeighborSearch(
+    const Tree& referenceTree,
+    const NeighborSearchMode mode,
+    const double epsilon,
+    const MetricType metric) :
     referenceTree(new Tree(referenceTree)),
     referenceSet(&this->referenceTree->Dataset()),
     treeOwner(true),
@@ -144,12 +150,14 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
-SingleTreeTraversalType>::NeighborSearch(Tree&& referenceTree,
-                                         const NeighborSearchMode mode,
-                                         const double epsilon,
-                                         const MetricType metric) :
+SingleTreeTraversalType, CandidateListType>::NeighborSearch(
+    Tree&& referenceTree,
+    const NeighborSearchMode mode,
+    const double epsilon,
+    const MetricType metric) :
     referenceTree(new Tree(std::move(referenceTree))),
     referenceSet(&this->referenceTree->Dataset()),
     treeOwner(true),
@@ -165,6 +173,37 @@ SingleTreeTraversalType>::NeighborSearch(Tree&& referenceTree,
     throw std::invalid_argument("epsilon must be non-negative");
 }
 
+// Construct the object, using the given tree without copying it.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
+NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
+SingleTreeTraversalType, CandidateListType>::NeighborSearch(
+    Tree* referenceTree,
+    const NeighborSearchMode mode,
+    const double epsilon,
+    const MetricType metric) :
+    referenceTree(referenceTree),
+    referenceSet(&referenceTree->Dataset()),
+    treeOwner(false),
+    setOwner(false),
+    searchMode(mode),
+    epsilon(epsilon),
+    metric(metric),
+    baseCases(0),
+    scores(0),
+    treeNeedsReset(false)
+{
+  if (epsilon < 0)
+    throw std::invalid_argument("epsilon must be non-negative");
+}
+
 // Construct the object without a reference dataset.
 template<typename SortPolicy,
          typename MetricType,
@@ -173,11 +212,13 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
-SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
-                                         const double epsilon,
-                                         const MetricType metric) :
+SingleTreeTraversalType, CandidateListType>::NeighborSearch(
+    const NeighborSearchMode mode,
+    const double epsilon,
+    const MetricType metric) :
     referenceTree(NULL),
     referenceSet(new MatType()), // Empty matrix.
     treeOwner(false),
@@ -208,9 +249,11 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
-SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
+SingleTreeTraversalType, CandidateListType>::NeighborSearch(
+    const NeighborSearch& other) :
     oldFromNewReferences(other.oldFromNewReferences),
     referenceTree(other.referenceTree ? new Tree(*other.referenceTree) : NULL),
     referenceSet(other.referenceTree ? &referenceTree->Dataset() :
@@ -235,9 +278,11 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
-SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
+SingleTreeTraversalType, CandidateListType>::NeighborSearch(
+    NeighborSearch&& other) :
     oldFromNewReferences(std::move(other.oldFromNewReferences)),
     referenceTree(other.referenceTree),
     referenceSet(other.referenceSet),
@@ -271,19 +316,22 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy,
                MetricType,
                MatType,
                TreeType,
                DualTreeTraversalType,
-               SingleTreeTraversalType>&
+               SingleTreeTraversalType,
+               CandidateListType>&
 NeighborSearch<SortPolicy,
                MetricType,
                MatType,
                TreeType,
                DualTreeTraversalType,
-               SingleTreeTraversalType>::operator=(const NeighborSearch& other)
+               SingleTreeTraversalType,
+               CandidateListType>::operator=(const NeighborSearch& other)
 {
   // Clean memory first.
   if (treeOwner && referenceTree)
@@ -313,19 +361,22 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy,
                MetricType,
                MatType,
                TreeType,
                DualTreeTraversalType,
-               SingleTreeTraversalType>&
+               SingleTreeTraversalType,
+               CandidateListType>&
 NeighborSearch<SortPolicy,
                MetricType,
                MatType,
                TreeType,
                DualTreeTraversalType,
-               SingleTreeTraversalType>::operator=(NeighborSearch&& other)
+               SingleTreeTraversalType,
+               CandidateListType>::operator=(NeighborSearch&& other)
 {
   // Clean memory first.
   if (treeOwner && referenceTree)
@@ -366,9 +417,10 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
-SingleTreeTraversalType>::~NeighborSearch()
+SingleTreeTraversalType, CandidateListType>::~NeighborSearch()
 {
   if (treeOwner && referenceTree)
     delete referenceTree;
@@ -383,9 +435,10 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::Train(
+DualTreeTraversalType, SingleTreeTraversalType, CandidateListType>::Train(
     const MatType& referenceSet)
 {
   // Clean up the old tree, if we built one.
@@ -424,9 +477,11 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType&& referenceSetIn)
+DualTreeTraversalType, SingleTreeTraversalType, CandidateListType>::Train(
+    MatType&& referenceSetIn)
 {
   // Clean up the old tree, if we built one.
   if (treeOwner && referenceTree)
@@ -470,9 +525,10 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::Train(
+DualTreeTraversalType, SingleTreeTraversalType, CandidateListType>::Train(
     const Tree& referenceTree)
 {
   if (searchMode == NAIVE_MODE)
@@ -501,9 +557,11 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree&& referenceTree)
+DualTreeTraversalType, SingleTreeTraversalType, CandidateListType>::Train(
+    Tree&& referenceTree)
 {
   if (searchMode == NAIVE_MODE)
     throw std::invalid_argument("cannot train on given reference tree when "
@@ -535,9 +593,10 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::Search(
+DualTreeTraversalType, SingleTreeTraversalType, CandidateListType>::Search(
     const MatType& querySet,
     const size_t k,
     arma::Mat<size_t>& neighbors,
@@ -582,14 +641,16 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   neighborPtr->set_size(k, querySet.n_cols);
   distancePtr->set_size(k, querySet.n_cols);
 
-  typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
+  typedef NeighborSearchRules<SortPolicy, MetricType, Tree,
+      CandidateListType> RuleType;
 
   switch (searchMode)
   {
     case NAIVE_MODE:
     {
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+      RuleType rules(*referenceSet, querySet, k, metric, candidates,
+          epsilon);
 
       // The naive brute-force traversal.
       for (size_t i = 0; i < querySet.n_cols; ++i)
@@ -604,7 +665,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     case SINGLE_TREE_MODE:
     {
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+      RuleType rules(*referenceSet, querySet, k, metric, candidates,
+          epsilon);
 
       // Create the traverser.
       SingleTreeTraversalType<RuleType> traverser(rules);
@@ -634,7 +696,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       Timer::Start("computing_neighbors");
 
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon);
+      RuleType rules(*referenceSet, queryTree->Dataset(), k, metric,
+          candidates, epsilon);
 
       // Create the traverser.
       DualTreeTraversalType<RuleType> traverser(rules);
@@ -657,7 +720,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     case GREEDY_SINGLE_TREE_MODE:
     {
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric);
+      RuleType rules(*referenceSet, querySet, k, metric, candidates);
 
       // Create the traverser.
       tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
@@ -748,9 +811,10 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::Search(
+DualTreeTraversalType, SingleTreeTraversalType, CandidateListType>::Search(
     Tree& queryTree,
     const size_t k,
     arma::Mat<size_t>& neighbors,
@@ -789,8 +853,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   distances.set_size(k, querySet.n_cols);
 
   // Create the helper object for the traversal.
-  typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, querySet, k, metric, epsilon, sameSet);
+  typedef NeighborSearchRules<SortPolicy, MetricType, Tree,
+      CandidateListType> RuleType;
+  RuleType rules(*referenceSet, querySet, k, metric, candidates, epsilon,
+      sameSet);
 
   // Create the traverser.
   DualTreeTraversalType<RuleType> traverser(rules);
@@ -833,9 +899,10 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::Search(
+DualTreeTraversalType, SingleTreeTraversalType, CandidateListType>::Search(
     const size_t k,
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
@@ -869,9 +936,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   distancePtr->set_size(k, referenceSet->n_cols);
 
   // Create the helper object for the traversal.
-  typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, k, metric, epsilon,
-      true /* don't return the same point as nearest neighbor */);
+  typedef NeighborSearchRules<SortPolicy, MetricType, Tree,
+      CandidateListType> RuleType;
+  RuleType rules(*referenceSet, *referenceSet, k, metric, candidates,
+      epsilon, true /* don't return the same point as nearest neighbor */);
 
   switch (searchMode)
   {
@@ -1010,9 +1078,11 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 double NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::EffectiveError(
+DualTreeTraversalType, SingleTreeTraversalType,
+CandidateListType>::EffectiveError(
     arma::mat& foundDistances,
     arma::mat& realDistances)
 {
@@ -1048,9 +1118,10 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 double NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::Recall(
+DualTreeTraversalType, SingleTreeTraversalType, CandidateListType>::Recall(
     arma::Mat<size_t>& foundNeighbors,
     arma::Mat<size_t>& realNeighbors)
 {
@@ -1079,10 +1150,11 @@ template<typename SortPolicy,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
          template<typename> class DualTreeTraversalType,
-         template<typename> class SingleTreeTraversalType>
+         template<typename> class SingleTreeTraversalType,
+         typename CandidateListType>
 template<typename Archive>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
-DualTreeTraversalType, SingleTreeTraversalType>::Serialize(
+DualTreeTraversalType, SingleTreeTraversalType, CandidateListType>::Serialize(
     Archive& ar,
     const unsigned int /* version */)
 {
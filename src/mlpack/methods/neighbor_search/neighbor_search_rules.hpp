@@ -15,7 +15,7 @@
 
 #include <mlpack/core/tree/traversal_info.hpp>
 
-#include <queue>
+#include "candidate_list.hpp"
 
 namespace mlpack {
 namespace neighbor {
@@ -30,8 +30,14 @@ namespace neighbor {
  * @tparam SortPolicy The sort policy for distances.
  * @tparam MetricType The metric to use for computation.
  * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ * @tparam CandidateListType The policy used to hold the list of candidate
+ *     neighbors of each query point (AdaptiveCandidateList,
+ *     SortedCandidateList or HeapCandidateList).
  */
-template<typename SortPolicy, typename MetricType, typename TreeType>
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType = AdaptiveCandidateList<SortPolicy>>
 class NeighborSearchRules
 {
  public:
@@ -54,6 +60,29 @@ class NeighborSearchRules
                       const double epsilon = 0,
                       const bool sameSet = false);
 
+  /**
+   * Construct the NeighborSearchRules object, holding the candidate neighbors
+   * in the given candidate list.  The list is reset, but if it is large enough
+   * no memory is allocated; so, a search that is repeated many times can reuse
+   * one list.  The list must outlive this object.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param k Number of neighbors to search for.
+   * @param metric Instantiated metric.
+   * @param candidates Candidate list to use.
+   * @param epsilon Relative approximate error.
+   * @param sameSet If true, the query and reference set are taken to be the
+   *      same, and a query point will not return itself in the results.
+   */
+  NeighborSearchRules(const typename TreeType::Mat& referenceSet,
+                      const typename TreeType::Mat& querySet,
+                      const size_t k,
+                      MetricType& metric,
+                      CandidateListType& candidates,
+                      const double epsilon = 0,
+                      const bool sameSet = false);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -73,6 +102,25 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Evaluate the base cases between a contiguous block of query points and a
+   * contiguous block of reference points.  For the Euclidean distance, the
+   * distances of the whole block are computed with one matrix product, and only
+   * the reference points that might improve the candidate list are evaluated
+   * exactly; the results are the same as calling BaseCase() for every pair.
+   * For other metrics, nothing is done and false is returned.
+   *
+   * @param queryBegin Index of first query point.
+   * @param queryCount Number of query points.
+   * @param referenceBegin Index of first reference point.
+   * @param referenceCount Number of reference points.
+   * @return Whether or not the base cases were evaluated.
+   */
+  bool BaseCaseBlock(const size_t queryBegin,
+                     const size_t queryCount,
+                     const size_t referenceBegin,
+                     const size_t referenceCount);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -164,24 +212,6 @@ class NeighborSearchRules
   //! The query set.
   const typename TreeType::Mat& querySet;
 
-  //! Candidate represents a possible candidate neighbor (distance, index).
-  typedef std::pair<double, size_t> Candidate;
-
-  //! Compare two candidates based on the distance.
-  struct CandidateCmp {
-    bool operator()(const Candidate& c1, const Candidate& c2)
-    {
-      return !SortPolicy::IsBetter(c2.first, c1.first);
-    };
-  };
-
-  //! Use a priority queue to represent the list of candidate neighbors.
-  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-      CandidateList;
-
-  //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
-
   //! Number of neighbors to search for.
   const size_t k;
 
@@ -206,10 +236,19 @@ class NeighborSearchRules
   //! The number of scores that have been performed.
   size_t scores;
 
+  //! The candidate list used if none was given to the constructor.
+  CandidateListType localCandidates;
+
+  //! Set of candidate neighbors for each point.
+  CandidateListType& candidates;
+
   //! Traversal info for the parent combination; this is updated by the
   //! traversal before each call to Score().
   TraversalInfoType traversalInfo;
 
+  //! Distances computed by the last call to BaseCaseBlock().
+  arma::Mat<typename TreeType::Mat::elem_type> blockDistances;
+
   /**
    * Recalculate the bound for a given query node.
    */
@@ -15,12 +15,17 @@
 // In case it hasn't been included yet.
 #include "neighbor_search_rules.hpp"
 #include <mlpack/core/tree/spill_tree/is_spill_tree.hpp>
+#include <mlpack/core/tree/base_case_block.hpp>
 
 namespace mlpack {
 namespace neighbor {
 
-template<typename SortPolicy, typename MetricType, typename TreeType>
-NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::NeighborSearchRules(
     const typename TreeType::Mat& referenceSet,
     const typename TreeType::Mat& querySet,
     const size_t k,
@@ -36,7 +41,8 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
     baseCases(0),
-    scores(0)
+    scores(0),
+    candidates(localCandidates)
 {
   // We must set the traversal info last query and reference node pointers to
   // something that is both invalid (i.e. not a tree node) and not NULL.  We'll
@@ -48,40 +54,60 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
   // It will be initialized with k candidates: (WorstDistance, size_t() - 1)
   // The list of candidates will be updated when visiting new points with the
   // BaseCase() method.
-  const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
-      size_t() - 1);
+  candidates.Reset(k, querySet.n_cols);
+}
 
-  std::vector<Candidate> vect(k, def);
-  CandidateList pqueue(CandidateCmp(), std::move(vect));
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::NeighborSearchRules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
+    const size_t k,
+    MetricType& metric,
+    CandidateListType& candidates,
+    const double epsilon,
+    const bool sameSet) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    k(k),
+    metric(metric),
+    sameSet(sameSet),
+    epsilon(epsilon),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0),
+    candidates(candidates)
+{
+  // See the other constructor.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
 
-  candidates.reserve(querySet.n_cols);
-  for (size_t i = 0; i < querySet.n_cols; i++)
-    candidates.push_back(pqueue);
+  candidates.Reset(k, querySet.n_cols);
 }
 
-template<typename SortPolicy, typename MetricType, typename TreeType>
-void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResults(
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::GetResults(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  neighbors.set_size(k, querySet.n_cols);
-  distances.set_size(k, querySet.n_cols);
-
-  for (size_t i = 0; i < querySet.n_cols; i++)
-  {
-    CandidateList& pqueue = candidates[i];
-    for (size_t j = 1; j <= k; j++)
-    {
-      neighbors(k - j, i) = pqueue.top().second;
-      distances(k - j, i) = pqueue.top().first;
-      pqueue.pop();
-    }
-  }
+  candidates.GetResults(neighbors, distances);
 };
 
-template<typename SortPolicy, typename MetricType, typename TreeType>
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
 inline force_inline // Absolutely MUST be inline so optimizations can happen.
-double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+double NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::
 BaseCase(const size_t queryIndex, const size_t referenceIndex)
 {
   // If the datasets are the same, then this search is only using one dataset
@@ -107,8 +133,55 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   return distance;
 }
 
-template<typename SortPolicy, typename MetricType, typename TreeType>
-inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+bool NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::BaseCaseBlock(const size_t queryBegin,
+                                      const size_t queryCount,
+                                      const size_t referenceBegin,
+                                      const size_t referenceCount)
+{
+  double slack;
+  if (!tree::BlockDistances(metric, querySet, queryBegin, queryCount,
+      referenceSet, referenceBegin, referenceCount, blockDistances, slack))
+    return false;
+
+  for (size_t q = 0; q < queryCount; ++q)
+  {
+    const size_t queryIndex = queryBegin + q;
+    for (size_t r = 0; r < referenceCount; ++r)
+    {
+      const size_t referenceIndex = referenceBegin + r;
+      if (sameSet && (queryIndex == referenceIndex))
+        continue;
+
+      ++baseCases;
+
+      // If even the best distance allowed by roundoff can't improve the list
+      // of candidates, then neither can the exact distance.
+      const double bestDistance = SortPolicy::CombineBest(
+          blockDistances(r, q), slack);
+      if (SortPolicy::IsBetter(candidates.WorstDistance(queryIndex),
+          bestDistance))
+        continue;
+
+      const double distance = metric.Evaluate(querySet.col(queryIndex),
+          referenceSet.col(referenceIndex));
+      InsertNeighbor(queryIndex, referenceIndex, distance);
+    }
+  }
+
+  return true;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+inline double NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::Score(
     const size_t queryIndex,
     TreeType& referenceNode)
 {
@@ -143,31 +216,43 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
   }
 
   // Compare against the best k'th distance for this query point so far.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = candidates.WorstDistance(queryIndex);
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ?
       SortPolicy::ConvertToScore(distance) : DBL_MAX;
 }
 
-template<typename SortPolicy, typename MetricType, typename TreeType>
-inline size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+inline size_t NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::
 GetBestChild(const size_t queryIndex, TreeType& referenceNode)
 {
   ++scores;
   return SortPolicy::GetBestChild(querySet.col(queryIndex), referenceNode);
 }
 
-template<typename SortPolicy, typename MetricType, typename TreeType>
-inline size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+inline size_t NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::
 GetBestChild(const TreeType& queryNode, TreeType& referenceNode)
 {
   ++scores;
   return SortPolicy::GetBestChild(queryNode, referenceNode);
 }
 
-template<typename SortPolicy, typename MetricType, typename TreeType>
-inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+inline double NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::Rescore(
     const size_t queryIndex,
     TreeType& /* referenceNode */,
     const double oldScore) const
@@ -179,14 +264,18 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
   const double distance = SortPolicy::ConvertToDistance(oldScore);
 
   // Just check the score again against the distances.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = candidates.WorstDistance(queryIndex);
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ? oldScore : DBL_MAX;
 }
 
-template<typename SortPolicy, typename MetricType, typename TreeType>
-inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+inline double NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::Score(
     TreeType& queryNode,
     TreeType& referenceNode)
 {
@@ -346,8 +435,12 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
   }
 }
 
-template<typename SortPolicy, typename MetricType, typename TreeType>
-inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+inline double NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::Rescore(
     TreeType& queryNode,
     TreeType& /* referenceNode */,
     const double oldScore) const
@@ -365,8 +458,12 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
 
 // Calculate the bound for a given query node in its current state and update
 // it.
-template<typename SortPolicy, typename MetricType, typename TreeType>
-inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+inline double NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::
     CalculateBound(TreeType& queryNode) const
 {
   // This is an adapted form of the B(N_q) function in the paper
@@ -404,7 +501,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
   // Loop over points held in the node.
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
-    const double distance = candidates[queryNode.Point(i)].top().first;
+    const double distance = candidates.WorstDistance(queryNode.Point(i));
     if (SortPolicy::IsBetter(worstDistance, distance))
       worstDistance = distance;
     if (SortPolicy::IsBetter(distance, bestPointDistance))
@@ -492,21 +589,18 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
  * @param neighbor Index of reference point which is being inserted.
  * @param distance Distance from query point to reference point.
  */
-template<typename SortPolicy, typename MetricType, typename TreeType>
-inline void NeighborSearchRules<SortPolicy, MetricType, TreeType>::
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         typename CandidateListType>
+inline void NeighborSearchRules<SortPolicy, MetricType, TreeType,
+    CandidateListType>::
 InsertNeighbor(
     const size_t queryIndex,
     const size_t neighbor,
     const double distance)
 {
-  CandidateList& pqueue = candidates[queryIndex];
-  Candidate c = std::make_pair(distance, neighbor);
-
-  if (CandidateCmp()(c, pqueue.top()))
-  {
-    pqueue.pop();
-    pqueue.push(c);
-  }
+  candidates.Insert(queryIndex, neighbor, distance);
 }
 
 } // namespace neighbor
@@ -0,0 +1,91 @@
+/**
+ * @file rerank.hpp
+ * @author agent
+ *
+ * Re-ranking of the results of a neighbor search.  This is used after a search
+ * done in single precision to recompute the distances to the neighbors that
+ * were found, and their order, in double precision.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_RERANK_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_RERANK_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Recompute the distance between each query point and each of its neighbors
+ * with the given datasets, and sort the neighbors of each query point again
+ * according to the new distances.  Neighbors with equal distances keep their
+ * order.  Slots that the search could not fill (whose index is size_t() - 1)
+ * are left at the end, with the worst possible distance.
+ *
+ * @tparam SortPolicy The sort policy for distances.
+ * @tparam MetricType The metric to use for computation.
+ * @tparam MatType The type of data matrix.
+ * @param querySet Set of query points.
+ * @param referenceSet Set of reference points.
+ * @param neighbors Matrix of neighbors resulting from neighbor search.
+ * @param distances Matrix of distances resulting from neighbor search; this
+ *     will be overwritten.
+ * @param metric Instantiated metric.
+ */
+template<typename SortPolicy, typename MetricType, typename MatType>
+void Rerank(const MatType& querySet,
+            const MatType& referenceSet,
+            arma::Mat<size_t>& neighbors,
+            arma::mat& distances,
+            MetricType metric = MetricType())
+{
+  if (neighbors.n_cols != querySet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "Rerank(): the neighbor matrix has " << neighbors.n_cols
+        << " columns, but there are " << querySet.n_cols << " query points!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  distances.set_size(neighbors.n_rows, neighbors.n_cols);
+
+  std::vector<std::pair<double, size_t>> candidates(neighbors.n_rows);
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      candidates[j].second = neighbors(j, i);
+      if (neighbors(j, i) == size_t() - 1)
+      {
+        candidates[j].first = SortPolicy::WorstDistance();
+        continue;
+      }
+
+      candidates[j].first = metric.Evaluate(querySet.col(i),
+          referenceSet.col(neighbors(j, i)));
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+        [](const std::pair<double, size_t>& a,
+           const std::pair<double, size_t>& b)
+        {
+          return (a.first != b.first) && SortPolicy::IsBetter(a.first,
+              b.first);
+        });
+
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      distances(j, i) = candidates[j].first;
+      neighbors(j, i) = candidates[j].second;
+    }
+  }
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
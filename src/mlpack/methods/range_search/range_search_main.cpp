@@ -89,6 +89,110 @@ PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "S");
+PARAM_FLAG("float", "If set, the tree is built and searched in single "
+    "precision, which uses half the memory; the distances to the points that "
+    "are found are then recomputed in double precision.  Only 'kd' and 'ball' "
+    "trees are supported, and models cannot be loaded or saved.", "f");
+
+// Search in single precision with the given type of tree, then recompute the
+// distances to the points that were found in double precision.  The search uses
+// a range widened by the worst rounding error of single precision, so that no
+// point in the range is missed, and points that the double precision distance
+// puts outside of the range are then dropped.  If the query set is empty, the
+// reference set is searched.
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void SearchFloat(const arma::mat& referenceSet,
+                 const arma::mat& querySet,
+                 const math::Range& range,
+                 const size_t leafSize,
+                 const bool naive,
+                 const bool singleMode,
+                 vector<vector<size_t>>& neighbors,
+                 vector<vector<double>>& distances)
+{
+  typedef RangeSearch<EuclideanDistance, arma::fmat, TreeType> FloatRS;
+
+  // Rounding the points to single precision moves each of them by at most
+  // eps * |x| / 2, and computing a distance d in single precision adds an error
+  // of roughly (dimensionality + 2) * eps * d; widen the range by twice both.
+  const double eps = std::numeric_limits<float>::epsilon();
+  double maxNorm = 0.0;
+  if (referenceSet.n_cols > 0)
+    maxNorm = arma::max(arma::sqrt(arma::sum(arma::square(referenceSet))));
+  if (querySet.n_cols > 0)
+    maxNorm = std::max(maxNorm,
+        arma::max(arma::sqrt(arma::sum(arma::square(querySet)))));
+  const double dimSlack = 2 * (referenceSet.n_rows + 2) * eps;
+  const math::Range floatRange(
+      std::max(range.Lo() - 2 * eps * maxNorm - dimSlack * range.Lo(), 0.0),
+      range.Hi() + 2 * eps * maxNorm + dimSlack * range.Hi());
+
+  if (naive)
+  {
+    FloatRS rs(arma::conv_to<arma::fmat>::from(referenceSet), true);
+    if (querySet.n_elem > 0)
+      rs.Search(arma::conv_to<arma::fmat>::from(querySet), floatRange,
+          neighbors, distances);
+    else
+      rs.Search(floatRange, neighbors, distances);
+  }
+  else
+  {
+    Timer::Start("tree_building");
+    std::vector<size_t> oldFromNew;
+    typename FloatRS::Tree tree(arma::conv_to<arma::fmat>::from(referenceSet),
+        oldFromNew, leafSize);
+    Timer::Stop("tree_building");
+
+    FloatRS rs(&tree, singleMode);
+    vector<vector<size_t>> mappedNeighbors;
+    vector<vector<double>> mappedDistances;
+    if (querySet.n_elem > 0)
+      rs.Search(arma::conv_to<arma::fmat>::from(querySet), floatRange,
+          mappedNeighbors, mappedDistances);
+    else
+      rs.Search(floatRange, mappedNeighbors, mappedDistances);
+
+    // The tree rearranged the reference points (and, when there is no query
+    // set, the query points), so map the results back to the original indices.
+    neighbors.clear();
+    neighbors.resize(mappedNeighbors.size());
+    distances.clear();
+    distances.resize(mappedNeighbors.size());
+    for (size_t i = 0; i < mappedNeighbors.size(); ++i)
+    {
+      const size_t queryIndex = (querySet.n_elem > 0) ? i : oldFromNew[i];
+      neighbors[queryIndex].resize(mappedNeighbors[i].size());
+      distances[queryIndex].resize(mappedNeighbors[i].size());
+      for (size_t j = 0; j < mappedNeighbors[i].size(); ++j)
+        neighbors[queryIndex][j] = oldFromNew[mappedNeighbors[i][j]];
+    }
+  }
+
+  // Recompute the distances in double precision, and keep only the points that
+  // are really in the range.
+  const arma::mat& queries = (querySet.n_elem > 0) ? querySet : referenceSet;
+  for (size_t i = 0; i < neighbors.size(); ++i)
+  {
+    size_t kept = 0;
+    for (size_t j = 0; j < neighbors[i].size(); ++j)
+    {
+      const double distance = EuclideanDistance::Evaluate(queries.col(i),
+          referenceSet.col(neighbors[i][j]));
+      if (range.Contains(distance))
+      {
+        neighbors[i][kept] = neighbors[i][j];
+        distances[i][kept] = distance;
+        ++kept;
+      }
+    }
+
+    neighbors[i].resize(kept);
+    distances[i].resize(kept);
+  }
+}
 
 void mlpackMain()
 {
@@ -150,8 +254,28 @@ void mlpackMain()
     Log::Fatal << "Invalid leaf size: " << lsInt << ".  Must be greater than 0."
         << endl;
 
+  // Single-precision search is done without a model.
+  const bool useFloat = CLI::HasParam("float");
+  if (useFloat)
+  {
+    if (CLI::HasParam("input_model") || CLI::HasParam("output_model"))
+      Log::Fatal << "--float (-f) cannot be used with --input_model_file (-m) "
+          << "or --output_model_file (-M)!" << endl;
+
+    const string treeType = CLI::GetParam<string>("tree_type");
+    if (treeType != "kd" && treeType != "ball")
+      Log::Fatal << "--float (-f) is only supported with 'kd' and 'ball' trees,"
+          << " not '" << treeType << "'!" << endl;
+
+    if (CLI::HasParam("random_basis"))
+      Log::Fatal << "--random_basis (-R) cannot be used with --float (-f)!"
+          << endl;
+  }
+
   // We either have to load the reference data, or we have to load the model.
   RSModel rs;
+  // The reference set, in double precision, when --float is given.
+  arma::mat referenceData;
   const bool naive = CLI::HasParam("naive");
   const bool singleMode = CLI::HasParam("single_mode");
   if (CLI::HasParam("reference"))
@@ -205,7 +329,10 @@ void mlpackMain()
 
     const size_t leafSize = size_t(lsInt);
 
-    rs.BuildModel(std::move(referenceSet), leafSize, naive, singleMode);
+    if (useFloat)
+      referenceData = std::move(referenceSet);
+    else
+      rs.BuildModel(std::move(referenceSet), leafSize, naive, singleMode);
   }
   else
   {
@@ -249,7 +376,13 @@ void mlpackMain()
     vector<vector<size_t>> neighbors;
     vector<vector<double>> distances;
 
-    if (CLI::HasParam("query"))
+    if (useFloat && rs.TreeType() == RSModel::BALL_TREE)
+      SearchFloat<BallTree>(referenceData, queryData, r, size_t(lsInt),
+          naive, singleMode, neighbors, distances);
+    else if (useFloat)
+      SearchFloat<KDTree>(referenceData, queryData, r, size_t(lsInt),
+          naive, singleMode, neighbors, distances);
+    else if (CLI::HasParam("query"))
       rs.Search(std::move(queryData), r, neighbors, distances);
     else
       rs.Search(r, neighbors, distances);
@@ -41,8 +41,8 @@ class RangeSearchRules
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
    */
-  RangeSearchRules(const arma::mat& referenceSet,
-                   const arma::mat& querySet,
+  RangeSearchRules(const typename TreeType::Mat& referenceSet,
+                   const typename TreeType::Mat& querySet,
                    const math::Range& range,
                    std::vector<std::vector<size_t> >& neighbors,
                    std::vector<std::vector<double> >& distances,
@@ -57,6 +57,25 @@ class RangeSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between a contiguous block of query points and a
+   * contiguous block of reference points.  For the Euclidean distance, the
+   * distances of the whole block are computed with one matrix product, and only
+   * the pairs that might be in range are evaluated exactly; the results are the
+   * same as calling BaseCase() for every pair.  For other metrics, nothing is
+   * done and false is returned.
+   *
+   * @param queryBegin Index of first query point.
+   * @param queryCount Number of query points.
+   * @param referenceBegin Index of first reference point.
+   * @param referenceCount Number of reference points.
+   * @return Whether or not the base cases were computed.
+   */
+  bool BaseCaseBlock(const size_t queryBegin,
+                     const size_t queryCount,
+                     const size_t referenceBegin,
+                     const size_t referenceCount);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -119,10 +138,10 @@ class RangeSearchRules
 
  private:
   //! The reference set.
-  const arma::mat& referenceSet;
+  const typename TreeType::Mat& referenceSet;
 
   //! The query set.
-  const arma::mat& querySet;
+  const typename TreeType::Mat& querySet;
 
   //! The range of distances for which we are searching.
   const math::Range& range;
@@ -152,6 +171,9 @@ class RangeSearchRules
 
   TraversalInfoType traversalInfo;
 
+  //! Distances computed by the last call to BaseCaseBlock().
+  arma::Mat<typename TreeType::Mat::elem_type> blockDistances;
+
   //! The number of base cases.
   size_t baseCases;
   //! THe number of scores.
@@ -14,14 +14,15 @@
 
 // In case it hasn't been included yet.
 #include "range_search_rules.hpp"
+#include <mlpack/core/tree/base_case_block.hpp>
 
 namespace mlpack {
 namespace range {
 
 template<typename MetricType, typename TreeType>
 RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
-    const arma::mat& referenceSet,
-    const arma::mat& querySet,
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t> >& neighbors,
     std::vector<std::vector<double> >& distances,
@@ -75,6 +76,50 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   return distance;
 }
 
+//! Compute the base cases between two blocks of points at once, if the metric
+//! allows it.
+template<typename MetricType, typename TreeType>
+bool RangeSearchRules<MetricType, TreeType>::BaseCaseBlock(
+    const size_t queryBegin,
+    const size_t queryCount,
+    const size_t referenceBegin,
+    const size_t referenceCount)
+{
+  double slack;
+  if (!tree::BlockDistances(metric, querySet, queryBegin, queryCount,
+      referenceSet, referenceBegin, referenceCount, blockDistances, slack))
+    return false;
+
+  for (size_t q = 0; q < queryCount; ++q)
+  {
+    const size_t queryIndex = queryBegin + q;
+    for (size_t r = 0; r < referenceCount; ++r)
+    {
+      const size_t referenceIndex = referenceBegin + r;
+      if (sameSet && (queryIndex == referenceIndex))
+        continue;
+
+      ++baseCases;
+
+      // Only compute the exact distance if roundoff could put the point in
+      // range.
+      if ((blockDistances(r, q) + slack < range.Lo()) ||
+          (blockDistances(r, q) - slack > range.Hi()))
+        continue;
+
+      const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
+          referenceSet.unsafe_col(referenceIndex));
+      if (range.Contains(distance))
+      {
+        neighbors[queryIndex].push_back(referenceIndex);
+        distances[queryIndex].push_back(distance);
+      }
+    }
+  }
+
+  return true;
+}
+
 //! Single-tree scoring function.
 template<typename MetricType, typename TreeType>
 double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
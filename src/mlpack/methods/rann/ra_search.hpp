@@ -456,6 +456,33 @@ class RASearch
   //! Instantiation of kernel.
   MetricType metric;
 
+  /**
+   * Perform single-tree search for every query point in parallel, storing the
+   * results in the given rules object.  The samples for each query point are
+   * drawn from a random stream seeded by the index of the query point, so the
+   * results do not depend on the number of threads.
+   *
+   * @param numQueries Number of query points.
+   * @param rules Rules object to store results in.
+   * @return The number of distance computations performed.
+   */
+  template<typename RuleType>
+  size_t SingleTreeSearch(const size_t numQueries, RuleType& rules);
+
+  /**
+   * Perform dual-tree search in parallel, storing the results in the given
+   * rules object.  The query tree is split into a fixed set of disjoint
+   * subtrees, which are traversed independently; the samples for each subtree
+   * are drawn from a random stream seeded by the index of the subtree, so the
+   * results do not depend on the number of threads.
+   *
+   * @param queryTree Query tree to search with.
+   * @param rules Rules object to store results in.
+   * @return The number of distance computations performed.
+   */
+  template<typename RuleType>
+  size_t DualTreeSearch(Tree& queryTree, RuleType& rules);
+
   //! For access to mappings when building models.
   template<typename SortPol>
   friend class TrainVisitor;
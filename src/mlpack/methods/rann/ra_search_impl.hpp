@@ -370,15 +370,21 @@ Search(const MatType& querySet,
     // from the reference set without replacement.
     const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
         k, tau, alpha);
-    arma::uvec distinctSamples;
-    math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
-        distinctSamples);
+    std::vector<size_t> distinctSamples;
+    RAUtil::ObtainDistinctSamples(numSamples, referenceSet->n_cols,
+        math::randGen, distinctSamples);
 
     // Run the base case on each combination of query point and sampled
     // reference point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < distinctSamples.n_elem; ++j)
-        rules.BaseCase(i, (size_t) distinctSamples[j]);
+    #pragma omp parallel
+    {
+      RuleType threadRules(rules);
+
+      #pragma omp for schedule(static)
+      for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+        for (size_t j = 0; j < distinctSamples.size(); ++j)
+          threadRules.BaseCase(i, distinctSamples[j]);
+    }
 
     rules.GetResults(*neighborPtr, *distancePtr);
   }
@@ -393,17 +399,13 @@ Search(const MatType& querySet,
     {
       Log::Info << "Performing single-tree traversal..." << std::endl;
 
-      // Create the traverser.
-      typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Now traverse for each point.
+      const size_t numDistComputations = SingleTreeSearch(querySet.n_cols,
+          rules);
 
       Log::Info << "Single-tree traversal complete." << std::endl;
       Log::Info << "Average number of distance calculations per query point: "
-          << (rules.NumDistComputations() / querySet.n_cols) << "."
-          << std::endl;
+          << (numDistComputations / querySet.n_cols) << "." << std::endl;
     }
 
     rules.GetResults(*neighborPtr, *distancePtr);
@@ -422,16 +424,15 @@ Search(const MatType& querySet,
 
     RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, tau, alpha,
         naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
     Log::Info << "Query statistic pre-search: "
         << queryTree->Stat().NumSamplesMade() << std::endl;
 
-    traverser.Traverse(*queryTree, *referenceTree);
+    const size_t numDistComputations = DualTreeSearch(*queryTree, rules);
 
     Log::Info << "Dual-tree traversal complete." << std::endl;
     Log::Info << "Average number of distance calculations per query point: "
-        << (rules.NumDistComputations() / querySet.n_cols) << "." << std::endl;
+        << (numDistComputations / querySet.n_cols) << "." << std::endl;
 
     rules.GetResults(*neighborPtr, *distancePtr);
 
@@ -536,9 +537,7 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, tau, alpha,
       naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
 
-  // Create the traverser.
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-  traverser.Traverse(*queryTree, *referenceTree);
+  DualTreeSearch(*queryTree, rules);
 
   rules.GetResults(*neighborPtr, distances);
 
@@ -594,34 +593,28 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
 
   if (naive)
   {
-    // Find how many samples from the reference set we need and sample uniformly
-    // from the reference set without replacement.
-    const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
-        k, tau, alpha);
-    arma::uvec distinctSamples;
-    math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
-        distinctSamples);
-
     // The naive brute-force solution.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+    #pragma omp parallel
+    {
+      RuleType threadRules(rules);
+
+      #pragma omp for schedule(static)
+      for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
+        for (size_t j = 0; j < referenceSet->n_cols; ++j)
+          threadRules.BaseCase(i, j);
+    }
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // Now traverse for each point.
+    SingleTreeSearch(referenceSet->n_cols, rules);
   }
   else
   {
-    // Create the traverser.
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*referenceTree, *referenceTree);
+    // The reference tree holds the query statistics too, so clear any left
+    // over from a previous search.
+    ResetQueryTree(referenceTree);
+    DualTreeSearch(*referenceTree, rules);
   }
 
   rules.GetResults(*neighborPtr, *distancePtr);
@@ -667,6 +660,104 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::ResetQueryTree(
     ResetQueryTree(&queryNode->Child(i));
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+size_t RASearch<SortPolicy, MetricType, MatType, TreeType>::SingleTreeSearch(
+    const size_t numQueries,
+    RuleType& rules)
+{
+  const size_t seed = (size_t) math::randGen();
+  size_t numDistComputations = 0;
+
+  // Each thread gets its own rules object, which shares its results with
+  // 'rules'.
+  #pragma omp parallel reduction(+: numDistComputations)
+  {
+    RuleType threadRules(rules);
+    typename Tree::template SingleTreeTraverser<RuleType>
+        traverser(threadRules);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+    {
+      threadRules.RandomSeed(seed + i);
+      traverser.Traverse(i, *referenceTree);
+    }
+
+    numDistComputations += threadRules.NumDistComputations();
+  }
+
+  return numDistComputations;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+size_t RASearch<SortPolicy, MetricType, MatType, TreeType>::DualTreeSearch(
+    Tree& queryTree,
+    RuleType& rules)
+{
+  // Split the query tree into disjoint subtrees, expanding it level by level.
+  // A node can only be replaced by its children if all of its points are held
+  // by its children too.  The split does not depend on the number of threads.
+  const size_t maxQuerySubtrees = 64;
+  std::vector<Tree*> queryNodes(1, &queryTree);
+  bool expanded = true;
+  while (expanded && queryNodes.size() < maxQuerySubtrees)
+  {
+    expanded = false;
+    std::vector<Tree*> nextNodes;
+    for (size_t i = 0; i < queryNodes.size(); ++i)
+    {
+      Tree& node = *queryNodes[i];
+      if (node.NumChildren() > 0 &&
+          (tree::TreeTraits<Tree>::HasSelfChildren || node.NumPoints() == 0))
+      {
+        for (size_t c = 0; c < node.NumChildren(); ++c)
+          nextNodes.push_back(&node.Child(c));
+        expanded = true;
+      }
+      else
+      {
+        nextNodes.push_back(&node);
+      }
+    }
+
+    queryNodes.swap(nextNodes);
+  }
+
+  const size_t seed = (size_t) math::randGen();
+  size_t numDistComputations = 0;
+
+  // Each thread traverses its query subtrees against the whole reference tree.
+  // The query statistics of different subtrees are disjoint.
+  #pragma omp parallel reduction(+: numDistComputations)
+  {
+    RuleType threadRules(rules);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(threadRules);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) queryNodes.size(); ++i)
+    {
+      threadRules.RandomSeed(seed + i);
+      traverser.Traverse(*queryNodes[i], *referenceTree);
+    }
+
+    numDistComputations += threadRules.NumDistComputations();
+  }
+
+  return numDistComputations;
+}
+
 template<typename SortPolicy,
          typename MetricType,
          typename MatType,
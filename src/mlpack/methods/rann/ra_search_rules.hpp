@@ -18,6 +18,8 @@
 
 #include <queue>
 
+#include "ra_util.hpp"
+
 namespace mlpack {
 namespace neighbor {
 
@@ -66,6 +68,27 @@ class RASearchRules
                 const size_t singleSampleLimit = 20,
                 const bool sameSet = false);
 
+  /**
+   * Construct a RASearchRules object for use by another thread during a
+   * parallel search.  The new object shares the candidate lists and the sample
+   * counts of the given object, but has its own random number generator,
+   * sample buffer, traversal information, and statistics.  Two threads must
+   * never search for the same query point at the same time.
+   *
+   * @param other RASearchRules object to share results with.
+   */
+  RASearchRules(RASearchRules& other);
+
+  /**
+   * Seed the random number generator used for sampling.  Seeding with a value
+   * derived from the query (or query node) before each traversal makes the
+   * results independent of the order in which queries are searched, and so of
+   * the number of threads.
+   *
+   * @param seed Seed for the random number generator.
+   */
+  void RandomSeed(const size_t seed) { rng.seed((uint32_t) seed); }
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -263,8 +286,12 @@ class RASearchRules
   typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
       CandidateList;
 
-  //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  //! Storage for the candidate neighbors of each point, if this object holds
+  //! them.
+  std::vector<CandidateList> candidateStorage;
+  //! Set of candidate neighbors for each point (possibly held by another
+  //! object).
+  std::vector<CandidateList>& candidates;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -287,6 +314,12 @@ class RASearchRules
   //! The number of samples made for every query.
   arma::Col<size_t> numSamplesMade;
 
+  //! The random number generator used for sampling.
+  std::mt19937 rng;
+
+  //! Buffer for sampled points, reused for every node that is sampled.
+  std::vector<size_t> distinctSamples;
+
   //! The sampling ratio.
   double samplingRatio;
 
@@ -33,6 +33,7 @@ RASearchRules(const arma::mat& referenceSet,
               const bool sameSet) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(candidateStorage),
     k(k),
     metric(metric),
     sampleAtLeaves(sampleAtLeaves),
@@ -67,6 +68,9 @@ RASearchRules(const arma::mat& referenceSet,
   numDistComputations = 0;
   samplingRatio = (double) numSamplesReqd / (double) n;
 
+  // Unless reseeded, draw samples from a stream determined by the global seed.
+  rng.seed((uint32_t) math::randGen());
+
   Log::Info << "Minimum samples required per query: " << numSamplesReqd <<
     ", sampling ratio: " << samplingRatio << std::endl;
 
@@ -86,17 +90,53 @@ RASearchRules(const arma::mat& referenceSet,
 
   if (naive) // No tree traversal; just do naive sampling here.
   {
-    // Sample enough points.
-    arma::uvec distinctSamples;
-    for (size_t i = 0; i < querySet.n_cols; ++i)
+    // Sample enough points for each query, in parallel.  The samples for each
+    // query are drawn from a stream seeded by the query index, so the results
+    // do not depend on the number of threads.
+    const size_t seed = (size_t) math::randGen();
+    size_t threadDistComputations = 0;
+    #pragma omp parallel reduction(+: threadDistComputations)
     {
-      math::ObtainDistinctSamples(0, n, numSamplesReqd, distinctSamples);
-      for (size_t j = 0; j < distinctSamples.n_elem; j++)
-        BaseCase(i, (size_t) distinctSamples[j]);
+      RASearchRules threadRules(*this);
+
+      #pragma omp for schedule(static)
+      for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+      {
+        threadRules.RandomSeed(seed + i);
+        RAUtil::ObtainDistinctSamples(numSamplesReqd, n, threadRules.rng,
+            threadRules.distinctSamples);
+        for (size_t j = 0; j < threadRules.distinctSamples.size(); j++)
+          threadRules.BaseCase(i, threadRules.distinctSamples[j]);
+      }
+
+      threadDistComputations += threadRules.numDistComputations;
     }
+    numDistComputations += threadDistComputations;
   }
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+RASearchRules<SortPolicy, MetricType, TreeType>::
+RASearchRules(RASearchRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(other.candidates),
+    k(other.k),
+    metric(other.metric),
+    sampleAtLeaves(other.sampleAtLeaves),
+    firstLeafExact(other.firstLeafExact),
+    singleSampleLimit(other.singleSampleLimit),
+    numSamplesReqd(other.numSamplesReqd),
+    numSamplesMade(other.numSamplesMade.memptr(), other.numSamplesMade.n_elem,
+        false, true),
+    rng(other.rng),
+    samplingRatio(other.samplingRatio),
+    numDistComputations(0),
+    sameSet(other.sameSet)
+{
+  // Nothing to do.
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 void RASearchRules<SortPolicy, MetricType, TreeType>::GetResults(
     arma::Mat<size_t>& neighbors,
@@ -203,10 +243,9 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
         {
           // Then samplesReqd <= singleSampleLimit.
           // Hence, approximate the node by sampling enough number of points.
-          arma::uvec distinctSamples;
-          math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-              samplesReqd, distinctSamples);
-          for (size_t i = 0; i < distinctSamples.n_elem; i++)
+          RAUtil::ObtainDistinctSamples(samplesReqd,
+              referenceNode.NumDescendants(), rng, distinctSamples);
+          for (size_t i = 0; i < distinctSamples.size(); i++)
             // The counting of the samples are done in the 'BaseCase' function
             // so no book-keeping is required here.
             BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[i]));
@@ -219,10 +258,9 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
           if (sampleAtLeaves) // If allowed to sample at leaves.
           {
             // Approximate node by sampling enough number of points.
-            arma::uvec distinctSamples;
-            math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                samplesReqd, distinctSamples);
-            for (size_t i = 0; i < distinctSamples.n_elem; i++)
+            RAUtil::ObtainDistinctSamples(samplesReqd,
+                referenceNode.NumDescendants(), rng, distinctSamples);
+            for (size_t i = 0; i < distinctSamples.size(); i++)
               // The counting of the samples are done in the 'BaseCase' function
               // so no book-keeping is required here.
               BaseCase(queryIndex,
@@ -307,10 +345,9 @@ Rescore(const size_t queryIndex,
       {
         // Then, samplesReqd <= singleSampleLimit.  Hence, approximate the node
         // by sampling enough number of points.
-        arma::uvec distinctSamples;
-        math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-            samplesReqd, distinctSamples);
-        for (size_t i = 0; i < distinctSamples.n_elem; i++)
+        RAUtil::ObtainDistinctSamples(samplesReqd,
+            referenceNode.NumDescendants(), rng, distinctSamples);
+        for (size_t i = 0; i < distinctSamples.size(); i++)
           // The counting of the samples are done in the 'BaseCase' function so
           // no book-keeping is required here.
           BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[i]));
@@ -323,10 +360,9 @@ Rescore(const size_t queryIndex,
         if (sampleAtLeaves)
         {
           // Approximate node by sampling enough points.
-          arma::uvec distinctSamples;
-          math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-              samplesReqd, distinctSamples);
-          for (size_t i = 0; i < distinctSamples.n_elem; i++)
+          RAUtil::ObtainDistinctSamples(samplesReqd,
+              referenceNode.NumDescendants(), rng, distinctSamples);
+          for (size_t i = 0; i < distinctSamples.size(); i++)
             // The counting of the samples are done in the 'BaseCase' function
             // so no book-keeping is required here.
             BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[i]));
@@ -507,13 +543,12 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
         {
           // Then samplesReqd <= singleSampleLimit.  Hence, approximate node by
           // sampling enough number of points for every query in the query node.
-          arma::uvec distinctSamples;
           for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
           {
             const size_t queryIndex = queryNode.Descendant(i);
-            math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                samplesReqd, distinctSamples);
-            for (size_t j = 0; j < distinctSamples.n_elem; j++)
+            RAUtil::ObtainDistinctSamples(samplesReqd,
+                referenceNode.NumDescendants(), rng, distinctSamples);
+            for (size_t j = 0; j < distinctSamples.size(); j++)
               // The counting of the samples are done in the 'BaseCase' function
               // so no book-keeping is required here.
               BaseCase(queryIndex,
@@ -537,13 +572,12 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
           {
             // Approximate node by sampling enough number of points for every
             // query in the query node.
-            arma::uvec distinctSamples;
             for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
             {
               const size_t queryIndex = queryNode.Descendant(i);
-              math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                  samplesReqd, distinctSamples);
-              for (size_t j = 0; j < distinctSamples.n_elem; j++)
+              RAUtil::ObtainDistinctSamples(samplesReqd,
+                  referenceNode.NumDescendants(), rng, distinctSamples);
+              for (size_t j = 0; j < distinctSamples.size(); j++)
                 // The counting of the samples are done in the 'BaseCase'
                 // function so no book-keeping is required here.
                 BaseCase(queryIndex,
@@ -712,13 +746,12 @@ Rescore(TreeType& queryNode,
       {
         // then samplesReqd <= singleSampleLimit.  Hence, approximate the node
         // by sampling enough points for every query in the query node.
-        arma::uvec distinctSamples;
         for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
         {
           const size_t queryIndex = queryNode.Descendant(i);
-          math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-              samplesReqd, distinctSamples);
-          for (size_t j = 0; j < distinctSamples.n_elem; j++)
+          RAUtil::ObtainDistinctSamples(samplesReqd,
+              referenceNode.NumDescendants(), rng, distinctSamples);
+          for (size_t j = 0; j < distinctSamples.size(); j++)
             // The counting of the samples are done in the 'BaseCase'
             // function so no book-keeping is required here.
             BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[j]));
@@ -741,13 +774,12 @@ Rescore(TreeType& queryNode,
         {
           // Approximate node by sampling enough points for every query in the
           // query node.
-          arma::uvec distinctSamples;
           for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
           {
             const size_t queryIndex = queryNode.Descendant(i);
-            math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                samplesReqd, distinctSamples);
-            for (size_t j = 0; j < distinctSamples.n_elem; j++)
+            RAUtil::ObtainDistinctSamples(samplesReqd,
+                referenceNode.NumDescendants(), rng, distinctSamples);
+            for (size_t j = 0; j < distinctSamples.size(); j++)
               // The counting of the samples are done in BaseCase() so no
               // book-keeping is required here.
               BaseCase(queryIndex,
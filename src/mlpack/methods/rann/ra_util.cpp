@@ -12,6 +12,8 @@
  */
 #include "ra_util.hpp"
 
+#include <algorithm>
+
 using namespace mlpack;
 using namespace mlpack::neighbor;
 
@@ -168,3 +170,31 @@ double mlpack::neighbor::RAUtil::SuccessProbability(const size_t n,
     return sum;
   } // For k > 1.
 }
+
+void mlpack::neighbor::RAUtil::ObtainDistinctSamples(
+    const size_t numSamples,
+    const size_t rangeUpperBound,
+    std::mt19937& rng,
+    std::vector<size_t>& distinctSamples)
+{
+  distinctSamples.clear();
+
+  if (rangeUpperBound <= numSamples)
+  {
+    // Every point in the range would be sampled anyway.
+    for (size_t i = 0; i < rangeUpperBound; ++i)
+      distinctSamples.push_back(i);
+    return;
+  }
+
+  // Sample with replacement, then remove the duplicates.  This takes
+  // O(numSamples log numSamples) time and no extra memory, instead of
+  // O(rangeUpperBound) for counting the samples.
+  std::uniform_int_distribution<size_t> dist(0, rangeUpperBound - 1);
+  for (size_t i = 0; i < numSamples; ++i)
+    distinctSamples.push_back(dist(rng));
+
+  std::sort(distinctSamples.begin(), distinctSamples.end());
+  distinctSamples.erase(std::unique(distinctSamples.begin(),
+      distinctSamples.end()), distinctSamples.end());
+}
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_RANN_RA_UTIL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <random>
 
 namespace mlpack {
 namespace neighbor {
@@ -52,15 +53,20 @@ class RAUtil
   /**
    * Pick up desired number of samples (with replacement) from a given range
    * of integers so that only the distinct samples are returned from
-   * the range [0 - specified upper bound)
+   * the range [0 - specified upper bound), in increasing order.  The samples
+   * are drawn from the given random number generator, and the memory of
+   * distinctSamples is reused, so a caller that draws samples many times can
+   * keep its own generator and buffer and avoid allocations.
    *
    * @param numSamples Number of random samples.
    * @param rangeUpperBound The upper bound on the range of integers.
+   * @param rng Random number generator to draw samples with.
    * @param distinctSamples The list of the distinct samples.
    */
   static void ObtainDistinctSamples(const size_t numSamples,
                                     const size_t rangeUpperBound,
-                                    arma::uvec& distinctSamples);
+                                    std::mt19937& rng,
+                                    std::vector<size_t>& distinctSamples);
 };
 
 } // namespace neighbor
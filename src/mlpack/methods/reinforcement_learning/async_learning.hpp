@@ -19,6 +19,7 @@
 #include "worker/one_step_sarsa_worker.hpp"
 #include "worker/n_step_q_learning_worker.hpp"
 #include "training_config.hpp"
+#include "parameter_server.hpp"
 
 namespace mlpack {
 namespace rl {
@@ -68,7 +68,10 @@ void AsyncLearning<
   NetworkType learningNetwork = std::move(this->learningNetwork);
   if (learningNetwork.Parameters().is_empty())
     learningNetwork.ResetParameters();
-  NetworkType targetNetwork = learningNetwork;
+
+  // The workers only share the parameters of the learning and the target
+  // network; each of them has its own copy of the networks.
+  ParameterServer parameterServer(learningNetwork.Parameters());
   size_t totalSteps = 0;
   PolicyType policy = this->policy;
   bool stop = false;
@@ -95,8 +98,8 @@ void AsyncLearning<
   numThreads++;
   Log::Debug << numThreads << " threads will be used in total." << std::endl;
 
-  #pragma omp parallel for shared(stop, workers, tasks, learningNetwork, \
-      targetNetwork, totalSteps, policy)
+  #pragma omp parallel for shared(stop, workers, tasks, parameterServer, \
+      totalSteps, policy)
   for (omp_size_t i = 0; i < numThreads; ++i)
   {
     #pragma omp critical
@@ -129,8 +132,8 @@ void AsyncLearning<
       // Get corresponding worker.
       WorkerType& worker = workers[task];
       double episodeReturn;
-      if (worker.Step(learningNetwork, targetNetwork, totalSteps,
-          policy, episodeReturn) && !task)
+      if (worker.Step(parameterServer, totalSteps, policy, episodeReturn) &&
+          !task)
       {
         stop = measure(episodeReturn);
       }
@@ -138,6 +141,7 @@ void AsyncLearning<
   }
 
   // Write back the learning network.
+  learningNetwork.Parameters() = parameterServer.Parameters();
   this->learningNetwork = std::move(learningNetwork);
 };
 
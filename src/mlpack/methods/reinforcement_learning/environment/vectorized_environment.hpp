@@ -0,0 +1,189 @@
+/**
+ * @file vectorized_environment.hpp
+ * @author agent
+ *
+ * This file is the definition of the VectorizedEnvironment class, which steps
+ * several instances of a task together.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ENVIRONMENT_VECTORIZED_ENVIRONMENT_HPP
+#define MLPACK_METHODS_RL_ENVIRONMENT_VECTORIZED_ENVIRONMENT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * A VectorizedEnvironment runs a number of independent instances of a task
+ * (such as CartPole or MountainCar) in lockstep, so that an agent can evaluate
+ * the states of all of them with one batched forward pass of its network.
+ * The states are handed out as the columns of a matrix, and each call to
+ * Step() advances every instance by one step.
+ *
+ * When the episode of an instance ends (because it reaches a terminal state or
+ * the step limit), the instance starts a new episode right away; Step() still
+ * returns the state the episode ended in, so that it can be used for the
+ * update target.
+ *
+ * @tparam EnvironmentType The type of the reinforcement learning task.
+ */
+template<typename EnvironmentType>
+class VectorizedEnvironment
+{
+ public:
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  /**
+   * Create the given number of instances of the task, and start an episode in
+   * each of them.
+   *
+   * @param numEnvironments The number of instances.
+   * @param environment The task; every instance is a copy of it.
+   * @param stepLimit The maximum number of steps of an episode; 0 means no
+   *     limit.
+   */
+  VectorizedEnvironment(const size_t numEnvironments,
+                        const EnvironmentType& environment = EnvironmentType(),
+                        const size_t stepLimit = 0) :
+      environments(numEnvironments, environment),
+      states(numEnvironments),
+      steps(numEnvironments),
+      episodeReturns(numEnvironments),
+      lastEpisodeReturns(numEnvironments, arma::fill::zeros),
+      stepLimit(stepLimit)
+  {
+    Reset();
+  }
+
+  /**
+   * Start a new episode in every instance.
+   */
+  void Reset()
+  {
+    for (size_t i = 0; i < environments.size(); ++i)
+      Reset(i);
+  }
+
+  /**
+   * Encode the current state of every instance; column i holds the state of
+   * instance i.
+   *
+   * @param encoded Matrix to store the encoded states in.
+   */
+  void Encode(arma::mat& encoded) const
+  {
+    encoded.set_size(StateType::dimension, states.size());
+    for (size_t i = 0; i < states.size(); ++i)
+      encoded.col(i) = states[i].Encode();
+  }
+
+  /**
+   * Advance every instance by one step with the given actions.  Instances
+   * whose episode ends start a new episode.
+   *
+   * @param actions The action to take in each instance.
+   * @param nextStates Matrix to store the encoded next state of each instance
+   *     in; for an instance whose episode ended, this is its last state.
+   * @param rewards Vector to store the reward of each instance in.
+   * @param isTerminal Vector to store whether the episode of each instance
+   *     ended in.
+   */
+  void Step(const std::vector<ActionType>& actions,
+            arma::mat& nextStates,
+            arma::colvec& rewards,
+            arma::icolvec& isTerminal)
+  {
+    if (actions.size() != environments.size())
+    {
+      std::ostringstream oss;
+      oss << "VectorizedEnvironment::Step(): " << actions.size() << " actions "
+          << "given, but there are " << environments.size() << " instances!";
+      throw std::invalid_argument(oss.str());
+    }
+
+    nextStates.set_size(StateType::dimension, environments.size());
+    rewards.set_size(environments.size());
+    isTerminal.set_size(environments.size());
+
+    StateType nextState;
+    for (size_t i = 0; i < environments.size(); ++i)
+    {
+      rewards[i] = environments[i].Sample(states[i], actions[i], nextState);
+      nextStates.col(i) = nextState.Encode();
+
+      episodeReturns[i] += rewards[i];
+      steps[i]++;
+
+      isTerminal[i] = environments[i].IsTerminal(nextState) ||
+          (stepLimit != 0 && steps[i] >= stepLimit);
+      if (isTerminal[i])
+      {
+        lastEpisodeReturns[i] = episodeReturns[i];
+        Reset(i);
+      }
+      else
+      {
+        states[i] = nextState;
+      }
+    }
+  }
+
+  //! Get the number of instances.
+  size_t NumEnvironments() const { return environments.size(); }
+
+  //! Get the current state of the given instance.
+  const StateType& State(const size_t i) const { return states[i]; }
+  //! Modify the current state of the given instance.
+  StateType& State(const size_t i) { return states[i]; }
+
+  //! Get the return of the last finished episode of each instance.
+  const arma::colvec& LastEpisodeReturns() const { return lastEpisodeReturns; }
+
+  //! Get the maximum number of steps of an episode (0 means no limit).
+  size_t StepLimit() const { return stepLimit; }
+
+ private:
+  /**
+   * Start a new episode in the given instance.
+   *
+   * @param i The index of the instance.
+   */
+  void Reset(const size_t i)
+  {
+    states[i] = environments[i].InitialSample();
+    steps[i] = 0;
+    episodeReturns[i] = 0.0;
+  }
+
+  //! Locally-stored instances of the task.
+  std::vector<EnvironmentType> environments;
+
+  //! Locally-stored current state of each instance.
+  std::vector<StateType> states;
+
+  //! Locally-stored number of steps of the current episode of each instance.
+  std::vector<size_t> steps;
+
+  //! Locally-stored return of the current episode of each instance.
+  arma::colvec episodeReturns;
+
+  //! Locally-stored return of the last finished episode of each instance.
+  arma::colvec lastEpisodeReturns;
+
+  //! Locally-stored maximum number of steps of an episode.
+  size_t stepLimit;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
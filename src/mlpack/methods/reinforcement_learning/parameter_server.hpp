@@ -0,0 +1,195 @@
+/**
+ * @file parameter_server.hpp
+ * @author agent
+ *
+ * This file is the definition of the ParameterServer class, which holds the
+ * parameters shared by asynchronous reinforcement learning workers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_PARAMETER_SERVER_HPP
+#define MLPACK_METHODS_RL_PARAMETER_SERVER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <atomic>
+#include <mutex>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * The ParameterServer holds the parameters of the shared learning network and
+ * of the shared target network as plain matrices, so that workers never have
+ * to copy or lock a whole network object.  Each worker keeps its own networks
+ * and only moves parameters in and out of them:
+ *
+ *  - Pull() copies the learning parameters into a worker-local buffer (usually
+ *    the Parameters() of the worker's network, whose memory is kept);
+ *  - Push() adds an update to the learning parameters;
+ *  - SyncTarget() copies the learning parameters to the target parameters;
+ *  - PullTarget() copies the target parameters into a worker-local buffer, if
+ *    they changed since the worker last pulled them.
+ *
+ * The parameters are split into stripes, each guarded by its own lock, so
+ * workers only contend when they touch the same stripe at the same time.  As
+ * in Hogwild!, a whole Pull() or Push() isn't atomic: a worker may see some
+ * stripes before and some after the update of another worker.
+ */
+class ParameterServer
+{
+ public:
+  /**
+   * Create the parameter server with the given initial parameters, which are
+   * used for both the learning and the target parameters.
+   *
+   * @param parameters The initial parameters.
+   * @param stripeSize The number of parameters guarded by one lock.
+   */
+  ParameterServer(const arma::mat& parameters,
+                  const size_t stripeSize = 4096) :
+      parameters(parameters),
+      targetParameters(parameters),
+      stripeSize(std::max(stripeSize, (size_t) 1)),
+      locks((parameters.n_elem + this->stripeSize - 1) / this->stripeSize),
+      targetVersion(0)
+  { /* Nothing to do here. */ }
+
+  /**
+   * Copy the learning parameters into the given buffer, which must have the
+   * same number of elements; its memory is reused.
+   *
+   * @param localParameters Buffer to copy the learning parameters into.
+   */
+  void Pull(arma::mat& localParameters)
+  {
+    Copy(parameters, localParameters, "Pull()");
+  }
+
+  /**
+   * Add the given update to the learning parameters.
+   *
+   * @param update The update to add; it must have as many elements as the
+   *     parameters.
+   */
+  void Push(const arma::mat& update)
+  {
+    CheckSize(update, "Push()");
+    for (size_t i = 0; i < locks.size(); ++i)
+    {
+      const size_t begin = i * stripeSize;
+      const size_t end = std::min(begin + stripeSize,
+          (size_t) parameters.n_elem);
+
+      std::lock_guard<std::mutex> lock(locks[i]);
+      for (size_t j = begin; j < end; ++j)
+        parameters[j] += update[j];
+    }
+  }
+
+  /**
+   * Copy the learning parameters to the target parameters.
+   */
+  void SyncTarget()
+  {
+    for (size_t i = 0; i < locks.size(); ++i)
+    {
+      const size_t begin = i * stripeSize;
+      const size_t n = std::min(stripeSize, (size_t) parameters.n_elem - begin);
+
+      std::lock_guard<std::mutex> lock(locks[i]);
+      std::copy(parameters.memptr() + begin, parameters.memptr() + begin + n,
+          targetParameters.memptr() + begin);
+    }
+    ++targetVersion;
+  }
+
+  /**
+   * Copy the target parameters into the given buffer, if they changed since
+   * the given version; its memory is reused.
+   *
+   * @param localParameters Buffer to copy the target parameters into.
+   * @param version The version of the target parameters in the buffer; it is
+   *     updated when they are copied.
+   * @return Whether the target parameters were copied.
+   */
+  bool PullTarget(arma::mat& localParameters, size_t& version)
+  {
+    const size_t currentVersion = targetVersion;
+    if (currentVersion == version)
+      return false;
+
+    Copy(targetParameters, localParameters, "PullTarget()");
+    version = currentVersion;
+    return true;
+  }
+
+  //! Get the learning parameters.  This isn't synchronized with workers.
+  const arma::mat& Parameters() const { return parameters; }
+
+  //! Get the target parameters.  This isn't synchronized with workers.
+  const arma::mat& TargetParameters() const { return targetParameters; }
+
+  //! Get the number of times the target parameters have been synced.
+  size_t TargetVersion() const { return targetVersion; }
+
+  //! Get the number of parameters guarded by one lock.
+  size_t StripeSize() const { return stripeSize; }
+
+ private:
+  /**
+   * Copy the given shared parameters into the given buffer, one stripe at a
+   * time.
+   */
+  void Copy(const arma::mat& source,
+            arma::mat& destination,
+            const std::string& caller)
+  {
+    CheckSize(destination, caller);
+    for (size_t i = 0; i < locks.size(); ++i)
+    {
+      const size_t begin = i * stripeSize;
+      const size_t n = std::min(stripeSize, (size_t) source.n_elem - begin);
+
+      std::lock_guard<std::mutex> lock(locks[i]);
+      std::copy(source.memptr() + begin, source.memptr() + begin + n,
+          destination.memptr() + begin);
+    }
+  }
+
+  //! Make sure the given matrix has as many elements as the parameters.
+  void CheckSize(const arma::mat& other, const std::string& caller) const
+  {
+    if (other.n_elem != parameters.n_elem)
+    {
+      std::ostringstream oss;
+      oss << "ParameterServer::" << caller << ": matrix has " << other.n_elem
+          << " elements, but there are " << parameters.n_elem
+          << " parameters!";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  //! Locally-stored learning parameters.
+  arma::mat parameters;
+
+  //! Locally-stored target parameters.
+  arma::mat targetParameters;
+
+  //! Locally-stored number of parameters guarded by one lock.
+  size_t stripeSize;
+
+  //! One lock for each stripe of the parameters.
+  std::vector<std::mutex> locks;
+
+  //! The number of times the target parameters have been synced.
+  std::atomic<size_t> targetVersion;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
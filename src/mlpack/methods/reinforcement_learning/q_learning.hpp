@@ -16,6 +16,7 @@
 #include <mlpack/prereqs.hpp>
 
 #include "replay/random_replay.hpp"
+#include "replay/prioritized_replay.hpp"
 #include "training_config.hpp"
 
 namespace mlpack {
@@ -45,7 +46,8 @@ namespace rl {
  * @tparam NetworkType The network to compute action value.
  * @tparam UpdaterType How to apply gradients when training.
  * @tparam PolicyType Behavior policy of the agent.
- * @tparam ReplayType Experience replay method.
+ * @tparam ReplayType Experience replay method, e.g. RandomReplay or
+ *     PrioritizedReplay.
  */
 template <
   typename EnvironmentType,
@@ -142,6 +144,33 @@ class QLearning
 
   //! Locally-stored flag indicating training mode or test mode.
   bool deterministic;
+
+  //! Locally-stored encoded states of the sampled experiences.
+  arma::mat sampledStates;
+
+  //! Locally-stored actions of the sampled experiences.
+  arma::icolvec sampledActions;
+
+  //! Locally-stored rewards of the sampled experiences.
+  arma::colvec sampledRewards;
+
+  //! Locally-stored encoded next states of the sampled experiences.
+  arma::mat sampledNextStates;
+
+  //! Locally-stored termination information of the sampled experiences.
+  arma::icolvec isTerminal;
+
+  //! Locally-stored action values of the sampled next states.
+  arma::mat nextActionValues;
+
+  //! Locally-stored update target of the sampled states.
+  arma::mat target;
+
+  //! Locally-stored temporal difference errors of the sampled experiences.
+  arma::colvec tdErrors;
+
+  //! Locally-stored gradients of the learning network.
+  arma::mat gradients;
 };
 
 } // namespace rl
@@ -115,17 +115,11 @@ double QLearning<
 
   // Start experience replay.
 
-  // Sample from previous experience.
-  arma::mat sampledStates;
-  arma::icolvec sampledActions;
-  arma::colvec sampledRewards;
-  arma::mat sampledNextStates;
-  arma::icolvec isTerminal;
+  // Sample from previous experience, into the buffers of the last step.
   replayMethod.Sample(sampledStates, sampledActions, sampledRewards,
       sampledNextStates, isTerminal);
 
   // Compute action value for next state with target network.
-  arma::mat nextActionValues;
   targetNetwork.Predict(sampledNextStates, nextActionValues);
 
   arma::Col<size_t> bestActions;
@@ -141,17 +135,22 @@ double QLearning<
     bestActions = BestAction(nextActionValues);
   }
 
-  // Compute the update target.
-  arma::mat target;
+  // Compute the update target.  The error of each experience is scaled by
+  // its importance sampling weight, which scales its gradient by the same
+  // amount.
+  const arma::colvec& weights = replayMethod.Weights();
   learningNetwork.Forward(sampledStates, target);
+  tdErrors.set_size(sampledNextStates.n_cols);
   for (size_t i = 0; i < sampledNextStates.n_cols; ++i)
   {
-    target(sampledActions[i], i) = sampledRewards[i] + config.Discount() *
+    const double targetActionValue = sampledRewards[i] + config.Discount() *
         (isTerminal[i] ? 0.0 : nextActionValues(bestActions[i], i));
+    tdErrors[i] = targetActionValue - target(sampledActions[i], i);
+    target(sampledActions[i], i) += weights[i] * tdErrors[i];
   }
+  replayMethod.Update(tdErrors);
 
   // Learn form experience.
-  arma::mat gradients;
   learningNetwork.Backward(target, gradients);
   updater.Update(learningNetwork.Parameters(), config.StepSize(), gradients);
 
@@ -0,0 +1,265 @@
+/**
+ * @file prioritized_replay.hpp
+ * @author agent
+ *
+ * This file is an implementation of prioritized experience replay.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+#define MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "sum_tree.hpp"
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of prioritized experience replay.
+ *
+ * Like RandomReplay, the transitions are kept in a First-In-First-Out buffer,
+ * but a transition is sampled with probability proportional to its priority
+ * raised to the power alpha.  The priority of a transition is the absolute
+ * value of its last temporal difference error (plus a small constant); new
+ * transitions get the largest priority seen so far, so that they are sampled
+ * at least once.  The priorities are kept in a sum tree, so sampling and
+ * updating a priority take O(log n) time.
+ *
+ * Since prioritized sampling changes the distribution of the updates, every
+ * sampled transition comes with an importance sampling weight
+ * (N * P(i))^(-beta), normalized by the largest weight in the batch; the agent
+ * should scale the update of each transition by its weight, and pass the new
+ * temporal difference errors to Update().
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @article{schaul2015prioritized,
+ *  title   = {Prioritized Experience Replay},
+ *  author  = {Schaul, Tom and Quan, John and Antonoglou, Ioannis and
+ *             Silver, David},
+ *  journal = {arXiv preprint arXiv:1511.05952},
+ *  year    = {2015}
+ * }
+ * @endcode
+ *
+ * @tparam EnvironmentType Desired task.
+ */
+template <typename EnvironmentType>
+class PrioritizedReplay
+{
+ public:
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Construct an instance of prioritized experience replay class.
+   *
+   * @param batchSize Number of examples returned at each sample.
+   * @param capacity Total memory size in terms of number of examples.
+   * @param alpha How much prioritization is used (0 means uniform sampling).
+   * @param beta How much the importance sampling weights correct for the
+   *     prioritization (1 means fully).
+   * @param epsilon Constant added to the absolute errors, so that no
+   *     transition has priority 0.
+   * @param dimension The dimension of an encoded state.
+   */
+  PrioritizedReplay(const size_t batchSize,
+                    const size_t capacity,
+                    const double alpha = 0.6,
+                    const double beta = 0.4,
+                    const double epsilon = 1e-6,
+                    const size_t dimension = StateType::dimension) :
+      batchSize(batchSize),
+      capacity(capacity),
+      alpha(alpha),
+      beta(beta),
+      epsilon(epsilon),
+      position(0),
+      states(dimension, capacity),
+      actions(capacity),
+      rewards(capacity),
+      nextStates(dimension, capacity),
+      isTerminal(capacity),
+      full(false),
+      priorities(capacity),
+      maxPriority(1.0),
+      sampledIndices(batchSize),
+      weights(batchSize)
+  { /* Nothing to do here. */ }
+
+  /**
+   * Store the given experience, with the largest priority seen so far.
+   *
+   * @param state Given state.
+   * @param action Given action.
+   * @param reward Given reward.
+   * @param nextState Given next state.
+   * @param isEnd Whether next state is terminal state.
+   */
+  void Store(const StateType& state,
+             ActionType action,
+             double reward,
+             const StateType& nextState,
+             bool isEnd)
+  {
+    states.col(position) = state.Encode();
+    actions(position) = action;
+    rewards(position) = reward;
+    nextStates.col(position) = nextState.Encode();
+    isTerminal(position) = isEnd;
+    priorities.Set(position, std::pow(maxPriority, alpha));
+    position++;
+    if (position == capacity)
+    {
+      full = true;
+      position = 0;
+    }
+  }
+
+  /**
+   * Sample some experiences in proportion to their priorities.  The given
+   * matrices are only reallocated if they don't have the right size yet.  The
+   * importance sampling weights of the sampled experiences are available from
+   * Weights() afterwards.
+   *
+   * @param sampledStates Sampled encoded states.
+   * @param sampledActions Sampled actions.
+   * @param sampledRewards Sampled rewards.
+   * @param sampledNextStates Sampled encoded next states.
+   * @param isTerminal Indicate whether corresponding next state is terminal
+   *        state.
+   */
+  void Sample(arma::mat& sampledStates,
+              arma::icolvec& sampledActions,
+              arma::colvec& sampledRewards,
+              arma::mat& sampledNextStates,
+              arma::icolvec& isTerminal)
+  {
+    const size_t size = Size();
+    sampledStates.set_size(states.n_rows, batchSize);
+    sampledActions.set_size(batchSize);
+    sampledRewards.set_size(batchSize);
+    sampledNextStates.set_size(nextStates.n_rows, batchSize);
+    isTerminal.set_size(batchSize);
+
+    // Split the total priority into equal segments, and draw one experience
+    // from each, which lowers the variance of the batch.
+    const double total = priorities.Sum();
+    const double segment = total / batchSize;
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const double mass = (i + math::Random()) * segment;
+      const size_t index = std::min(priorities.Find(mass), size - 1);
+      sampledIndices[i] = index;
+
+      const double probability = priorities.Get(index) / total;
+      weights[i] = std::pow(size * probability, -beta);
+
+      sampledStates.col(i) = states.col(index);
+      sampledActions[i] = actions[index];
+      sampledRewards[i] = rewards[index];
+      sampledNextStates.col(i) = nextStates.col(index);
+      isTerminal[i] = this->isTerminal[index];
+    }
+
+    weights /= weights.max();
+  }
+
+  /**
+   * Update the priorities of the experiences returned by the last call to
+   * Sample().
+   *
+   * @param tdErrors The new temporal difference error of each sampled
+   *     experience.
+   */
+  void Update(const arma::colvec& tdErrors)
+  {
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const double priority = std::abs(tdErrors[i]) + epsilon;
+      maxPriority = std::max(maxPriority, priority);
+      priorities.Set(sampledIndices[i], std::pow(priority, alpha));
+    }
+  }
+
+  /**
+   * Get the number of transitions in the memory.
+   *
+   * @return Actual used memory size
+   */
+  const size_t& Size()
+  {
+    return full ? capacity : position;
+  }
+
+  //! Get the importance sampling weights of the last sampled experiences.
+  const arma::colvec& Weights() const { return weights; }
+
+  //! Get the amount of importance sampling correction.
+  double Beta() const { return beta; }
+  //! Modify the amount of importance sampling correction.
+  double& Beta() { return beta; }
+
+ private:
+  //! Locally-stored number of examples of each sample.
+  size_t batchSize;
+
+  //! Locally-stored total memory limit.
+  size_t capacity;
+
+  //! Locally-stored amount of prioritization.
+  double alpha;
+
+  //! Locally-stored amount of importance sampling correction.
+  double beta;
+
+  //! Locally-stored constant added to the absolute errors.
+  double epsilon;
+
+  //! Indicate the position to store new transition.
+  size_t position;
+
+  //! Locally-stored encoded previous states.
+  arma::mat states;
+
+  //! Locally-stored previous actions.
+  arma::icolvec actions;
+
+  //! Locally-stored previous rewards.
+  arma::colvec rewards;
+
+  //! Locally-stored encoded previous next states.
+  arma::mat nextStates;
+
+  //! Locally-stored termination information of previous experience.
+  arma::icolvec isTerminal;
+
+  //! Locally-stored indicator that whether the memory is full or not
+  bool full;
+
+  //! Locally-stored priorities (raised to the power alpha) of the experiences.
+  SumTree priorities;
+
+  //! Locally-stored largest priority seen so far.
+  double maxPriority;
+
+  //! Locally-stored indices of the last sampled experiences.
+  std::vector<size_t> sampledIndices;
+
+  //! Locally-stored importance sampling weights of the last sampled
+  //! experiences.
+  arma::colvec weights;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
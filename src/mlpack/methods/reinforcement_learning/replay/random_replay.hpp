@@ -67,7 +67,8 @@ class RandomReplay
       rewards(capacity),
       nextStates(dimension, capacity),
       isTerminal(capacity),
-      full(false)
+      full(false),
+      weights(batchSize, arma::fill::ones)
   { /* Nothing to do here. */ }
 
   /**
@@ -99,7 +100,8 @@ class RandomReplay
   }
 
   /**
-   * Sample some experiences.
+   * Sample some experiences.  The given matrices are only reallocated if they
+   * don't have the right size yet.
    *
    * @param sampledStates Sampled encoded states.
    * @param sampledActions Sampled actions.
@@ -115,16 +117,29 @@ class RandomReplay
               arma::icolvec& isTerminal)
   {
     size_t upperBound = full ? capacity : position;
-    arma::uvec sampledIndices = arma::randi<arma::uvec>(
-        batchSize, arma::distr_param(0, upperBound - 1));
-
-    sampledStates = states.cols(sampledIndices);
-    sampledActions = actions.elem(sampledIndices);
-    sampledRewards = rewards.elem(sampledIndices);
-    sampledNextStates = nextStates.cols(sampledIndices);
-    isTerminal = this->isTerminal.elem(sampledIndices);
+    sampledStates.set_size(states.n_rows, batchSize);
+    sampledActions.set_size(batchSize);
+    sampledRewards.set_size(batchSize);
+    sampledNextStates.set_size(nextStates.n_rows, batchSize);
+    isTerminal.set_size(batchSize);
+
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const size_t index = math::RandInt(upperBound);
+      sampledStates.col(i) = states.col(index);
+      sampledActions[i] = actions[index];
+      sampledRewards[i] = rewards[index];
+      sampledNextStates.col(i) = nextStates.col(index);
+      isTerminal[i] = this->isTerminal[index];
+    }
   }
 
+  /**
+   * Update the priorities of the last sampled experiences.  All experiences
+   * are equally likely here, so this does nothing.
+   */
+  void Update(const arma::colvec& /* tdErrors */) { }
+
   /**
    * Get the number of transitions in the memory.
    *
@@ -135,6 +150,10 @@ class RandomReplay
     return full ? capacity : position;
   }
 
+  //! Get the importance sampling weights of the sampled experiences, which
+  //! are all 1.
+  const arma::colvec& Weights() const { return weights; }
+
  private:
   //! Locally-stored number of examples of each sample.
   size_t batchSize;
@@ -162,6 +181,9 @@ class RandomReplay
 
   //! Locally-stored indicator that whether the memory is full or not
   bool full;
+
+  //! Locally-stored importance sampling weights.
+  arma::colvec weights;
 };
 
 } // namespace rl
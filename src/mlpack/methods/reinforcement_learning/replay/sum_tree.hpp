@@ -0,0 +1,117 @@
+/**
+ * @file sum_tree.hpp
+ * @author agent
+ *
+ * This file is the definition of the SumTree class, which supports sampling
+ * indices in proportion to their values.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_SUM_TREE_HPP
+#define MLPACK_METHODS_RL_REPLAY_SUM_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * A sum tree holds a non-negative value for each of a fixed number of indices,
+ * and finds the index at which the running sum of the values passes a given
+ * mass.  Drawing the mass uniformly from [0, Sum()) thus samples each index
+ * with probability proportional to its value.  Both setting a value and
+ * finding an index take O(log n) time.
+ *
+ * The tree is stored flat: node 1 is the root, the children of node i are
+ * nodes 2i and 2i + 1, and the value of index j is stored in leaf
+ * (leaves + j), where the number of leaves is the capacity rounded up to a
+ * power of two.  Every internal node holds the sum of its children.
+ */
+class SumTree
+{
+ public:
+  /**
+   * Create a sum tree for the given number of indices, all with value 0.
+   *
+   * @param capacity The number of indices.
+   */
+  SumTree(const size_t capacity = 0) : capacity(capacity), leaves(1)
+  {
+    while (leaves < capacity)
+      leaves *= 2;
+    tree.zeros(2 * leaves);
+  }
+
+  /**
+   * Set the value of the given index.
+   *
+   * @param index The index to set, in [0, Capacity()).
+   * @param value The new (non-negative) value.
+   */
+  void Set(const size_t index, const double value)
+  {
+    size_t node = leaves + index;
+    tree[node] = value;
+    // Recompute the sums on the path to the root from the children, so that
+    // rounding errors don't accumulate.
+    for (node /= 2; node >= 1; node /= 2)
+      tree[node] = tree[2 * node] + tree[2 * node + 1];
+  }
+
+  //! Get the value of the given index.
+  double Get(const size_t index) const { return tree[leaves + index]; }
+
+  //! Get the sum of all the values.
+  double Sum() const { return tree[1]; }
+
+  /**
+   * Find the smallest index whose running sum of values (including itself) is
+   * larger than the given mass.  If the mass isn't smaller than Sum(), the
+   * last index with a positive value is returned.
+   *
+   * @param mass The mass to find, in [0, Sum()).
+   * @return The index at which the running sum passes the mass.
+   */
+  size_t Find(double mass) const
+  {
+    size_t node = 1;
+    while (node < leaves)
+    {
+      const size_t left = 2 * node;
+      // Go right only if the mass is past the left subtree and there is
+      // something there; this keeps rounding errors from reaching an empty
+      // leaf.
+      if (mass >= tree[left] && tree[left + 1] > 0.0)
+      {
+        mass -= tree[left];
+        node = left + 1;
+      }
+      else
+      {
+        node = left;
+      }
+    }
+    return node - leaves;
+  }
+
+  //! Get the number of indices.
+  size_t Capacity() const { return capacity; }
+
+ private:
+  //! Locally-stored number of indices.
+  size_t capacity;
+
+  //! Locally-stored number of leaves of the tree.
+  size_t leaves;
+
+  //! Locally-stored nodes of the tree; node 0 is unused.
+  arma::colvec tree;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file sync_learning.hpp
+ * @author agent
+ *
+ * This file is the definition of SyncLearning class, which is a wrapper for
+ * synchronous learning algorithms over a batch of environments.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_SYNC_LEARNING_HPP
+#define MLPACK_METHODS_RL_SYNC_LEARNING_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "worker/sync_one_step_q_learning_worker.hpp"
+#include "training_config.hpp"
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Wrapper of synchronous learning algorithms.  Unlike AsyncLearning, where
+ * every worker runs one environment in its own thread, a synchronous worker
+ * steps config.NumWorkers() environments together and handles all of their
+ * transitions with batched passes of the networks, so training runs in a
+ * single thread and needs no locking.
+ *
+ * @tparam WorkerType The type of the worker.
+ * @tparam EnvironmentType The type of reinforcement learning task.
+ * @tparam NetworkType The type of the network model.
+ * @tparam UpdaterType The type of the optimizer.
+ * @tparam PolicyType The type of the behavior policy.
+ */
+template <
+  typename WorkerType,
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+class SyncLearning
+{
+ public:
+  /**
+   * Construct an instance of the given sync learning algorithm.
+   *
+   * @param config Hyper-parameters for training.
+   * @param network The network model.
+   * @param policy The behavior policy.
+   * @param updater The optimizer.
+   * @param environment The reinforcement learning task.
+   */
+  SyncLearning(TrainingConfig config,
+               NetworkType network,
+               PolicyType policy,
+               UpdaterType updater = UpdaterType(),
+               EnvironmentType environment = EnvironmentType());
+
+  /**
+   * Starting sync training.
+   *
+   * @tparam Measure The type of the measurement. It should be a
+   *   callable object like
+   *   @code
+   *   bool foo(double reward);
+   *   @endcode
+   *   where reward is the total reward of a deterministic test episode,
+   *   and the return value should indicate whether the training
+   *   process is completed.
+   * @param measure The measurement instance.
+   */
+  template <typename Measure>
+  void Train(Measure& measure);
+
+  //! Get training config.
+  TrainingConfig& Config() { return config; }
+  //! Modify training config.
+  const TrainingConfig& Config() const { return config; }
+
+  //! Get learning network.
+  NetworkType& Network() { return learningNetwork; }
+  //! Modify learning network.
+  const NetworkType& Network() const { return learningNetwork; }
+
+  //! Get behavior policy.
+  PolicyType& Policy() { return policy; }
+  //! Modify behavior policy.
+  const PolicyType& Policy() const { return policy; }
+
+  //! Get optimizer.
+  UpdaterType& Updater() { return updater; }
+  //! Modify optimizer.
+  const UpdaterType& Updater() const { return updater; }
+
+  //! Get the environment.
+  EnvironmentType& Environment() { return environment; }
+  //! Modify the environment.
+  const EnvironmentType& Environment() const { return environment; }
+
+ private:
+  //! Locally-stored hyper-parameters.
+  TrainingConfig config;
+
+  //! Locally-stored learning network.
+  NetworkType learningNetwork;
+
+  //! Locally-stored policy.
+  PolicyType policy;
+
+  //! Locally-stored optimizer.
+  UpdaterType updater;
+
+  //! Locally-stored task.
+  EnvironmentType environment;
+};
+
+/**
+ * Convenient typedef for sync one step q-learning.
+ *
+ * @tparam EnvironmentType The type of the reinforcement learning task.
+ * @tparam NetworkType The type of the network model.
+ * @tparam UpdaterType The type of the optimizer.
+ * @tparam PolicyType The type of the behavior policy.
+ */
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+using SyncOneStepQLearning = SyncLearning<SyncOneStepQLearningWorker<
+    EnvironmentType, NetworkType, UpdaterType, PolicyType>, EnvironmentType,
+    NetworkType, UpdaterType, PolicyType>;
+
+} // namespace rl
+} // namespace mlpack
+
+// Include implementation
+#include "sync_learning_impl.hpp"
+
+#endif
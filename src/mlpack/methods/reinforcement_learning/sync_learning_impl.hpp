@@ -0,0 +1,89 @@
+/**
+ * @file sync_learning_impl.hpp
+ * @author agent
+ *
+ * This file is the implementation of SyncLearning class, which is a wrapper
+ * for synchronous learning algorithms over a batch of environments.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_SYNC_LEARNING_IMPL_HPP
+#define MLPACK_METHODS_RL_SYNC_LEARNING_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sync_learning.hpp"
+
+namespace mlpack {
+namespace rl {
+
+template <
+  typename WorkerType,
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+SyncLearning<
+  WorkerType,
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  PolicyType
+>::SyncLearning(
+    TrainingConfig config,
+    NetworkType network,
+    PolicyType policy,
+    UpdaterType updater,
+    EnvironmentType environment):
+    config(std::move(config)),
+    learningNetwork(std::move(network)),
+    policy(std::move(policy)),
+    updater(std::move(updater)),
+    environment(std::move(environment))
+{ /* Nothing to do here. */ };
+
+template <
+  typename WorkerType,
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+template <typename Measure>
+void SyncLearning<
+  WorkerType,
+  EnvironmentType,
+  NetworkType,
+  UpdaterType,
+  PolicyType
+>::Train(Measure& measure)
+{
+  if (learningNetwork.Parameters().is_empty())
+    learningNetwork.ResetParameters();
+  NetworkType targetNetwork = learningNetwork;
+  size_t totalSteps = 0;
+
+  WorkerType worker(updater, environment, config);
+  worker.Initialize(learningNetwork);
+
+  // The worker steps all its environments at once, and reports the return of
+  // each finished test episode.
+  bool stop = false;
+  while (!stop)
+  {
+    double episodeReturn;
+    if (worker.Step(learningNetwork, targetNetwork, totalSteps, policy,
+        episodeReturn))
+    {
+      stop = measure(episodeReturn);
+    }
+  }
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_RL_WORKER_ONE_STEP_SARSA_WORKER_HPP
 
 #include <mlpack/methods/reinforcement_learning/training_config.hpp>
+#include <mlpack/methods/reinforcement_learning/parameter_server.hpp>
 
 namespace mlpack {
 namespace rl {
@@ -69,23 +70,24 @@ class OneStepSarsaWorker
   {
     updater.Initialize(learningNetwork.Parameters().n_rows,
         learningNetwork.Parameters().n_cols);
-    // Build local network.
+    // Build local networks; afterwards only their parameters are synced.
     network = learningNetwork;
+    targetNetwork = learningNetwork;
+    targetVersion = 0;
   }
 
   /**
    * The agent will execute one step.
    *
-   * @param learningNetwork The shared learning network.
-   * @param targetNetwork The shared target network.
+   * @param parameterServer The shared parameters of the learning and the
+   *     target network.
    * @param totalSteps The shared counter for total steps.
    * @param policy The shared behavior policy.
    * @param totalReward This will be the episode return if the episode ends
    *     after this step. Otherwise this is invalid.
    * @return Indicate whether current episode ends after this step.
    */
-  bool Step(NetworkType& learningNetwork,
-            NetworkType& targetNetwork,
+  bool Step(ParameterServer& parameterServer,
             size_t& totalSteps,
             PolicyType& policy,
             double& totalReward)
@@ -116,7 +118,7 @@ class OneStepSarsaWorker
         totalReward = episodeReturn;
         Reset();
         // Sync with latest learning network.
-        network = learningNetwork;
+        parameterServer.Pull(network.Parameters());
         return true;
       }
       state = nextState;
@@ -133,19 +135,18 @@ class OneStepSarsaWorker
     if (terminal || pendingIndex >= config.UpdateInterval())
     {
       // Initialize the gradient storage.
-      arma::mat totalGradients(learningNetwork.Parameters().n_rows,
-          learningNetwork.Parameters().n_cols, arma::fill::zeros);
+      arma::mat totalGradients(network.Parameters().n_rows,
+          network.Parameters().n_cols, arma::fill::zeros);
+
+      // Sync the local target network if the shared one has changed.
+      parameterServer.PullTarget(targetNetwork.Parameters(), targetVersion);
       for (size_t i = 0; i < pending.size(); ++i)
       {
         TransitionType &transition = pending[i];
 
         // Compute the target state-action value.
         arma::colvec actionValue;
-        #pragma omp critical
-        {
-          targetNetwork.Predict(
-              std::get<3>(transition).Encode(), actionValue);
-        };
+        targetNetwork.Predict(std::get<3>(transition).Encode(), actionValue);
         double targetActionValue = 0;
         if (!(terminal && i == pending.size() - 1))
           targetActionValue = actionValue[std::get<4>(transition)];
@@ -170,22 +171,23 @@ class OneStepSarsaWorker
           { return std::min(std::max(gradient, -config.GradientLimit()),
           config.GradientLimit()); });
 
-      // Perform async update of the global network.
-      updater.Update(learningNetwork.Parameters(),
-          config.StepSize(), totalGradients);
+      // Perform async update of the global network: apply the update to a
+      // copy of the local parameters, and push the difference.
+      arma::mat& parameters = network.Parameters();
+      update = parameters;
+      updater.Update(update, config.StepSize(), totalGradients);
+      update -= parameters;
+      parameterServer.Push(update);
 
       // Sync the local network with the global network.
-      network = learningNetwork;
+      parameterServer.Pull(parameters);
 
       pendingIndex = 0;
     }
 
     // Update global target network.
     if (totalSteps % config.TargetNetworkSyncInterval() == 0)
-    {
-      #pragma omp critical
-      { targetNetwork = learningNetwork; }
-    }
+      parameterServer.SyncTarget();
 
     policy.Anneal();
 
@@ -240,6 +242,15 @@ class OneStepSarsaWorker
   //! Local network of the worker.
   NetworkType network;
 
+  //! Local copy of the target network.
+  NetworkType targetNetwork;
+
+  //! The version of the target parameters in the local target network.
+  size_t targetVersion;
+
+  //! Buffer for the update of the parameters.
+  arma::mat update;
+
   //! Current state of the agent.
   StateType state;
 
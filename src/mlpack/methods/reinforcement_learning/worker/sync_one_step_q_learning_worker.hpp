@@ -0,0 +1,217 @@
+/**
+ * @file sync_one_step_q_learning_worker.hpp
+ * @author agent
+ *
+ * This file is the definition of SyncOneStepQLearningWorker class, which
+ * implements synchronous one step Q-Learning over a batch of environments.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_WORKER_SYNC_ONE_STEP_Q_LEARNING_WORKER_HPP
+#define MLPACK_METHODS_RL_WORKER_SYNC_ONE_STEP_Q_LEARNING_WORKER_HPP
+
+#include <mlpack/methods/reinforcement_learning/training_config.hpp>
+#include <mlpack/methods/reinforcement_learning/environment/vectorized_environment.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Synchronous one step Q-Learning worker.  Instead of one environment per
+ * thread, the worker steps config.NumWorkers() environments together: all of
+ * their states are evaluated with one batched forward pass of the learning
+ * network, all of their targets with one batched forward pass of the target
+ * network, and all of their transitions are learned from with one batched
+ * backward pass.  Since the worker runs in a single thread, the networks need
+ * no locking.
+ *
+ * One more environment runs the deterministic test episodes, in the same
+ * forward pass; its transitions aren't learned from.
+ *
+ * @tparam EnvironmentType The type of the reinforcement learning task.
+ * @tparam NetworkType The type of the network model.
+ * @tparam UpdaterType The type of the optimizer.
+ * @tparam PolicyType The type of the behavior policy.
+ */
+template <
+  typename EnvironmentType,
+  typename NetworkType,
+  typename UpdaterType,
+  typename PolicyType
+>
+class SyncOneStepQLearningWorker
+{
+ public:
+  using StateType = typename EnvironmentType::State;
+  using ActionType = typename EnvironmentType::Action;
+
+  /**
+   * Construct the synchronous one step Q-Learning worker with the given
+   * parameters and environment.
+   *
+   * @param updater The optimizer.
+   * @param environment The reinforcement learning task.
+   * @param config Hyper-parameters.
+   */
+  SyncOneStepQLearningWorker(
+      const UpdaterType& updater,
+      const EnvironmentType& environment,
+      const TrainingConfig& config):
+      updater(updater),
+      environments(config.NumWorkers() + 1, environment, config.StepLimit()),
+      config(config),
+      actions(config.NumWorkers() + 1),
+      pendingSteps(0)
+  {
+    if (config.NumWorkers() == 0)
+    {
+      throw std::invalid_argument("SyncOneStepQLearningWorker: the number of "
+          "workers (environments) must be positive!");
+    }
+  }
+
+  /**
+   * Initialize the worker.
+   * @param learningNetwork The learning network.
+   */
+  void Initialize(NetworkType& learningNetwork)
+  {
+    updater.Initialize(learningNetwork.Parameters().n_rows,
+        learningNetwork.Parameters().n_cols);
+    totalGradients.zeros(learningNetwork.Parameters().n_rows,
+        learningNetwork.Parameters().n_cols);
+  }
+
+  /**
+   * Every environment will execute one step.
+   *
+   * @param learningNetwork The learning network.
+   * @param targetNetwork The target network.
+   * @param totalSteps The counter for total steps.
+   * @param policy The behavior policy.
+   * @param totalReward This will be the return of the test episode if it ends
+   *     after this step. Otherwise this is invalid.
+   * @return Indicate whether the test episode ends after this step.
+   */
+  bool Step(NetworkType& learningNetwork,
+            NetworkType& targetNetwork,
+            size_t& totalSteps,
+            PolicyType& policy,
+            double& totalReward)
+  {
+    // Evaluate the states of all environments with one forward pass.  The
+    // first environment runs the test episode.
+    environments.Encode(states);
+    learningNetwork.Forward(states, actionValues);
+    for (size_t i = 0; i < actions.size(); ++i)
+      actions[i] = policy.Sample(actionValues.unsafe_col(i), i == 0);
+
+    // Interact with the environments.
+    environments.Step(actions, nextStates, rewards, isTerminal);
+
+    // Compute the target state-action values with one forward pass of the
+    // target network.
+    targetNetwork.Forward(nextStates, nextActionValues);
+
+    // The target of the test environment is its own output, so it doesn't
+    // contribute to the gradients.
+    for (size_t i = 1; i < actions.size(); ++i)
+    {
+      const double targetActionValue = isTerminal[i] ? 0.0 :
+          nextActionValues.col(i).max();
+      actionValues(actions[i], i) = rewards[i] + config.Discount() *
+          targetActionValue;
+    }
+
+    // The activations of the learning network are still those of the states,
+    // so the gradients of all transitions come from one backward pass.
+    learningNetwork.Backward(std::move(actionValues), gradients);
+    totalGradients += gradients;
+
+    if (++pendingSteps >= config.UpdateInterval())
+    {
+      // Clamp the accumulated gradients.
+      totalGradients.transform(
+          [&](double gradient)
+          { return std::min(std::max(gradient, -config.GradientLimit()),
+          config.GradientLimit()); });
+
+      updater.Update(learningNetwork.Parameters(), config.StepSize(),
+          totalGradients);
+
+      totalGradients.zeros();
+      pendingSteps = 0;
+    }
+
+    // Update the target network whenever the step counter passes a multiple
+    // of the sync interval.
+    const size_t newSteps = actions.size() - 1;
+    const size_t syncInterval = config.TargetNetworkSyncInterval();
+    if ((totalSteps + newSteps) / syncInterval != totalSteps / syncInterval)
+      targetNetwork = learningNetwork;
+    totalSteps += newSteps;
+
+    for (size_t i = 0; i < newSteps; ++i)
+      policy.Anneal();
+
+    if (isTerminal[0])
+    {
+      totalReward = environments.LastEpisodeReturns()[0];
+      return true;
+    }
+
+    return false;
+  }
+
+  //! Get the environments.
+  const VectorizedEnvironment<EnvironmentType>& Environments() const
+  { return environments; }
+
+ private:
+  //! Locally-stored optimizer.
+  UpdaterType updater;
+
+  //! Locally-stored tasks; the first one runs the test episodes.
+  VectorizedEnvironment<EnvironmentType> environments;
+
+  //! Locally-stored hyper-parameters.
+  TrainingConfig config;
+
+  //! Locally-stored actions of the current step.
+  std::vector<ActionType> actions;
+
+  //! Number of steps whose gradients haven't been applied yet.
+  size_t pendingSteps;
+
+  //! Locally-stored encoded states of the current step.
+  arma::mat states;
+
+  //! Locally-stored action values of the current states.
+  arma::mat actionValues;
+
+  //! Locally-stored encoded next states.
+  arma::mat nextStates;
+
+  //! Locally-stored action values of the next states.
+  arma::mat nextActionValues;
+
+  //! Locally-stored rewards of the current step.
+  arma::colvec rewards;
+
+  //! Locally-stored terminal indicators of the current step.
+  arma::icolvec isTerminal;
+
+  //! Locally-stored gradients of the current step.
+  arma::mat gradients;
+
+  //! Locally-stored gradients accumulated since the last update.
+  arma::mat totalGradients;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
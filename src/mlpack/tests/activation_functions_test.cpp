@@ -114,6 +114,38 @@ void CheckInverseCorrect(const arma::colvec input)
   }
 }
 
+/*
+ * Check that running the activation layer in place gives the same activations,
+ * and that the fused backward pass gives the error times the derivatives.
+ *
+ * @param input Input data used for evaluating the activation function.
+ *
+ * @tparam ActivationFunction Activation function used for the check.
+ */
+template<class ActivationFunction>
+void CheckFusedLayerCorrect(const arma::mat& input)
+{
+  BaseLayer<ActivationFunction> layer;
+
+  arma::mat activations;
+  layer.Forward(std::move(input), std::move(activations));
+
+  // The same matrix may be used as input and output.
+  arma::mat inPlaceActivations(input);
+  layer.Forward(std::move(inPlaceActivations),
+      std::move(inPlaceActivations));
+  CheckMatrices(inPlaceActivations, activations);
+
+  arma::mat error = arma::randn<arma::mat>(input.n_rows, input.n_cols);
+  arma::mat gradient;
+  layer.Backward(std::move(activations), std::move(error),
+      std::move(gradient));
+
+  arma::mat derivatives;
+  ActivationFunction::Deriv(activations, derivatives);
+  CheckMatrices(gradient, error % derivatives);
+}
+
 /*
  * Implementation of the HardTanH activation function test. The function is
  * implemented as a HardTanH Layer in hard_tanh.hpp
@@ -484,4 +516,42 @@ BOOST_AUTO_TEST_CASE(PReLUFunctionTest)
   CheckPReLUGradientCorrect(activationData, desiredGradient);
 }
 
+/**
+ * Make sure that the activation layers run in place, and that their fused
+ * backward passes match the error times the derivatives.
+ */
+BOOST_AUTO_TEST_CASE(FusedActivationLayerTest)
+{
+  arma::mat input = 3 * arma::randn<arma::mat>(10, 5);
+
+  CheckFusedLayerCorrect<LogisticFunction>(input);
+  CheckFusedLayerCorrect<IdentityFunction>(input);
+  CheckFusedLayerCorrect<TanhFunction>(input);
+  CheckFusedLayerCorrect<RectifierFunction>(input);
+  CheckFusedLayerCorrect<SoftplusFunction>(input);
+  CheckFusedLayerCorrect<SoftsignFunction>(input);
+
+  // The backward pass of the other layers must be linear in the error.
+  arma::mat error = arma::randn<arma::mat>(10, 5);
+  arma::mat ones = arma::ones<arma::mat>(10, 5);
+  arma::mat gradient, derivatives;
+
+  LeakyReLU<> leakyReLU;
+  leakyReLU.Backward(std::move(input), std::move(error), std::move(gradient));
+  leakyReLU.Backward(std::move(input), std::move(ones),
+      std::move(derivatives));
+  CheckMatrices(gradient, error % derivatives);
+
+  ELU<> elu;
+  elu.Backward(std::move(input), std::move(error), std::move(gradient));
+  elu.Backward(std::move(input), std::move(ones), std::move(derivatives));
+  CheckMatrices(gradient, error % derivatives);
+
+  HardTanH<> hardTanH;
+  hardTanH.Backward(std::move(input), std::move(error), std::move(gradient));
+  hardTanH.Backward(std::move(input), std::move(ones),
+      std::move(derivatives));
+  CheckMatrices(gradient, error % derivatives);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
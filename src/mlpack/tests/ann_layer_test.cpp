@@ -14,10 +14,11 @@
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/layer/layer_types.hpp>
 #include <mlpack/methods/ann/init_rules/random_init.hpp>
-#include <mlpack/methods/ann/init_rules/const_init.hpp>
 #include <mlpack/methods/ann/init_rules/nguyen_widrow_init.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
 #include <mlpack/methods/ann/rnn.hpp>
+#include <mlpack/methods/ann/buffer_stack.hpp>
+#include <mlpack/methods/ann/visitor/quantize_visitor.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -831,9 +832,8 @@ BOOST_AUTO_TEST_CASE(ForwardGRULayerTest)
   GRU<> gru(3, 3, 5);
 
   // Initialize the weights to all ones.
-  NetworkInitialization<ConstInitialization>
-    networkInit(ConstInitialization(1));
-  networkInit.Initialize(gru.Model(), gru.Parameters());
+  gru.Parameters().ones();
+  gru.Reset();
 
   // Provide input of all ones.
   arma::mat input = arma::ones(3, 1);
@@ -877,6 +877,70 @@ BOOST_AUTO_TEST_CASE(ForwardGRULayerTest)
 }
 
 
+/**
+ * Make sure that the LSTM and GRU layers compute the same outputs and input
+ * errors for a batch of sequences as for each sequence on its own.
+ */
+template<typename LayerType>
+void CheckRecurrentBatch()
+{
+  const size_t steps = 4, batchSize = 3;
+
+  LayerType layer(5, 3);
+  layer.Parameters().randn();
+  layer.Reset();
+
+  arma::cube input = arma::randu(5, batchSize, steps);
+  arma::cube error = arma::randu(3, batchSize, steps);
+
+  // Run the whole batch through the layer.
+  arma::cube batchOutput(3, batchSize, steps);
+  arma::cube batchDelta(5, batchSize, steps);
+  arma::mat output, delta, gy;
+  layer.ResetCell();
+  for (size_t t = 0; t < steps; ++t)
+  {
+    arma::mat stepInput = input.slice(t);
+    layer.Forward(std::move(stepInput), std::move(output));
+    batchOutput.slice(t) = output;
+  }
+  for (size_t t = steps; t > 0; --t)
+  {
+    gy = error.slice(t - 1);
+    layer.Backward(std::move(output), std::move(gy), std::move(delta));
+    batchDelta.slice(t - 1) = delta;
+  }
+
+  // Now run each sequence on its own.
+  for (size_t b = 0; b < batchSize; ++b)
+  {
+    layer.ResetCell();
+    for (size_t t = 0; t < steps; ++t)
+    {
+      arma::mat stepInput = input.slice(t).col(b);
+      layer.Forward(std::move(stepInput), std::move(output));
+      for (size_t i = 0; i < output.n_elem; ++i)
+        BOOST_REQUIRE_CLOSE(output[i], batchOutput(i, b, t), 1e-5);
+    }
+    for (size_t t = steps; t > 0; --t)
+    {
+      gy = error.slice(t - 1).col(b);
+      layer.Backward(std::move(output), std::move(gy), std::move(delta));
+      for (size_t i = 0; i < delta.n_elem; ++i)
+        BOOST_REQUIRE_CLOSE(delta[i], batchDelta(i, b, t - 1), 1e-5);
+    }
+  }
+}
+
+/**
+ * LSTM and GRU batch test.
+ */
+BOOST_AUTO_TEST_CASE(BatchRecurrentCellTest)
+{
+  CheckRecurrentBatch<LSTM<> >();
+  CheckRecurrentBatch<GRU<> >();
+}
+
 /**
  * Simple concat module test.
  */
@@ -1104,4 +1168,242 @@ BOOST_AUTO_TEST_CASE(SimpleMeanSquaredErrorLayerTest)
 }
 
 
+/**
+ * The Convolution layer should give the same results with the im2col rules as
+ * with the naive rules.
+ */
+BOOST_AUTO_TEST_CASE(Im2ColConvolutionLayerTest)
+{
+  Convolution<> naive(3, 4, 3, 3, 1, 1, 0, 0, 7, 6);
+  Convolution<Im2ColConvolution<ValidConvolution>,
+              Im2ColConvolution<FullConvolution>,
+              Im2ColConvolution<ValidConvolution> > im2col(3, 4, 3, 3, 1, 1,
+      0, 0, 7, 6);
+
+  naive.Parameters().randu();
+  im2col.Parameters() = naive.Parameters();
+  naive.Reset();
+  im2col.Reset();
+
+  arma::mat input = arma::randu(7 * 6 * 3, 1);
+  arma::mat naiveOutput, im2colOutput;
+  naive.Forward(std::move(input), std::move(naiveOutput));
+  im2col.Forward(std::move(input), std::move(im2colOutput));
+  BOOST_REQUIRE_EQUAL(im2colOutput.n_elem, 5 * 4 * 4);
+  CheckMatrices(naiveOutput, im2colOutput);
+
+  arma::mat error = arma::randu(naiveOutput.n_elem, 1);
+  arma::mat naiveDelta, im2colDelta;
+  naive.Backward(std::move(input), std::move(error), std::move(naiveDelta));
+  im2col.Backward(std::move(input), std::move(error), std::move(im2colDelta));
+  CheckMatrices(naiveDelta, im2colDelta);
+
+  // An input that does not hold exactly one sample must be rejected.
+  arma::mat batch = arma::randu(7 * 6 * 3, 2);
+  BOOST_REQUIRE_THROW(naive.Forward(std::move(batch), std::move(naiveOutput)),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(im2col.Forward(std::move(batch),
+      std::move(im2colOutput)), std::invalid_argument);
+}
+
+/**
+ * Jacobian test for the Convolution layer with the im2col rules, with padding
+ * and a stride.
+ */
+BOOST_AUTO_TEST_CASE(JacobianIm2ColConvolutionLayerTest)
+{
+  Convolution<Im2ColConvolution<ValidConvolution>,
+              Im2ColConvolution<FullConvolution>,
+              Im2ColConvolution<ValidConvolution> > module(2, 3, 3, 3, 2, 2,
+      1, 1, 5, 5);
+  module.Parameters().randu();
+
+  arma::mat input = arma::zeros(5 * 5 * 2, 1);
+  double error = JacobianTest(module, input);
+  BOOST_REQUIRE_LE(error, 1e-5);
+}
+
+/**
+ * Convolution layer with the im2col rules numerically gradient test.
+ */
+BOOST_AUTO_TEST_CASE(GradientIm2ColConvolutionLayerTest)
+{
+  // Convolution function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(6 * 6 * 2, 1);
+      target = arma::mat("1");
+
+      model = new FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>(
+          input, target);
+      model->Add<Convolution<Im2ColConvolution<ValidConvolution>,
+          Im2ColConvolution<FullConvolution>,
+          Im2ColConvolution<ValidConvolution> > >(2, 3, 3, 3, 2, 2, 1, 1, 6,
+          6);
+      model->Add<Linear<> >(3 * 3 * 3, 2);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      arma::mat output;
+      double error = model->Evaluate(model->Parameters(), 0);
+      model->Gradient(model->Parameters(), 0, gradient);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
+/**
+ * Make sure that the BufferStack restores the values in reverse order and
+ * reuses the memory of popped matrices.
+ */
+BOOST_AUTO_TEST_CASE(BufferStackTest)
+{
+  BufferStack<arma::mat> stack;
+  BOOST_REQUIRE(stack.Empty());
+
+  arma::mat a = arma::randu<arma::mat>(100, 1);
+  arma::mat b = arma::randu<arma::mat>(100, 1);
+
+  stack.Push(a);
+  stack.Push(b);
+  BOOST_REQUIRE_EQUAL(stack.Size(), 2);
+
+  CheckMatrices(stack.Top(), b);
+  const double* second = stack.Top().memptr();
+  stack.Pop();
+  CheckMatrices(stack.Top(), a);
+  const double* first = stack.Top().memptr();
+  stack.Pop();
+  BOOST_REQUIRE(stack.Empty());
+
+  // Pushing matrices of the same size again must not allocate memory.
+  BOOST_REQUIRE_EQUAL(stack.Push(b).memptr(), first);
+  BOOST_REQUIRE_EQUAL(stack.Push(a).memptr(), second);
+  CheckMatrices(stack.Top(), a);
+}
+
+/**
+ * Make sure that the half precision conversions are exact where they should be
+ * and round correctly elsewhere.
+ */
+BOOST_AUTO_TEST_CASE(HalfPrecisionConversionTest)
+{
+  // These values can be represented exactly.
+  const float exact[] = { 0.0f, 1.0f, -2.5f, 0.5f, 65504.0f,
+      std::ldexp(1.0f, -14), std::ldexp(1.0f, -24), -std::ldexp(3.0f, -20) };
+  for (const float value : exact)
+    BOOST_REQUIRE_EQUAL(HalfToFloat(FloatToHalf(value)), value);
+
+  BOOST_REQUIRE_EQUAL(FloatToHalf(1.0f), 0x3C00);
+  BOOST_REQUIRE_EQUAL(FloatToHalf(-2.0f), 0xC000);
+  BOOST_REQUIRE_EQUAL(FloatToHalf(65520.0f), 0x7C00);
+  BOOST_REQUIRE_EQUAL(FloatToHalf(std::ldexp(1.0f, -26)), 0);
+
+  // Other values have a relative error of at most 2^-11.
+  arma::mat values = arma::randu(1000) * 200 - 100;
+  for (size_t i = 0; i < values.n_elem; ++i)
+  {
+    const float value = float(values[i]);
+    BOOST_REQUIRE_LE(std::abs(HalfToFloat(FloatToHalf(value)) - value),
+        std::ldexp(std::abs(value), -11));
+  }
+}
+
+/**
+ * Quantize the given layer with the range of the given input, and check that
+ * the quantized layer (of the given type) gives nearly the same output with
+ * much less memory.
+ */
+template<typename QuantizedLayerType, typename LayerType>
+void CheckQuantizedLayer(LayerType& layer,
+                         arma::mat& input,
+                         const QuantizationType type,
+                         const double tolerance)
+{
+  arma::mat output, quantizedOutput;
+  layer.Forward(std::move(input), std::move(output));
+
+  LayerTypes quantized = QuantizeVisitor(arma::max(arma::vectorise(
+      arma::abs(input))), type)(&layer);
+  QuantizedLayerType* quantizedLayer =
+      boost::get<QuantizedLayerType*>(quantized);
+
+  quantizedLayer->Forward(std::move(input), std::move(quantizedOutput));
+  BOOST_REQUIRE_EQUAL(quantizedOutput.n_rows, output.n_rows);
+  BOOST_REQUIRE_EQUAL(quantizedOutput.n_cols, output.n_cols);
+  BOOST_REQUIRE_LE(arma::max(arma::vectorise(arma::abs(quantizedOutput -
+      output))), tolerance * arma::max(arma::vectorise(arma::abs(output))));
+
+  BOOST_REQUIRE_LT(quantizedLayer->Weights().MemoryUsage(),
+      layer.Parameters().n_elem * sizeof(double) / 2);
+
+  delete quantizedLayer;
+}
+
+/**
+ * The quantized Linear, LinearNoBias, Convolution and Lookup layers should give
+ * nearly the same results as the layers they were made from.
+ */
+BOOST_AUTO_TEST_CASE(QuantizedLayerTest)
+{
+  Linear<> linear(10, 5);
+  linear.Parameters().randu();
+  linear.Reset();
+
+  LinearNoBias<> linearNoBias(10, 5);
+  linearNoBias.Parameters().randu();
+  linearNoBias.Reset();
+
+  Convolution<> convolution(2, 3, 3, 3, 2, 2, 1, 1, 6, 6);
+  convolution.Parameters().randu();
+  convolution.Reset();
+
+  Lookup<> lookup(10, 5);
+  lookup.Parameters().randu();
+
+  arma::mat input = arma::randu(10, 4);
+  arma::mat convolutionInput = arma::randu(6 * 6 * 2, 1);
+  arma::mat lookupInput("1; 3; 10");
+
+  const QuantizationType types[] = { INT8_QUANTIZATION, FP16_QUANTIZATION };
+  for (const QuantizationType type : types)
+  {
+    const double tolerance = (type == INT8_QUANTIZATION) ? 0.05 : 1e-3;
+
+    CheckQuantizedLayer<QuantizedLinear<> >(linear, input, type, tolerance);
+    CheckQuantizedLayer<QuantizedLinear<> >(linearNoBias, input, type,
+        tolerance);
+    CheckQuantizedLayer<QuantizedConvolution<> >(convolution,
+        convolutionInput, type, tolerance);
+    CheckQuantizedLayer<QuantizedLookup<> >(lookup, lookupInput, type,
+        tolerance);
+  }
+
+  // An input that does not hold exactly one sample must be rejected.
+  LayerTypes quantized = QuantizeVisitor(1.0, INT8_QUANTIZATION)(&convolution);
+  QuantizedConvolution<>* quantizedConvolution =
+      boost::get<QuantizedConvolution<>*>(quantized);
+  arma::mat batch = arma::randu(6 * 6 * 2, 2);
+  arma::mat output;
+  BOOST_REQUIRE_THROW(quantizedConvolution->Forward(std::move(batch),
+      std::move(output)), std::invalid_argument);
+  delete quantizedConvolution;
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -15,6 +15,7 @@
 #include <mlpack/methods/ann/init_rules/gaussian_init.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/reinforcement_learning/async_learning.hpp>
+#include <mlpack/methods/reinforcement_learning/sync_learning.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/cart_pole.hpp>
 #include <mlpack/core/optimizers/adam/adam_update.hpp>
 #include <mlpack/methods/reinforcement_learning/policy/greedy_policy.hpp>
@@ -217,4 +218,61 @@ BOOST_AUTO_TEST_CASE(NStepQLearningTest)
   Log::Debug << "Total test episodes: " << testEpisodes << std::endl;
 }
 
+// Test sync one step q-learning over a batch of Cart Poles.
+BOOST_AUTO_TEST_CASE(SyncOneStepQLearningTest)
+{
+  // Set up the network.
+  FFN<MeanSquaredError<>, GaussianInitialization> model(MeanSquaredError<>(),
+      GaussianInitialization(0, 0.001));
+  model.Add<Linear<>>(4, 20);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(20, 20);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(20, 2);
+
+  // Set up the policy.
+  using Policy = GreedyPolicy<CartPole>;
+  AggregatedPolicy<Policy> policy({Policy(0.7, 5000, 0.1),
+                                  Policy(0.7, 5000, 0.01),
+                                  Policy(0.7, 5000, 0.5)},
+                                  arma::colvec("0.4 0.3 0.3"));
+
+  // Every step handles a batch of 16 transitions, so the network is updated
+  // after each one.
+  TrainingConfig config;
+  config.StepSize() = 0.0001;
+  config.Discount() = 0.99;
+  config.NumWorkers() = 16;
+  config.UpdateInterval() = 1;
+  config.StepLimit() = 200;
+  config.TargetNetworkSyncInterval() = 200;
+
+  SyncOneStepQLearning<CartPole, decltype(model), VanillaUpdate,
+      decltype(policy)> agent(std::move(config), std::move(model),
+      std::move(policy));
+
+  arma::vec rewards(20, arma::fill::zeros);
+  size_t pos = 0;
+  size_t testEpisodes = 0;
+  auto measure = [&rewards, &pos, &testEpisodes](double reward)
+  {
+    size_t maxEpisode = 10000;
+    if (testEpisodes > maxEpisode)
+      BOOST_REQUIRE(false);
+    testEpisodes++;
+    rewards[pos++] = reward;
+    pos %= rewards.n_elem;
+    // Maybe underestimated.
+    double avgReward = arma::mean(rewards);
+    Log::Debug << "Average return: " << avgReward
+        << " Episode return: " << reward << std::endl;
+    if (avgReward > 60)
+      return true;
+    return false;
+  };
+
+  agent.Train(measure);
+  Log::Debug << "Total test episodes: " << testEpisodes << std::endl;
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -167,4 +167,29 @@ BOOST_AUTO_TEST_CASE(SparseTest)
   BOOST_REQUIRE_EQUAL(distances.n_rows, 3);
 }
 
+// Make sure that the batch size does not change the results.
+BOOST_AUTO_TEST_CASE(BatchSizeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  arma::mat querySet = arma::randu<arma::mat>(5, 300);
+
+  DrusillaSelect<> ds(dataset, 5, 10);
+
+  arma::Mat<size_t> neighbors, batchNeighbors;
+  arma::mat distances, batchDistances;
+
+  ds.Search(querySet, 3, neighbors, distances, 1);
+  ds.Search(querySet, 3, batchNeighbors, batchDistances, 64);
+
+  CheckMatrices(neighbors, batchNeighbors);
+  CheckMatrices(distances, batchDistances);
+
+  // The number of threads should not change the results either.
+  ds.NumThreads() = 1;
+  ds.Search(querySet, 3, batchNeighbors, batchDistances, 64);
+
+  CheckMatrices(neighbors, batchNeighbors);
+  CheckMatrices(distances, batchDistances);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -278,4 +278,31 @@ BOOST_AUTO_TEST_CASE(BallTreeTest)
   }
 }
 
+/**
+ * Compute the MST of single-precision data; its total length should match the
+ * MST computed in double precision.
+ */
+BOOST_AUTO_TEST_CASE(FloatDTBTest)
+{
+  arma::mat inputData;
+  if (!data::Load("test_data_3_1000.csv", inputData))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  // naive mode.
+  DualTreeBoruvka<> bst(inputData, true);
+  arma::fmat floatData = arma::conv_to<arma::fmat>::from(inputData);
+  DualTreeBoruvka<EuclideanDistance, arma::fmat> floatDTB(floatData);
+
+  arma::mat bstResults;
+  arma::mat floatResults;
+
+  // Run the algorithms.
+  bst.ComputeMST(bstResults);
+  floatDTB.ComputeMST(floatResults);
+
+  BOOST_REQUIRE_EQUAL(bstResults.n_cols, floatResults.n_cols);
+  BOOST_REQUIRE_CLOSE(arma::accu(bstResults.row(2)),
+      arma::accu(floatResults.row(2)), 1e-3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
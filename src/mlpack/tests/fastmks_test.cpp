@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/fastmks/fastmks.hpp>
 #include <mlpack/methods/fastmks/fastmks_model.hpp>
+#include <mlpack/methods/fastmks/fastmks_block_kernel.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -1082,4 +1083,130 @@ BOOST_AUTO_TEST_CASE(CopyAssignmentTest)
   }
 }
 
+/**
+ * Make sure that the block kernel evaluations used by naive search match the
+ * kernel evaluations of each pair of points.
+ */
+template<typename KernelType>
+void CheckBlockKernel(KernelType& kernel)
+{
+  arma::mat querySet = arma::randu<arma::mat>(4, 30);
+  arma::mat referenceSet = arma::randu<arma::mat>(4, 50);
+
+  arma::mat kernels;
+  BlockKernel(kernel, querySet, referenceSet, kernels);
+
+  BOOST_REQUIRE_EQUAL(kernels.n_rows, referenceSet.n_cols);
+  BOOST_REQUIRE_EQUAL(kernels.n_cols, querySet.n_cols);
+
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+  {
+    for (size_t r = 0; r < referenceSet.n_cols; ++r)
+    {
+      BOOST_REQUIRE_CLOSE(kernels(r, q), kernel.Evaluate(querySet.col(q),
+          referenceSet.col(r)), 1e-5);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BlockKernelTest)
+{
+  LinearKernel lk;
+  CheckBlockKernel(lk);
+  PolynomialKernel pk(3.0, 1.5);
+  CheckBlockKernel(pk);
+  GaussianKernel gk(0.8);
+  CheckBlockKernel(gk);
+  TriangularKernel tk(2.0);
+  CheckBlockKernel(tk);
+}
+
+/**
+ * Compare single-tree, dual-tree, and naive search with enough points that
+ * naive search uses several blocks, and the query tree is split into several
+ * subtrees for parallel search.
+ */
+BOOST_AUTO_TEST_CASE(GaussianTreeVsNaiveLargeTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(3, 1200);
+  arma::mat querySet = arma::randu<arma::mat>(3, 300);
+  GaussianKernel gk(0.5);
+
+  FastMKS<GaussianKernel> naive(referenceSet, gk, false, true);
+  FastMKS<GaussianKernel> single(referenceSet, gk, true);
+  FastMKS<GaussianKernel> dual(referenceSet, gk);
+
+  arma::Mat<size_t> naiveIndices, singleIndices, dualIndices;
+  arma::mat naiveKernels, singleKernels, dualKernels;
+
+  naive.Search(querySet, 5, naiveIndices, naiveKernels);
+  single.Search(querySet, 5, singleIndices, singleKernels);
+  dual.Search(querySet, 5, dualIndices, dualKernels);
+
+  for (size_t i = 0; i < naiveKernels.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(singleKernels[i], naiveKernels[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(dualKernels[i], naiveKernels[i], 1e-5);
+  }
+
+  // Also check the monochromatic case.
+  naive.Search(5, naiveIndices, naiveKernels);
+  single.Search(5, singleIndices, singleKernels);
+  dual.Search(5, dualIndices, dualKernels);
+
+  for (size_t i = 0; i < naiveKernels.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(singleKernels[i], naiveKernels[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(dualKernels[i], naiveKernels[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that the number of threads of a FastMKSModel doesn't change the
+ * results of any search mode, and that it is reset to 0 (all threads) when a
+ * model is loaded.
+ */
+BOOST_AUTO_TEST_CASE(FastMKSModelNumThreadsTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 800);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+  LinearKernel lk;
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    const bool single = (mode == 1);
+    const bool naive = (mode == 2);
+
+    FastMKSModel m(FastMKSModel::LINEAR_KERNEL);
+    m.BuildModel(referenceData, lk, single, naive, 2.0);
+    BOOST_REQUIRE_EQUAL(m.NumThreads(), 0);
+
+    arma::Mat<size_t> indices, threadIndices;
+    arma::mat kernels, threadKernels;
+
+    m.NumThreads() = 1;
+    m.Search(queryData, 3, indices, kernels, 2.0);
+    m.NumThreads() = 3;
+    m.Search(queryData, 3, threadIndices, threadKernels, 2.0);
+    CheckMatrices(threadIndices, indices);
+    CheckMatrices(threadKernels, kernels);
+
+    m.NumThreads() = 1;
+    m.Search(3, indices, kernels);
+    m.NumThreads() = 3;
+    m.Search(3, threadIndices, threadKernels);
+    CheckMatrices(threadIndices, indices);
+    CheckMatrices(threadKernels, kernels);
+
+    FastMKSModel xmlModel, textModel, binaryModel;
+    xmlModel.NumThreads() = 2;
+    textModel.NumThreads() = 2;
+    binaryModel.NumThreads() = 2;
+    SerializeObjectAll(m, xmlModel, textModel, binaryModel);
+    BOOST_REQUIRE_EQUAL(xmlModel.NumThreads(), 0);
+    BOOST_REQUIRE_EQUAL(textModel.NumThreads(), 0);
+    BOOST_REQUIRE_EQUAL(binaryModel.NumThreads(), 0);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
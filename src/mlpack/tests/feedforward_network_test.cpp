@@ -13,9 +13,13 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
 #include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/inference_session.hpp>
+
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -500,4 +504,259 @@ BOOST_AUTO_TEST_CASE(FFNMiscTest)
   movedModel = std::move(copiedModel);
 }
 
+/**
+ * Make sure that the layers of a copied network use the parameters of the
+ * copy, and not those of the original network.
+ */
+BOOST_AUTO_TEST_CASE(FFNCopyParametersTest)
+{
+  FFN<MeanSquaredError<>> model;
+  model.Add<Linear<>>(4, 8);
+  model.Add<SigmoidLayer<>>();
+  model.Add<Linear<>>(8, 2);
+  model.ResetParameters();
+
+  arma::mat input = arma::randu<arma::mat>(4, 5);
+  arma::mat output, copiedOutput;
+  model.Predict(input, output);
+
+  FFN<MeanSquaredError<>> copiedModel(model);
+  copiedModel.Predict(input, copiedOutput);
+  CheckMatrices(output, copiedOutput);
+
+  // Changing the parameters of the copy changes its predictions only.
+  copiedModel.Parameters() *= 2;
+  copiedModel.Predict(input, copiedOutput);
+  BOOST_REQUIRE_GT(arma::abs(output - copiedOutput).max(), 1e-3);
+
+  arma::mat newOutput;
+  model.Predict(input, newOutput);
+  CheckMatrices(output, newOutput);
+}
+
+/**
+ * Make sure that data-parallel training takes the same steps as plain
+ * mini-batch gradient descent, and that it is reproducible for a fixed number
+ * of shards.
+ */
+BOOST_AUTO_TEST_CASE(FFNTrainParallelTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 120);
+  arma::mat responses = arma::join_cols(arma::sum(data), arma::prod(data));
+
+  FFN<MeanSquaredError<>> model;
+  model.Add<Linear<>>(5, 16);
+  model.Add<SigmoidLayer<>>();
+  model.Add<Linear<>>(16, 2);
+  model.ResetParameters();
+
+  // Run the network once, so that training doesn't reset the parameters.
+  arma::mat output;
+  model.Predict(data.col(0), output);
+
+  // Take two epochs of steps over the mini-batches by hand.
+  const double stepSize = 0.01;
+  const size_t batchSize = 20;
+  FFN<MeanSquaredError<>> reference(model);
+  arma::mat gradient, pointGradient;
+  for (size_t epoch = 0; epoch < 2; ++epoch)
+  {
+    for (size_t begin = 0; begin < data.n_cols; begin += batchSize)
+    {
+      gradient.zeros(reference.Parameters().n_rows, 1);
+      for (size_t i = begin; i < begin + batchSize; ++i)
+      {
+        reference.Forward(data.col(i), output);
+        reference.Backward(responses.col(i), pointGradient);
+        gradient += pointGradient;
+      }
+      reference.Parameters() -= stepSize * gradient;
+    }
+  }
+
+  // SGD takes one step per mini-batch, so 12 steps are two epochs.
+  std::vector<arma::mat> parameters;
+  for (size_t shards : { 1, 4, 4 })
+  {
+    FFN<MeanSquaredError<>> parallelModel(model);
+    StandardSGD opt(stepSize, 13, -1, false);
+    parallelModel.TrainParallel(data, responses, opt, batchSize, shards);
+
+    CheckMatrices(parallelModel.Parameters(), reference.Parameters());
+    parameters.push_back(parallelModel.Parameters());
+  }
+
+  // The same number of shards gives the same bits.
+  for (size_t i = 0; i < parameters[1].n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(parameters[1][i], parameters[2][i]);
+}
+
+/**
+ * Make sure that an InferenceSession used by many threads at once gives the
+ * same predictions as the network it was made from.
+ */
+BOOST_AUTO_TEST_CASE(FFNInferenceSessionTest)
+{
+  FFN<NegativeLogLikelihood<>> model;
+  model.Add<Linear<>>(10, 8);
+  model.Add<SigmoidLayer<>>();
+  model.Add<Linear<>>(8, 3);
+  model.Add<LogSoftMax<>>();
+
+  arma::mat data = arma::randu<arma::mat>(10, 200);
+  arma::mat predictions;
+  model.Predict(data, predictions);
+
+  InferenceSession<FFN<NegativeLogLikelihood<>>> session(model, 4, 16, 200);
+  BOOST_REQUIRE_EQUAL(session.NumWorkers(), 4);
+  BOOST_REQUIRE_EQUAL(session.Parameters().n_elem, model.Parameters().n_elem);
+
+  // Each thread predicts its own columns, a few at a time.
+  const size_t numThreads = 8;
+  const size_t pointsPerThread = data.n_cols / numThreads;
+  arma::mat results(predictions.n_rows, data.n_cols);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      arma::mat queries, threadResults;
+      for (size_t i = 0; i < pointsPerThread;)
+      {
+        const size_t count = std::min(1 + (i + t) % 5, pointsPerThread - i);
+        const size_t first = t * pointsPerThread + i;
+        queries = data.cols(first, first + count - 1);
+        session.Predict(queries, threadResults);
+        results.cols(first, first + count - 1) = threadResults;
+        i += count;
+      }
+    });
+  }
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(results[i], predictions[i], 1e-5);
+}
+
+/**
+ * A network quantized to int8 or fp16 should predict nearly the same as the
+ * original network, without any of the weights of the quantized layers in its
+ * parameters.
+ */
+BOOST_AUTO_TEST_CASE(FFNQuantizeTest)
+{
+  FFN<NegativeLogLikelihood<>> model;
+  model.Add<Linear<>>(10, 8);
+  model.Add<SigmoidLayer<>>();
+  model.Add<LinearNoBias<>>(8, 8);
+  model.Add<PReLU<>>();
+  model.Add<Linear<>>(8, 3);
+  model.Add<LogSoftMax<>>();
+
+  arma::mat data = arma::randu<arma::mat>(10, 200);
+  arma::mat predictions;
+  model.Predict(data, predictions);
+
+  const QuantizationType types[] = { INT8_QUANTIZATION, FP16_QUANTIZATION };
+  for (const QuantizationType type : types)
+  {
+    FFN<NegativeLogLikelihood<>> quantizedModel(model);
+    quantizedModel.Quantize(data.cols(0, 99), type);
+
+    // Only the parameter of the PReLU layer is left.
+    BOOST_REQUIRE_EQUAL(quantizedModel.Parameters().n_elem, 1);
+    BOOST_REQUIRE_EQUAL(quantizedModel.Parameters()[0],
+        model.Parameters()[10 * 8 + 8 + 8 * 8]);
+
+    arma::mat quantizedPredictions;
+    quantizedModel.Predict(data, quantizedPredictions);
+    BOOST_REQUIRE_EQUAL(quantizedPredictions.n_rows, predictions.n_rows);
+    BOOST_REQUIRE_EQUAL(quantizedPredictions.n_cols, predictions.n_cols);
+
+    // The rounding of the inputs of the int8 layers occasionally causes a
+    // larger error, so only the mean error and the predicted classes are
+    // checked for them.
+    const arma::mat errors = arma::abs(quantizedPredictions - predictions);
+    if (type == FP16_QUANTIZATION)
+    {
+      BOOST_REQUIRE_LT(errors.max(), 1e-2);
+      continue;
+    }
+
+    BOOST_REQUIRE_LT(arma::mean(arma::vectorise(errors)), 0.02);
+
+    size_t agreements = 0;
+    for (size_t i = 0; i < predictions.n_cols; ++i)
+    {
+      arma::uword predicted, quantizedPredicted;
+      predictions.col(i).max(predicted);
+      quantizedPredictions.col(i).max(quantizedPredicted);
+      if (predicted == quantizedPredicted)
+        ++agreements;
+    }
+    BOOST_REQUIRE_GE(agreements, 190);
+  }
+}
+
+/**
+ * The activations that run in place on the output of the Linear layers should
+ * give the same outputs and gradients as when they don't (here, an identity
+ * layer before each activation keeps it from running in place), also when
+ * the batch size changes between passes.
+ */
+BOOST_AUTO_TEST_CASE(FFNInPlaceActivationTest)
+{
+  FFN<MeanSquaredError<>> model;
+  model.Add<Linear<>>(10, 8);
+  model.Add<SigmoidLayer<>>();
+  model.Add<LinearNoBias<>>(8, 8);
+  model.Add<ReLULayer<>>();
+  model.Add<Linear<>>(8, 8);
+  model.Add<TanHLayer<>>();
+  model.Add<Linear<>>(8, 3);
+
+  FFN<MeanSquaredError<>> unfusedModel;
+  unfusedModel.Add<Linear<>>(10, 8);
+  unfusedModel.Add<IdentityLayer<>>();
+  unfusedModel.Add<SigmoidLayer<>>();
+  unfusedModel.Add<LinearNoBias<>>(8, 8);
+  unfusedModel.Add<IdentityLayer<>>();
+  unfusedModel.Add<ReLULayer<>>();
+  unfusedModel.Add<Linear<>>(8, 8);
+  unfusedModel.Add<IdentityLayer<>>();
+  unfusedModel.Add<TanHLayer<>>();
+  unfusedModel.Add<Linear<>>(8, 3);
+
+  model.ResetParameters();
+  unfusedModel.ResetParameters();
+  unfusedModel.Parameters() = model.Parameters();
+
+  const size_t batchSizes[] = { 5, 1, 12, 5 };
+  for (const size_t batchSize : batchSizes)
+  {
+    arma::mat input = arma::randn<arma::mat>(10, batchSize);
+    arma::mat target = arma::randu<arma::mat>(3, batchSize);
+
+    arma::mat output, unfusedOutput;
+    model.Forward(input, output);
+    unfusedModel.Forward(input, unfusedOutput);
+    CheckMatrices(output, unfusedOutput);
+
+    arma::mat gradient, unfusedGradient;
+    const double error = model.Backward(target, gradient);
+    const double unfusedError = unfusedModel.Backward(target,
+        unfusedGradient);
+    BOOST_REQUIRE_CLOSE(error, unfusedError, 1e-5);
+    CheckMatrices(gradient, unfusedGradient);
+
+    // Predict() passes one point at a time, so the activations are aliased to
+    // smaller outputs and back again.
+    arma::mat predictions;
+    model.Predict(input, predictions);
+    CheckMatrices(predictions, output);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -1173,5 +1173,152 @@ BOOST_AUTO_TEST_CASE(DiscreteHMMLoadSaveTest)
           hmm2.Emission()[j].Probabilities()[i], 1e-3);
 }
 
+/**
+ * Make sure that the log-likelihood of high-dimensional Gaussian sequences is
+ * computed correctly, even when the emission densities themselves underflow.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMUnderflowLogLikelihoodTest)
+{
+  // With one state, the log-likelihood is just the sum of the log-densities.
+  HMM<GaussianDistribution> hmm(1, GaussianDistribution(200));
+  hmm.Transition().ones();
+  hmm.Initial().ones();
+
+  arma::mat obs = arma::randn<arma::mat>(200, 50) + 30.0;
+  BOOST_REQUIRE_EQUAL(hmm.Emission()[0].Probability(obs.unsafe_col(0)), 0.0);
+
+  arma::vec logProbs;
+  hmm.Emission()[0].LogProbability(obs, logProbs);
+
+  BOOST_REQUIRE_CLOSE(hmm.LogLikelihood(obs), arma::accu(logProbs), 1e-5);
+
+  // With two states, the state probabilities must still be well-defined.
+  std::vector<GaussianDistribution> emissions(2, GaussianDistribution(200));
+  emissions[1].Mean().fill(30.0);
+  arma::mat transition("0.9 0.1; 0.1 0.9");
+  HMM<GaussianDistribution> hmm2(arma::vec("0.5 0.5"), transition, emissions);
+
+  arma::mat stateProb;
+  const double loglik = hmm2.Estimate(obs, stateProb);
+  BOOST_REQUIRE(std::isfinite(loglik));
+  for (size_t t = 0; t < obs.n_cols; ++t)
+  {
+    BOOST_REQUIRE_CLOSE(arma::accu(stateProb.col(t)), 1.0, 1e-5);
+    BOOST_REQUIRE_GT(stateProb(1, t), 0.99);
+  }
+
+  arma::Row<size_t> states;
+  hmm2.Predict(obs, states);
+  for (size_t t = 0; t < obs.n_cols; ++t)
+    BOOST_REQUIRE_EQUAL(states[t], 1);
+}
+
+/**
+ * Make sure that training on many sequences at once (which is done in
+ * parallel, if OpenMP is available) recovers the true model.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMManySequencesTrainTest)
+{
+  std::vector<GaussianDistribution> emissions(2, GaussianDistribution(2));
+  emissions[1].Mean().fill(5.0);
+  arma::mat transition("0.8 0.3; 0.2 0.7");
+  HMM<GaussianDistribution> hmm(arma::vec("0.6 0.4"), transition, emissions);
+
+  std::vector<arma::mat> sequences(500);
+  std::vector<arma::Row<size_t>> states(500);
+  for (size_t i = 0; i < sequences.size(); ++i)
+    hmm.Generate(20 + math::RandInt(20), sequences[i], states[i],
+        (math::Random() < 0.6) ? 0 : 1);
+
+  // Start from the labeled estimate, perturbed; Baum-Welch should not go far
+  // from the truth.
+  HMM<GaussianDistribution> hmm2(2, GaussianDistribution(2));
+  hmm2.Train(sequences, states);
+  hmm2.Transition() = arma::mat("0.5 0.5; 0.5 0.5");
+
+  double oldLoglik = 0.0;
+  for (size_t i = 0; i < sequences.size(); ++i)
+    oldLoglik += hmm2.LogLikelihood(sequences[i]);
+
+  hmm2.Train(sequences);
+
+  double loglik = 0.0;
+  for (size_t i = 0; i < sequences.size(); ++i)
+    loglik += hmm2.LogLikelihood(sequences[i]);
+
+  BOOST_REQUIRE_GE(loglik, oldLoglik);
+  for (size_t i = 0; i < 2; ++i)
+    for (size_t j = 0; j < 2; ++j)
+      BOOST_REQUIRE_SMALL(hmm2.Transition()(i, j) - transition(i, j), 0.05);
+  BOOST_REQUIRE_SMALL(hmm2.Emission()[0].Mean()[0], 0.2);
+  BOOST_REQUIRE_CLOSE(hmm2.Emission()[1].Mean()[0], 5.0, 4.0);
+}
+
+/**
+ * Make sure that incremental filtering gives the same results as the
+ * forward-backward algorithm run on the whole sequence.
+ */
+BOOST_AUTO_TEST_CASE(FilterStateTest)
+{
+  std::vector<GaussianDistribution> emissions(3, GaussianDistribution(2));
+  emissions[1].Mean().fill(2.0);
+  emissions[2].Mean().fill(-2.0);
+  arma::mat transition("0.7 0.2 0.1; 0.2 0.6 0.3; 0.1 0.2 0.6");
+  HMM<GaussianDistribution> hmm(arma::vec("0.3 0.3 0.4"), transition,
+      emissions);
+
+  arma::mat obs;
+  arma::Row<size_t> states;
+  hmm.Generate(40, obs, states);
+
+  arma::mat stateProb, forwardProb, backwardProb;
+  arma::vec scales;
+  const double loglik = hmm.Estimate(obs, stateProb, forwardProb,
+      backwardProb, scales);
+
+  // Absorb the observations one at a time.
+  const size_t lag = 4;
+  HMM<GaussianDistribution>::FilterState filter(hmm, lag);
+  arma::vec smoothed;
+  for (size_t t = 0; t < obs.n_cols; ++t)
+  {
+    const double partialLoglik = filter.Update(obs.col(t));
+    BOOST_REQUIRE_CLOSE(partialLoglik, hmm.LogLikelihood(obs.cols(0, t)),
+        1e-5);
+
+    const arma::vec filtered = filter.StateProb();
+    for (size_t i = 0; i < 3; ++i)
+      BOOST_REQUIRE_CLOSE(filtered[i], forwardProb(i, t), 1e-5);
+  }
+
+  BOOST_REQUIRE_EQUAL(filter.Observations(), obs.n_cols);
+  BOOST_REQUIRE_CLOSE(filter.LogLikelihood(), loglik, 1e-5);
+
+  // The smoothed state at the end of the sequence is conditioned on the whole
+  // sequence.
+  filter.Smooth(smoothed);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(smoothed[i], stateProb(i, obs.n_cols - 1 - lag), 1e-5);
+
+  // Absorbing the observations in blocks should give the same results.
+  filter.Reset();
+  filter.Update(obs.cols(0, 16));
+  filter.Update(obs.cols(17, obs.n_cols - 1));
+  BOOST_REQUIRE_CLOSE(filter.LogLikelihood(), loglik, 1e-5);
+
+  arma::vec smoothed2;
+  filter.Smooth(smoothed2);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(smoothed2[i], smoothed[i], 1e-5);
+
+  // With a lag as long as the sequence, smoothing gives the state distribution
+  // at the first time step.
+  HMM<GaussianDistribution>::FilterState longFilter(hmm, 100);
+  longFilter.Update(obs);
+  longFilter.Smooth(smoothed);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(smoothed[i], stateProb(i, 0), 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
@@ -13,6 +13,7 @@
 #include <mlpack/methods/neighbor_search/unmap.hpp>
 #include <mlpack/methods/neighbor_search/ns_model.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/octree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -1434,4 +1435,314 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   CheckMatrices(distances, distances2);
 }
 
+/**
+ * Make sure that the sorted-array, heap and adaptive candidate lists hold the
+ * same candidates, that a list gives the same results when it is reset and
+ * reused, and that lists with no candidates work.
+ */
+BOOST_AUTO_TEST_CASE(CandidateListTest)
+{
+  for (size_t k = 0; k <= 40; k += 13)
+  {
+    SortedCandidateList<NearestNeighborSort> sorted;
+    HeapCandidateList<NearestNeighborSort> heap;
+    AdaptiveCandidateList<NearestNeighborSort> adaptive;
+
+    for (size_t trial = 0; trial < 2; ++trial)
+    {
+      sorted.Reset(k, 10);
+      heap.Reset(k, 10);
+      adaptive.Reset(k, 10);
+
+      arma::mat distances(100, 10, arma::fill::randu);
+      for (size_t q = 0; q < 10; ++q)
+      {
+        for (size_t i = 0; i < 100; ++i)
+        {
+          sorted.Insert(q, i, distances(i, q));
+          heap.Insert(q, i, distances(i, q));
+          adaptive.Insert(q, i, distances(i, q));
+        }
+
+        BOOST_REQUIRE_EQUAL(sorted.WorstDistance(q), heap.WorstDistance(q));
+        BOOST_REQUIRE_EQUAL(adaptive.WorstDistance(q), heap.WorstDistance(q));
+        if (k == 0)
+        {
+          BOOST_REQUIRE_EQUAL(sorted.WorstDistance(q),
+              NearestNeighborSort::BestDistance());
+        }
+      }
+
+      arma::Mat<size_t> sortedNeighbors, heapNeighbors, adaptiveNeighbors;
+      arma::mat sortedDistances, heapDistances, adaptiveDistances;
+      sorted.GetResults(sortedNeighbors, sortedDistances);
+      heap.GetResults(heapNeighbors, heapDistances);
+      adaptive.GetResults(adaptiveNeighbors, adaptiveDistances);
+
+      BOOST_REQUIRE_EQUAL(sortedNeighbors.n_rows, k);
+      BOOST_REQUIRE_EQUAL(sortedNeighbors.n_cols, 10);
+      BOOST_REQUIRE_EQUAL(heapNeighbors.n_cols, 10);
+      BOOST_REQUIRE_EQUAL(adaptiveNeighbors.n_cols, 10);
+      for (size_t i = 0; i < sortedNeighbors.n_elem; ++i)
+      {
+        BOOST_REQUIRE_EQUAL(sortedNeighbors[i], heapNeighbors[i]);
+        BOOST_REQUIRE_EQUAL(sortedDistances[i], heapDistances[i]);
+        BOOST_REQUIRE_EQUAL(adaptiveNeighbors[i], heapNeighbors[i]);
+        BOOST_REQUIRE_EQUAL(adaptiveDistances[i], heapDistances[i]);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that the candidate list of NeighborSearch can be chosen, and that
+ * every choice gives the same results for small and large k.
+ */
+BOOST_AUTO_TEST_CASE(CandidateListTypeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 300);
+  arma::mat querySet = arma::randu<arma::mat>(3, 50);
+
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      KDTree, KDTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat>::template DualTreeTraverser, KDTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>,
+      arma::mat>::template SingleTreeTraverser,
+      HeapCandidateList<NearestNeighborSort>> HeapKNN;
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      KDTree, KDTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat>::template DualTreeTraverser, KDTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>,
+      arma::mat>::template SingleTreeTraverser,
+      SortedCandidateList<NearestNeighborSort>> SortedKNN;
+
+  KNN knn(dataset);
+  HeapKNN heapKnn(dataset);
+  SortedKNN sortedKnn(dataset);
+  for (size_t k = 5; k <= 65; k += 60)
+  {
+    arma::Mat<size_t> neighbors, heapNeighbors, sortedNeighbors;
+    arma::mat distances, heapDistances, sortedDistances;
+    knn.Search(querySet, k, neighbors, distances);
+    heapKnn.Search(querySet, k, heapNeighbors, heapDistances);
+    sortedKnn.Search(querySet, k, sortedNeighbors, sortedDistances);
+
+    CheckMatrices(neighbors, heapNeighbors);
+    CheckMatrices(distances, heapDistances);
+    CheckMatrices(neighbors, sortedNeighbors);
+    CheckMatrices(distances, sortedDistances);
+  }
+}
+
+/**
+ * Searching many times with the same KNN object (which reuses its candidate
+ * lists) should give the same results as searching with new objects.
+ */
+BOOST_AUTO_TEST_CASE(RepeatedSearchTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 200);
+  KNN knn(dataset);
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    arma::mat querySet = arma::randu<arma::mat>(3, 50 * (3 - i));
+    const size_t k = 2 * i + 1;
+
+    arma::Mat<size_t> neighbors1, neighbors2;
+    arma::mat distances1, distances2;
+    knn.Search(querySet, k, neighbors1, distances1);
+
+    KNN naive(dataset, NAIVE_MODE);
+    naive.Search(querySet, k, neighbors2, distances2);
+
+    BOOST_REQUIRE_EQUAL(neighbors1.n_rows, k);
+    BOOST_REQUIRE_EQUAL(neighbors1.n_cols, querySet.n_cols);
+    for (size_t j = 0; j < neighbors1.n_elem; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors1[j], neighbors2[j]);
+      BOOST_REQUIRE_CLOSE(distances1[j], distances2[j], 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that evaluating a block of base cases at once gives exactly the
+ * same results as evaluating each base case.
+ */
+BOOST_AUTO_TEST_CASE(BaseCaseBlockTest)
+{
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance,
+      KNN::Tree> RuleType;
+  BOOST_REQUIRE(HasBaseCaseBlock<RuleType>::value);
+
+  arma::mat querySet = arma::randu<arma::mat>(5, 40);
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 60);
+  // Make sure that a distance of zero is handled correctly.
+  referenceSet.col(7) = querySet.col(3);
+
+  EuclideanDistance metric;
+  RuleType blockRules(referenceSet, querySet, 4, metric);
+  RuleType pairRules(referenceSet, querySet, 4, metric);
+  for (size_t r = 0; r < 60; r += 20)
+  {
+    BOOST_REQUIRE(blockRules.BaseCaseBlock(0, 40, r, 20));
+    for (size_t i = 0; i < 40; ++i)
+      for (size_t j = r; j < r + 20; ++j)
+        pairRules.BaseCase(i, j);
+  }
+
+  BOOST_REQUIRE_EQUAL(blockRules.BaseCases(), pairRules.BaseCases());
+
+  arma::Mat<size_t> blockNeighbors, pairNeighbors;
+  arma::mat blockDistances, pairDistances;
+  blockRules.GetResults(blockNeighbors, blockDistances);
+  pairRules.GetResults(pairNeighbors, pairDistances);
+
+  BOOST_REQUIRE_EQUAL(blockDistances(0, 3), 0.0);
+  for (size_t i = 0; i < blockNeighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(blockNeighbors[i], pairNeighbors[i]);
+    BOOST_REQUIRE_EQUAL(blockDistances[i], pairDistances[i]);
+  }
+}
+
+/**
+ * Search in single precision, then recompute the distances in double precision
+ * with Rerank(); the results should match a search in double precision.
+ */
+BOOST_AUTO_TEST_CASE(FloatRerankTest)
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::fmat,
+      KDTree> FloatKNN;
+
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 1000);
+  arma::mat querySet = arma::randu<arma::mat>(5, 100);
+
+  std::vector<size_t> oldFromNew;
+  FloatKNN::Tree tree(arma::conv_to<arma::fmat>::from(referenceSet),
+      oldFromNew);
+  FloatKNN knn(std::move(tree));
+
+  arma::Mat<size_t> mappedNeighbors, neighbors, naiveNeighbors;
+  arma::mat mappedDistances, distances, naiveDistances;
+  knn.Search(arma::conv_to<arma::fmat>::from(querySet), 5, mappedNeighbors,
+      mappedDistances);
+  Unmap(mappedNeighbors, mappedDistances, oldFromNew, neighbors, distances);
+  Rerank<NearestNeighborSort>(querySet, referenceSet, neighbors, distances,
+      EuclideanDistance());
+
+  KNN naive(referenceSet, NAIVE_MODE);
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+
+  BOOST_REQUIRE_EQUAL(distances.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, 100);
+  for (size_t i = 0; i < distances.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-4);
+    BOOST_REQUIRE_CLOSE(distances[i], EuclideanDistance::Evaluate(
+        querySet.col(i / 5), referenceSet.col(neighbors[i])), 1e-10);
+  }
+
+  // Rerank() must reject a neighbor matrix of the wrong size.
+  BOOST_REQUIRE_THROW(Rerank<NearestNeighborSort>(referenceSet, referenceSet,
+      neighbors, distances, EuclideanDistance()), std::invalid_argument);
+}
+
+/**
+ * When k is larger than the number of candidates the search could reach, the
+ * unfilled slots must survive Rerank() unchanged.
+ */
+BOOST_AUTO_TEST_CASE(RerankUnfilledSlotsTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 3);
+  arma::mat querySet = arma::randu<arma::mat>(5, 10);
+
+  KNN naive(referenceSet, NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(querySet, 3, naiveNeighbors, naiveDistances);
+
+  // Ask for five neighbors, of which only three can be found.
+  arma::Mat<size_t> neighbors(5, 10);
+  neighbors.fill(size_t() - 1);
+  neighbors.rows(0, 2) = arma::flipud(naiveNeighbors);
+  arma::mat distances(5, 10);
+
+  Rerank<NearestNeighborSort>(querySet, referenceSet, neighbors, distances,
+      EuclideanDistance());
+
+  for (size_t i = 0; i < 10; ++i)
+  {
+    for (size_t j = 0; j < 3; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, i), naiveNeighbors(j, i));
+      BOOST_REQUIRE_CLOSE(distances(j, i), naiveDistances(j, i), 1e-10);
+    }
+
+    for (size_t j = 3; j < 5; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, i), size_t() - 1);
+      BOOST_REQUIRE_EQUAL(distances(j, i), DBL_MAX);
+    }
+  }
+}
+
+/**
+ * Search with reference trees that borrow the reference set; the results should
+ * be given in terms of the original reference set, and match naive search.
+ */
+BOOST_AUTO_TEST_CASE(BorrowedReferenceTreeTest)
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      Octree> OctreeKNN;
+
+  arma::mat referenceSet = arma::randu<arma::mat>(3, 1000);
+  arma::mat querySet = arma::randu<arma::mat>(3, 200);
+  const arma::mat originalReferenceSet(referenceSet);
+
+  KNN naive(referenceSet, NAIVE_MODE);
+  arma::Mat<size_t> naiveNeighbors, naiveMonoNeighbors;
+  arma::mat naiveDistances, naiveMonoDistances;
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+  naive.Search(5, naiveMonoNeighbors, naiveMonoDistances);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    const NeighborSearchMode searchMode = (mode == 0) ? DUAL_TREE_MODE :
+        SINGLE_TREE_MODE;
+
+    KNN::Tree kdTree(referenceSet, BorrowDataset());
+    OctreeKNN::Tree octree(referenceSet, BorrowDataset());
+    BOOST_REQUIRE_EQUAL(kdTree.Dataset().memptr(), referenceSet.memptr());
+    BOOST_REQUIRE_EQUAL(octree.Dataset().memptr(), referenceSet.memptr());
+
+    KNN kdKNN(std::move(kdTree), searchMode);
+    OctreeKNN octreeKNN(std::move(octree), searchMode);
+
+    arma::Mat<size_t> kdNeighbors, octreeNeighbors;
+    arma::mat kdDistances, octreeDistances;
+    kdKNN.Search(querySet, 5, kdNeighbors, kdDistances);
+    octreeKNN.Search(querySet, 5, octreeNeighbors, octreeDistances);
+
+    for (size_t i = 0; i < naiveNeighbors.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(kdNeighbors[i], naiveNeighbors[i]);
+      BOOST_REQUIRE_CLOSE(kdDistances[i], naiveDistances[i], 1e-5);
+      BOOST_REQUIRE_EQUAL(octreeNeighbors[i], naiveNeighbors[i]);
+      BOOST_REQUIRE_CLOSE(octreeDistances[i], naiveDistances[i], 1e-5);
+    }
+
+    // The reference tree is also the query tree for monochromatic search.
+    kdKNN.Search(5, kdNeighbors, kdDistances);
+    for (size_t i = 0; i < naiveMonoNeighbors.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(kdNeighbors[i], naiveMonoNeighbors[i]);
+      BOOST_REQUIRE_CLOSE(kdDistances[i], naiveMonoDistances[i], 1e-5);
+    }
+  }
+
+  // The reference set must not have been reordered.
+  CheckMatrices(referenceSet, originalReferenceSet);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
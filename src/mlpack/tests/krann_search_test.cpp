@@ -715,4 +715,56 @@ BOOST_AUTO_TEST_CASE(RAModelTest)
   }
 }
 
+#ifdef HAS_OPENMP
+/**
+ * With a fixed random seed, rank-approximate search must return the same
+ * results regardless of the number of threads used.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDeterminismTest)
+{
+  arma::mat refData;
+  arma::mat queryData;
+
+  data::Load("rann_test_r_3_900.csv", refData, true);
+  data::Load("rann_test_q_3_100.csv", queryData, true);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+
+  // Naive, single-tree, and dual-tree search.
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RASearch<> rann(refData, (mode == 0), (mode == 1), 5.0, 0.95, false, false,
+        5);
+
+    arma::Mat<size_t> sequentialNeighbors, parallelNeighbors;
+    arma::mat sequentialDistances, parallelDistances;
+
+    omp_set_num_threads(1);
+    math::RandomSeed(1234);
+    rann.Search(queryData, 3, sequentialNeighbors, sequentialDistances);
+
+    omp_set_num_threads(4);
+    math::RandomSeed(1234);
+    rann.Search(queryData, 3, parallelNeighbors, parallelDistances);
+
+    CheckMatrices(sequentialNeighbors, parallelNeighbors);
+    CheckMatrices(sequentialDistances, parallelDistances);
+
+    // Now the monochromatic case.
+    omp_set_num_threads(1);
+    math::RandomSeed(1234);
+    rann.Search(3, sequentialNeighbors, sequentialDistances);
+
+    omp_set_num_threads(4);
+    math::RandomSeed(1234);
+    rann.Search(3, parallelNeighbors, parallelDistances);
+
+    CheckMatrices(sequentialNeighbors, parallelNeighbors);
+    CheckMatrices(sequentialDistances, parallelDistances);
+  }
+
+  omp_set_num_threads(prevNumThreads);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -912,4 +912,227 @@ BOOST_AUTO_TEST_CASE(MoveOperatorTest)
   CheckMatrices(distances, distances2);
 }
 
+/**
+ * Make sure that when there is no limit on the bucket size, every point is
+ * stored exactly once per table in the CSR-format second hash table.
+ */
+BOOST_AUTO_TEST_CASE(SecondHashTableStructureTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  const size_t numTables = 8;
+
+  // Use a bucket size of 0 (no limit).
+  LSHSearch<> lsh(dataset, 3, numTables, 0.0, 99901, 0);
+
+  const arma::Col<uint32_t>& table = lsh.SecondHashTable();
+  const arma::Col<size_t>& offsets = lsh.BucketOffsets();
+
+  BOOST_REQUIRE_EQUAL(table.n_elem, numTables * dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(offsets[0], 0);
+  BOOST_REQUIRE_EQUAL(offsets[offsets.n_elem - 1], table.n_elem);
+
+  arma::Col<size_t> counts(dataset.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i + 1 < offsets.n_elem; ++i)
+  {
+    // No bucket may be empty.
+    BOOST_REQUIRE_LT(offsets[i], offsets[i + 1]);
+    for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+    {
+      BOOST_REQUIRE_LT(table[j], dataset.n_cols);
+      counts[table[j]]++;
+    }
+  }
+
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], numTables);
+}
+
+/**
+ * Make sure that SecondHashTableBuckets() holds every live point exactly once
+ * per table, including points that were inserted and not yet compacted, and
+ * no removed points.
+ */
+BOOST_AUTO_TEST_CASE(SecondHashTableBucketsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  arma::mat newPoints = arma::randu<arma::mat>(5, 10);
+  const size_t numTables = 8;
+
+  // Use a bucket size of 0 (no limit).
+  LSHSearch<> lsh(dataset, 3, numTables, 0.0, 99901, 0);
+
+  // Without any updates, the buckets are the rows of the CSR table.
+  std::vector<arma::Col<size_t>> buckets = lsh.SecondHashTableBuckets();
+  const arma::Col<size_t>& offsets = lsh.BucketOffsets();
+  BOOST_REQUIRE_EQUAL(buckets.size(), offsets.n_elem - 1);
+  for (size_t i = 0; i < buckets.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(buckets[i].n_elem, offsets[i + 1] - offsets[i]);
+    for (size_t j = 0; j < buckets[i].n_elem; ++j)
+      BOOST_REQUIRE_EQUAL(buckets[i][j], lsh.SecondHashTable()[offsets[i] + j]);
+  }
+
+  // These are few enough points that the model is not compacted.
+  lsh.Insert(newPoints);
+  lsh.Remove(arma::uvec("3 7 11"));
+
+  buckets = lsh.SecondHashTableBuckets();
+  arma::Col<size_t> counts(dataset.n_cols + newPoints.n_cols,
+      arma::fill::zeros);
+  for (size_t i = 0; i < buckets.size(); ++i)
+  {
+    for (size_t j = 0; j < buckets[i].n_elem; ++j)
+    {
+      BOOST_REQUIRE_LT(buckets[i][j], counts.n_elem);
+      counts[buckets[i][j]]++;
+    }
+  }
+
+  for (size_t i = 0; i < counts.n_elem; ++i)
+  {
+    if (i == 3 || i == 7 || i == 11)
+      BOOST_REQUIRE_EQUAL(counts[i], 0);
+    else
+      BOOST_REQUIRE_EQUAL(counts[i], numTables);
+  }
+}
+
+/**
+ * Insert points into a model, and make sure that each inserted point is found
+ * as its own nearest neighbor, both before and after compaction.
+ */
+BOOST_AUTO_TEST_CASE(InsertTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  arma::mat newPoints = arma::randu<arma::mat>(5, 100);
+
+  LSHSearch<> lsh(dataset, 3, 10);
+  lsh.Insert(newPoints);
+
+  BOOST_REQUIRE_EQUAL(lsh.ReferenceSet().n_cols, 1100);
+  CheckMatrices(arma::mat(lsh.ReferenceSet().cols(1000, 1099)), newPoints);
+
+  arma::Mat<size_t> neighbors, compactedNeighbors;
+  arma::mat distances, compactedDistances;
+  lsh.Search(newPoints, 1, neighbors, distances);
+
+  for (size_t i = 0; i < newPoints.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors(0, i), 1000 + i);
+    BOOST_REQUIRE_SMALL(distances(0, i), 1e-10);
+  }
+
+  // Compaction shouldn't change anything.
+  lsh.Compact();
+  lsh.Search(newPoints, 1, compactedNeighbors, compactedDistances);
+
+  CheckMatrices(neighbors, compactedNeighbors);
+  CheckMatrices(distances, compactedDistances);
+}
+
+/**
+ * Remove points from a model, and make sure they are never returned as
+ * neighbors, whether or not they were inserted after training.
+ */
+BOOST_AUTO_TEST_CASE(RemoveTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  arma::mat newPoints = arma::randu<arma::mat>(5, 10);
+
+  LSHSearch<> lsh(dataset, 3, 10);
+  lsh.Insert(newPoints);
+
+  // Remove some original points and some inserted points.
+  arma::uvec removed;
+  removed << 3 << 17 << 250 << 999 << 1000 << 1005;
+  lsh.Remove(removed);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(lsh.ReferenceSet().cols(removed), 10, neighbors, distances);
+
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+    for (size_t j = 0; j < removed.n_elem; ++j)
+      BOOST_REQUIRE_NE(neighbors[i], removed[j]);
+
+  // The same should hold after compaction.
+  lsh.Compact();
+  lsh.Search(lsh.ReferenceSet().cols(removed), 10, neighbors, distances);
+
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+    for (size_t j = 0; j < removed.n_elem; ++j)
+      BOOST_REQUIRE_NE(neighbors[i], removed[j]);
+}
+
+/**
+ * Insert(), Remove() and Compact() must throw on a model that was not trained,
+ * and Search() must only count points that were not removed.
+ */
+BOOST_AUTO_TEST_CASE(UntrainedAndRemovedPointsTest)
+{
+  LSHSearch<> untrained;
+  arma::uvec indices;
+  BOOST_REQUIRE_THROW(untrained.Insert(arma::mat()), std::invalid_argument);
+  BOOST_REQUIRE_THROW(untrained.Remove(indices), std::invalid_argument);
+  BOOST_REQUIRE_THROW(untrained.Compact(), std::invalid_argument);
+
+  arma::mat dataset = arma::randu<arma::mat>(5, 20);
+  LSHSearch<> lsh(dataset, 3, 10);
+
+  // Removing a point twice should only count it once.
+  arma::uvec removed;
+  removed << 2 << 7 << 7;
+  lsh.Remove(removed);
+  lsh.Remove(removed);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  BOOST_REQUIRE_THROW(lsh.Search(dataset, 19, neighbors, distances),
+      std::invalid_argument);
+  lsh.Search(dataset, 18, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 18);
+
+  // A copy should remember the removed points, but retraining forgets them.
+  LSHSearch<> copy(lsh);
+  BOOST_REQUIRE_THROW(copy.Search(dataset, 19, neighbors, distances),
+      std::invalid_argument);
+  lsh.Train(dataset, 3, 10);
+  lsh.Search(dataset, 20, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 20);
+}
+
+/**
+ * The candidate scratch space is reused between searches, so make sure that
+ * repeated searches (and searches after the model is updated) give the same
+ * results as a fresh model.
+ */
+BOOST_AUTO_TEST_CASE(RepeatedSearchTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  arma::mat querySet = arma::randu<arma::mat>(5, 300);
+  arma::mat newPoints = arma::randu<arma::mat>(5, 50);
+
+  LSHSearch<> lsh(dataset, 3, 10);
+
+  arma::Mat<size_t> neighbors, repeatedNeighbors;
+  arma::mat distances, repeatedDistances;
+  lsh.Search(querySet, 5, neighbors, distances);
+  lsh.Search(5, repeatedNeighbors, repeatedDistances);
+  lsh.Search(querySet, 5, repeatedNeighbors, repeatedDistances);
+
+  CheckMatrices(neighbors, repeatedNeighbors);
+  CheckMatrices(distances, repeatedDistances);
+
+  // A copy of the model starts with empty scratch space.
+  LSHSearch<> copy(lsh);
+  lsh.Insert(newPoints);
+  copy.Insert(newPoints);
+
+  lsh.Search(querySet, 5, neighbors, distances);
+  copy.Search(querySet, 5, repeatedNeighbors, repeatedDistances);
+
+  CheckMatrices(neighbors, repeatedNeighbors);
+  CheckMatrices(distances, repeatedDistances);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -346,4 +346,53 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
   delete textTree;
 }
 
+/**
+ * Make sure that an octree that borrows its dataset references the caller's
+ * memory without copying it, leaves the dataset unchanged, and gives the points
+ * of each node in terms of the original dataset.
+ */
+BOOST_AUTO_TEST_CASE(BorrowDatasetTest)
+{
+  arma::mat dataset(3, 1000, arma::fill::randu);
+  const arma::mat originalDataset(dataset);
+
+  Octree<> t(dataset, BorrowDataset(), 5);
+
+  BOOST_REQUIRE(t.BorrowsDataset());
+  BOOST_REQUIRE_EQUAL(t.Dataset().memptr(), dataset.memptr());
+  BOOST_REQUIRE_EQUAL(t.NumDescendants(), 1000);
+  for (size_t i = 0; i < dataset.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(dataset[i], originalDataset[i]);
+
+  // Each point must be held by exactly one leaf, and each node must contain all
+  // of its points.
+  std::vector<size_t> counts(dataset.n_cols, 0);
+  std::stack<Octree<>*> stack;
+  stack.push(&t);
+  while (!stack.empty())
+  {
+    Octree<>* node = stack.top();
+    stack.pop();
+
+    arma::mat points;
+    node->GatherPoints(points);
+    BOOST_REQUIRE_EQUAL(points.n_cols, node->NumDescendants());
+    for (size_t i = 0; i < node->NumDescendants(); ++i)
+    {
+      const size_t index = node->Descendant(i);
+      BOOST_REQUIRE(node->Bound().Contains(dataset.col(index)));
+      for (size_t d = 0; d < dataset.n_rows; ++d)
+        BOOST_REQUIRE_EQUAL(points(d, i), dataset(d, index));
+    }
+
+    for (size_t i = 0; i < node->NumPoints(); ++i)
+      ++counts[node->Point(i)];
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      stack.push(&node->Child(i));
+  }
+
+  for (size_t i = 0; i < counts.size(); ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -208,4 +208,46 @@ BOOST_AUTO_TEST_CASE(SparseTest)
   BOOST_REQUIRE_EQUAL(distances.n_cols, 1000);
 }
 
+/**
+ * Make sure that the batch size does not change the results, and that multiple
+ * results for each query point are sorted from furthest to nearest.
+ */
+BOOST_AUTO_TEST_CASE(BatchSizeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 500);
+  arma::mat querySet = arma::randu<arma::mat>(10, 300);
+
+  QDAFN<> qdafn(dataset, 10, 30);
+
+  arma::Mat<size_t> neighbors, batchNeighbors;
+  arma::mat distances, batchDistances;
+
+  qdafn.Search(querySet, 5, neighbors, distances, 1);
+  qdafn.Search(querySet, 5, batchNeighbors, batchDistances, 64);
+
+  CheckMatrices(neighbors, batchNeighbors);
+  CheckMatrices(distances, batchDistances);
+
+  // The number of threads should not change the results either.
+  qdafn.NumThreads() = 1;
+  qdafn.Search(querySet, 5, batchNeighbors, batchDistances, 64);
+
+  CheckMatrices(neighbors, batchNeighbors);
+  CheckMatrices(distances, batchDistances);
+
+  for (size_t i = 0; i < distances.n_cols; ++i)
+  {
+    for (size_t j = 1; j < distances.n_rows; ++j)
+      BOOST_REQUIRE_GE(distances(j - 1, i), distances(j, i));
+
+    // Check that the distances are correct.
+    for (size_t j = 0; j < distances.n_rows; ++j)
+    {
+      const double dist = metric::EuclideanDistance::Evaluate(querySet.col(i),
+          dataset.col(neighbors(j, i)));
+      BOOST_REQUIRE_CLOSE(distances(j, i), dist, 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -1696,4 +1696,42 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   }
 }
 
+/**
+ * Make sure that computing a block of base cases at once gives exactly the same
+ * results as computing each base case.
+ */
+BOOST_AUTO_TEST_CASE(BaseCaseBlockTest)
+{
+  typedef RangeSearchRules<EuclideanDistance, RangeSearch<>::Tree> RuleType;
+  BOOST_REQUIRE(HasBaseCaseBlock<RuleType>::value);
+
+  arma::mat querySet = arma::randu<arma::mat>(3, 30);
+  arma::mat referenceSet = arma::randu<arma::mat>(3, 50);
+  const Range range(0.1, 0.5);
+
+  EuclideanDistance metric;
+  std::vector<std::vector<size_t>> blockNeighbors(30), pairNeighbors(30);
+  std::vector<std::vector<double>> blockDistances(30), pairDistances(30);
+  RuleType blockRules(referenceSet, querySet, range, blockNeighbors,
+      blockDistances, metric);
+  RuleType pairRules(referenceSet, querySet, range, pairNeighbors,
+      pairDistances, metric);
+
+  BOOST_REQUIRE(blockRules.BaseCaseBlock(0, 30, 0, 50));
+  for (size_t i = 0; i < 30; ++i)
+    for (size_t j = 0; j < 50; ++j)
+      pairRules.BaseCase(i, j);
+
+  BOOST_REQUIRE_EQUAL(blockRules.BaseCases(), pairRules.BaseCases());
+  for (size_t i = 0; i < 30; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(blockNeighbors[i].size(), pairNeighbors[i].size());
+    for (size_t j = 0; j < blockNeighbors[i].size(); ++j)
+    {
+      BOOST_REQUIRE_EQUAL(blockNeighbors[i][j], pairNeighbors[i][j]);
+      BOOST_REQUIRE_EQUAL(blockDistances[i][j], pairDistances[i][j]);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -16,6 +16,9 @@
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
+#include <atomic>
+#include <thread>
+
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -89,6 +92,22 @@ std::vector<arma::vec*> GetAllPointsInTree(const TreeType& tree)
   return vec;
 }
 
+/**
+ * Collect the indices of the points held in the leaves of the tree.
+ *
+ * @param tree The tree that we want to extract the indices from.
+ * @param indices The vector to append the indices to.
+ */
+template<typename TreeType>
+void GetAllIndicesInTree(const TreeType& tree, std::vector<size_t>& indices)
+{
+  for (size_t i = 0; i < tree.NumChildren(); ++i)
+    GetAllIndicesInTree(tree.Child(i), indices);
+
+  for (size_t i = 0; i < tree.Count(); ++i)
+    indices.push_back(tree.Point(i));
+}
+
 // Test to ensure that none of the points in the tree are duplicates.  This,
 // combined with the above test to see how many points are in the tree, should
 // ensure that we inserted all points.
@@ -1384,4 +1403,265 @@ BOOST_AUTO_TEST_CASE(RectangleTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+/**
+ * Build an R* tree with Sort-Tile-Recursive packing, and make sure that it is
+ * valid, that it stays valid when points are deleted and inserted, and that it
+ * gives the same search results as a naive search.
+ */
+BOOST_AUTO_TEST_CASE(RStarTreeBulkLoadTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 5000);
+
+  typedef RStarTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  TreeType tree(dataset, BulkLoad(), 20, 6, 5, 2, 0);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 5000);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckFills(tree);
+  CheckNumDescendants(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+
+  // Delete the last 100 points, and then add 200 new points.
+  for (size_t i = 4900; i < 5000; ++i)
+    BOOST_REQUIRE(tree.DeletePoint(i));
+
+  arma::mat newPoints;
+  newPoints.randu(5, 200);
+  dataset.shed_cols(4900, 4999);
+  dataset.insert_cols(4900, newPoints);
+  tree.Dataset().shed_cols(4900, 4999);
+  tree.Dataset().insert_cols(4900, newPoints);
+  for (size_t i = 4900; i < 5100; ++i)
+    tree.InsertPoint(i);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 5100);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+
+  arma::mat querySet;
+  querySet.randu(5, 200);
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, arma::mat,
+      RStarTree> knn1(std::move(tree));
+  arma::Mat<size_t> neighbors1;
+  arma::mat distances1;
+  knn1.Search(querySet, 5, neighbors1, distances1);
+
+  KNN knn2(dataset, NAIVE_MODE);
+  arma::Mat<size_t> neighbors2;
+  arma::mat distances2;
+  knn2.Search(querySet, 5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_CLOSE(distances1[i], distances2[i], 1e-5);
+  }
+}
+
+/**
+ * Hilbert R trees can't be packed, so the bulk-loading constructor inserts the
+ * points; make sure the tree is still ordered correctly.
+ */
+BOOST_AUTO_TEST_CASE(HilbertRTreeBulkLoadTest)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1000);
+
+  typedef HilbertRTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> TreeType;
+  TreeType tree(dataset, BulkLoad(), 20, 6, 5, 2, 0);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1000);
+  CheckHilbertOrdering(tree);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+}
+
+/**
+ * Search snapshots of a ConcurrentRectangleTree from another thread while
+ * points are inserted and published, and make sure that each snapshot gives
+ * the same results as a brute-force search of its dataset.
+ */
+BOOST_AUTO_TEST_CASE(ConcurrentRectangleTreeSnapshotTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 500);
+
+  typedef NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>,
+      arma::mat, RStarTree> KNNType;
+  typedef KNNType::Tree TreeType;
+  ConcurrentRectangleTree<TreeType> index(TreeType(std::move(dataset)));
+
+  arma::mat querySet;
+  querySet.randu(3, 50);
+
+  std::atomic<bool> done(false);
+  std::atomic<size_t> mismatches(0);
+  std::atomic<size_t> searches(0);
+  std::thread reader([&]()
+  {
+    while (!done || searches == 0)
+    {
+      std::shared_ptr<TreeType> snapshot = index.Snapshot();
+      if (snapshot->NumDescendants() != snapshot->Dataset().n_cols)
+        ++mismatches;
+
+      KNNType knn1(snapshot.get(), SINGLE_TREE_MODE);
+      arma::Mat<size_t> neighbors1;
+      arma::mat distances1;
+      knn1.Search(querySet, 3, neighbors1, distances1);
+
+      KNN knn2(snapshot->Dataset(), NAIVE_MODE);
+      arma::Mat<size_t> neighbors2;
+      arma::mat distances2;
+      knn2.Search(querySet, 3, neighbors2, distances2);
+
+      for (size_t i = 0; i < neighbors1.n_elem; ++i)
+        if (neighbors1[i] != neighbors2[i])
+          ++mismatches;
+
+      ++searches;
+    }
+  });
+
+  for (size_t i = 0; i < 20; ++i)
+  {
+    for (size_t j = 0; j < 50; ++j)
+    {
+      arma::vec point = arma::randu<arma::vec>(3);
+      BOOST_REQUIRE_EQUAL(index.Insert(point), 500 + 50 * i + j);
+    }
+
+    index.Publish();
+  }
+
+  done = true;
+  reader.join();
+
+  BOOST_REQUIRE_EQUAL(mismatches, 0);
+  BOOST_REQUIRE_EQUAL(index.Snapshot()->NumDescendants(), 1500);
+
+  // Deleting points is only visible after publishing.
+  std::shared_ptr<TreeType> oldSnapshot = index.Snapshot();
+  for (size_t i = 0; i < 100; ++i)
+    BOOST_REQUIRE(index.Delete(i));
+  BOOST_REQUIRE(!index.Delete(1500));
+  BOOST_REQUIRE_EQUAL(index.Snapshot()->NumDescendants(), 1500);
+
+  index.Publish();
+  BOOST_REQUIRE_EQUAL(index.Snapshot()->NumDescendants(), 1400);
+  BOOST_REQUIRE_EQUAL(oldSnapshot->NumDescendants(), 1500);
+  CheckContainment(*index.Snapshot());
+  CheckNumDescendants(*index.Snapshot());
+  CheckHierarchy(index.WorkingTree());
+}
+
+/**
+ * Make sure that publishing a ConcurrentRectangleTree copies only the nodes
+ * that changed, and that replaced snapshots are freed once no reader holds
+ * them.
+ */
+BOOST_AUTO_TEST_CASE(ConcurrentRectangleTreePathCopyTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 1000);
+
+  typedef RStarTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  ConcurrentRectangleTree<TreeType> index(TreeType(std::move(dataset)));
+  BOOST_REQUIRE_EQUAL(index.Epoch(), 1);
+
+  // Publishing without changes does nothing.
+  std::shared_ptr<TreeType> first = index.Snapshot();
+  index.Publish();
+  BOOST_REQUIRE_EQUAL(index.Epoch(), 1);
+  BOOST_REQUIRE_EQUAL(index.Snapshot().get(), first.get());
+
+  // Inserting a point copies the root, but leaves at least one of its subtrees
+  // untouched.
+  arma::vec point = arma::randu<arma::vec>(3);
+  BOOST_REQUIRE_EQUAL(index.Insert(point), 1000);
+  index.Publish();
+  std::shared_ptr<TreeType> second = index.Snapshot();
+  BOOST_REQUIRE_EQUAL(index.Epoch(), 2);
+  BOOST_REQUIRE_NE(second.get(), first.get());
+  BOOST_REQUIRE_EQUAL(first->NumDescendants(), 1000);
+  BOOST_REQUIRE_EQUAL(second->NumDescendants(), 1001);
+  BOOST_REQUIRE_GT(first->NumChildren(), 1);
+
+  size_t shared = 0;
+  for (size_t i = 0; i < first->NumChildren(); ++i)
+    for (size_t j = 0; j < second->NumChildren(); ++j)
+      if (&first->Child(i) == &second->Child(j))
+        ++shared;
+  BOOST_REQUIRE_GT(shared, 0);
+
+  CheckContainment(*first);
+  CheckContainment(*second);
+  CheckNumDescendants(*second);
+
+  // The first snapshot is still held, so it can't be freed yet.
+  BOOST_REQUIRE_EQUAL(index.NumRetired(), 1);
+
+  first.reset();
+  BOOST_REQUIRE(index.Delete(0));
+  index.Publish();
+  BOOST_REQUIRE_EQUAL(index.Epoch(), 3);
+  BOOST_REQUIRE_EQUAL(index.NumRetired(), 1);
+  BOOST_REQUIRE_EQUAL(second->NumDescendants(), 1001);
+  BOOST_REQUIRE_EQUAL(index.Snapshot()->NumDescendants(), 1000);
+  CheckContainment(*index.Snapshot());
+  CheckNumDescendants(*index.Snapshot());
+}
+
+/**
+ * Insert a copy of a point and delete the original before a single Publish().
+ * The number of descendants and the bounds of the common ancestors of both
+ * leaves stay the same, so the snapshot has to find the changed subtrees from
+ * the versions of the nodes, not from their contents.
+ */
+BOOST_AUTO_TEST_CASE(ConcurrentRectangleTreeInsertDeleteTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 1000);
+
+  typedef RStarTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  ConcurrentRectangleTree<TreeType> index(TreeType(std::move(dataset)));
+
+  // Find a leaf that can lose a point without being condensed.
+  const TreeType* leaf = &index.WorkingTree();
+  while (!leaf->IsLeaf())
+    leaf = &leaf->Child(0);
+  BOOST_REQUIRE_GT(leaf->Count(), leaf->MinLeafSize());
+
+  // Replace the first point of the leaf with a copy of it.
+  const size_t deleted = leaf->Point(0);
+  const arma::vec point = index.WorkingTree().Dataset().col(deleted);
+  BOOST_REQUIRE_EQUAL(index.Insert(point), 1000);
+  BOOST_REQUIRE(index.Delete(deleted));
+  index.Publish();
+
+  std::shared_ptr<TreeType> snapshot = index.Snapshot();
+  BOOST_REQUIRE_EQUAL(snapshot->NumDescendants(), 1000);
+
+  std::vector<size_t> indices;
+  GetAllIndicesInTree(*snapshot, indices);
+  std::sort(indices.begin(), indices.end());
+  BOOST_REQUIRE_EQUAL(indices.size(), 1000);
+  for (size_t i = 0; i < indices.size(); ++i)
+    BOOST_REQUIRE_EQUAL(indices[i], (i < deleted) ? i : i + 1);
+
+  CheckContainment(*snapshot);
+  CheckNumDescendants(*snapshot);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
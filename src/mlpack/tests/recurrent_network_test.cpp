@@ -14,8 +14,11 @@
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/rnn.hpp>
+#include <mlpack/methods/ann/inference_session.hpp>
 #include <mlpack/core/data/binarize.hpp>
 
+#include <thread>
+
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -741,4 +744,88 @@ BOOST_AUTO_TEST_CASE(GRUDistractedSequenceRecallTest)
   DistractedSequenceRecallTestNetwork<GRU<>>();
 }
 
+/**
+ * Make sure that the batched forward pass of an RNN, and an InferenceSession
+ * made from it, give the same outputs as running each sequence on its own.
+ */
+BOOST_AUTO_TEST_CASE(RNNInferenceSessionTest)
+{
+  const size_t rho = 5;
+  RNN<> model(rho);
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(1, 4);
+  model.Add<LSTM<> >(4, 4, rho);
+  model.Add<Linear<> >(4, 2);
+  model.Add<LogSoftMax<> >();
+
+  arma::mat data = arma::randu<arma::mat>(rho, 40);
+  arma::mat batchOutput;
+  model.Forward(data, batchOutput);
+  BOOST_REQUIRE_EQUAL(batchOutput.n_rows, 2 * rho);
+  BOOST_REQUIRE_EQUAL(batchOutput.n_cols, data.n_cols);
+
+  arma::mat output;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    model.Forward(data.col(i), output);
+    for (size_t j = 0; j < output.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(output[j], batchOutput(j, i), 1e-5);
+  }
+
+  InferenceSession<RNN<> > session(model, 2, 8, 200);
+  arma::mat results(batchOutput.n_rows, data.n_cols);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      arma::mat threadResults;
+      for (size_t i = t; i < data.n_cols; i += 4)
+      {
+        session.Predict(data.col(i), threadResults);
+        results.col(i) = threadResults;
+      }
+    });
+  }
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < results.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(results[i], batchOutput[i], 1e-5);
+}
+
+/**
+ * Make sure that a copied RNN uses its own parameters: it should give the same
+ * outputs as the original, and changing its parameters should change only its
+ * outputs.
+ */
+BOOST_AUTO_TEST_CASE(RNNCopyParametersTest)
+{
+  const size_t rho = 5;
+  RNN<> model(rho);
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(1, 4);
+  model.Add<LSTM<> >(4, 4, rho);
+  model.Add<Linear<> >(4, 2);
+  model.Add<LogSoftMax<> >();
+
+  arma::mat data = arma::randu<arma::mat>(rho, 10);
+  arma::mat output, copiedOutput;
+  model.Forward(data, output);
+
+  RNN<> copiedModel(model);
+  copiedModel.Forward(data, copiedOutput);
+  CheckMatrices(output, copiedOutput);
+
+  // Changing the parameters of the copy changes its outputs only.
+  copiedModel.Parameters() *= 2;
+  copiedModel.Forward(data, copiedOutput);
+  BOOST_REQUIRE_GT(arma::abs(output - copiedOutput).max(), 1e-3);
+
+  arma::mat newOutput;
+  model.Forward(data, newOutput);
+  CheckMatrices(output, newOutput);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -14,7 +14,10 @@
 
 #include <mlpack/methods/reinforcement_learning/environment/mountain_car.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/cart_pole.hpp>
+#include <mlpack/methods/reinforcement_learning/environment/vectorized_environment.hpp>
 #include <mlpack/methods/reinforcement_learning/replay/random_replay.hpp>
+#include <mlpack/methods/reinforcement_learning/replay/prioritized_replay.hpp>
+#include <mlpack/methods/reinforcement_learning/parameter_server.hpp>
 #include <mlpack/methods/reinforcement_learning/policy/greedy_policy.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -122,4 +125,208 @@ BOOST_AUTO_TEST_CASE(GreedyPolicyTest)
   BOOST_REQUIRE_CLOSE(actionValue[action], actionValue.max(), 1e-5);
 }
 
+/**
+ * Step a vectorized CartPole and check that every instance behaves like a
+ * single CartPole, and starts a new episode when its episode ends.
+ */
+BOOST_AUTO_TEST_CASE(VectorizedEnvironmentTest)
+{
+  const CartPole task = CartPole();
+  VectorizedEnvironment<CartPole> environments(5, task, 10);
+  BOOST_REQUIRE_EQUAL(environments.NumEnvironments(), 5);
+
+  std::vector<CartPole::Action> actions(5, CartPole::Action::forward);
+  arma::mat states, nextStates;
+  arma::colvec rewards;
+  arma::icolvec isTerminal;
+  for (size_t step = 0; step < 30; ++step)
+  {
+    environments.Encode(states);
+    BOOST_REQUIRE_EQUAL(states.n_rows, CartPole::State::dimension);
+    BOOST_REQUIRE_EQUAL(states.n_cols, 5);
+
+    environments.Step(actions, nextStates, rewards, isTerminal);
+    for (size_t i = 0; i < 5; ++i)
+    {
+      CartPole::State nextState;
+      const double reward = task.Sample(CartPole::State(states.col(i)),
+          actions[i], nextState);
+      BOOST_REQUIRE_EQUAL(rewards[i], reward);
+      for (size_t j = 0; j < nextStates.n_rows; ++j)
+        BOOST_REQUIRE_CLOSE(nextStates(j, i), nextState.Encode()[j], 1e-5);
+
+      // Pushing forward all the time makes the pole fall before the step
+      // limit; either way, the instance has to start over.
+      if (isTerminal[i])
+      {
+        BOOST_REQUIRE(environments.LastEpisodeReturns()[i] <= 10.0);
+        BOOST_REQUIRE(!task.IsTerminal(environments.State(i)));
+      }
+      else
+      {
+        BOOST_REQUIRE(!task.IsTerminal(nextState));
+      }
+    }
+  }
+
+  // Passing the wrong number of actions is an error.
+  actions.pop_back();
+  BOOST_REQUIRE_THROW(environments.Step(actions, nextStates, rewards,
+      isTerminal), std::invalid_argument);
+}
+
+/**
+ * Push updates to a parameter server from several threads and check that none
+ * of them is lost, and that the target parameters are only pulled after they
+ * are synced.
+ */
+BOOST_AUTO_TEST_CASE(ParameterServerTest)
+{
+  // Use a stripe size that doesn't divide the number of parameters.
+  arma::mat initial = arma::randu<arma::mat>(50, 1);
+  ParameterServer server(initial, 7);
+
+  arma::mat local(50, 1);
+  const double* memory = local.memptr();
+  server.Pull(local);
+  CheckMatrices(local, initial);
+  BOOST_REQUIRE_EQUAL(local.memptr(), memory);
+
+  const arma::mat update = arma::randu<arma::mat>(50, 1);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < 100; ++i)
+    server.Push(update);
+
+  server.Pull(local);
+  CheckMatrices(local, initial + 100 * update);
+  CheckMatrices(server.TargetParameters(), initial);
+
+  // The target parameters haven't changed yet.
+  size_t version = 0;
+  BOOST_REQUIRE(!server.PullTarget(local, version));
+
+  server.SyncTarget();
+  BOOST_REQUIRE(server.PullTarget(local, version));
+  BOOST_REQUIRE_EQUAL(version, server.TargetVersion());
+  CheckMatrices(local, initial + 100 * update);
+  BOOST_REQUIRE(!server.PullTarget(local, version));
+
+  // A buffer of the wrong size is an error.
+  arma::mat wrong(49, 1);
+  BOOST_REQUIRE_THROW(server.Pull(wrong), std::invalid_argument);
+  BOOST_REQUIRE_THROW(server.Push(wrong), std::invalid_argument);
+}
+
+/**
+ * Check that a sum tree finds the right index for a given mass, and samples
+ * indices in proportion to their values.
+ */
+BOOST_AUTO_TEST_CASE(SumTreeTest)
+{
+  // Use a capacity that isn't a power of two.
+  SumTree tree(5);
+  const arma::colvec values("1 0 3 2 4");
+  for (size_t i = 0; i < values.n_elem; ++i)
+    tree.Set(i, values[i]);
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 10.0, 1e-5);
+
+  BOOST_REQUIRE_EQUAL(tree.Find(0.0), 0);
+  BOOST_REQUIRE_EQUAL(tree.Find(0.5), 0);
+  BOOST_REQUIRE_EQUAL(tree.Find(1.0), 2);
+  BOOST_REQUIRE_EQUAL(tree.Find(3.9), 2);
+  BOOST_REQUIRE_EQUAL(tree.Find(4.0), 3);
+  BOOST_REQUIRE_EQUAL(tree.Find(9.9), 4);
+  // Masses past the sum end at the last index with a positive value.
+  BOOST_REQUIRE_EQUAL(tree.Find(12.0), 4);
+
+  tree.Set(4, 0.0);
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 6.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(tree.Find(5.9), 3);
+  BOOST_REQUIRE_EQUAL(tree.Find(7.0), 3);
+
+  // Sample many times, and compare the frequencies with the values.
+  arma::colvec counts(5, arma::fill::zeros);
+  for (size_t i = 0; i < 60000; ++i)
+    counts[tree.Find(math::Random() * tree.Sum())]++;
+  BOOST_REQUIRE_EQUAL(counts[1], 0);
+  BOOST_REQUIRE_EQUAL(counts[4], 0);
+  BOOST_REQUIRE_CLOSE(counts[0] / 60000, 1.0 / 6.0, 5);
+  BOOST_REQUIRE_CLOSE(counts[2] / 60000, 3.0 / 6.0, 5);
+  BOOST_REQUIRE_CLOSE(counts[3] / 60000, 2.0 / 6.0, 5);
+}
+
+/**
+ * Construct a prioritized replay instance and check that experiences with
+ * large errors are sampled more often, with smaller weights.
+ */
+BOOST_AUTO_TEST_CASE(PrioritizedReplayTest)
+{
+  PrioritizedReplay<MountainCar> replay(2, 3, 1.0, 1.0);
+  MountainCar env;
+  MountainCar::State state = env.InitialSample();
+  MountainCar::State nextState;
+  double reward = env.Sample(state, MountainCar::Action::forward, nextState);
+  replay.Store(state, MountainCar::Action::forward, reward, nextState, false);
+
+  arma::mat sampledState;
+  arma::icolvec sampledAction;
+  arma::colvec sampledReward;
+  arma::mat sampledNextState;
+  arma::icolvec sampledTerminal;
+
+  // So far there is only one record in the memory.
+  replay.Sample(sampledState, sampledAction, sampledReward, sampledNextState,
+      sampledTerminal);
+  BOOST_REQUIRE_EQUAL(sampledState.n_cols, 2);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    CheckMatrices(state.Encode(), sampledState.col(i));
+    CheckMatrices(nextState.Encode(), sampledNextState.col(i));
+    BOOST_REQUIRE_EQUAL(sampledAction[i], MountainCar::Action::forward);
+    BOOST_REQUIRE_CLOSE(sampledReward[i], reward, 1e-5);
+    BOOST_REQUIRE_CLOSE(replay.Weights()[i], 1.0, 1e-5);
+  }
+
+  // The buffers aren't reallocated when they have the right size.
+  const double* memory = sampledState.memptr();
+
+  // Give the first record a tiny error; the new records get the largest
+  // priority seen so far, which is 1.
+  replay.Update(arma::colvec("0.01 0.01"));
+  replay.Store(nextState, MountainCar::Action::backward, reward, state, true);
+  replay.Store(nextState, MountainCar::Action::backward, reward, state, true);
+
+  size_t firstRecord = 0;
+  for (size_t i = 0; i < 100; ++i)
+  {
+    replay.Sample(sampledState, sampledAction, sampledReward, sampledNextState,
+        sampledTerminal);
+    BOOST_REQUIRE_EQUAL(sampledState.memptr(), memory);
+
+    const bool hit = arma::any(sampledAction ==
+        (int) MountainCar::Action::forward);
+    for (size_t j = 0; j < 2; ++j)
+    {
+      if (sampledAction[j] == MountainCar::Action::forward)
+      {
+        // Rare experiences get the largest weight.
+        firstRecord++;
+        CheckMatrices(state.Encode(), sampledState.col(j));
+        BOOST_REQUIRE_CLOSE(replay.Weights()[j], 1.0, 1e-5);
+      }
+      else if (hit)
+      {
+        BOOST_REQUIRE_LT(replay.Weights()[j], 0.1);
+      }
+      else
+      {
+        BOOST_REQUIRE_CLOSE(replay.Weights()[j], 1.0, 1e-5);
+      }
+    }
+  }
+
+  // The first record has probability 0.01 / 2.01 per sample.
+  BOOST_REQUIRE_LT(firstRecord, 20);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1239,9 +1239,12 @@ BOOST_AUTO_TEST_CASE(LSHTest)
   BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
       binaryLsh.SecondHashTable().size());
 
-  for (size_t i = 0; i < lsh.SecondHashTable().size(); ++i)
-  CheckMatrices(lsh.SecondHashTable()[i], xmlLsh.SecondHashTable()[i],
-      textLsh.SecondHashTable()[i], binaryLsh.SecondHashTable()[i]);
+  CheckMatrices(arma::conv_to<arma::Mat<size_t>>::from(lsh.SecondHashTable()),
+      arma::conv_to<arma::Mat<size_t>>::from(xmlLsh.SecondHashTable()),
+      arma::conv_to<arma::Mat<size_t>>::from(textLsh.SecondHashTable()),
+      arma::conv_to<arma::Mat<size_t>>::from(binaryLsh.SecondHashTable()));
+  CheckMatrices(lsh.BucketOffsets(), xmlLsh.BucketOffsets(),
+      textLsh.BucketOffsets(), binaryLsh.BucketOffsets());
 }
 
 // Make sure serialization works for the decision stump.
@@ -308,4 +308,19 @@ BOOST_AUTO_TEST_CASE(SpillTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+/**
+ * Make sure that the spill tree references the given dataset instead of copying
+ * it.
+ */
+BOOST_AUTO_TEST_CASE(SpillTreeNoCopyTest)
+{
+  typedef SPTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+
+  TreeType tree(dataset);
+
+  BOOST_REQUIRE_EQUAL(&tree.Dataset(), &dataset);
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 500);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
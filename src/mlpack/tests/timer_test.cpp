@@ -19,6 +19,7 @@
 #endif
 
 #include <mlpack/core.hpp>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -90,4 +91,34 @@ BOOST_AUTO_TEST_CASE(TwiceStartTimerTest)
   BOOST_REQUIRE_THROW(Timer::Start("test_timer"), std::runtime_error);
 }
 
+/**
+ * The same timer may be run in several threads at once; the time of each
+ * thread is added to the total.
+ */
+BOOST_AUTO_TEST_CASE(MultithreadedTimerTest)
+{
+  auto timeThread = []()
+  {
+    for (size_t i = 0; i < 2; ++i)
+    {
+      Timer::Start("thread_timer");
+
+      #ifdef _WIN32
+      Sleep(10);
+      #else
+      usleep(10000);
+      #endif
+
+      Timer::Stop("thread_timer");
+    }
+  };
+
+  std::thread thread1(timeThread);
+  std::thread thread2(timeThread);
+  thread1.join();
+  thread2.join();
+
+  BOOST_REQUIRE_GE(Timer::Get("thread_timer").count(), 40000);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
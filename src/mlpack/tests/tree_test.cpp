@@ -21,6 +21,10 @@
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::math;
 using namespace mlpack::tree;
@@ -2094,6 +2098,58 @@ BOOST_AUTO_TEST_CASE(CoverTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(t2.Dataset().n_cols, 1000);
 }
 
+/**
+ * Make sure that a cover tree built with several threads is exactly the same as
+ * one built with a single thread.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeParallelBuildTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 20000);
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+
+#ifdef HAS_OPENMP
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  TreeType tree1(dataset);
+#ifdef HAS_OPENMP
+  omp_set_num_threads(4);
+#endif
+  TreeType tree2(dataset);
+#ifdef HAS_OPENMP
+  omp_set_num_threads(prevNumThreads);
+#endif
+
+  BOOST_REQUIRE_EQUAL(tree1.DistanceComps(), tree2.DistanceComps());
+
+  // Walk both trees at once.
+  std::stack<TreeType*> stack1, stack2;
+  stack1.push(&tree1);
+  stack2.push(&tree2);
+  while (!stack1.empty())
+  {
+    TreeType* node1 = stack1.top();
+    TreeType* node2 = stack2.top();
+    stack1.pop();
+    stack2.pop();
+
+    BOOST_REQUIRE_EQUAL(node1->Point(), node2->Point());
+    BOOST_REQUIRE_EQUAL(node1->Scale(), node2->Scale());
+    BOOST_REQUIRE_EQUAL(node1->NumDescendants(), node2->NumDescendants());
+    BOOST_REQUIRE_EQUAL(node1->NumChildren(), node2->NumChildren());
+    BOOST_REQUIRE_EQUAL(node1->ParentDistance(), node2->ParentDistance());
+    BOOST_REQUIRE_EQUAL(node1->FurthestDescendantDistance(),
+        node2->FurthestDescendantDistance());
+
+    for (size_t i = 0; i < node1->NumChildren(); ++i)
+    {
+      stack1.push(&node1->Child(i));
+      stack2.push(&node2->Child(i));
+    }
+  }
+}
+
 /**
  * Make sure copy constructor works right for the binary space tree.
  */
@@ -2136,6 +2192,67 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeCopyConstructor)
   BOOST_REQUIRE_EQUAL(b.Right()->Right(), c.Right()->Right());
 }
 
+/**
+ * Make sure that a tree built with several threads is the same as one built
+ * with a single thread.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeParallelBuildTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  arma::mat dataset = arma::randu<arma::mat>(3, 50000);
+
+  std::vector<size_t> oldFromNew1, oldFromNew2;
+#ifdef HAS_OPENMP
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  TreeType tree1(dataset, oldFromNew1);
+#ifdef HAS_OPENMP
+  omp_set_num_threads(4);
+#endif
+  TreeType tree2(dataset, oldFromNew2);
+#ifdef HAS_OPENMP
+  omp_set_num_threads(prevNumThreads);
+#endif
+
+  BOOST_REQUIRE_EQUAL(oldFromNew1.size(), oldFromNew2.size());
+  for (size_t i = 0; i < oldFromNew1.size(); ++i)
+    BOOST_REQUIRE_EQUAL(oldFromNew1[i], oldFromNew2[i]);
+  CheckMatrices(tree1.Dataset(), tree2.Dataset());
+
+  // Walk both trees at once.
+  std::stack<TreeType*> stack1, stack2;
+  stack1.push(&tree1);
+  stack2.push(&tree2);
+  while (!stack1.empty())
+  {
+    TreeType* node1 = stack1.top();
+    TreeType* node2 = stack2.top();
+    stack1.pop();
+    stack2.pop();
+
+    BOOST_REQUIRE_EQUAL(node1->Begin(), node2->Begin());
+    BOOST_REQUIRE_EQUAL(node1->Count(), node2->Count());
+    BOOST_REQUIRE_EQUAL(node1->NumChildren(), node2->NumChildren());
+    BOOST_REQUIRE_CLOSE(node1->FurthestDescendantDistance(),
+        node2->FurthestDescendantDistance(), 1e-10);
+    if (node1->Parent() != NULL)
+    {
+      BOOST_REQUIRE_EQUAL(node1->Parent()->Begin(), node2->Parent()->Begin());
+      BOOST_REQUIRE_CLOSE(node1->ParentDistance(), node2->ParentDistance(),
+          1e-10);
+    }
+
+    for (size_t i = 0; i < node1->NumChildren(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(node1->Child(i).Parent(), node1);
+      BOOST_REQUIRE_EQUAL(node2->Child(i).Parent(), node2);
+      stack1.push(&node1->Child(i));
+      stack2.push(&node2->Child(i));
+    }
+  }
+}
+
 //! Count the number of leaves under this node.
 template<typename TreeType>
 size_t NumLeaves(TreeType* node)
@@ -2252,4 +2369,84 @@ BOOST_AUTO_TEST_CASE(CoverTreeDescendantTest)
   CheckDescendants(&tree);
 }
 
+/**
+ * Make sure that a tree that borrows its dataset references the caller's memory
+ * without copying it, leaves the dataset unchanged, and gives the points of
+ * each node in terms of the original dataset.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeBorrowDatasetTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  const arma::mat originalDataset(dataset);
+
+  TreeType tree(dataset, BorrowDataset(), 10);
+
+  BOOST_REQUIRE(tree.BorrowsDataset());
+  BOOST_REQUIRE_EQUAL(tree.Dataset().memptr(), dataset.memptr());
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1000);
+  for (size_t i = 0; i < dataset.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(dataset[i], originalDataset[i]);
+
+  // Each point must be held by exactly one leaf, and each node must contain all
+  // of its points.  A copy of the tree must hold the same points.
+  TreeType copy(tree);
+  BOOST_REQUIRE(copy.BorrowsDataset());
+  std::vector<size_t> counts(dataset.n_cols, 0);
+  std::stack<TreeType*> stack, copyStack;
+  stack.push(&tree);
+  copyStack.push(&copy);
+  while (!stack.empty())
+  {
+    TreeType* node = stack.top();
+    TreeType* copyNode = copyStack.top();
+    stack.pop();
+    copyStack.pop();
+
+    arma::mat points;
+    node->GatherPoints(points);
+    BOOST_REQUIRE_EQUAL(points.n_cols, node->NumDescendants());
+    for (size_t i = 0; i < node->NumDescendants(); ++i)
+    {
+      const size_t index = node->Descendant(i);
+      BOOST_REQUIRE_EQUAL(copyNode->Descendant(i), index);
+      BOOST_REQUIRE(node->Bound().Contains(dataset.col(index)));
+      for (size_t d = 0; d < dataset.n_rows; ++d)
+        BOOST_REQUIRE_EQUAL(points(d, i), dataset(d, index));
+    }
+
+    if (node->IsLeaf())
+    {
+      for (size_t i = 0; i < node->NumPoints(); ++i)
+        ++counts[node->Point(i)];
+    }
+    else
+    {
+      stack.push(node->Left());
+      stack.push(node->Right());
+      copyStack.push(copyNode->Left());
+      copyStack.push(copyNode->Right());
+    }
+  }
+
+  for (size_t i = 0; i < counts.size(); ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+}
+
+/**
+ * Make sure that the cover tree references the given dataset instead of copying
+ * it.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeNoCopyTest)
+{
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+
+  TreeType tree(dataset);
+
+  BOOST_REQUIRE_EQUAL(&tree.Dataset(), &dataset);
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 500);
+}
+
 BOOST_AUTO_TEST_SUITE_END();